@@ -1,198 +1,296 @@
-/* AST IMPLEMENTATION - FIXED FOR FUNCTIONS
- * Functions to create and manipulate Abstract Syntax Tree nodes
+/* AST IMPLEMENTATION
+ * Nodes are carved out of one array of 32-bit words per program, each
+ * only as large as its kind needs (a variable is three words, a binary
+ * operation four), and refer to their children and names by 32-bit
+ * ids. The whole tree goes at once with astClear or astFree.
  */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 #include "ast.h"
 
+#define INITIAL_WORDS 1024
+
+// Bytes of a node whose union member is member
+#define NODE_SIZE(member) (offsetof(ASTNode, data) + sizeof(((ASTNode*)0)->data.member))
+
+/* ============ ARENA ============ */
+
+void astInit(AST* ast, StringTable* names) {
+    memset(ast, 0, sizeof(AST));
+    ast->names = names;
+}
+
+// Forget every node but keep the memory for the next program
+void astClear(AST* ast) {
+    ast->size = 0;
+    ast->pendingCount = 0;
+    ast->failed = 0;
+}
+
+void astFree(AST* ast) {
+    free(ast->words);
+    free(ast->pending);
+    astInit(ast, ast->names);
+}
+
+// Memory ran out: the tree is marked failed and the node that could
+// not be made is "no node", which the constructors pass along
+static NodeId outOfMemory(AST* ast) {
+    ast->failed = 1;
+    return 0;
+}
+
+// Room for a node of size bytes; returns its id with the type set, or
+// 0 if memory ran out
+static NodeId newNode(AST* ast, NodeType type, size_t size) {
+    uint32_t words = (uint32_t)((size + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+    if (ast->size == 0) ast->size = 1;
+    if ((uint64_t)ast->size + words > ast->capacity) {
+        uint64_t capacity = ast->capacity ? ast->capacity : INITIAL_WORDS;
+        while (capacity < (uint64_t)ast->size + words) capacity *= 2;
+        if (capacity > UINT32_MAX) return outOfMemory(ast);
+        uint32_t* grown = realloc(ast->words, capacity * sizeof(uint32_t));
+        if (!grown) return outOfMemory(ast);
+        ast->words = grown;
+        ast->capacity = (uint32_t)capacity;
+    }
+    NodeId id = ast->size;
+    ast->size += words;
+    astNode(ast, id)->type = type;
+    return id;
+}
+
+// The same for a node that names something: name 0 means interning the
+// name ran out of memory (intern.h), which fails the tree as well
+static NodeId newNamedNode(AST* ast, NameId name, NodeType type, size_t size) {
+    return name ? newNode(ast, type, size) : outOfMemory(ast);
+}
+
+/* ============ CONSTRUCTION ============ */
+
 /* Create a function declaration node */
-ASTNode* createFuncDecl(char* returnType, char* name, ASTNode* params, ASTNode* body) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_FUNC_DECL;
-    node->data.func_decl.returnType = strdup(returnType);
-    node->data.func_decl.name = strdup(name);
+NodeId createFuncDecl(AST* ast, NameId returnType, NameId name, NodeId params, NodeId body) {
+    NodeId id = newNamedNode(ast, returnType ? name : 0, NODE_FUNC_DECL, NODE_SIZE(func_decl));
+    if (!id) return 0;
+    ASTNode* node = astNode(ast, id);
+    node->data.func_decl.returnType = returnType;
+    node->data.func_decl.name = name;
     node->data.func_decl.params = params;
     node->data.func_decl.body = body;
-    return node;
+    return id;
 }
 
 /* Create a function call node */
-ASTNode* createFuncCall(char* name, ASTNode* args) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_FUNC_CALL;
-    node->data.func_call.name = strdup(name);
+NodeId createFuncCall(AST* ast, NameId name, NodeId args) {
+    NodeId id = newNamedNode(ast, name, NODE_FUNC_CALL, NODE_SIZE(func_call));
+    if (!id) return 0;
+    ASTNode* node = astNode(ast, id);
+    node->data.func_call.name = name;
     node->data.func_call.args = args;
-    return node;
+    node->data.func_call.function = 0;
+    return id;
 }
 
 /* Create a parameter node */
-ASTNode* createParam(char* type, char* name) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_PARAM;
-    node->data.param.type = strdup(type);
-    node->data.param.name = strdup(name);
-    return node;
-}
-
-/* Create a parameter list node */
-ASTNode* createParamList(ASTNode* param, ASTNode* next) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_PARAM_LIST;
-    node->data.list.item = param;
-    node->data.list.next = next;
-    return node;
-}
-
-/* Create an argument list node */
-ASTNode* createArgList(ASTNode* arg, ASTNode* next) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_ARG_LIST;
-    node->data.list.item = arg;
-    node->data.list.next = next;
-    return node;
+NodeId createParam(AST* ast, NameId type, NameId name) {
+    NodeId id = newNamedNode(ast, type ? name : 0, NODE_PARAM, NODE_SIZE(param));
+    if (!id) return 0;
+    ASTNode* node = astNode(ast, id);
+    node->data.param.type = type;
+    node->data.param.name = name;
+    return id;
 }
 
 /* Create a return statement node */
-ASTNode* createReturn(ASTNode* expr) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_RETURN;
-    node->data.return_expr = expr;
-    return node;
-}
-
-/* Create a function list node */
-ASTNode* createFuncList(ASTNode* func, ASTNode* next) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_FUNC_LIST;
-    node->data.list.item = func;
-    node->data.list.next = next;
-    return node;
+NodeId createReturn(AST* ast, NodeId expr) {
+    NodeId id = newNode(ast, NODE_RETURN, NODE_SIZE(return_expr));
+    if (!id) return 0;
+    astNode(ast, id)->data.return_expr = expr;
+    return id;
 }
 
 /* Create a number literal node */
-ASTNode* createNum(int value) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_NUM;
-    node->data.num = value;
-    return node;
+NodeId createNum(AST* ast, int value) {
+    NodeId id = newNode(ast, NODE_NUM, NODE_SIZE(num));
+    if (!id) return 0;
+    astNode(ast, id)->data.num = value;
+    return id;
 }
 
 /* Create a variable reference node */
-ASTNode* createVar(char* name) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_VAR;
-    node->data.name = strdup(name);
-    return node;
+NodeId createVar(AST* ast, NameId name) {
+    NodeId id = newNamedNode(ast, name, NODE_VAR, NODE_SIZE(var));
+    if (!id) return 0;
+    ASTNode* node = astNode(ast, id);
+    node->data.var.name = name;
+    node->data.var.symbol = 0;
+    return id;
 }
 
 /* Create a binary operation node */
-ASTNode* createBinOp(char op, ASTNode* left, ASTNode* right) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_BINOP;
+NodeId createBinOp(AST* ast, char op, NodeId left, NodeId right) {
+    NodeId id = newNode(ast, NODE_BINOP, NODE_SIZE(binop));
+    if (!id) return 0;
+    ASTNode* node = astNode(ast, id);
     node->data.binop.op = op;
     node->data.binop.left = left;
     node->data.binop.right = right;
-    return node;
+    return id;
 }
 
 /* Create a variable declaration node */
-ASTNode* createDecl(char* name) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_DECL;
-    node->data.name = strdup(name);
-    return node;
+NodeId createDecl(AST* ast, NameId name) {
+    NodeId id = newNamedNode(ast, name, NODE_DECL, NODE_SIZE(name));
+    if (!id) return 0;
+    astNode(ast, id)->data.name = name;
+    return id;
 }
 
 /* Create an assignment statement node */
-ASTNode* createAssign(char* var, ASTNode* value) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_ASSIGN;
-    node->data.assign.var = strdup(var);
+NodeId createAssign(AST* ast, NameId var, NodeId value) {
+    NodeId id = newNamedNode(ast, var, NODE_ASSIGN, NODE_SIZE(assign));
+    if (!id) return 0;
+    ASTNode* node = astNode(ast, id);
+    node->data.assign.var = var;
     node->data.assign.value = value;
-    return node;
+    node->data.assign.symbol = 0;
+    return id;
 }
 
 /* Create a print statement node */
-ASTNode* createPrint(ASTNode* expr) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_PRINT;
-    node->data.expr = expr;
-    return node;
+NodeId createPrint(AST* ast, NodeId expr) {
+    NodeId id = newNode(ast, NODE_PRINT, NODE_SIZE(expr));
+    if (!id) return 0;
+    astNode(ast, id)->data.expr = expr;
+    return id;
 }
 
 /* Create an array declaration node */
-ASTNode* createArrayDecl(char* name, int size) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_ARRAY_DECL;
-    node->data.array_decl.name = strdup(name);
+NodeId createArrayDecl(AST* ast, NameId name, int size) {
+    NodeId id = newNamedNode(ast, name, NODE_ARRAY_DECL, NODE_SIZE(array_decl));
+    if (!id) return 0;
+    ASTNode* node = astNode(ast, id);
+    node->data.array_decl.name = name;
     node->data.array_decl.size = size;
-    return node;
+    return id;
 }
 
 /* Create an array element assignment node */
-ASTNode* createArrayAssign(char* name, ASTNode* index, ASTNode* value) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_ARRAY_ASSIGN;
-    node->data.array_assign.name = strdup(name);
+NodeId createArrayAssign(AST* ast, NameId name, NodeId index, NodeId value) {
+    NodeId id = newNamedNode(ast, name, NODE_ARRAY_ASSIGN, NODE_SIZE(array_assign));
+    if (!id) return 0;
+    ASTNode* node = astNode(ast, id);
+    node->data.array_assign.name = name;
     node->data.array_assign.index = index;
     node->data.array_assign.value = value;
-    return node;
+    node->data.array_assign.symbol = 0;
+    return id;
 }
 
 /* Create an array element access node */
-ASTNode* createArrayAccess(char* name, ASTNode* index) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_ARRAY_ACCESS;
-    node->data.array_access.name = strdup(name);
+NodeId createArrayAccess(AST* ast, NameId name, NodeId index) {
+    NodeId id = newNamedNode(ast, name, NODE_ARRAY_ACCESS, NODE_SIZE(array_access));
+    if (!id) return 0;
+    ASTNode* node = astNode(ast, id);
+    node->data.array_access.name = name;
     node->data.array_access.index = index;
-    return node;
+    node->data.array_access.symbol = 0;
+    return id;
 }
 
 /* Create a 2D array declaration node */
-ASTNode* createArray2DDecl(char* name, int rows, int cols) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_ARRAY_2D_DECL;
-    node->data.array_2d_decl.name = strdup(name);
+NodeId createArray2DDecl(AST* ast, NameId name, int rows, int cols) {
+    NodeId id = newNamedNode(ast, name, NODE_ARRAY_2D_DECL, NODE_SIZE(array_2d_decl));
+    if (!id) return 0;
+    ASTNode* node = astNode(ast, id);
+    node->data.array_2d_decl.name = name;
     node->data.array_2d_decl.rows = rows;
     node->data.array_2d_decl.cols = cols;
-    return node;
+    return id;
 }
 
 /* Create a 2D array element assignment node */
-ASTNode* createArray2DAssign(char* name, ASTNode* row, ASTNode* col, ASTNode* value) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_ARRAY_2D_ASSIGN;
-    node->data.array_2d_assign.name = strdup(name);
+NodeId createArray2DAssign(AST* ast, NameId name, NodeId row, NodeId col, NodeId value) {
+    NodeId id = newNamedNode(ast, name, NODE_ARRAY_2D_ASSIGN, NODE_SIZE(array_2d_assign));
+    if (!id) return 0;
+    ASTNode* node = astNode(ast, id);
+    node->data.array_2d_assign.name = name;
     node->data.array_2d_assign.row = row;
     node->data.array_2d_assign.col = col;
     node->data.array_2d_assign.value = value;
-    return node;
+    node->data.array_2d_assign.symbol = 0;
+    return id;
 }
 
 /* Create a 2D array element access node */
-ASTNode* createArray2DAccess(char* name, ASTNode* row, ASTNode* col) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_ARRAY_2D_ACCESS;
-    node->data.array_2d_access.name = strdup(name);
+NodeId createArray2DAccess(AST* ast, NameId name, NodeId row, NodeId col) {
+    NodeId id = newNamedNode(ast, name, NODE_ARRAY_2D_ACCESS, NODE_SIZE(array_2d_access));
+    if (!id) return 0;
+    ASTNode* node = astNode(ast, id);
+    node->data.array_2d_access.name = name;
     node->data.array_2d_access.row = row;
     node->data.array_2d_access.col = col;
-    return node;
+    node->data.array_2d_access.symbol = 0;
+    return id;
+}
+
+/* ============ LISTS ============ */
+
+uint32_t beginList(AST* ast) {
+    return ast->pendingCount;
+}
+
+void appendToList(AST* ast, NodeId item) {
+    if (ast->pendingCount == ast->pendingCapacity) {
+        uint32_t capacity = ast->pendingCapacity ? ast->pendingCapacity * 2 : 256;
+        NodeId* grown = realloc(ast->pending, capacity * sizeof(NodeId));
+        if (!grown) {
+            outOfMemory(ast);
+            return;
+        }
+        ast->pending = grown;
+        ast->pendingCapacity = capacity;
+    }
+    ast->pending[ast->pendingCount++] = item;
+}
+
+/* Move the items pushed since start into a list node */
+NodeId endList(AST* ast, NodeType type, uint32_t start) {
+    uint32_t count = ast->pendingCount - start;
+    NodeId id = newNode(ast, type, offsetof(ASTNode, data.list.items) + count * sizeof(NodeId));
+    if (!id) {
+        ast->pendingCount = start;
+        return 0;
+    }
+    ASTNode* node = astNode(ast, id);
+    node->data.list.count = count;
+    memcpy(node->data.list.items, ast->pending + start, count * sizeof(NodeId));
+    ast->pendingCount = start;
+    return id;
 }
 
-/* Create a statement list node */
-ASTNode* createStmtList(ASTNode* stmt1, ASTNode* stmt2) {
-    ASTNode* node = malloc(sizeof(ASTNode));
-    node->type = NODE_STMT_LIST;
-    node->data.stmtlist.stmt = stmt1;
-    node->data.stmtlist.next = stmt2;
-    return node;
+/* ============ TRAVERSAL ============ */
+
+static int isList(const ASTNode* node) {
+    return node->type == NODE_STMT_LIST || node->type == NODE_PARAM_LIST ||
+           node->type == NODE_ARG_LIST || node->type == NODE_FUNC_LIST;
 }
 
 /* Display the AST structure */
-void printAST(ASTNode* node, int level) {
+void printAST(const AST* ast, NodeId id, int level) {
+    ASTNode* node = astNode(ast, id);
     if (!node) return;
     
+    // Lists show only their items, at the list's own level
+    if (isList(node)) {
+        for (int i = 0; i < node->data.list.count; i++) {
+            printAST(ast, node->data.list.items[i], level);
+        }
+        return;
+    }
+    
     for (int i = 0; i < level; i++) printf("  ");
     
     switch(node->type) {
@@ -200,109 +298,115 @@ void printAST(ASTNode* node, int level) {
             printf("NUM: %d\n", node->data.num);
             break;
         case NODE_VAR:
-            printf("VAR: %s\n", node->data.name);
+            printf("VAR: %s\n", astName(ast, node->data.var.name));
             break;
         case NODE_BINOP:
             printf("BINOP: %c\n", node->data.binop.op);
-            printAST(node->data.binop.left, level + 1);
-            printAST(node->data.binop.right, level + 1);
+            printAST(ast, node->data.binop.left, level + 1);
+            printAST(ast, node->data.binop.right, level + 1);
             break;
         case NODE_DECL:
-            printf("DECL: %s\n", node->data.name);
+            printf("DECL: %s\n", astName(ast, node->data.name));
             break;
         case NODE_ASSIGN:
-            printf("ASSIGN TO: %s\n", node->data.assign.var);
-            printAST(node->data.assign.value, level + 1);
+            printf("ASSIGN TO: %s\n", astName(ast, node->data.assign.var));
+            printAST(ast, node->data.assign.value, level + 1);
             break;
         case NODE_PRINT:
             printf("PRINT\n");
-            printAST(node->data.expr, level + 1);
-            break;
-        case NODE_STMT_LIST:
-            printAST(node->data.stmtlist.stmt, level);
-            printAST(node->data.stmtlist.next, level);
+            printAST(ast, node->data.expr, level + 1);
             break;
         case NODE_ARRAY_DECL:
-            printf("ARRAY_DECL: %s[%d]\n", node->data.array_decl.name, node->data.array_decl.size);
+            printf("ARRAY_DECL: %s[%d]\n", astName(ast, node->data.array_decl.name), node->data.array_decl.size);
             break;
         case NODE_ARRAY_ASSIGN:
-            printf("ARRAY_ASSIGN TO: %s\n", node->data.array_assign.name);
+            printf("ARRAY_ASSIGN TO: %s\n", astName(ast, node->data.array_assign.name));
             for (int i = 0; i < level + 1; i++) printf("   ");
             printf("Index:\n");
-            printAST(node->data.array_assign.index, level + 2);
+            printAST(ast, node->data.array_assign.index, level + 2);
             for (int i = 0; i < level + 1; i++) printf("   ");
             printf("Value:\n");
-            printAST(node->data.array_assign.value, level + 2);
+            printAST(ast, node->data.array_assign.value, level + 2);
             break;
         case NODE_ARRAY_ACCESS:
-            printf("ARRAY_ACCESS: %s\n", node->data.array_access.name);
+            printf("ARRAY_ACCESS: %s\n", astName(ast, node->data.array_access.name));
             for (int i = 0; i < level + 1; i++) printf("   ");
             printf("Index:\n");
-            printAST(node->data.array_access.index, level + 2);
+            printAST(ast, node->data.array_access.index, level + 2);
             break;
         case NODE_ARRAY_2D_DECL:
             printf("ARRAY_2D_DECL: %s[%d][%d]\n", 
-                   node->data.array_2d_decl.name, 
+                   astName(ast, node->data.array_2d_decl.name), 
                    node->data.array_2d_decl.rows, 
                    node->data.array_2d_decl.cols);
             break;
         case NODE_ARRAY_2D_ASSIGN:
-            printf("ARRAY_2D_ASSIGN TO: %s\n", node->data.array_2d_assign.name);
+            printf("ARRAY_2D_ASSIGN TO: %s\n", astName(ast, node->data.array_2d_assign.name));
             for (int i = 0; i < level + 1; i++) printf("   ");
             printf("Row:\n");
-            printAST(node->data.array_2d_assign.row, level + 2);
+            printAST(ast, node->data.array_2d_assign.row, level + 2);
             for (int i = 0; i < level + 1; i++) printf("   ");
             printf("Col:\n");
-            printAST(node->data.array_2d_assign.col, level + 2);
+            printAST(ast, node->data.array_2d_assign.col, level + 2);
             for (int i = 0; i < level + 1; i++) printf("   ");
             printf("Value:\n");
-            printAST(node->data.array_2d_assign.value, level + 2);
+            printAST(ast, node->data.array_2d_assign.value, level + 2);
             break;
         case NODE_ARRAY_2D_ACCESS:
-            printf("ARRAY_2D_ACCESS: %s\n", node->data.array_2d_access.name);
+            printf("ARRAY_2D_ACCESS: %s\n", astName(ast, node->data.array_2d_access.name));
             for (int i = 0; i < level + 1; i++) printf("   ");
             printf("Row:\n");
-            printAST(node->data.array_2d_access.row, level + 2);
+            printAST(ast, node->data.array_2d_access.row, level + 2);
             for (int i = 0; i < level + 1; i++) printf("   ");
             printf("Col:\n");
-            printAST(node->data.array_2d_access.col, level + 2);
+            printAST(ast, node->data.array_2d_access.col, level + 2);
             break;
         case NODE_FUNC_DECL:
-            printf("FUNC_DECL: %s %s\n", node->data.func_decl.returnType, node->data.func_decl.name);
+            printf("FUNC_DECL: %s %s\n", astName(ast, node->data.func_decl.returnType), astName(ast, node->data.func_decl.name));
             if (node->data.func_decl.params) {
                 for (int i = 0; i < level + 1; i++) printf("   ");
                 printf("Parameters:\n");
-                printAST(node->data.func_decl.params, level + 2);
+                printAST(ast, node->data.func_decl.params, level + 2);
             }
             for (int i = 0; i < level + 1; i++) printf("   ");
             printf("Body:\n");
-            printAST(node->data.func_decl.body, level + 2);
+            printAST(ast, node->data.func_decl.body, level + 2);
             break;
         case NODE_FUNC_CALL:
-            printf("FUNC_CALL: %s\n", node->data.func_call.name);
+            printf("FUNC_CALL: %s\n", astName(ast, node->data.func_call.name));
             if (node->data.func_call.args) {
                 for (int i = 0; i < level + 1; i++) printf("   ");
                 printf("Arguments:\n");
-                printAST(node->data.func_call.args, level + 2);
+                printAST(ast, node->data.func_call.args, level + 2);
             }
             break;
         case NODE_PARAM:
-            printf("PARAM: %s %s\n", node->data.param.type, node->data.param.name);
-            break;
-        case NODE_PARAM_LIST:
-        case NODE_ARG_LIST:
-            printAST(node->data.list.item, level);
-            printAST(node->data.list.next, level);
+            printf("PARAM: %s %s\n", astName(ast, node->data.param.type), astName(ast, node->data.param.name));
             break;
         case NODE_RETURN:
             printf("RETURN\n");
             if (node->data.return_expr) {
-                printAST(node->data.return_expr, level + 1);
+                printAST(ast, node->data.return_expr, level + 1);
             }
             break;
-        case NODE_FUNC_LIST:
-            printAST(node->data.list.item, level);
-            printAST(node->data.list.next, level);
+        default:
             break;
     }
-}
\ No newline at end of file
+}
+
+/* The top-level items of a program (its functions) in source order, as
+ * a malloc'd array in *funcs. Returns how many there are, or -1 if
+ * memory ran out. */
+int collectFunctions(const AST* ast, NodeId root, NodeId** funcs) {
+    ASTNode* node = astNode(ast, root);
+    int isList = node && node->type == NODE_FUNC_LIST;
+    int count = isList ? (int)node->data.list.count : node != NULL;
+    *funcs = malloc((count ? count : 1) * sizeof(NodeId));
+    if (!*funcs) return -1;
+    if (isList) {
+        memcpy(*funcs, node->data.list.items, count * sizeof(NodeId));
+    } else if (node) {
+        (*funcs)[0] = root;
+    }
+    return count;
+}
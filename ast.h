@@ -1,6 +1,9 @@
 #ifndef AST_H
 #define AST_H
 
+#include <stdint.h>
+#include "intern.h"
+
 /* NODE TYPES - Different kinds of AST nodes in our language */
 typedef enum {
     NODE_NUM,
@@ -25,7 +28,21 @@ typedef enum {
     NODE_FUNC_LIST
 } NodeType;
 
-/* AST NODE STRUCTURE */
+/* NODE AND NAME IDS
+ * Nodes live in their AST's arena and refer to each other by position
+ * in it, as 32-bit ids; 0 is "no node". Names are the ids the
+ * context's string table gives them (intern.h); 0 is "no name".
+ * Symbols and functions are numbered by the binding pass (symtab.h),
+ * which stores them in the nodes that use them; 0 is "not bound". */
+typedef uint32_t NodeId;
+typedef uint32_t NameId;
+typedef uint32_t SymbolId;
+typedef uint32_t FunctionId;
+
+/* AST NODE STRUCTURE
+ * A node takes only the words its kind needs: the type, then its
+ * member of the union. Use astNode() to look at one; the view stays
+ * valid until more nodes are added. */
 typedef struct ASTNode {
     NodeType type;
     
@@ -33,126 +50,167 @@ typedef struct ASTNode {
         /* Literal number value */
         int num;
         
-        /* Variable or declaration name */
-        char* name;
+        /* Declaration name */
+        NameId name;
+
+        /* Variable reference */
+        struct {
+            NameId name;
+            SymbolId symbol;
+        } var;
         
         /* Binary operation structure */
         struct {
             char op;
-            struct ASTNode* left;
-            struct ASTNode* right;
+            NodeId left;
+            NodeId right;
         } binop;
         
         /* Assignment structure */
         struct {
-            char* var;
-            struct ASTNode* value;
+            NameId var;
+            NodeId value;
+            SymbolId symbol;
         } assign;
         
         /* Array declaration */
         struct {
-            char* name;
+            NameId name;
             int size;
         } array_decl;
 
         /* Array element assignment */
         struct {
-            char* name;
-            struct ASTNode* index;
-            struct ASTNode* value;
+            NameId name;
+            NodeId index;
+            NodeId value;
+            SymbolId symbol;
         } array_assign;
 
         /* Array element access */
         struct {
-            char* name;
-            struct ASTNode* index;
+            NameId name;
+            NodeId index;
+            SymbolId symbol;
         } array_access;
 
         /* 2D Array declaration */
         struct {
-            char* name;
+            NameId name;
             int rows;
             int cols;
         } array_2d_decl;
 
         /* 2D Array element assignment */
         struct {
-            char* name;
-            struct ASTNode* row;
-            struct ASTNode* col;
-            struct ASTNode* value;
+            NameId name;
+            NodeId row;
+            NodeId col;
+            NodeId value;
+            SymbolId symbol;
         } array_2d_assign;
 
         /* 2D Array element access */
         struct {
-            char* name;
-            struct ASTNode* row;
-            struct ASTNode* col;
+            NameId name;
+            NodeId row;
+            NodeId col;
+            SymbolId symbol;
         } array_2d_access;
         
         /* Function declaration */
         struct {
-            char* returnType;
-            char* name;
-            struct ASTNode* params;
-            struct ASTNode* body;
+            NameId returnType;
+            NameId name;
+            NodeId params;
+            NodeId body;
         } func_decl;
         
         /* Function call */
         struct {
-            char* name;
-            struct ASTNode* args;
+            NameId name;
+            NodeId args;
+            FunctionId function;
         } func_call;
         
         /* Parameter */
         struct {
-            char* type;
-            char* name;
+            NameId type;
+            NameId name;
         } param;
         
-        /* Lists (params, args, functions, statements) */
+        /* Lists (params, args, functions, statements): the items in
+         * source order, stored right after the count */
         struct {
-            struct ASTNode* item;
-            struct ASTNode* next;
+            uint32_t count;
+            NodeId items[];
         } list;
         
         /* Return statement */
-        struct ASTNode* return_expr;
+        NodeId return_expr;
         
         /* Print expression */
-        struct ASTNode* expr;
-        
-        /* Statement list structure */
-        struct {
-            struct ASTNode* stmt;
-            struct ASTNode* next;
-        } stmtlist;
+        NodeId expr;
     } data;
 } ASTNode;
 
+/* A program's nodes, in one growing array of words. Lists are built on
+ * the pending stack while they are parsed: a list opens, its items are
+ * pushed as they are reduced, and it is copied into the arena whole
+ * when it closes. Lists nest, so the one being appended to is always
+ * on top. If memory runs out, the constructors return 0 from then on
+ * and the tree is marked failed for the parser to report. */
+typedef struct AST {
+    uint32_t* words;
+    uint32_t size;          // Words in use; word 0 is never a node
+    uint32_t capacity;
+    NodeId* pending;        // Items of the lists still being parsed
+    uint32_t pendingCount;
+    uint32_t pendingCapacity;
+    StringTable* names;     // What NameIds refer to
+    int failed;             // Memory ran out while the tree was built
+} AST;
+
+void astInit(AST* ast, StringTable* names);
+void astClear(AST* ast);
+void astFree(AST* ast);
+
+static inline ASTNode* astNode(const AST* ast, NodeId id) {
+    return id ? (ASTNode*)(ast->words + id) : NULL;
+}
+
+static inline const char* astName(const AST* ast, NameId id) {
+    return nameText(ast->names, id);
+}
+
 /* AST CONSTRUCTION FUNCTIONS */
-ASTNode* createNum(int value);
-ASTNode* createVar(char* name);
-ASTNode* createBinOp(char op, ASTNode* left, ASTNode* right);
-ASTNode* createDecl(char* name);
-ASTNode* createAssign(char* var, ASTNode* value);
-ASTNode* createPrint(ASTNode* expr);
-ASTNode* createStmtList(ASTNode* stmt1, ASTNode* stmt2);
-ASTNode* createArrayDecl(char* name, int size);
-ASTNode* createArrayAssign(char* name, ASTNode* index, ASTNode* value);
-ASTNode* createArrayAccess(char* name, ASTNode* index);
-ASTNode* createArray2DDecl(char* name, int rows, int cols);
-ASTNode* createArray2DAssign(char* name, ASTNode* row, ASTNode* col, ASTNode* value);
-ASTNode* createArray2DAccess(char* name, ASTNode* row, ASTNode* col);
-ASTNode* createFuncDecl(char* returnType, char* name, ASTNode* params, ASTNode* body);
-ASTNode* createFuncCall(char* name, ASTNode* args);
-ASTNode* createParam(char* type, char* name);
-ASTNode* createParamList(ASTNode* param, ASTNode* next);
-ASTNode* createArgList(ASTNode* arg, ASTNode* next);
-ASTNode* createReturn(ASTNode* expr);
-ASTNode* createFuncList(ASTNode* func, ASTNode* next);
+NodeId createNum(AST* ast, int value);
+NodeId createVar(AST* ast, NameId name);
+NodeId createBinOp(AST* ast, char op, NodeId left, NodeId right);
+NodeId createDecl(AST* ast, NameId name);
+NodeId createAssign(AST* ast, NameId var, NodeId value);
+NodeId createPrint(AST* ast, NodeId expr);
+NodeId createArrayDecl(AST* ast, NameId name, int size);
+NodeId createArrayAssign(AST* ast, NameId name, NodeId index, NodeId value);
+NodeId createArrayAccess(AST* ast, NameId name, NodeId index);
+NodeId createArray2DDecl(AST* ast, NameId name, int rows, int cols);
+NodeId createArray2DAssign(AST* ast, NameId name, NodeId row, NodeId col, NodeId value);
+NodeId createArray2DAccess(AST* ast, NameId name, NodeId row, NodeId col);
+NodeId createFuncDecl(AST* ast, NameId returnType, NameId name, NodeId params, NodeId body);
+NodeId createFuncCall(AST* ast, NameId name, NodeId args);
+NodeId createParam(AST* ast, NameId type, NameId name);
+NodeId createReturn(AST* ast, NodeId expr);
+
+/* Lists: beginList returns the list's place on the pending stack,
+ * which endList takes to turn it into a node of the given list type */
+uint32_t beginList(AST* ast);
+void appendToList(AST* ast, NodeId item);
+NodeId endList(AST* ast, NodeType type, uint32_t start);
 
 /* AST DISPLAY FUNCTION */
-void printAST(ASTNode* node, int level);
+void printAST(const AST* ast, NodeId id, int level);
+
+/* AST TRAVERSAL */
+int collectFunctions(const AST* ast, NodeId root, NodeId** funcs);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,653 @@
+/* COMPILER THROUGHPUT BENCHMARK
+ * Generates synthetic programs that each stress one part of the
+ * compiler, compiles them and reports lines per second, the time of
+ * every phase (from --stats-json) and the peak RSS of the compiler
+ * process. Results can be saved as a baseline; later runs are compared
+ * against it and workloads that got slower or bigger are flagged.
+ *
+ *   bench gen <workload> <size> [seed]     print one program
+ *   bench run [options] <compiler>         run every workload
+ *   bench lex [--runs=n] [--dir=d] <compiler>
+ *                                          scanner throughput, every scanner
+ *   bench parse [--runs=n] [--dir=d] <compiler>
+ *                                          lex+parse throughput, both parsers
+ *
+ * Options of run:
+ *   --runs=<n>          Compile each program n times, keep the fastest
+ *   --dir=<dir>         Where programs and results go (bench/work)
+ *   --baseline=<file>   Baseline to compare with (bench/baseline.txt)
+ *   --save              Write this run as the new baseline
+ *   --tolerance=<pct>   Slowdown or growth that counts as a regression
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#define MAX_PHASES 32
+#define MAX_WORKLOADS 16
+#define NAME_SIZE 64
+
+/* ============ PROGRAM GENERATORS ============ */
+
+/* Every generator writes a complete program of roughly the given size
+ * with a main, using only what the language has: int scalars and
+ * arrays, + - *, calls, print and return. */
+
+static unsigned long long rngState;
+
+static unsigned randomInt(unsigned limit) {
+    // xorshift64*: the same seed gives the same program everywhere
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    return (unsigned)((rngState * 2685821657736338717ULL) >> 33) % limit;
+}
+
+static char randomOp() {
+    return "+-*"[randomInt(3)];
+}
+
+// Many small functions, each called once from main
+static void genFunctions(FILE* out, int size) {
+    for (int i = 0; i < size; i++) {
+        fprintf(out, "int f%d(int a, int b) {\n", i);
+        fprintf(out, "    int x;\n    int y;\n");
+        fprintf(out, "    x = a + b * %u;\n", randomInt(100));
+        fprintf(out, "    y = x - a;\n");
+        fprintf(out, "    return y %c %u;\n}\n\n", randomOp(), randomInt(100));
+    }
+    fprintf(out, "int main() {\n    int r;\n    r = 0;\n");
+    for (int i = 0; i < size; i++) {
+        fprintf(out, "    r = r + f%d(%d, r);\n", i, i);
+    }
+    fprintf(out, "    print(r);\n    return 0;\n}\n");
+}
+
+// One function with a very long statement list over a few variables
+static void genStatements(FILE* out, int size) {
+    const int vars = 50;
+    fprintf(out, "int main() {\n");
+    for (int v = 0; v < vars; v++) fprintf(out, "    int v%d;\n", v);
+    for (int v = 0; v < vars; v++) fprintf(out, "    v%d = %d;\n", v, v);
+    for (int i = 0; i < size; i++) {
+        if (i % 16 == 15) {
+            fprintf(out, "    print(v%u);\n", randomInt(vars));
+        } else {
+            fprintf(out, "    v%u = v%u %c v%u %c %u;\n", randomInt(vars), randomInt(vars),
+                    randomOp(), randomInt(vars), randomOp(), randomInt(1000));
+        }
+    }
+    fprintf(out, "    return 0;\n}\n");
+}
+
+// Expression nested depth levels deep, alternately leaning left
+// ((a + 1) * b) and right a + (1 * (b ...)) so both the parser stack
+// and the recursive passes over expressions get deep
+static void genNested(FILE* out, int depth, int leanLeft) {
+    if (depth == 0) {
+        fprintf(out, "v%u", randomInt(8));
+        return;
+    }
+    if (leanLeft) {
+        fprintf(out, "(");
+        genNested(out, depth - 1, leanLeft);
+        fprintf(out, " %c %u)", randomOp(), randomInt(10));
+    } else {
+        fprintf(out, "%u %c (", randomInt(10), randomOp());
+        genNested(out, depth - 1, leanLeft);
+        fprintf(out, ")");
+    }
+}
+
+static void genNesting(FILE* out, int size) {
+    const int perFunction = 50, depth = 200;
+    int functions = (size + perFunction - 1) / perFunction;
+    for (int f = 0; f < functions; f++) {
+        fprintf(out, "int n%d(int v0) {\n", f);
+        for (int v = 1; v < 8; v++) fprintf(out, "    int v%d;\n    v%d = v0 + %d;\n", v, v, v);
+        for (int i = 0; i < perFunction && f * perFunction + i < size; i++) {
+            fprintf(out, "    v%u = ", randomInt(8));
+            genNested(out, depth, i % 2 == 0);
+            fprintf(out, ";\n");
+        }
+        fprintf(out, "    return v1;\n}\n\n");
+    }
+    fprintf(out, "int main() {\n");
+    for (int f = 0; f < functions; f++) fprintf(out, "    print(n%d(%d));\n", f, f);
+    fprintf(out, "    return 0;\n}\n");
+}
+
+// Large 1D and 2D arrays read and written at computed indices
+static void genArrays(FILE* out, int size) {
+    const int perFunction = 200, length = 1024, rows = 32, cols = 32;
+    int functions = (size + perFunction - 1) / perFunction;
+    for (int f = 0; f < functions; f++) {
+        fprintf(out, "int a%d(int i) {\n", f);
+        fprintf(out, "    int v[%d];\n    int m[%d][%d];\n    int j;\n    j = i + 1;\n", length, rows, cols);
+        for (int s = 0; s < perFunction && f * perFunction + s < size; s++) {
+            switch (s % 4) {
+                case 0:
+                    fprintf(out, "    v[%u] = i * %u + j;\n", randomInt(length), randomInt(100));
+                    break;
+                case 1:
+                    fprintf(out, "    m[%u][%u] = v[%u] + v[i + %u];\n", randomInt(rows), randomInt(cols),
+                            randomInt(length), randomInt(length / 2));
+                    break;
+                case 2:
+                    fprintf(out, "    v[j + %u] = m[i][%u] %c m[%u][j];\n", randomInt(length / 2),
+                            randomInt(cols), randomOp(), randomInt(rows));
+                    break;
+                default:
+                    fprintf(out, "    j = m[%u][%u] + v[%u];\n", randomInt(rows), randomInt(cols),
+                            randomInt(length));
+                    break;
+            }
+        }
+        fprintf(out, "    return j;\n}\n\n");
+    }
+    fprintf(out, "int main() {\n");
+    for (int f = 0; f < functions; f++) fprintf(out, "    print(a%d(%d));\n", f, f % 8);
+    fprintf(out, "    return 0;\n}\n");
+}
+
+// A dense call graph: every function calls several earlier ones
+static void genCalls(FILE* out, int size) {
+    fprintf(out, "int c0(int a, int b, int c) {\n    return a + b * c;\n}\n\n");
+    for (int i = 1; i < size; i++) {
+        fprintf(out, "int c%d(int a, int b, int c) {\n    int x;\n    int y;\n", i);
+        fprintf(out, "    x = c%u(a, b, c) + c%u(b, c, a) * c%u(c, %u, a);\n",
+                randomInt(i), randomInt(i), randomInt(i), randomInt(10));
+        fprintf(out, "    y = c%u(x, a, b + %u) - c%u(y, x, c);\n", randomInt(i), randomInt(10), randomInt(i));
+        fprintf(out, "    return x + y;\n}\n\n");
+    }
+    fprintf(out, "int main() {\n    print(c%d(1, 2, 3));\n    return 0;\n}\n", size - 1);
+}
+
+// Deeply indented statements under long comments and blank lines, like
+// machine-generated source, where most bytes are never tokens
+static void genComments(FILE* out, int size) {
+    const int vars = 20;
+    fprintf(out, "int main() {\n");
+    for (int v = 0; v < vars; v++) fprintf(out, "    int value_%d;\n    value_%d = %d;\n", v, v, v);
+    for (int i = 0; i < size; i++) {
+        fprintf(out, "\n                // step %d: fold value_%u into value_%u and keep the running total "
+                "in range\n", i, randomInt(vars), randomInt(vars));
+        fprintf(out, "                value_%u = value_%u %c value_%u;\n", randomInt(vars), randomInt(vars),
+                randomOp(), randomInt(vars));
+        if (i % 64 == 63) fprintf(out, "                print(value_%u);\n", randomInt(vars));
+    }
+    fprintf(out, "    return 0;\n}\n");
+}
+
+typedef struct {
+    const char* name;
+    void (*generate)(FILE* out, int size);
+    int size;               // Default size for bench run
+    const char* stresses;
+} Workload;
+
+static const Workload workloads[] = {
+    { "functions",  genFunctions,  20000, "many small functions" },
+    { "statements", genStatements, 50000, "one very long statement list" },
+    { "nesting",    genNesting,    1000,  "expressions nested 200 deep" },
+    { "arrays",     genArrays,     40000, "1D/2D array indexing" },
+    { "calls",      genCalls,      10000, "a dense call graph" },
+    { "comments",   genComments,   40000, "indented code under long comments" },
+};
+#define WORKLOAD_COUNT ((int)(sizeof(workloads) / sizeof(workloads[0])))
+
+static const Workload* findWorkload(const char* name) {
+    for (int i = 0; i < WORKLOAD_COUNT; i++) {
+        if (strcmp(workloads[i].name, name) == 0) return &workloads[i];
+    }
+    return NULL;
+}
+
+static void generate(const Workload* workload, int size, unsigned long long seed, FILE* out) {
+    rngState = seed ? seed : 1;
+    workload->generate(out, size);
+}
+
+/* ============ MEASURING ============ */
+
+typedef struct {
+    char name[NAME_SIZE];
+    double ms;
+} PhaseTime;
+
+/* One workload's best run */
+typedef struct {
+    char name[NAME_SIZE];
+    long lines;
+    double ms;              // Wall time of the whole compiler process
+    long rssKB;             // Peak resident set size
+    PhaseTime phases[MAX_PHASES];
+    int phaseCount;
+} Result;
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static long countLines(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) return 0;
+    long lines = 0;
+    int c;
+    while ((c = getc(file)) != EOF) {
+        if (c == '\n') lines++;
+    }
+    fclose(file);
+    return lines;
+}
+
+// Pull the phases out of the compiler's --stats-json output
+static void readPhases(const char* path, Result* result) {
+    FILE* file = fopen(path, "r");
+    if (!file) return;
+    char line[1024];
+    result->phaseCount = 0;
+    while (fgets(line, sizeof(line), file) && result->phaseCount < MAX_PHASES) {
+        char* name = strstr(line, "{\"name\": \"");
+        char* wall = strstr(line, "\"wall_s\": ");
+        if (!name || !wall || strstr(line, "\"total\"")) continue;
+        PhaseTime* phase = &result->phases[result->phaseCount++];
+        sscanf(name + 10, "%63[^\"]", phase->name);
+        phase->ms = atof(wall + 10) * 1e3;
+    }
+    fclose(file);
+}
+
+// Run the compiler once with -q, --stats-json and args. Returns its
+// exit status (128 plus the signal if it crashed), or -1 if it could not
+// be run.
+static int runCompiler(const char* compiler, const char* const args[], const char* statsFile,
+                       double* ms, long* rssKB) {
+    char statsOption[4096 + 16];
+    snprintf(statsOption, sizeof(statsOption), "--stats-json=%s", statsFile);
+    char* argv[16] = { (char*)compiler, "-q", statsOption };
+    int argc = 3;
+    while (*args && argc < 15) argv[argc++] = (char*)*args++;
+    argv[argc] = NULL;
+    double start = now();
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        if (null >= 0) dup2(null, STDOUT_FILENO);
+        execv(compiler, argv);
+        fprintf(stderr, "Error: Cannot run '%s': %s\n", compiler, strerror(errno));
+        _exit(127);
+    }
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid) return -1;
+    *ms = now() - start;
+    *rssKB = usage.ru_maxrss;
+    if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// Write the workload's program to <dir>/<name>.c
+static int writeProgram(const char* dir, const Workload* workload, char* source, size_t size) {
+    snprintf(source, size, "%s/%s.c", dir, workload->name);
+    FILE* out = fopen(source, "w");
+    if (!out) {
+        fprintf(stderr, "Error: Cannot write '%s'\n", source);
+        return -1;
+    }
+    generate(workload, workload->size, 1, out);
+    fclose(out);
+    return 0;
+}
+
+static int measure(const char* compiler, const char* dir, const Workload* workload, int runs,
+                   Result* result) {
+    char source[4096], output[4096], statsFile[4096];
+    snprintf(output, sizeof(output), "%s/%s.s", dir, workload->name);
+    snprintf(statsFile, sizeof(statsFile), "%s/%s.json", dir, workload->name);
+    if (writeProgram(dir, workload, source, sizeof(source)) != 0) return -1;
+    const char* args[] = { source, "-o", output, NULL };
+
+    memset(result, 0, sizeof(Result));
+    snprintf(result->name, sizeof(result->name), "%s", workload->name);
+    result->lines = countLines(source);
+    for (int run = 0; run < runs; run++) {
+        double ms;
+        long rssKB;
+        int status = runCompiler(compiler, args, statsFile, &ms, &rssKB);
+        if (status != 0) {
+            fprintf(stderr, "Error: Compiling '%s' failed (status %d)\n", source, status);
+            return -1;
+        }
+        if (rssKB > result->rssKB) result->rssKB = rssKB;
+        if (run == 0 || ms < result->ms) {
+            result->ms = ms;
+            readPhases(statsFile, result);
+        }
+    }
+    return 0;
+}
+
+static double linesPerSecond(const Result* result) {
+    return result->ms > 0 ? result->lines * 1e3 / result->ms : 0;
+}
+
+/* ============ BASELINE ============ */
+
+/* One line per workload:
+ *   <name> <lines/s> <peak RSS kB> <phase>=<ms> ...
+ */
+static int loadBaseline(const char* path, Result* results, int* count) {
+    FILE* file = fopen(path, "r");
+    if (!file) return -1;
+    char line[4096];
+    *count = 0;
+    while (fgets(line, sizeof(line), file) && *count < MAX_WORKLOADS) {
+        Result* result = &results[*count];
+        double rate;
+        int used;
+        memset(result, 0, sizeof(Result));
+        if (line[0] == '#' || sscanf(line, "%63s %lf %ld%n", result->name, &rate, &result->rssKB, &used) != 3) {
+            continue;
+        }
+        // Keep the rate as a time for 1000 lines
+        result->lines = 1000;
+        result->ms = rate > 0 ? 1e6 / rate : 0;
+        char* field = strtok(line + used, " \n");
+        while (field && result->phaseCount < MAX_PHASES) {
+            PhaseTime* phase = &result->phases[result->phaseCount];
+            if (sscanf(field, "%63[^=]=%lf", phase->name, &phase->ms) == 2) result->phaseCount++;
+            field = strtok(NULL, " \n");
+        }
+        (*count)++;
+    }
+    fclose(file);
+    return 0;
+}
+
+static int saveBaseline(const char* path, const Result* results, int count) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot write baseline '%s'\n", path);
+        return -1;
+    }
+    fprintf(file, "# workload lines/s peak-RSS-kB phase=ms ...\n");
+    for (int i = 0; i < count; i++) {
+        const Result* result = &results[i];
+        fprintf(file, "%s %.0f %ld", result->name, linesPerSecond(result), result->rssKB);
+        for (int p = 0; p < result->phaseCount; p++) {
+            fprintf(file, " %s=%.3f", result->phases[p].name, result->phases[p].ms);
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+    return 0;
+}
+
+static const Result* findResult(const Result* results, int count, const char* name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(results[i].name, name) == 0) return &results[i];
+    }
+    return NULL;
+}
+
+static double findPhase(const Result* result, const char* name) {
+    for (int p = 0; p < result->phaseCount; p++) {
+        if (strcmp(result->phases[p].name, name) == 0) return result->phases[p].ms;
+    }
+    return -1;
+}
+
+// Print how the run compares with its baseline. Returns 1 if it is a
+// regression.
+static int compare(const Result* result, const Result* base, double tolerance) {
+    double rate = linesPerSecond(result);
+    double baseRate = linesPerSecond(base);
+    double speed = baseRate > 0 ? (rate / baseRate - 1) * 100 : 0;
+    double growth = base->rssKB > 0 ? ((double)result->rssKB / base->rssKB - 1) * 100 : 0;
+    int slower = speed < -tolerance;
+    int bigger = growth > tolerance;
+    printf("  %-12s %+7.1f%% lines/s  %+7.1f%% RSS", result->name, speed, growth);
+    if (slower || bigger) {
+        printf("  REGRESSION");
+        // The phases that lost the most time point at the culprit
+        for (int p = 0; p < result->phaseCount; p++) {
+            const PhaseTime* phase = &result->phases[p];
+            double before = findPhase(base, phase->name);
+            if (before > 0 && phase->ms > before * (1 + tolerance / 100)) {
+                printf("  %s %+.0f%%", phase->name, (phase->ms / before - 1) * 100);
+            }
+        }
+    }
+    printf("\n");
+    return slower || bigger;
+}
+
+/* ============ DRIVER ============ */
+
+static void printResult(const Result* result) {
+    printf("%-12s %9ld %10.1f %12.0f %10.1f ", result->name, result->lines, result->ms,
+           linesPerSecond(result), result->rssKB / 1024.0);
+    for (int p = 0; p < result->phaseCount; p++) {
+        printf(" %s %.1f", result->phases[p].name, result->phases[p].ms);
+    }
+    printf("\n");
+}
+
+static int makeDir(const char* path) {
+    return mkdir(path, 0777) == 0 || errno == EEXIST ? 0 : -1;
+}
+
+/* Versions of one front-end phase timed against each other. The last
+ * version is the reference the others are compared with. */
+typedef struct {
+    const char* command;    // bench subcommand
+    const char* phase;      // Phase timed, from --stats-json
+    const char* option;     // Selects a version when its name is appended
+    const char* versions[4];
+    int versionCount;
+    int dumpTokens;         // Lex only (--dump-tokens) instead of compiling
+} Comparison;
+
+static const Comparison comparisons[] = {
+    { "lex", "lex", "--scanner=", { "scalar", "sse2", "avx2", "flex" }, 4, 1 },
+    { "parse", "parse", "--parser=", { "pratt", "bison" }, 2, 0 },
+};
+#define COMPARISON_COUNT ((int)(sizeof(comparisons) / sizeof(comparisons[0])))
+
+// Fastest time of the compared phase over runs, in ms, or -1
+static double measurePhase(const char* compiler, const Comparison* comparison, const char* version,
+                           const char* source, const char* output, const char* statsFile, int runs) {
+    char option[64];
+    snprintf(option, sizeof(option), "%s%s", comparison->option, version);
+    const char* lexArgs[] = { "--dump-tokens", option, source, NULL };
+    const char* compileArgs[] = { option, source, "-o", output, NULL };
+    double best = -1;
+    for (int run = 0; run < runs; run++) {
+        double ms;
+        long rssKB;
+        const char* const* args = comparison->dumpTokens ? lexArgs : compileArgs;
+        int status = runCompiler(compiler, args, statsFile, &ms, &rssKB);
+        if (status != 0) {
+            fprintf(stderr, "Error: '%s' failed on '%s' (status %d)\n", option, source, status);
+            return -1;
+        }
+        Result result;
+        memset(&result, 0, sizeof(Result));
+        readPhases(statsFile, &result);
+        double phase = findPhase(&result, comparison->phase);
+        if (phase >= 0 && (best < 0 || phase < best)) best = phase;
+    }
+    return best;
+}
+
+static long fileSize(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : 0;
+}
+
+/* MB/s of the phase for every workload with each version, and how much
+ * faster the best one is than the reference */
+static int runComparison(const Comparison* comparison, int argc, char* argv[]) {
+    const char* dir = "bench/work";
+    const char* compiler = NULL;
+    int runs = 3;
+    for (int i = 0; i < argc; i++) {
+        if (strncmp(argv[i], "--runs=", 7) == 0) {
+            runs = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--dir=", 6) == 0) {
+            dir = argv[i] + 6;
+        } else if (argv[i][0] != '-' && !compiler) {
+            compiler = argv[i];
+        } else {
+            fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
+            return 2;
+        }
+    }
+    if (!compiler || runs < 1) {
+        fprintf(stderr, "Error: bench %s needs a compiler and --runs of at least 1\n", comparison->command);
+        return 2;
+    }
+    if (makeDir(dir) != 0) {
+        fprintf(stderr, "Error: Cannot create '%s'\n", dir);
+        return 2;
+    }
+
+    int reference = comparison->versionCount - 1;
+    printf("%-12s %9s", "workload", "MB");
+    for (int v = 0; v < comparison->versionCount; v++) printf(" %10s MB/s", comparison->versions[v]);
+    printf("  vs %s\n", comparison->versions[reference]);
+    for (int i = 0; i < WORKLOAD_COUNT; i++) {
+        char source[4096], output[4096], statsFile[4096];
+        snprintf(output, sizeof(output), "%s/%s.s", dir, workloads[i].name);
+        snprintf(statsFile, sizeof(statsFile), "%s/%s-%s.json", dir, workloads[i].name, comparison->command);
+        if (writeProgram(dir, &workloads[i], source, sizeof(source)) != 0) return 2;
+        double mb = fileSize(source) / 1e6;
+        double best = 0, referenceMs = 0;
+        printf("%-12s %9.2f", workloads[i].name, mb);
+        for (int v = 0; v < comparison->versionCount; v++) {
+            double ms = measurePhase(compiler, comparison, comparison->versions[v], source, output, statsFile,
+                                     runs);
+            if (ms < 0) return 2;
+            printf(" %15.1f", ms > 0 ? mb * 1e3 / ms : 0);
+            if (v == reference) referenceMs = ms;
+            else if (best == 0 || ms < best) best = ms;
+        }
+        printf(" %7.2fx\n", best > 0 ? referenceMs / best : 0);
+    }
+    return 0;
+}
+
+static int runBenchmarks(int argc, char* argv[]) {
+    const char* dir = "bench/work";
+    const char* baselinePath = "bench/baseline.txt";
+    const char* compiler = NULL;
+    int runs = 3, save = 0;
+    double tolerance = 10;
+    for (int i = 0; i < argc; i++) {
+        if (strncmp(argv[i], "--runs=", 7) == 0) {
+            runs = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--dir=", 6) == 0) {
+            dir = argv[i] + 6;
+        } else if (strncmp(argv[i], "--baseline=", 11) == 0) {
+            baselinePath = argv[i] + 11;
+        } else if (strcmp(argv[i], "--save") == 0) {
+            save = 1;
+        } else if (strncmp(argv[i], "--tolerance=", 12) == 0) {
+            tolerance = atof(argv[i] + 12);
+        } else if (argv[i][0] != '-' && !compiler) {
+            compiler = argv[i];
+        } else {
+            fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
+            return 2;
+        }
+    }
+    if (!compiler || runs < 1) {
+        fprintf(stderr, "Error: bench run needs a compiler and --runs of at least 1\n");
+        return 2;
+    }
+    if (makeDir(dir) != 0) {
+        fprintf(stderr, "Error: Cannot create '%s'\n", dir);
+        return 2;
+    }
+
+    Result results[MAX_WORKLOADS];
+    printf("%-12s %9s %10s %12s %10s  %s\n", "workload", "lines", "wall ms", "lines/s", "RSS MB",
+           "phases (ms, fastest run)");
+    for (int i = 0; i < WORKLOAD_COUNT; i++) {
+        if (measure(compiler, dir, &workloads[i], runs, &results[i]) != 0) return 2;
+        printResult(&results[i]);
+    }
+
+    if (save) {
+        if (saveBaseline(baselinePath, results, WORKLOAD_COUNT) != 0) return 2;
+        printf("\nSaved baseline to %s\n", baselinePath);
+        return 0;
+    }
+
+    Result baseline[MAX_WORKLOADS];
+    int baselineCount;
+    if (loadBaseline(baselinePath, baseline, &baselineCount) != 0) {
+        printf("\nNo baseline at %s (make bench-baseline saves one)\n", baselinePath);
+        return 0;
+    }
+    printf("\nAgainst %s (tolerance %.0f%%):\n", baselinePath, tolerance);
+    int regressions = 0;
+    for (int i = 0; i < WORKLOAD_COUNT; i++) {
+        const Result* base = findResult(baseline, baselineCount, results[i].name);
+        if (base) {
+            regressions += compare(&results[i], base, tolerance);
+        } else {
+            printf("  %-12s not in the baseline\n", results[i].name);
+        }
+    }
+    if (regressions) {
+        printf("%d of %d workloads regressed\n", regressions, WORKLOAD_COUNT);
+        return 1;
+    }
+    return 0;
+}
+
+static void usage() {
+    fprintf(stderr, "Usage: bench gen <workload> <size> [seed]\n");
+    fprintf(stderr, "       bench run [--runs=n] [--dir=d] [--baseline=f] [--save] [--tolerance=pct] <compiler>\n");
+    fprintf(stderr, "       bench lex|parse [--runs=n] [--dir=d] <compiler>\n");
+    fprintf(stderr, "Workloads:\n");
+    for (int i = 0; i < WORKLOAD_COUNT; i++) {
+        fprintf(stderr, "  %-12s %s (default size %d)\n", workloads[i].name, workloads[i].stresses,
+                workloads[i].size);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 4 && strcmp(argv[1], "gen") == 0) {
+        const Workload* workload = findWorkload(argv[2]);
+        int size = atoi(argv[3]);
+        if (!workload || size < 1) {
+            usage();
+            return 2;
+        }
+        generate(workload, size, argc > 4 ? strtoull(argv[4], NULL, 10) : 1, stdout);
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "run") == 0) {
+        return runBenchmarks(argc - 2, argv + 2);
+    }
+    for (int i = 0; argc >= 2 && i < COMPARISON_COUNT; i++) {
+        if (strcmp(argv[1], comparisons[i].command) == 0) {
+            return runComparison(&comparisons[i], argc - 2, argv + 2);
+        }
+    }
+    usage();
+    return 2;
+}
@@ -0,0 +1,34 @@
+// Array elements stay inside their own slots: filling an array must not
+// overwrite the scalars declared around it or the saved $fp and $ra
+int fill(int base) {
+    int before;
+    int v[4];
+    int after;
+    before = 11;
+    after = 22;
+    v[0] = base;
+    v[1] = base + 1;
+    v[2] = base + 2;
+    v[3] = base + 3;
+    return before + after + v[0] + v[3];
+}
+
+int main() {
+    int x;
+    int m[2][3];
+    int y;
+    x = 7;
+    y = 8;
+    m[0][0] = 1;
+    m[0][1] = 2;
+    m[0][2] = 3;
+    m[1][0] = 4;
+    m[1][1] = 5;
+    m[1][2] = 6;
+    print(x);
+    print(y);
+    print(m[0][0] + m[1][2]);
+    print(fill(100));
+    print(x + y);
+    return 0;
+}
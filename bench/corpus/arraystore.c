@@ -0,0 +1,27 @@
+// The right-hand side of an array store gets every temp but the one
+// holding the element's address
+int main() {
+    int a;
+    int b;
+    int c;
+    int d;
+    int e;
+    int f;
+    int v[3];
+    int g[2][2];
+    a = 1;
+    b = 2;
+    c = 3;
+    d = 4;
+    e = 5;
+    f = 6;
+    v[1] = a + (b + (c + (d + (e + f))));
+    v[2] = a * (b + (c * (d + (e - f))));
+    g[1][0] = f - (e - (d - (c - (b - a))));
+    g[0][1] = a + (b * (c + (d * (e + f))));
+    print(v[1]);
+    print(v[2]);
+    print(g[1][0]);
+    print(g[0][1]);
+    return 0;
+}
@@ -0,0 +1,33 @@
+// Small helpers called from inside expressions and from each other's arguments
+int sq(int x) {
+    return x * x;
+}
+
+int cube(int x) {
+    return x * sq(x);
+}
+
+int mad(int a, int b, int c) {
+    return a * b + c;
+}
+
+int sum4(int a, int b, int c, int d) {
+    return a + b + c + d;
+}
+
+int dist2(int x1, int y1, int x2, int y2) {
+    return sq(x2 - x1) + sq(y2 - y1);
+}
+
+int main() {
+    int x;
+    int y;
+    x = 7 + sq(3) * cube(2) - mad(1, 2, 3);
+    print(x);
+    y = sum4(sq(1), cube(2), mad(3, 4, sq(2)), 5) + sq(3);
+    print(y);
+    print(mad(sq(x - y), 2, cube(3)) - dist2(1, 2, 4, 6));
+    print(sum4(dist2(0, 0, 3, 4), dist2(1, 1, 2, 2), sq(sq(2)), cube(sq(2))));
+    print(x * y + sq(x) - cube(y - 40));
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Checksums and weighted sums over an array
+int weigh(int v, int w) {
+    return v * w;
+}
+
+int main() {
+    int d[16];
+    int s;
+    int w;
+    int m;
+    d[0] = 11;
+    d[1] = 48;
+    d[2] = 85;
+    d[3] = 25;
+    d[4] = 62;
+    d[5] = 2;
+    d[6] = 39;
+    d[7] = 76;
+    d[8] = 16;
+    d[9] = 53;
+    d[10] = 90;
+    d[11] = 30;
+    d[12] = 67;
+    d[13] = 7;
+    d[14] = 44;
+    d[15] = 81;
+    s = 0;
+    s = s * 2 + d[0];
+    s = s * 2 + d[1];
+    s = s * 2 + d[2];
+    s = s * 2 + d[3];
+    s = s * 2 + d[4];
+    s = s * 2 + d[5];
+    s = s * 2 + d[6];
+    s = s * 2 + d[7];
+    s = s * 2 + d[8];
+    s = s * 2 + d[9];
+    s = s * 2 + d[10];
+    s = s * 2 + d[11];
+    s = s * 2 + d[12];
+    s = s * 2 + d[13];
+    s = s * 2 + d[14];
+    s = s * 2 + d[15];
+    print(s);
+    w = 0;
+    w = w + weigh(d[0], 1);
+    w = w + weigh(d[1], 2);
+    w = w + weigh(d[2], 3);
+    w = w + weigh(d[3], 4);
+    w = w + weigh(d[4], 5);
+    w = w + weigh(d[5], 6);
+    w = w + weigh(d[6], 7);
+    w = w + weigh(d[7], 8);
+    w = w + weigh(d[8], 9);
+    w = w + weigh(d[9], 10);
+    w = w + weigh(d[10], 11);
+    w = w + weigh(d[11], 12);
+    w = w + weigh(d[12], 13);
+    w = w + weigh(d[13], 14);
+    w = w + weigh(d[14], 15);
+    w = w + weigh(d[15], 16);
+    print(w);
+    m = 0;
+    m = m + d[0] * d[1] - d[0] * 4;
+    m = m + d[2] * d[3] - d[2] * 4;
+    m = m + d[4] * d[5] - d[4] * 4;
+    m = m + d[6] * d[7] - d[6] * 4;
+    m = m + d[8] * d[9] - d[8] * 4;
+    m = m + d[10] * d[11] - d[10] * 4;
+    m = m + d[12] * d[13] - d[12] * 4;
+    m = m + d[14] * d[15] - d[14] * 4;
+    print(m);
+    return 0;
+}
@@ -0,0 +1,15 @@
+// Expressions that need more than $t0-$t7: the arguments of a call
+// nested in other operations, and a chain of right operands, must not
+// reuse a temp that is still live
+int pick(int a, int b, int c, int d) {
+    return d;
+}
+
+int main() {
+    int arr[3];
+    arr[1] = 7;
+    print(1 + (2 + (3 + pick(4, 5, 6, arr[1]))));
+    print(1 + (2 + (3 + (4 + (5 + (6 + (7 + (8 + (9 + (10 + arr[1]))))))))));
+    print(arr[1] * (pick(1, 2, 3, 4) - (5 - (6 - (7 - (8 - (9 - (10 - (11 - arr[1])))))))));
+    return 0;
+}
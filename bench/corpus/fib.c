@@ -0,0 +1,71 @@
+// Fibonacci numbers in a table, and Lucas numbers through a helper
+int step(int a, int b) {
+    return a + b;
+}
+
+int main() {
+    int f[25];
+    int l[25];
+    int total;
+    f[0] = 0;
+    f[1] = 1;
+    l[0] = 2;
+    l[1] = 1;
+    f[2] = f[1] + f[0];
+    f[3] = f[2] + f[1];
+    f[4] = f[3] + f[2];
+    f[5] = f[4] + f[3];
+    f[6] = f[5] + f[4];
+    f[7] = f[6] + f[5];
+    f[8] = f[7] + f[6];
+    f[9] = f[8] + f[7];
+    f[10] = f[9] + f[8];
+    f[11] = f[10] + f[9];
+    f[12] = f[11] + f[10];
+    f[13] = f[12] + f[11];
+    f[14] = f[13] + f[12];
+    f[15] = f[14] + f[13];
+    f[16] = f[15] + f[14];
+    f[17] = f[16] + f[15];
+    f[18] = f[17] + f[16];
+    f[19] = f[18] + f[17];
+    f[20] = f[19] + f[18];
+    f[21] = f[20] + f[19];
+    f[22] = f[21] + f[20];
+    f[23] = f[22] + f[21];
+    f[24] = f[23] + f[22];
+    l[2] = step(l[1], l[0]);
+    l[3] = step(l[2], l[1]);
+    l[4] = step(l[3], l[2]);
+    l[5] = step(l[4], l[3]);
+    l[6] = step(l[5], l[4]);
+    l[7] = step(l[6], l[5]);
+    l[8] = step(l[7], l[6]);
+    l[9] = step(l[8], l[7]);
+    l[10] = step(l[9], l[8]);
+    l[11] = step(l[10], l[9]);
+    l[12] = step(l[11], l[10]);
+    l[13] = step(l[12], l[11]);
+    l[14] = step(l[13], l[12]);
+    l[15] = step(l[14], l[13]);
+    l[16] = step(l[15], l[14]);
+    l[17] = step(l[16], l[15]);
+    l[18] = step(l[17], l[16]);
+    l[19] = step(l[18], l[17]);
+    l[20] = step(l[19], l[18]);
+    l[21] = step(l[20], l[19]);
+    l[22] = step(l[21], l[20]);
+    l[23] = step(l[22], l[21]);
+    l[24] = step(l[23], l[22]);
+    print(f[10]);
+    print(f[20]);
+    print(f[24]);
+    print(l[10]);
+    print(l[20]);
+    print(l[24]);
+    total = f[0] + f[4] + f[8] + f[12] + f[16] + f[20] + f[24];
+    print(total);
+    // F(n-1) + F(n+1) = L(n)
+    print(f[19] + f[21] - l[20]);
+    return 0;
+}
@@ -0,0 +1,21 @@
+// Temps holding the left side of an expression stay live across a call
+// in its right side
+int sq(int x) {
+    return x * x;
+}
+
+int twice(int x) {
+    return x + x;
+}
+
+int main() {
+    int a;
+    int b;
+    a = 3;
+    b = 5;
+    print(a + sq(4));
+    print(a * b - sq(b - a) + twice(a));
+    print(b + (a + (b * sq(a))));
+    print(sq(a) + sq(b) + sq(a + b));
+    return 0;
+}
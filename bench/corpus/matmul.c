@@ -0,0 +1,81 @@
+// 4x4 integer matrix product C = A * B, its trace and row sums
+int main() {
+    int a[4][4];
+    int b[4][4];
+    int c[4][4];
+    int trace;
+
+    a[0][0] = 1;
+    a[0][1] = 2;
+    a[0][2] = 3;
+    a[0][3] = 4;
+    a[1][0] = 5;
+    a[1][1] = 6;
+    a[1][2] = 7;
+    a[1][3] = 1;
+    a[2][0] = 2;
+    a[2][1] = 3;
+    a[2][2] = 4;
+    a[2][3] = 5;
+    a[3][0] = 6;
+    a[3][1] = 7;
+    a[3][2] = 1;
+    a[3][3] = 2;
+    b[0][0] = 1;
+    b[0][1] = 3;
+    b[0][2] = 5;
+    b[0][3] = 2;
+    b[1][0] = 2;
+    b[1][1] = 4;
+    b[1][2] = 1;
+    b[1][3] = 3;
+    b[2][0] = 3;
+    b[2][1] = 5;
+    b[2][2] = 2;
+    b[2][3] = 4;
+    b[3][0] = 4;
+    b[3][1] = 1;
+    b[3][2] = 3;
+    b[3][3] = 5;
+
+    c[0][0] = a[0][0] * b[0][0] + a[0][1] * b[1][0] + a[0][2] * b[2][0] + a[0][3] * b[3][0];
+    c[0][1] = a[0][0] * b[0][1] + a[0][1] * b[1][1] + a[0][2] * b[2][1] + a[0][3] * b[3][1];
+    c[0][2] = a[0][0] * b[0][2] + a[0][1] * b[1][2] + a[0][2] * b[2][2] + a[0][3] * b[3][2];
+    c[0][3] = a[0][0] * b[0][3] + a[0][1] * b[1][3] + a[0][2] * b[2][3] + a[0][3] * b[3][3];
+    c[1][0] = a[1][0] * b[0][0] + a[1][1] * b[1][0] + a[1][2] * b[2][0] + a[1][3] * b[3][0];
+    c[1][1] = a[1][0] * b[0][1] + a[1][1] * b[1][1] + a[1][2] * b[2][1] + a[1][3] * b[3][1];
+    c[1][2] = a[1][0] * b[0][2] + a[1][1] * b[1][2] + a[1][2] * b[2][2] + a[1][3] * b[3][2];
+    c[1][3] = a[1][0] * b[0][3] + a[1][1] * b[1][3] + a[1][2] * b[2][3] + a[1][3] * b[3][3];
+    c[2][0] = a[2][0] * b[0][0] + a[2][1] * b[1][0] + a[2][2] * b[2][0] + a[2][3] * b[3][0];
+    c[2][1] = a[2][0] * b[0][1] + a[2][1] * b[1][1] + a[2][2] * b[2][1] + a[2][3] * b[3][1];
+    c[2][2] = a[2][0] * b[0][2] + a[2][1] * b[1][2] + a[2][2] * b[2][2] + a[2][3] * b[3][2];
+    c[2][3] = a[2][0] * b[0][3] + a[2][1] * b[1][3] + a[2][2] * b[2][3] + a[2][3] * b[3][3];
+    c[3][0] = a[3][0] * b[0][0] + a[3][1] * b[1][0] + a[3][2] * b[2][0] + a[3][3] * b[3][0];
+    c[3][1] = a[3][0] * b[0][1] + a[3][1] * b[1][1] + a[3][2] * b[2][1] + a[3][3] * b[3][1];
+    c[3][2] = a[3][0] * b[0][2] + a[3][1] * b[1][2] + a[3][2] * b[2][2] + a[3][3] * b[3][2];
+    c[3][3] = a[3][0] * b[0][3] + a[3][1] * b[1][3] + a[3][2] * b[2][3] + a[3][3] * b[3][3];
+
+    print(c[0][0]);
+    print(c[0][1]);
+    print(c[0][2]);
+    print(c[0][3]);
+    print(c[1][0]);
+    print(c[1][1]);
+    print(c[1][2]);
+    print(c[1][3]);
+    print(c[2][0]);
+    print(c[2][1]);
+    print(c[2][2]);
+    print(c[2][3]);
+    print(c[3][0]);
+    print(c[3][1]);
+    print(c[3][2]);
+    print(c[3][3]);
+    trace = c[0][0] + c[1][1] + c[2][2] + c[3][3];
+    print(trace);
+    print(c[0][0] + c[0][1] + c[0][2] + c[0][3]);
+    print(c[1][0] + c[1][1] + c[1][2] + c[1][3]);
+    print(c[2][0] + c[2][1] + c[2][2] + c[2][3]);
+    print(c[3][0] + c[3][1] + c[3][2] + c[3][3]);
+    return 0;
+}
@@ -0,0 +1,21 @@
+// Calls nested in the arguments of another call must not overwrite the
+// $a registers already loaded for it
+int sq(int x) {
+    return x * x;
+}
+
+int sub(int a, int b) {
+    return a - b;
+}
+
+int mad(int a, int b, int c) {
+    return a * b + c;
+}
+
+int main() {
+    print(sub(1, sq(3)));
+    print(sub(sq(5), sq(2)));
+    print(mad(2, sub(10, 4), sq(3)));
+    print(mad(sub(9, sq(2)), sq(sub(7, 4)), mad(1, 2, 3)));
+    return 0;
+}
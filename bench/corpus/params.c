@@ -0,0 +1,29 @@
+// Parameters belong to the callee's frame: storing them must not touch
+// the caller's locals or its saved $ra
+int mix(int a, int b, int c) {
+    int t;
+    t = a * 100 + b * 10 + c;
+    return t;
+}
+
+int outer(int p, int q) {
+    int r;
+    r = mix(q, p, 7);
+    return r + p - q;
+}
+
+int main() {
+    int x;
+    int y;
+    int z;
+    x = 1;
+    y = 2;
+    z = 3;
+    print(mix(4, 5, 6));
+    print(x);
+    print(y);
+    print(z);
+    print(outer(x + 10, y + 20));
+    print(x + y + z);
+    return 0;
+}
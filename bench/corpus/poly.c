@@ -0,0 +1,43 @@
+// Quadratics by Horner's rule; calls nested in arguments and expressions
+int horner(int x, int a, int b, int c) {
+    int r;
+    r = a * x + b;
+    r = r * x + c;
+    return r;
+}
+
+int cubic(int x) {
+    // 2x^3 - 3x^2 + 5x - 7
+    return horner(x, 2, 0 - 3, 5) * x - 7;
+}
+
+int main() {
+    int x;
+    int sum;
+    sum = 0;
+    x = 0 - 3;
+    print(cubic(x));
+    sum = sum + cubic(x) * 2 + horner(x, 1, 1, 1);
+    x = 0 - 2;
+    print(cubic(x));
+    sum = sum + cubic(x) * 2 + horner(x, 1, 1, 1);
+    x = 0 - 1;
+    print(cubic(x));
+    sum = sum + cubic(x) * 2 + horner(x, 1, 1, 1);
+    x = 0;
+    print(cubic(x));
+    sum = sum + cubic(x) * 2 + horner(x, 1, 1, 1);
+    x = 1;
+    print(cubic(x));
+    sum = sum + cubic(x) * 2 + horner(x, 1, 1, 1);
+    x = 2;
+    print(cubic(x));
+    sum = sum + cubic(x) * 2 + horner(x, 1, 1, 1);
+    x = 3;
+    print(cubic(x));
+    sum = sum + cubic(x) * 2 + horner(x, 1, 1, 1);
+    print(sum);
+    print(horner(2, 1, horner(1, 1, 1, 1), horner(0, 5, 5, 3)));
+    print(cubic(cubic(2)) - cubic(3) * cubic(1));
+    return 0;
+}
@@ -0,0 +1,73 @@
+// Three-point stencil on a vector and five-point stencil on a grid
+int main() {
+    int a[12];
+    int b[12];
+    int g[5][5];
+    int h[5][5];
+    int s;
+    a[0] = 3;
+    a[1] = 10;
+    a[2] = 8;
+    a[3] = 20;
+    a[4] = 0;
+    a[5] = 17;
+    a[6] = 2;
+    a[7] = 1;
+    a[8] = 14;
+    a[9] = 18;
+    a[10] = 13;
+    a[11] = 22;
+    b[1] = a[0] + 2 * a[1] + a[2];
+    b[2] = a[1] + 2 * a[2] + a[3];
+    b[3] = a[2] + 2 * a[3] + a[4];
+    b[4] = a[3] + 2 * a[4] + a[5];
+    b[5] = a[4] + 2 * a[5] + a[6];
+    b[6] = a[5] + 2 * a[6] + a[7];
+    b[7] = a[6] + 2 * a[7] + a[8];
+    b[8] = a[7] + 2 * a[8] + a[9];
+    b[9] = a[8] + 2 * a[9] + a[10];
+    b[10] = a[9] + 2 * a[10] + a[11];
+    s = b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + b[7] + b[8] + b[9] + b[10];
+    print(s);
+    print(b[1]);
+    print(b[5]);
+    print(b[10]);
+    g[0][0] = 0;
+    g[0][1] = 3;
+    g[0][2] = 6;
+    g[0][3] = 9;
+    g[0][4] = 1;
+    g[1][0] = 5;
+    g[1][1] = 8;
+    g[1][2] = 0;
+    g[1][3] = 3;
+    g[1][4] = 6;
+    g[2][0] = 10;
+    g[2][1] = 2;
+    g[2][2] = 5;
+    g[2][3] = 8;
+    g[2][4] = 0;
+    g[3][0] = 4;
+    g[3][1] = 7;
+    g[3][2] = 10;
+    g[3][3] = 2;
+    g[3][4] = 5;
+    g[4][0] = 9;
+    g[4][1] = 1;
+    g[4][2] = 4;
+    g[4][3] = 7;
+    g[4][4] = 10;
+    h[1][1] = 4 * g[1][1] - g[0][1] - g[2][1] - g[1][0] - g[1][2];
+    h[1][2] = 4 * g[1][2] - g[0][2] - g[2][2] - g[1][1] - g[1][3];
+    h[1][3] = 4 * g[1][3] - g[0][3] - g[2][3] - g[1][2] - g[1][4];
+    h[2][1] = 4 * g[2][1] - g[1][1] - g[3][1] - g[2][0] - g[2][2];
+    h[2][2] = 4 * g[2][2] - g[1][2] - g[3][2] - g[2][1] - g[2][3];
+    h[2][3] = 4 * g[2][3] - g[1][3] - g[3][3] - g[2][2] - g[2][4];
+    h[3][1] = 4 * g[3][1] - g[2][1] - g[4][1] - g[3][0] - g[3][2];
+    h[3][2] = 4 * g[3][2] - g[2][2] - g[4][2] - g[3][1] - g[3][3];
+    h[3][3] = 4 * g[3][3] - g[2][3] - g[4][3] - g[3][2] - g[3][4];
+    print(h[1][1] + h[1][2] + h[1][3]);
+    print(h[2][1] + h[2][2] + h[2][3]);
+    print(h[3][1] + h[3][2] + h[3][3]);
+    return 0;
+}
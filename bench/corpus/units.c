@@ -0,0 +1,23 @@
+// Unit conversions: mostly constant arithmetic and power-of-two scaling
+int seconds(int h, int m, int s) {
+    return h * 3600 + m * 60 + s;
+}
+
+int kilobytes(int kb) {
+    return kb * 1024;
+}
+
+int main() {
+    int t;
+    int b[4];
+    t = seconds(1, 2, 3) + 24 * 60 * 60;
+    print(t);
+    print(kilobytes(64) + 4 * 1024 * 1024 - 512 * 2);
+    b[0] = 2 + 3 * 4;
+    b[1] = b[0] * 8 + (10 - 4) * 16;
+    b[2] = b[1] * 32 - 100 + 2 * 50;
+    b[3] = (b[2] + 1000) * 4 - b[0] * 2;
+    print(b[0] + b[1] + b[2] + b[3]);
+    print(seconds(b[0], 1 + 1, 60 - 1) - 7 * 7 * 7);
+    return 0;
+}
@@ -0,0 +1,256 @@
+/* GENERATED-CODE QUALITY BENCHMARK
+ * Compiles every program of a corpus at each optimization level, runs
+ * the executables in the compiler's MIPS simulator (--sim) and checks
+ * what they print against the golden output kept next to the source
+ * (<name>.expected). Dynamic instruction count, memory accesses and
+ * code size go into one table, with the change against -O0, so an
+ * optimization shows what it buys and a miscompile fails the run.
+ * The pgo level is -O1 with the profile of an instrumented -O1 run.
+ *
+ *   quality [options] <compiler>
+ *
+ * Options:
+ *   --corpus=<dir>      Programs and golden outputs (bench/corpus)
+ *   --dir=<dir>         Where executables and outputs go (bench/work/quality)
+ *
+ * Exits with 1 if any program failed to compile, faulted in the
+ * simulator or printed something other than its golden output.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#define MAX_PROGRAMS 256
+#define NAME_SIZE 64
+#define PATH_SIZE 4096
+
+static const char* levels[] = { "-O0", "-O1", "pgo" };
+#define LEVEL_COUNT ((int)(sizeof(levels) / sizeof(levels[0])))
+
+/* One program at one level */
+typedef struct {
+    const char* failure;    // NULL if it ran and printed the golden output
+    unsigned long long instructions;
+    unsigned long long memory;  // Loads plus stores
+    unsigned long codeSize;
+} Run;
+
+/* ============ RUNNING ============ */
+
+// Run argv with stdout and stderr sent to files (NULL: /dev/null).
+// Returns the exit status, 128 plus the signal, or -1.
+static int runCommand(char* const argv[], const char* stdoutPath, const char* stderrPath) {
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+    if (pid == 0) {
+        int out = open(stdoutPath ? stdoutPath : "/dev/null", O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        int err = stderrPath ? open(stderrPath, O_WRONLY | O_CREAT | O_TRUNC, 0666) : -1;
+        if (out >= 0) dup2(out, STDOUT_FILENO);
+        if (err >= 0) dup2(err, STDERR_FILENO);
+        execv(argv[0], argv);
+        fprintf(stderr, "Error: Cannot run '%s': %s\n", argv[0], strerror(errno));
+        _exit(127);
+    }
+    int status;
+    if (waitpid(pid, &status, 0) != pid) return -1;
+    if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static int sameContents(const char* a, const char* b) {
+    FILE* x = fopen(a, "rb");
+    FILE* y = fopen(b, "rb");
+    int same = x && y;
+    while (same) {
+        int c = getc(x);
+        if (c != getc(y)) same = 0;
+        if (c == EOF) break;
+    }
+    if (x) fclose(x);
+    if (y) fclose(y);
+    return same;
+}
+
+// Pull the counts out of the --sim-stats report
+static void readSimStats(const char* path, Run* run) {
+    FILE* file = fopen(path, "r");
+    if (!file) return;
+    char line[256];
+    unsigned long long value;
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, " instructions %llu", &value) == 1) run->instructions = value;
+        else if (sscanf(line, " loads %llu", &value) == 1) run->memory += value;
+        else if (sscanf(line, " stores %llu", &value) == 1) run->memory += value;
+        else if (sscanf(line, " code size %llu", &value) == 1) run->codeSize = value;
+    }
+    fclose(file);
+}
+
+static void measure(const char* compiler, const char* corpus, const char* dir, const char* name,
+                    const char* level, Run* run) {
+    char source[PATH_SIZE], expected[PATH_SIZE], exe[PATH_SIZE], output[PATH_SIZE], report[PATH_SIZE];
+    snprintf(source, sizeof(source), "%s/%.63s.c", corpus, name);
+    snprintf(expected, sizeof(expected), "%s/%.63s.expected", corpus, name);
+    snprintf(exe, sizeof(exe), "%s/%.63s%s", dir, name, level);
+    snprintf(output, sizeof(output), "%s/%.63s%s.out", dir, name, level);
+    snprintf(report, sizeof(report), "%s/%.63s%s.sim", dir, name, level);
+    memset(run, 0, sizeof(Run));
+
+    // pgo: build instrumented and run it for the profile first
+    char* compile[] = { (char*)compiler, "-q", (char*)level, "--emit=exe", source, "-o", exe, NULL, NULL };
+    if (strcmp(level, "pgo") == 0) {
+        char generate[PATH_SIZE], use[PATH_SIZE];
+        snprintf(generate, sizeof(generate), "-fprofile-generate=%s/%.63s.prof", dir, name);
+        snprintf(use, sizeof(use), "-fprofile-use=%s/%.63s.prof", dir, name);
+        compile[2] = "-O1";
+        compile[7] = generate;
+        char* train[] = { (char*)compiler, "--sim", exe, NULL };
+        if (runCommand(compile, NULL, NULL) != 0 || runCommand(train, NULL, NULL) != 0) {
+            run->failure = "training run failed";
+            return;
+        }
+        compile[7] = use;
+        if (runCommand(compile, NULL, NULL) != 0) {
+            run->failure = "compile failed";
+            return;
+        }
+    } else if (runCommand(compile, NULL, NULL) != 0) {
+        run->failure = "compile failed";
+        return;
+    }
+    char* simulate[] = { (char*)compiler, "--sim-stats", exe, NULL };
+    if (runCommand(simulate, output, report) != 0) {
+        run->failure = "run failed";
+        return;
+    }
+    readSimStats(report, run);
+    if (!sameContents(output, expected)) run->failure = "wrong output";
+}
+
+/* ============ DRIVER ============ */
+
+static int byName(const void* a, const void* b) {
+    return strcmp(a, b);
+}
+
+// Names (without .c) of the programs that have a golden output
+static int findPrograms(const char* corpus, char names[][NAME_SIZE]) {
+    DIR* dir = opendir(corpus);
+    if (!dir) return -1;
+    int count = 0;
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL && count < MAX_PROGRAMS) {
+        size_t len = strlen(ent->d_name);
+        if (len < 3 || len - 2 >= NAME_SIZE || strcmp(ent->d_name + len - 2, ".c") != 0) continue;
+        char expected[PATH_SIZE];
+        snprintf(expected, sizeof(expected), "%s/%.*s.expected", corpus, (int)(len - 2), ent->d_name);
+        if (access(expected, R_OK) != 0) {
+            fprintf(stderr, "Warning: %s/%s has no golden output\n", corpus, ent->d_name);
+            continue;
+        }
+        snprintf(names[count++], NAME_SIZE, "%.*s", (int)(len - 2), ent->d_name);
+    }
+    closedir(dir);
+    qsort(names, count, NAME_SIZE, byName);
+    return count;
+}
+
+static void printChange(unsigned long long value, unsigned long long base) {
+    if (base == 0) {
+        printf(" %8s", "");
+    } else {
+        printf(" %+7.1f%%", (double)value * 100.0 / base - 100.0);
+    }
+}
+
+static void printRow(const char* name, const char* level, const Run* run, const Run* base) {
+    printf("%-12s %-5s", name, level);
+    if (run->failure) {
+        printf(" %s\n", run->failure);
+        return;
+    }
+    printf(" %13llu", run->instructions);
+    printChange(run->instructions, run == base ? 0 : base->instructions);
+    printf(" %13llu %11lu", run->memory, run->codeSize);
+    printChange(run->codeSize, run == base ? 0 : base->codeSize);
+    printf("\n");
+}
+
+static void usage() {
+    fprintf(stderr, "Usage: quality [--corpus=dir] [--dir=d] <compiler>\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* corpus = "bench/corpus";
+    const char* dir = "bench/work/quality";
+    const char* compiler = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--corpus=", 9) == 0) {
+            corpus = argv[i] + 9;
+        } else if (strncmp(argv[i], "--dir=", 6) == 0) {
+            dir = argv[i] + 6;
+        } else if (argv[i][0] != '-' && !compiler) {
+            compiler = argv[i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (!compiler) {
+        usage();
+        return 2;
+    }
+
+    static char names[MAX_PROGRAMS][NAME_SIZE];
+    int count = findPrograms(corpus, names);
+    if (count <= 0) {
+        fprintf(stderr, "Error: No programs in '%s'\n", corpus);
+        return 2;
+    }
+    char parent[PATH_SIZE];
+    snprintf(parent, sizeof(parent), "%s", dir);
+    char* slash = strrchr(parent, '/');
+    if (slash) {
+        *slash = '\0';
+        mkdir(parent, 0777);
+    }
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: Cannot create '%s'\n", dir);
+        return 2;
+    }
+
+    printf("%-12s %-5s %13s %8s %13s %11s %8s\n", "program", "level", "instructions", "vs -O0",
+           "loads+stores", "code bytes", "vs -O0");
+    Run totals[LEVEL_COUNT];
+    memset(totals, 0, sizeof(totals));
+    int failures = 0;
+    for (int p = 0; p < count; p++) {
+        Run runs[LEVEL_COUNT];
+        for (int l = 0; l < LEVEL_COUNT; l++) {
+            measure(compiler, corpus, dir, names[p], levels[l], &runs[l]);
+            printRow(names[p], levels[l], &runs[l], &runs[0]);
+            if (runs[l].failure) {
+                failures++;
+                continue;
+            }
+            totals[l].instructions += runs[l].instructions;
+            totals[l].memory += runs[l].memory;
+            totals[l].codeSize += runs[l].codeSize;
+        }
+    }
+    if (failures) {
+        printf("\n%d of %d runs failed (outputs in %s)\n", failures, count * LEVEL_COUNT, dir);
+        return 1;
+    }
+    printf("\n");
+    for (int l = 0; l < LEVEL_COUNT; l++) {
+        printRow("total", levels[l], &totals[l], &totals[0]);
+    }
+    return 0;
+}
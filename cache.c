@@ -0,0 +1,328 @@
+/* COMPILE CACHE
+ * ccache-style reuse of earlier results. The key is the SHA-256 of the
+ * cache format, the compiler binary (size and modification time), the
+ * options that change the output and the source bytes. An entry lives
+ * at <dir>/<first two hex digits>/<rest of the key>.
+ *
+ * Entries are written to a temporary file and renamed into place, so
+ * readers never see half an entry. A hit refreshes the entry's mtime.
+ * When a store takes the total over maxSize, the entries with the
+ * oldest mtimes (least recently used) are removed until the total is
+ * back under 90% of the limit. The --incremental function caches in
+ * <dir>/functions count towards the limit and are evicted the same
+ * way. Hit/miss counters and the total size
+ * live in <dir>/stats, updated under flock so concurrent builds can
+ * share a cache.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include "cache.h"
+#include "sha256.h"
+#include "textbuf.h"
+
+#define CACHE_FORMAT "minicompiler-cache-1"
+
+/* ============ DIRECTORY AND STATS ============ */
+
+static int makeDirs(const char* path) {
+    char* copy = strdup(path);
+    for (char* p = copy + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (mkdir(copy, 0777) != 0 && errno != EEXIST) {
+            free(copy);
+            return -1;
+        }
+        *p = '/';
+    }
+    int result = mkdir(copy, 0777) != 0 && errno != EEXIST ? -1 : 0;
+    free(copy);
+    return result;
+}
+
+static char* defaultDir() {
+    const char* env = getenv("MINICOMPILER_CACHE_DIR");
+    if (env && *env) return strdup(env);
+
+    TextBuffer path = {0};
+    const char* xdg = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+    if (xdg && *xdg) {
+        textAppendf(&path, "%s/minicompiler", xdg);
+    } else {
+        textAppendf(&path, "%s/.cache/minicompiler", home && *home ? home : "/tmp");
+    }
+    return path.data;
+}
+
+// Lock and open <dir>/stats; the caller unlocks by closing
+static int lockStats(const CompileCache* cache) {
+    TextBuffer path = {0};
+    textAppendf(&path, "%s/stats", cache->dir);
+    int fd = path.data ? open(path.data, O_RDWR | O_CREAT, 0666) : -1;
+    textFree(&path);
+    if (fd < 0) return -1;
+    if (flock(fd, LOCK_EX) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void readStatsFile(int fd, CacheStats* stats) {
+    char text[256];
+    ssize_t n = pread(fd, text, sizeof(text) - 1, 0);
+    memset(stats, 0, sizeof(CacheStats));
+    if (n <= 0) return;
+    text[n] = '\0';
+    sscanf(text, "hits %lld\nmisses %lld\nsize %lld\nentries %lld",
+           &stats->hits, &stats->misses, &stats->size, &stats->entries);
+}
+
+static void writeStatsFile(int fd, const CacheStats* stats) {
+    char text[256];
+    int n = snprintf(text, sizeof(text), "hits %lld\nmisses %lld\nsize %lld\nentries %lld\n",
+                     stats->hits, stats->misses, stats->size, stats->entries);
+    // Best effort: a wrong total is corrected by the next eviction scan
+    if (pwrite(fd, text, n, 0) == n && ftruncate(fd, n) != 0) return;
+}
+
+/* ============ EVICTION ============ */
+
+typedef struct {
+    char* path;
+    long long size;
+    struct timespec used;
+} CacheEntry;
+
+static int olderFirst(const void* a, const void* b) {
+    const CacheEntry* x = a;
+    const CacheEntry* y = b;
+    if (x->used.tv_sec != y->used.tv_sec) return x->used.tv_sec < y->used.tv_sec ? -1 : 1;
+    if (x->used.tv_nsec != y->used.tv_nsec) return x->used.tv_nsec < y->used.tv_nsec ? -1 : 1;
+    return 0;
+}
+
+// Walk every entry, drop the least recently used ones and recount
+// stats. Runs with the stats lock held.
+static void evict(const CompileCache* cache, CacheStats* stats) {
+    CacheEntry* entries = NULL;
+    size_t count = 0, capacity = 0;
+    long long total = 0;
+
+    // The 256 buckets, then the function caches
+    for (int bucket = 0; bucket <= 256; bucket++) {
+        char sub[4096];
+        if (bucket < 256) {
+            snprintf(sub, sizeof(sub), "%s/%02x", cache->dir, bucket);
+        } else {
+            snprintf(sub, sizeof(sub), "%s/" CACHE_FUNCTION_DIR, cache->dir);
+        }
+        DIR* dir = opendir(sub);
+        if (!dir) continue;
+        struct dirent* ent;
+        while ((ent = readdir(dir)) != NULL) {
+            // Entries are named in hex; anything with a dot is being written
+            if (strchr(ent->d_name, '.')) continue;
+            TextBuffer path = {0};
+            textAppendf(&path, "%s/%s", sub, ent->d_name);
+            struct stat info;
+            if (!path.data || stat(path.data, &info) != 0 || !S_ISREG(info.st_mode)) {
+                textFree(&path);
+                continue;
+            }
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 256;
+                entries = realloc(entries, capacity * sizeof(CacheEntry));
+            }
+            entries[count++] = (CacheEntry){ path.data, info.st_size, info.st_mtim };
+            total += info.st_size;
+        }
+        closedir(dir);
+    }
+
+    qsort(entries, count, sizeof(CacheEntry), olderFirst);
+    long long target = cache->maxSize / 10 * 9;
+    size_t kept = count;
+    for (size_t i = 0; i < count && total > target; i++) {
+        if (unlink(entries[i].path) == 0) {
+            total -= entries[i].size;
+            kept--;
+        }
+    }
+    for (size_t i = 0; i < count; i++) free(entries[i].path);
+    free(entries);
+
+    stats->size = total;
+    stats->entries = kept;
+}
+
+/* ============ PUBLIC INTERFACE ============ */
+
+int cacheOpen(CompileCache* cache, const char* dir, long long maxSize) {
+    memset(cache, 0, sizeof(CompileCache));
+    cache->dir = dir ? strdup(dir) : defaultDir();
+    cache->maxSize = maxSize > 0 ? maxSize : CACHE_DEFAULT_MAX_SIZE;
+    if (!cache->dir || makeDirs(cache->dir) != 0) {
+        fprintf(stderr, "Warning: Cannot use cache directory '%s'\n", cache->dir ? cache->dir : "");
+        cacheClose(cache);
+        return -1;
+    }
+
+    // A rebuilt compiler may generate different code
+    struct stat info;
+    if (stat("/proc/self/exe", &info) == 0) {
+        snprintf(cache->compilerId, sizeof(cache->compilerId), "%lld.%ld.%ld",
+                 (long long)info.st_size, (long)info.st_mtim.tv_sec, info.st_mtim.tv_nsec);
+    }
+    return 0;
+}
+
+void cacheClose(CompileCache* cache) {
+    free(cache->dir);
+    cache->dir = NULL;
+}
+
+void cacheKey(const CompileCache* cache, const char* options,
+              const char* src, size_t len, char key[CACHE_KEY_SIZE]) {
+    Sha256 sha;
+    unsigned char digest[SHA256_SIZE];
+    sha256Init(&sha);
+    // NUL separators keep the fields from running into each other
+    sha256Update(&sha, CACHE_FORMAT, sizeof(CACHE_FORMAT));
+    sha256Update(&sha, cache->compilerId, strlen(cache->compilerId) + 1);
+    sha256Update(&sha, options, strlen(options) + 1);
+    sha256Update(&sha, src, len);
+    sha256Final(&sha, digest);
+    for (int i = 0; i < SHA256_SIZE; i++) {
+        snprintf(key + i * 2, 3, "%02x", digest[i]);
+    }
+}
+
+static void entryPath(const CompileCache* cache, const char* key, TextBuffer* path) {
+    textAppendf(path, "%s/%.2s/%s", cache->dir, key, key + 2);
+}
+
+static void countLookup(const CompileCache* cache, int hit) {
+    int fd = lockStats(cache);
+    if (fd < 0) return;
+    CacheStats stats;
+    readStatsFile(fd, &stats);
+    if (hit) stats.hits++; else stats.misses++;
+    writeStatsFile(fd, &stats);
+    close(fd);
+}
+
+int cacheLookup(CompileCache* cache, const char* key, char** data, size_t* size) {
+    TextBuffer path = {0};
+    entryPath(cache, key, &path);
+    int fd = path.data ? open(path.data, O_RDONLY) : -1;
+    int result = -1;
+
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0) {
+        char* bytes = malloc(info.st_size + 1);
+        size_t done = 0;
+        while (bytes && done < (size_t)info.st_size) {
+            ssize_t n = read(fd, bytes + done, info.st_size - done);
+            if (n <= 0) break;
+            done += n;
+        }
+        if (bytes && done == (size_t)info.st_size) {
+            bytes[done] = '\0';
+            *data = bytes;
+            *size = done;
+            result = 0;
+            futimens(fd, NULL);     // Most recently used now
+        } else {
+            free(bytes);
+        }
+    }
+    if (fd >= 0) close(fd);
+    textFree(&path);
+
+    countLookup(cache, result == 0);
+    return result;
+}
+
+// Write the entry file. Returns the size of the entry it replaced, -1 if
+// there was none, or -2 on failure.
+static long long writeEntry(const CompileCache* cache, const char* key, const void* data, size_t size) {
+    TextBuffer path = {0}, temp = {0};
+    long long replaced = -2;
+    entryPath(cache, key, &path);
+    textAppendf(&temp, "%s/%.2s", cache->dir, key);
+    if (path.data && temp.data && makeDirs(temp.data) == 0) {
+        // Unique per process and thread; rename makes the entry appear whole
+        textAppendf(&temp, "/.tmp.%ld.%lx", (long)getpid(), (unsigned long)pthread_self());
+        int fd = open(temp.data, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd >= 0) {
+            int failed = writeAll(fd, data, size) != 0;
+            if (close(fd) != 0) failed = 1;
+            struct stat old;
+            long long oldSize = stat(path.data, &old) == 0 ? old.st_size : -1;
+            if (!failed && rename(temp.data, path.data) == 0) {
+                replaced = oldSize;
+            } else {
+                unlink(temp.data);
+            }
+        }
+    }
+    textFree(&path);
+    textFree(&temp);
+    return replaced;
+}
+
+void cacheStore(CompileCache* cache, const char* key, const void* data, size_t size) {
+    long long replaced = writeEntry(cache, key, data, size);
+    if (replaced == -2) return;
+    cacheAdded(cache, replaced, size);
+}
+
+void cacheAdded(CompileCache* cache, long long replaced, size_t size) {
+    int fd = lockStats(cache);
+    if (fd < 0) return;
+    CacheStats stats;
+    readStatsFile(fd, &stats);
+    if (replaced >= 0) {
+        stats.size += (long long)size - replaced;
+    } else {
+        stats.size += size;
+        stats.entries++;
+    }
+    if (stats.size > cache->maxSize) evict(cache, &stats);
+    writeStatsFile(fd, &stats);
+    close(fd);
+}
+
+int cacheReadStats(const CompileCache* cache, CacheStats* stats) {
+    int fd = lockStats(cache);
+    if (fd < 0) return -1;
+    readStatsFile(fd, stats);
+    close(fd);
+    return 0;
+}
+
+void cachePrintStats(const CompileCache* cache, FILE* out) {
+    CacheStats stats;
+    if (cacheReadStats(cache, &stats) != 0) {
+        fprintf(stderr, "Error: Cannot read cache statistics in '%s'\n", cache->dir);
+        return;
+    }
+    long long lookups = stats.hits + stats.misses;
+    fprintf(out, "cache directory   %s\n", cache->dir);
+    fprintf(out, "cache hits        %lld\n", stats.hits);
+    fprintf(out, "cache misses      %lld\n", stats.misses);
+    fprintf(out, "hit rate          %.1f%%\n", lookups ? stats.hits * 100.0 / lookups : 0.0);
+    fprintf(out, "entries           %lld\n", stats.entries);
+    fprintf(out, "cache size        %.1f kB\n", stats.size / 1024.0);
+    fprintf(out, "max cache size    %.1f kB\n", cache->maxSize / 1024.0);
+}
@@ -0,0 +1,54 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define CACHE_KEY_SIZE 65          // 64 hex digits of SHA-256 plus NUL
+#define CACHE_FUNCTION_DIR "functions"  // --incremental state, under the cache directory
+#define CACHE_DEFAULT_MAX_SIZE (100LL * 1024 * 1024)
+
+/* An on-disk compile cache, shared by every process that uses the same
+ * directory. Entries are files named by the hash of everything that
+ * affects the output. */
+typedef struct {
+    char* dir;
+    long long maxSize;             // Bytes; older entries go past this
+    char compilerId[64];           // Identifies the compiler binary
+} CompileCache;
+
+/* Totals kept in <dir>/stats */
+typedef struct {
+    long long hits;
+    long long misses;
+    long long size;                // Bytes in entries
+    long long entries;
+} CacheStats;
+
+/* dir may be NULL for the default ($MINICOMPILER_CACHE_DIR, then
+ * $XDG_CACHE_HOME/minicompiler, then ~/.cache/minicompiler) */
+int cacheOpen(CompileCache* cache, const char* dir, long long maxSize);
+void cacheClose(CompileCache* cache);
+
+/* Key for a source buffer compiled with the given option string */
+void cacheKey(const CompileCache* cache, const char* options,
+              const char* src, size_t len, char key[CACHE_KEY_SIZE]);
+
+/* Returns 0 on a hit, with *data (malloc'd) and *size set, and counts
+ * the hit or miss */
+int cacheLookup(CompileCache* cache, const char* key, char** data, size_t* size);
+
+/* Store output under key, then evict old entries if over the limit.
+ * Failures are silent: the cache only ever saves work. */
+void cacheStore(CompileCache* cache, const char* key, const void* data, size_t size);
+
+/* Count a file of size bytes written into CACHE_FUNCTION_DIR, replacing
+ * one of replaced bytes (-1 if it is new), and evict as cacheStore does.
+ * Those files are part of the total and go least recently used first
+ * like any entry. */
+void cacheAdded(CompileCache* cache, long long replaced, size_t size);
+
+int cacheReadStats(const CompileCache* cache, CacheStats* stats);
+void cachePrintStats(const CompileCache* cache, FILE* out);
+
+#endif
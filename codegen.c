@@ -1,174 +1,949 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
 #include "codegen.h"
 #include "symtab.h"
+#include "mips.h"
+#include "incremental.h"
+#include "profile.h"
 
-FILE* output;
-int tempReg = 0;
-int inFunction = 0;
-int localVarCount = 0;
+#define T(n) tempRegister(n)
+#define A(n) (REG_A0 + (n))
 
-int getNextTemp() {
-    int reg = tempReg++;
-    if (tempReg > 7) tempReg = 0;
-    return reg;
+// $t0-$t7 by number. Any other n is a bug; it gives a register number
+// emitInstr rejects rather than one of the registers after $t7.
+static inline int tempRegister(int n) {
+    return n >= 0 && n < 8 ? REG_T0 + n : -1;
 }
 
-// Helper function to collect parameters from parameter list
-int collectParameters(ASTNode* paramNode, ASTNode** params) {
+/* EMISSION HELPERS
+ * Every instruction goes through emitInstr, which either prints it as
+ * text assembly or hands it to the binary encoder. Comments and
+ * directives only exist in the text form.
+ */
+void emitInstr(CompilerContext* ctx, MipsOp op, int rd, int rs, int rt, int imm, const char* label) {
+    MipsInstr instr = { op, rd, rs, rt, imm, label };
+    if (!mipsValidRegisters(&instr)) {
+        compilerError(ctx, "Internal compiler error: register out of range (%d, %d, %d)", rd, rs, rt);
+        return;
+    }
+    if (ctx->binaryOutput) {
+        mipsAsmEmit(ctx->binaryOutput, &instr);
+    } else {
+        textAppend(ctx->output, "    ", 4);
+        mipsAppendInstr(ctx->output, &instr);
+        textAppendChar(ctx->output, '\n');
+    }
+}
+
+void emitR(CompilerContext* ctx, MipsOp op, int rd, int rs, int rt) { emitInstr(ctx, op, rd, rs, rt, 0, NULL); }
+void emitAddi(CompilerContext* ctx, int rt, int rs, int imm) { emitInstr(ctx, MIPS_ADDI, 0, rs, rt, imm, NULL); }
+void emitSll(CompilerContext* ctx, int rd, int rt, int shift) { emitInstr(ctx, MIPS_SLL, rd, 0, rt, shift, NULL); }
+void emitMem(CompilerContext* ctx, MipsOp op, int rt, int offset, int base) { emitInstr(ctx, op, 0, base, rt, offset, NULL); }
+void emitLi(CompilerContext* ctx, int rt, int imm) { emitInstr(ctx, MIPS_LI, 0, 0, rt, imm, NULL); }
+void emitMove(CompilerContext* ctx, int rd, int rs) { emitInstr(ctx, MIPS_MOVE, rd, rs, 0, 0, NULL); }
+void emitJal(CompilerContext* ctx, const char* label) { emitInstr(ctx, MIPS_JAL, 0, 0, 0, 0, label); }
+void emitJr(CompilerContext* ctx, int rs) { emitInstr(ctx, MIPS_JR, 0, rs, 0, 0, NULL); }
+void emitSyscall(CompilerContext* ctx) { emitInstr(ctx, MIPS_SYSCALL, 0, 0, 0, 0, NULL); }
+
+void emitText(CompilerContext* ctx, const char* fmt, ...) {
+    if (ctx->binaryOutput) return;
+    if (!strchr(fmt, '%')) {
+        textAppendString(ctx->output, fmt);
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    textAppendv(ctx->output, fmt, args);
+    va_end(args);
+}
+
+void emitLabel(CompilerContext* ctx, const char* name, int global) {
+    if (ctx->binaryOutput) {
+        mipsAsmLabel(ctx->binaryOutput, name, global);
+    } else {
+        textAppendString(ctx->output, name);
+        textAppend(ctx->output, ":\n", 2);
+    }
+}
+
+// Assembly label for a function - main keeps its name, others get func_
+void functionLabel(const char* name, char* label, size_t size) {
+    if (strcmp(name, "main") == 0) {
+        snprintf(label, size, "%s", name);
+    } else {
+        snprintf(label, size, "func_%s", name);
+    }
+}
+
+// Temps are $t0-$t7, taken in order and given back by resetting
+// tempReg. Expressions spill rather than run out (genNested), so this
+// only fails for an index nested too deeply to leave one free.
+int getNextTemp(CompilerContext* ctx) {
+    if (ctx->tempReg >= 8) {
+        compilerError(ctx, "Error: Expression too complex");
+        return 7;
+    }
+    return ctx->tempReg++;
+}
+
+// Helper function to find the parameters of a function declaration:
+// points *params at them in the AST and returns how many there are
+int collectParameters(const AST* ast, NodeId func, const NodeId** params) {
+    NodeId* first = &astNode(ast, func)->data.func_decl.params;
+    ASTNode* paramNode = astNode(ast, *first);
+    *params = NULL;
     if (!paramNode) return 0;
     
-    int count = 0;
-    
     if (paramNode->type == NODE_PARAM) {
         // Single parameter
-        params[count++] = paramNode;
+        *params = first;
+        return 1;
     } else if (paramNode->type == NODE_PARAM_LIST) {
-        // Recursive list - collect from left side first
-        count += collectParameters(paramNode->data.list.item, params + count);
-        // Then from right side
-        count += collectParameters(paramNode->data.list.next, params + count);
+        *params = paramNode->data.list.items;
+        return paramNode->data.list.count;
+    }
+    
+    return 0;
+}
+
+void genExpr(CompilerContext* ctx, NodeId id);
+
+/* PROFILING
+ * -fprofile-generate: every function entry and call site bumps a word
+ * of the counter block in .data (layout in profile.h), using $t8/$t9,
+ * which nothing else touches. main does not return to its caller but
+ * jumps to a stub that writes the block to the profile file with the
+ * open/write/close system calls and then exits with main's result.
+ */
+#define PROFILE_DATA "__prof_data"
+#define PROFILE_FILE "__prof_file"
+#define PROFILE_EXIT "__prof_exit"
+
+static void emitCount(CompilerContext* ctx, uint32_t offset) {
+    emitInstr(ctx, MIPS_LA, 0, 0, REG_T8, 0, PROFILE_DATA);
+    emitMem(ctx, MIPS_LW, REG_T9, offset, REG_T8);
+    emitInstr(ctx, MIPS_ADDIU, 0, REG_T9, REG_T9, 1, NULL);
+    emitMem(ctx, MIPS_SW, REG_T9, offset, REG_T8);
+}
+
+// Leave the function whose frame has just been popped
+static void emitReturn(CompilerContext* ctx) {
+    Profile* profile = ctx->profile;
+    if (profile && strcmp(profile->functions[profile->current].name, "main") == 0) {
+        emitJal(ctx, PROFILE_EXIT);
+    } else {
+        emitJr(ctx, REG_RA);
+    }
+}
+
+static void emitProfileExit(CompilerContext* ctx) {
+    emitText(ctx, "\n# Write the profile to %s and exit with main's result\n", ctx->profileGenerate);
+    emitLabel(ctx, PROFILE_EXIT, 0);
+    emitMove(ctx, REG_S0, REG_V0);
+    emitLi(ctx, REG_V0, 13);
+    emitInstr(ctx, MIPS_LA, 0, 0, REG_A0, 0, PROFILE_FILE);
+    emitLi(ctx, REG_A0 + 1, 1);
+    emitLi(ctx, REG_A0 + 2, 0644);
+    emitSyscall(ctx);
+    emitMove(ctx, REG_S1, REG_V0);
+    emitLi(ctx, REG_V0, 15);
+    emitMove(ctx, REG_A0, REG_S1);
+    emitInstr(ctx, MIPS_LA, 0, 0, REG_A0 + 1, 0, PROFILE_DATA);
+    emitLi(ctx, REG_A0 + 2, profileSize(ctx->profile));
+    emitSyscall(ctx);
+    emitLi(ctx, REG_V0, 16);
+    emitMove(ctx, REG_A0, REG_S1);
+    emitSyscall(ctx);
+    emitMove(ctx, REG_A0, REG_S0);
+    emitLi(ctx, REG_V0, 17);
+    emitSyscall(ctx);
+}
+
+static void emitDataLabel(CompilerContext* ctx, const char* name) {
+    if (ctx->binaryOutput) {
+        mipsAsmDataLabel(ctx->binaryOutput, name);
+    } else {
+        textAppendString(ctx->output, name);
+        textAppend(ctx->output, ":\n", 2);
+    }
+}
+
+static void emitDataWord(CompilerContext* ctx, uint32_t value) {
+    if (ctx->binaryOutput) {
+        mipsAsmDataWord(ctx->binaryOutput, value);
+    } else {
+        textAppendf(ctx->output, "    .word %u\n", value);
+    }
+}
+
+static void emitDataString(CompilerContext* ctx, const char* text) {
+    if (ctx->binaryOutput) {
+        mipsAsmDataString(ctx->binaryOutput, text);
+        return;
+    }
+    textAppendString(ctx->output, "    .asciiz \"");
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') textAppendChar(ctx->output, '\\');
+        textAppendChar(ctx->output, *c);
+    }
+    textAppend(ctx->output, "\"\n", 2);
+}
+
+static void emitDataAlign(CompilerContext* ctx) {
+    if (ctx->binaryOutput) {
+        mipsAsmDataAlign(ctx->binaryOutput);
+    } else {
+        textAppendString(ctx->output, "    .align 2\n");
+    }
+}
+
+// The counter block, all counts zero, then the profile file's name
+static void emitProfileData(CompilerContext* ctx) {
+    Profile* profile = ctx->profile;
+    emitText(ctx, "\n# Profile counters\n.data\n.align 2\n");
+    emitDataLabel(ctx, PROFILE_DATA);
+    emitDataWord(ctx, PROFILE_MAGIC);
+    emitDataWord(ctx, PROFILE_VERSION);
+    emitDataWord(ctx, profile->functionCount);
+    emitDataWord(ctx, profile->siteCount);
+    uint32_t name = profileNamesOffset(profile);
+    for (int i = 0; i < profile->functionCount; i++) {
+        ProfileFunction* func = &profile->functions[i];
+        emitText(ctx, "    # %s\n", func->name);
+        emitDataWord(ctx, name);
+        emitDataWord(ctx, func->hash);
+        emitDataWord(ctx, 0);
+        emitDataWord(ctx, func->siteCount);
+        name += strlen(func->name) + 1;
+    }
+    for (int i = 0; i < profile->siteCount; i++) {
+        emitDataWord(ctx, profile->sites[i].callee);
+        emitDataWord(ctx, 0);
+    }
+    for (int i = 0; i < profile->functionCount; i++) {
+        emitDataString(ctx, profile->functions[i].name);
+    }
+    emitDataAlign(ctx);
+    emitDataLabel(ctx, PROFILE_FILE);
+    emitDataString(ctx, ctx->profileGenerate);
+}
+
+/* Lay out the counters before any code is generated. Returns -1 if
+ * memory ran out. */
+static int beginProfile(CompilerContext* ctx) {
+    if (!ctx->profileGenerate) return 0;
+    ctx->profile = profileCreate(&ctx->ast, ctx->root);
+    if (!ctx->profile) {
+        compilerError(ctx, "Error: Out of memory");
+        return -1;
+    }
+    return 0;
+}
+
+// The counters go after all the code
+static void endProfile(CompilerContext* ctx) {
+    if (!ctx->profile) return;
+    emitProfileData(ctx);
+    profileFree(ctx->profile);
+    ctx->profile = NULL;
+}
+
+void genFunction(CompilerContext* ctx, NodeId id);
+
+/* PROFILE-GUIDED OPTIMIZATION
+ * -fprofile-use: counts from an instrumented run of the same program
+ * steer three decisions. Functions are only trusted with counts while
+ * their body hashes the same as when they were measured; a stale or
+ * missing profile leaves the function as if there were none.
+ *
+ *  - Layout: functions that ran go first, most entered first; those
+ *    that never ran are moved after _exit, out of the hot code.
+ *  - Inlining: a call site that was taken, to a function that only
+ *    returns an expression of its parameters, evaluates the expression
+ *    in place on the argument temps.
+ *  - Registers: in a function that ran, each scalar gets a spill weight
+ *    of its references times the entry count. The heaviest ones that
+ *    outweigh saving and restoring a register live in $s0-$s7 instead
+ *    of the frame.
+ */
+#define MAX_PROMOTED 8
+#define MAX_INLINE_ARGS 4
+#define PROMOTE_COST 2      // Save and restore, per entry
+
+typedef struct {
+    NodeId decl;
+    int order;              // Position in the source
+    int profiled;           // Index into the profile, or -1 without usable counts
+    uint32_t entries;
+} GuidedFunction;
+
+typedef struct ProfileGuide {
+    GuidedFunction* funcs;  // By FunctionId - 1
+    GuidedFunction** layout;    // The same, in the order they are generated
+    int count;
+    GuidedFunction* current;    // Function being generated
+    int callSite;           // Its next call site, numbered as the instrumented build did
+    NameId promoted[MAX_PROMOTED];          // Scalars kept in $s0.. in this function
+    int promotedCount;
+    int savedOffset;        // Frame slot of $s0's saved value; the rest follow down
+    NameId bound[MAX_INLINE_ARGS];          // Parameters of the call being inlined
+    int boundReg[MAX_INLINE_ARGS];          // and the temps holding its arguments
+    int boundCount;
+} ProfileGuide;
+
+static int byHeat(const void* a, const void* b);
+
+// Match the program's functions to the profile. Returns -1 if memory ran out.
+static int beginGuide(CompilerContext* ctx) {
+    Profile* profile = ctx->profileUse;
+    if (!profile) return 0;
+    ProfileGuide* guide = calloc(1, sizeof(ProfileGuide));
+    NodeId* funcs = NULL;
+    int count = guide ? collectFunctions(&ctx->ast, ctx->root, &funcs) : -1;
+    if (count < 0 || !(guide->funcs = calloc(count ? count : 1, sizeof(GuidedFunction))) ||
+        !(guide->layout = malloc((count ? count : 1) * sizeof(GuidedFunction*)))) {
+        free(funcs);
+        if (guide) free(guide->funcs);
+        free(guide);
+        compilerError(ctx, "Error: Out of memory");
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        GuidedFunction* func = &guide->funcs[i];
+        const char* name = astName(&ctx->ast, astNode(&ctx->ast, funcs[i])->data.func_decl.name);
+        func->decl = funcs[i];
+        func->order = i;
+        func->profiled = profileFindFunction(profile, name);
+        if (func->profiled < 0) {
+            fprintf(ctx->diag, "Warning: No profile data for function %s\n", name);
+        } else if (profile->functions[func->profiled].hash != functionBodyHash(&ctx->ast, funcs[i])) {
+            fprintf(ctx->diag, "Warning: Profile of function %s is stale (the function changed); "
+                    "ignoring it\n", name);
+            func->profiled = -1;
+        } else {
+            func->entries = profile->functions[func->profiled].entries;
+        }
+        guide->layout[i] = func;
+    }
+    guide->count = count;
+    qsort(guide->layout, count, sizeof(GuidedFunction*), byHeat);
+    ctx->guide = guide;
+    free(funcs);
+    return 0;
+}
+
+static void endGuide(CompilerContext* ctx) {
+    if (!ctx->guide) return;
+    free(ctx->guide->funcs);
+    free(ctx->guide->layout);
+    free(ctx->guide);
+    ctx->guide = NULL;
+}
+
+// Functions without counts stay among the hot ones: nothing says they are cold
+static int isCold(const GuidedFunction* func) {
+    return func->profiled >= 0 && func->entries == 0;
+}
+
+// Hot functions, most entered first, before cold ones; otherwise source order
+static int byHeat(const void* a, const void* b) {
+    const GuidedFunction* x = *(GuidedFunction* const*)a;
+    const GuidedFunction* y = *(GuidedFunction* const*)b;
+    if (isCold(x) != isCold(y)) return isCold(x) - isCold(y);
+    if (x->entries != y->entries) return x->entries > y->entries ? -1 : 1;
+    return x->order - y->order;
+}
+
+// Times the current function's call site was taken, or -1 if unknown
+static long siteCount(CompilerContext* ctx, int site) {
+    GuidedFunction* func = ctx->guide->current;
+    if (!func || func->profiled < 0) return -1;
+    ProfileFunction* measured = &ctx->profileUse->functions[func->profiled];
+    if (site >= measured->siteCount) return -1;
+    return ctx->profileUse->sites[measured->firstSite + site].count;
+}
+
+typedef int (*NodeMatch)(const ASTNode* node, NameId name);
+
+static int isCall(const ASTNode* node, NameId name) {
+    return node->type == NODE_FUNC_CALL;
+}
+
+static int isUse(const ASTNode* node, NameId name) {
+    return (node->type == NODE_VAR && node->data.var.name == name) ||
+           (node->type == NODE_ASSIGN && node->data.assign.var == name);
+}
+
+// Statements and expressions under node that match
+static int countMatches(const AST* ast, NodeId id, NodeMatch match, NameId name) {
+    ASTNode* node = astNode(ast, id);
+    if (!node) return 0;
+    int count = match(node, name);
+    switch (node->type) {
+        case NODE_BINOP:
+            return count + countMatches(ast, node->data.binop.left, match, name) +
+                   countMatches(ast, node->data.binop.right, match, name);
+        case NODE_ASSIGN:
+            return count + countMatches(ast, node->data.assign.value, match, name);
+        case NODE_PRINT:
+            return count + countMatches(ast, node->data.expr, match, name);
+        case NODE_RETURN:
+            return count + countMatches(ast, node->data.return_expr, match, name);
+        case NODE_ARRAY_ASSIGN:
+            return count + countMatches(ast, node->data.array_assign.index, match, name) +
+                   countMatches(ast, node->data.array_assign.value, match, name);
+        case NODE_ARRAY_ACCESS:
+            return count + countMatches(ast, node->data.array_access.index, match, name);
+        case NODE_ARRAY_2D_ASSIGN:
+            return count + countMatches(ast, node->data.array_2d_assign.row, match, name) +
+                   countMatches(ast, node->data.array_2d_assign.col, match, name) +
+                   countMatches(ast, node->data.array_2d_assign.value, match, name);
+        case NODE_ARRAY_2D_ACCESS:
+            return count + countMatches(ast, node->data.array_2d_access.row, match, name) +
+                   countMatches(ast, node->data.array_2d_access.col, match, name);
+        case NODE_FUNC_CALL:
+            return count + countMatches(ast, node->data.func_call.args, match, name);
+        case NODE_STMT_LIST:
+        case NODE_ARG_LIST:
+            for (int i = 0; i < node->data.list.count; i++) {
+                count += countMatches(ast, node->data.list.items[i], match, name);
+            }
+            return count;
+        default:
+            return count;
+    }
+}
+
+/* ---- Registers ---- */
+
+// Register a variable of the current function lives in, or -1
+static int promotedRegister(CompilerContext* ctx, NameId name) {
+    for (int i = 0; ctx->guide && i < ctx->guide->promotedCount; i++) {
+        if (ctx->guide->promoted[i] == name) return REG_S0 + i;
+    }
+    return -1;
+}
+
+// Register already holding an operand, so it need not be loaded: a
+// promoted variable or a parameter of an inlined call
+static int operandRegister(CompilerContext* ctx, NodeId id) {
+    ASTNode* node = astNode(&ctx->ast, id);
+    if (!ctx->guide || node->type != NODE_VAR) return -1;
+    for (int i = 0; i < ctx->guide->boundCount; i++) {
+        if (ctx->guide->bound[i] == node->data.var.name) return T(ctx->guide->boundReg[i]);
+    }
+    if (!node->data.var.symbol) return -1;
+    return promotedRegister(ctx, node->data.var.name);
+}
+
+// The operand's register, generating it into a temp if it has none
+static int genOperand(CompilerContext* ctx, NodeId id) {
+    int reg = operandRegister(ctx, id);
+    if (reg >= 0) return reg;
+    genExpr(ctx, id);
+    return T(ctx->tempReg - 1);
+}
+
+typedef struct {
+    NameId name;
+    uint64_t weight;
+    int order;
+} SpillCandidate;
+
+static void addCandidate(SpillCandidate* candidates, int* count, NameId name, int uses,
+                         uint32_t entries) {
+    candidates[*count] = (SpillCandidate){ name, (uint64_t)uses * entries, *count };
+    (*count)++;
+}
+
+static void collectDeclared(const AST* ast, NodeId id, NodeId body, SpillCandidate* candidates,
+                            int* count, uint32_t entries) {
+    ASTNode* node = astNode(ast, id);
+    if (!node) return;
+    if (node->type == NODE_STMT_LIST) {
+        for (int i = 0; i < node->data.list.count; i++) {
+            collectDeclared(ast, node->data.list.items[i], body, candidates, count, entries);
+        }
+    } else if (node->type == NODE_DECL) {
+        NameId name = node->data.name;
+        addCandidate(candidates, count, name, countMatches(ast, body, isUse, name), entries);
     }
+}
+
+static int byWeight(const void* a, const void* b) {
+    const SpillCandidate* x = a;
+    const SpillCandidate* y = b;
+    if (x->weight != y->weight) return x->weight > y->weight ? -1 : 1;
+    return x->order - y->order;
+}
+
+// Choose the scalars of a function that ran to keep in $s registers
+static void choosePromoted(CompilerContext* ctx, NodeId func, const NodeId* params, int paramCount) {
+    const AST* ast = &ctx->ast;
+    ProfileGuide* guide = ctx->guide;
+    guide->promotedCount = 0;
+    uint32_t entries = guide->current ? guide->current->entries : 0;
+    if (entries == 0) return;
     
-    return count;
+    // Room for the register parameters and every declared word; if
+    // there is none, nothing is promoted
+    NodeId body = astNode(ast, func)->data.func_decl.body;
+    int registerParams = paramCount < 4 ? paramCount : 4;
+    SpillCandidate* candidates = malloc((registerParams + countLocalVars(ast, body) + 1) *
+                                        sizeof(SpillCandidate));
+    if (!candidates) return;
+    int count = 0;
+    for (int i = 0; i < registerParams; i++) {
+        // Storing the incoming argument is a use too
+        NameId name = astNode(ast, params[i])->data.param.name;
+        addCandidate(candidates, &count, name, 1 + countMatches(ast, body, isUse, name), entries);
+    }
+    collectDeclared(ast, body, body, candidates, &count, entries);
+    qsort(candidates, count, sizeof(SpillCandidate), byWeight);
+    for (int i = 0; i < count && guide->promotedCount < MAX_PROMOTED; i++) {
+        if (candidates[i].weight <= (uint64_t)PROMOTE_COST * entries) break;
+        guide->promoted[guide->promotedCount++] = candidates[i].name;
+    }
+    free(candidates);
+}
+
+static void emitSavePromoted(CompilerContext* ctx) {
+    ProfileGuide* guide = ctx->guide;
+    for (int i = 0; guide && i < guide->promotedCount; i++) {
+        emitMem(ctx, MIPS_SW, REG_S0 + i, guide->savedOffset - i * 4, REG_FP);
+    }
+}
+
+static void emitRestorePromoted(CompilerContext* ctx) {
+    ProfileGuide* guide = ctx->guide;
+    for (int i = 0; guide && i < guide->promotedCount; i++) {
+        emitMem(ctx, MIPS_LW, REG_S0 + i, guide->savedOffset - i * 4, REG_FP);
+    }
+}
+
+/* ---- Inlining ---- */
+
+// The returned expression of a function that does nothing else
+static NodeId returnedExpression(const AST* ast, NodeId func) {
+    ASTNode* body = astNode(ast, astNode(ast, func)->data.func_decl.body);
+    if (body && body->type == NODE_STMT_LIST && body->data.list.count == 1) {
+        body = astNode(ast, body->data.list.items[0]);
+    }
+    return body && body->type == NODE_RETURN ? body->data.return_expr : 0;
+}
+
+// Whether expr only combines literals and the parameters
+static int isLeafExpression(const AST* ast, NodeId id, const NodeId* params, int paramCount) {
+    ASTNode* expr = astNode(ast, id);
+    switch (expr->type) {
+        case NODE_NUM:
+            return 1;
+        case NODE_VAR:
+            for (int i = 0; i < paramCount; i++) {
+                if (astNode(ast, params[i])->data.param.name == expr->data.var.name) return 1;
+            }
+            return 0;
+        case NODE_BINOP:
+            return isLeafExpression(ast, expr->data.binop.left, params, paramCount) &&
+                   isLeafExpression(ast, expr->data.binop.right, params, paramCount);
+        default:
+            return 0;
+    }
+}
+
+// Temps genExpr needs for expr, at most, if nothing in it spills. A
+// call needs one: it saves the live temps and starts its arguments
+// from $t0.
+static int tempsNeeded(const AST* ast, NodeId id) {
+    ASTNode* expr = astNode(ast, id);
+    int left, right;
+    switch (expr->type) {
+        case NODE_BINOP:
+            left = tempsNeeded(ast, expr->data.binop.left);
+            right = tempsNeeded(ast, expr->data.binop.right) + 1;
+            return left > right ? left : right;
+        case NODE_ARRAY_ACCESS:
+            left = tempsNeeded(ast, expr->data.array_access.index);
+            return left > 2 ? left : 2;
+        case NODE_ARRAY_2D_ACCESS:
+            left = tempsNeeded(ast, expr->data.array_2d_access.row);
+            right = tempsNeeded(ast, expr->data.array_2d_access.col) + 1;
+            if (right < 3) right = 3;
+            return left > right ? left : right;
+        default:
+            return 1;
+    }
+}
+
+// Generate the right operand of an operation, whose left one is in
+// the last live temp. If the temps left do not have room for it, the
+// live ones go to the stack while it is generated and its value ends
+// up in $v1. Returns the register holding the value.
+static int genNested(CompilerContext* ctx, NodeId id) {
+    int live = ctx->tempReg;
+    if (live + tempsNeeded(&ctx->ast, id) <= 8) {
+        genExpr(ctx, id);
+        return T(ctx->tempReg - 1);
+    }
+    emitText(ctx, "    # Spill %d live temporaries\n", live);
+    emitAddi(ctx, REG_SP, REG_SP, -4 * live);
+    for (int i = 0; i < live; i++) {
+        emitMem(ctx, MIPS_SW, T(i), i * 4, REG_SP);
+    }
+    ctx->tempReg = 0;
+    genExpr(ctx, id);
+    emitMove(ctx, REG_V1, T(ctx->tempReg - 1));
+    for (int i = 0; i < live; i++) {
+        emitMem(ctx, MIPS_LW, T(i), i * 4, REG_SP);
+    }
+    emitAddi(ctx, REG_SP, REG_SP, 4 * live);
+    ctx->tempReg = live;
+    return REG_V1;
+}
+
+// Generate the call in place if the profile says it is worth it.
+// Returns 0 (having emitted nothing) if the call has to be made.
+static int genInlineCall(CompilerContext* ctx, FunctionId function, const NodeId* args, int argCount,
+                         int site) {
+    const AST* ast = &ctx->ast;
+    ProfileGuide* guide = ctx->guide;
+    GuidedFunction* callee = function ? &guide->funcs[function - 1] : NULL;
+    if (!callee || callee == guide->current || siteCount(ctx, site) <= 0) return 0;
+    const NodeId* params;
+    int paramCount = collectParameters(ast, callee->decl, &params);
+    NodeId expr = returnedExpression(ast, callee->decl);
+    if (!expr || paramCount != argCount || argCount > MAX_INLINE_ARGS ||
+        !isLeafExpression(ast, expr, params, paramCount) || guide->boundCount > 0 ||
+        ctx->tempReg + argCount + tempsNeeded(ast, expr) > 8) {
+        return 0;
+    }
+    for (int i = 0; i < argCount; i++) {
+        if (ctx->tempReg + i + tempsNeeded(ast, args[i]) > 8) return 0;
+    }
+    
+    const char* name = astName(ast, astNode(ast, callee->decl)->data.func_decl.name);
+    emitText(ctx, "    # Inlined call to %s\n", name);
+    // Arguments may inline calls of their own, so the parameters are
+    // bound only once all of them are in temps
+    int live = ctx->tempReg;
+    int argRegs[MAX_INLINE_ARGS];
+    for (int i = 0; i < argCount; i++) {
+        genExpr(ctx, args[i]);
+        argRegs[i] = ctx->tempReg - 1;
+    }
+    for (int i = 0; i < argCount; i++) {
+        guide->bound[i] = astNode(ast, params[i])->data.param.name;
+        guide->boundReg[i] = argRegs[i];
+    }
+    guide->boundCount = argCount;
+    int result = genOperand(ctx, expr);
+    guide->boundCount = 0;
+    
+    ctx->tempReg = live;
+    int dest = T(getNextTemp(ctx));
+    if (result != dest) emitMove(ctx, dest, result);
+    return 1;
+}
+
+// The hot functions, or the cold ones, in the order the profile gives
+static void genGuidedFunctions(CompilerContext* ctx, int cold) {
+    ProfileGuide* guide = ctx->guide;
+    int first = 1;
+    for (int i = 0; i < guide->count; i++) {
+        if (isCold(guide->layout[i]) != cold) continue;
+        if (cold && first) emitText(ctx, "\n# Functions that did not run in the profiled run\n");
+        first = 0;
+        guide->current = guide->layout[i];
+        genFunction(ctx, guide->current->decl);
+    }
+    guide->current = NULL;
+}
+
+/* -O1 HELPERS
+ * Expressions built only from literals are computed at compile time.
+ * + and - are not folded when the sum overflows, so the program still
+ * traps where the unoptimized add would.
+ */
+static int constantValue(const AST* ast, NodeId id, int* value) {
+    ASTNode* node = astNode(ast, id);
+    if (node->type == NODE_NUM) {
+        *value = node->data.num;
+        return 1;
+    }
+    int left, right;
+    if (node->type != NODE_BINOP || !constantValue(ast, node->data.binop.left, &left) ||
+        !constantValue(ast, node->data.binop.right, &right)) {
+        return 0;
+    }
+    switch (node->data.binop.op) {
+        case '+': return !__builtin_add_overflow(left, right, value);
+        case '-': return !__builtin_sub_overflow(left, right, value);
+        case '*': *value = (int)((unsigned)left * (unsigned)right); return 1;   // mul wraps
+        default: return 0;
+    }
 }
 
-void genExpr(ASTNode* node) {
+static int optimizedConstant(CompilerContext* ctx, NodeId id, int* value) {
+    return ctx->optLevel > 0 && constantValue(&ctx->ast, id, value);
+}
+
+// Frame offset of an element whose index is known, or 0 if it is not
+static int constantElement(CompilerContext* ctx, const Symbol* sym, NodeId row, NodeId col, int* offset) {
+    int r = 0, c;
+    if (!optimizedConstant(ctx, col, &c) || (row && !optimizedConstant(ctx, row, &r))) return 0;
+    int columns = row ? sym->cols : sym->arraySize;
+    if (r < 0 || c < 0 || c >= columns || (long)r * columns + c >= sym->arraySize) return 0;
+    *offset = sym->offset + (r * columns + c) * 4;
+    return 1;
+}
+
+// x + c, x - c and x * 2^k without loading the constant. Returns 0 if
+// node is not of that form.
+static int genBinopImmediate(CompilerContext* ctx, ASTNode* node) {
+    NodeId left = node->data.binop.left;
+    NodeId right = node->data.binop.right;
+    int op = node->data.binop.op, c;
+    NodeId other;
+    if (optimizedConstant(ctx, right, &c)) {
+        other = left;
+    } else if (op != '-' && optimizedConstant(ctx, left, &c)) {
+        other = right;
+    } else {
+        return 0;
+    }
+
+    int shift = 0;
+    if (op == '*') {
+        if (c <= 0 || (c & (c - 1)) != 0) return 0;
+        while ((1 << shift) != c) shift++;
+    } else if (op == '-') {
+        if (c == -2147483647 - 1) return 0;
+        c = -c;
+    }
+
+    // A variable in a register is used from there
+    int src = operandRegister(ctx, other);
+    int dest;
+    if (src >= 0) {
+        dest = T(getNextTemp(ctx));
+    } else {
+        genExpr(ctx, other);
+        dest = src = T(ctx->tempReg - 1);
+    }
+    if (op == '*' && shift > 0) {
+        emitSll(ctx, dest, src, shift);
+    } else if (op != '*' && c != 0) {
+        emitAddi(ctx, dest, src, c);
+    } else if (src != dest) {
+        emitMove(ctx, dest, src);
+    }
+    return 1;
+}
+
+// A binary operation with an operand in a register of its own
+static void genBinopOperands(CompilerContext* ctx, ASTNode* node) {
+    int base = ctx->tempReg;
+    int left = genOperand(ctx, node->data.binop.left);
+    int right = operandRegister(ctx, node->data.binop.right);
+    if (right < 0) right = genNested(ctx, node->data.binop.right);
+    ctx->tempReg = base;
+    int dest = T(getNextTemp(ctx));
+    int op = node->data.binop.op;
+    emitR(ctx, op == '+' ? MIPS_ADD : op == '-' ? MIPS_SUB : MIPS_MUL, dest, left, right);
+}
+
+void genExpr(CompilerContext* ctx, NodeId id) {
+    const AST* ast = &ctx->ast;
+    ASTNode* node = astNode(ast, id);
     if (!node) return;
+    int value;
     
     switch(node->type) {
         case NODE_NUM:
-            fprintf(output, "    li $t%d, %d\n", getNextTemp(), node->data.num);
+            emitLi(ctx, T(getNextTemp(ctx)), node->data.num);
             break;
             
         case NODE_VAR: {
-            Symbol* sym = lookupSymbol(node->data.name);
+            int reg = operandRegister(ctx, id);
+            if (reg >= 0) {
+                emitMove(ctx, T(getNextTemp(ctx)), reg);
+                break;
+            }
+            const Symbol* sym = boundSymbol(&ctx->symtab, node->data.var.symbol);
             if (!sym) {
-                fprintf(stderr, "Error: Variable %s not declared\n", node->data.name);
-                exit(1);
+                compilerError(ctx, "Error: Variable %s not declared", astName(ast, node->data.var.name));
+                return;
             }
             int offset = sym->offset;
-            fprintf(output, "    lw $t%d, %d($fp)\n", getNextTemp(), offset);
+            emitMem(ctx, MIPS_LW, T(getNextTemp(ctx)), offset, REG_FP);
             break;
         }
         
         case NODE_BINOP:
-            genExpr(node->data.binop.left);
-            int leftReg = tempReg - 1;
-            genExpr(node->data.binop.right);
-            int rightReg = tempReg - 1;
+            if (optimizedConstant(ctx, id, &value)) {
+                emitLi(ctx, T(getNextTemp(ctx)), value);
+                break;
+            }
+            if (ctx->optLevel > 0 && genBinopImmediate(ctx, node)) break;
+            if (operandRegister(ctx, node->data.binop.left) >= 0 ||
+                operandRegister(ctx, node->data.binop.right) >= 0) {
+                genBinopOperands(ctx, node);
+                break;
+            }
+            genExpr(ctx, node->data.binop.left);
+            int leftReg = ctx->tempReg - 1;
+            int rightReg = genNested(ctx, node->data.binop.right);
             
             if (node->data.binop.op == '+') {
-                fprintf(output, "    add $t%d, $t%d, $t%d\n", leftReg, leftReg, rightReg);
+                emitR(ctx, MIPS_ADD, T(leftReg), T(leftReg), rightReg);
             } else if (node->data.binop.op == '-') {
-                fprintf(output, "    sub $t%d, $t%d, $t%d\n", leftReg, leftReg, rightReg);
+                emitR(ctx, MIPS_SUB, T(leftReg), T(leftReg), rightReg);
             } else if (node->data.binop.op == '*') {
-                fprintf(output, "    mul $t%d, $t%d, $t%d\n", leftReg, leftReg, rightReg);
+                emitR(ctx, MIPS_MUL, T(leftReg), T(leftReg), rightReg);
             }
-            tempReg = leftReg + 1;
+            ctx->tempReg = leftReg + 1;
             break;
         
         case NODE_ARRAY_ACCESS: {
-            Symbol* sym = lookupSymbol(node->data.array_access.name);
+            const Symbol* sym = boundSymbol(&ctx->symtab, node->data.array_access.symbol);
             if (!sym) {
-                fprintf(stderr, "Error: Array %s not declared\n", node->data.array_access.name);
-                exit(1);
+                compilerError(ctx, "Error: Array %s not declared",
+                              astName(ast, node->data.array_access.name));
+                return;
             }
             int baseOffset = sym->offset;
+            if (constantElement(ctx, sym, 0, node->data.array_access.index, &value)) {
+                emitMem(ctx, MIPS_LW, T(getNextTemp(ctx)), value, REG_FP);
+                break;
+            }
             
-            genExpr(node->data.array_access.index);
-            int indexReg = tempReg - 1;
+            genExpr(ctx, node->data.array_access.index);
+            int indexReg = ctx->tempReg - 1;
             
-            fprintf(output, "    sll $t%d, $t%d, 2\n", indexReg, indexReg);
-            fprintf(output, "    addi $t%d, $fp, %d\n", getNextTemp(), baseOffset);
-            int baseReg = tempReg - 1;
-            fprintf(output, "    add $t%d, $t%d, $t%d\n", baseReg, baseReg, indexReg);
-            fprintf(output, "    lw $t%d, 0($t%d)\n", indexReg, baseReg);
-            tempReg = indexReg + 1;
+            emitSll(ctx, T(indexReg), T(indexReg), 2);
+            emitAddi(ctx, T(getNextTemp(ctx)), REG_FP, baseOffset);
+            int baseReg = ctx->tempReg - 1;
+            emitR(ctx, MIPS_ADD, T(baseReg), T(baseReg), T(indexReg));
+            emitMem(ctx, MIPS_LW, T(indexReg), 0, T(baseReg));
+            ctx->tempReg = indexReg + 1;
             break;
         }
 
         case NODE_ARRAY_2D_ACCESS: {
-            Symbol* sym = getSymbol(node->data.array_2d_access.name);
+            const Symbol* sym = boundSymbol(&ctx->symtab, node->data.array_2d_access.symbol);
             if (!sym || !sym->is2DArray) {
-                fprintf(stderr, "Error: 2D Array %s not declared\n", node->data.array_2d_access.name);
-                exit(1);
+                compilerError(ctx, "Error: 2D Array %s not declared",
+                              astName(ast, node->data.array_2d_access.name));
+                return;
             }
             
             int baseOffset = sym->offset;
             int cols = sym->cols;
+            if (constantElement(ctx, sym, node->data.array_2d_access.row, node->data.array_2d_access.col,
+                                &value)) {
+                emitMem(ctx, MIPS_LW, T(getNextTemp(ctx)), value, REG_FP);
+                break;
+            }
             
-            genExpr(node->data.array_2d_access.row);
-            int rowReg = tempReg - 1;
-            genExpr(node->data.array_2d_access.col);
-            int colReg = tempReg - 1;
+            genExpr(ctx, node->data.array_2d_access.row);
+            int rowReg = ctx->tempReg - 1;
+            genExpr(ctx, node->data.array_2d_access.col);
+            int colReg = ctx->tempReg - 1;
             
-            fprintf(output, "    li $t%d, %d\n", getNextTemp(), cols);
-            int colsReg = tempReg - 1;
-            fprintf(output, "    mul $t%d, $t%d, $t%d\n", rowReg, rowReg, colsReg);
-            fprintf(output, "    add $t%d, $t%d, $t%d\n", rowReg, rowReg, colReg);
-            fprintf(output, "    sll $t%d, $t%d, 2\n", rowReg, rowReg);
-            fprintf(output, "    addi $t%d, $fp, %d\n", colsReg, baseOffset);
-            fprintf(output, "    add $t%d, $t%d, $t%d\n", colsReg, colsReg, rowReg);
-            fprintf(output, "    lw $t%d, 0($t%d)\n", rowReg, colsReg);
-            tempReg = rowReg + 1;
+            emitLi(ctx, T(getNextTemp(ctx)), cols);
+            int colsReg = ctx->tempReg - 1;
+            emitR(ctx, MIPS_MUL, T(rowReg), T(rowReg), T(colsReg));
+            emitR(ctx, MIPS_ADD, T(rowReg), T(rowReg), T(colReg));
+            emitSll(ctx, T(rowReg), T(rowReg), 2);
+            emitAddi(ctx, T(colsReg), REG_FP, baseOffset);
+            emitR(ctx, MIPS_ADD, T(colsReg), T(colsReg), T(rowReg));
+            emitMem(ctx, MIPS_LW, T(rowReg), 0, T(colsReg));
+            ctx->tempReg = rowReg + 1;
             break;
         }
         
         case NODE_FUNC_CALL: {
-            // Save $ra if we're in a function (nested calls)
-            if (inFunction) {
-                fprintf(output, "    # Save $ra before nested call\n");
-                fprintf(output, "    addi $sp, $sp, -4\n");
-                fprintf(output, "    sw $ra, 0($sp)\n");
-            }
+            // The arguments, in order
+            ASTNode* argList = astNode(ast, node->data.func_call.args);
+            int argCount = argList ? argList->data.list.count : 0;
+            const NodeId* args = argList ? argList->data.list.items : NULL;
             
-            // Count arguments and collect them into array
-            int argCount = 0;
-            ASTNode* args[10];
-            
-            // Flatten the argument list
-            ASTNode* argNode = node->data.func_call.args;
-            while (argNode) {
-                if (argNode->type == NODE_ARG_LIST) {
-                    args[argCount++] = argNode->data.list.item;
-                    argNode = argNode->data.list.next;
-                } else {
-                    args[argCount++] = argNode;
+            // Call sites are numbered after the calls in their arguments,
+            // as the instrumented build counted them
+            int site = 0;
+            if (ctx->guide) {
+                site = ctx->guide->callSite + countMatches(ast, node->data.func_call.args, isCall, 0);
+                if (genInlineCall(ctx, node->data.func_call.function, args, argCount, site)) {
+                    ctx->guide->callSite = site + 1;
                     break;
                 }
             }
             
-            // Reverse the args array (they were built backwards)
-            for (int i = 0; i < argCount / 2; i++) {
-                ASTNode* temp = args[i];
-                args[i] = args[argCount - 1 - i];
-                args[argCount - 1 - i] = temp;
+            // The callee is free to use $t0-$t7, so temps holding parts
+            // of the enclosing expression are kept on the stack
+            int live = ctx->tempReg;
+            if (live > 0) {
+                emitText(ctx, "    # Save %d live temporaries\n", live);
+                emitAddi(ctx, REG_SP, REG_SP, -4 * live);
+                for (int i = 0; i < live; i++) {
+                    emitMem(ctx, MIPS_SW, T(i), i * 4, REG_SP);
+                }
             }
             
-            // Load arguments into $a0-$a3 (max 4 args for simplicity)
+            // Save $ra if we're in a function (nested calls). The
+            // prologue has saved it already, so -O1 leaves this out.
+            int saveRA = ctx->inFunction && ctx->optLevel == 0;
+            if (saveRA) {
+                emitText(ctx, "    # Save $ra before nested call\n");
+                emitAddi(ctx, REG_SP, REG_SP, -4);
+                emitMem(ctx, MIPS_SW, REG_RA, 0, REG_SP);
+            }
+            
+            // Load arguments into $a0-$a3 (max 4 args for simplicity).
+            // An argument may contain a call of its own, which would
+            // overwrite the $a registers, so all of them are evaluated
+            // into temps first, from $t0 on as the live ones are saved.
+            ctx->tempReg = 0;
+            int argRegs[4];
+            for (int i = 0; i < argCount && i < 4; i++) {
+                genExpr(ctx, args[i]);
+                argRegs[i] = ctx->tempReg - 1;
+            }
             for (int i = 0; i < argCount && i < 4; i++) {
-                genExpr(args[i]);
-                fprintf(output, "    move $a%d, $t%d\n", i, tempReg - 1);
+                emitMove(ctx, A(i), T(argRegs[i]));
             }
             
             // Call the function - add func_ prefix unless it's main
-            if (strcmp(node->data.func_call.name, "main") == 0) {
-                fprintf(output, "    jal %s\n", node->data.func_call.name);
-            } else {
-                fprintf(output, "    jal func_%s\n", node->data.func_call.name);
+            const char* name = astName(ast, node->data.func_call.name);
+            char label[256];
+            functionLabel(name, label, sizeof(label));
+            if (ctx->profile) {
+                // The profile lists the functions in source order, as FunctionIds count them
+                emitCount(ctx, profileAddSite(ctx->profile, (int)node->data.func_call.function - 1));
             }
+            emitJal(ctx, label);
             
             // Restore $ra if needed
-            if (inFunction) {
-                fprintf(output, "    # Restore $ra after nested call\n");
-                fprintf(output, "    lw $ra, 0($sp)\n");
-                fprintf(output, "    addi $sp, $sp, 4\n");
+            if (saveRA) {
+                emitText(ctx, "    # Restore $ra after nested call\n");
+                emitMem(ctx, MIPS_LW, REG_RA, 0, REG_SP);
+                emitAddi(ctx, REG_SP, REG_SP, 4);
             }
             
             // Move return value to temp register
-            fprintf(output, "    move $t%d, $v0\n", getNextTemp());
+            ctx->tempReg = live;
+            emitMove(ctx, T(getNextTemp(ctx)), REG_V0);
+            
+            if (live > 0) {
+                emitText(ctx, "    # Restore live temporaries\n");
+                for (int i = 0; i < live; i++) {
+                    emitMem(ctx, MIPS_LW, T(i), i * 4, REG_SP);
+                }
+                emitAddi(ctx, REG_SP, REG_SP, 4 * live);
+            }
+            if (ctx->guide) ctx->guide->callSite = site + 1;
             break;
         }
             
@@ -177,218 +952,286 @@ void genExpr(ASTNode* node) {
     }
 }
 
-void genStmt(ASTNode* node) {
+void genStmt(CompilerContext* ctx, NodeId id);
+
+// Label, prologue, body and epilogue of one function
+void genFunction(CompilerContext* ctx, NodeId id) {
+    const AST* ast = &ctx->ast;
+    ASTNode* node = astNode(ast, id);
+    const char* name = astName(ast, node->data.func_decl.name);
+    ctx->inFunction = 1;
+    ctx->localVarCount = 0;
+    
+    // Generate function label - don't mangle main
+    char label[256];
+    functionLabel(name, label, sizeof(label));
+    emitText(ctx, "\n");
+    emitText(ctx, "# Function: %s\n", name);
+    emitLabel(ctx, label, strcmp(name, "main") == 0);
+    
+    // Function prologue
+    emitText(ctx, "    # Prologue\n");
+    emitAddi(ctx, REG_SP, REG_SP, -8);
+    emitMem(ctx, MIPS_SW, REG_RA, 4, REG_SP);
+    emitMem(ctx, MIPS_SW, REG_FP, 0, REG_SP);
+    emitMove(ctx, REG_FP, REG_SP);
+    if (ctx->profile) {
+        emitCount(ctx, profileEntryCounter(ctx->profile, profileBeginFunction(ctx->profile)));
+    }
+    
+    // Collect all parameters using helper function; the binding pass
+    // has given them their slots
+    const NodeId* params;
+    int paramCount = collectParameters(ast, id, &params);
+    for (int i = 0; i < paramCount; i++) {
+        ASTNode* param = astNode(ast, params[i]);
+        emitText(ctx, "    # Parameter %d: %s\n", i, astName(ast, param->data.param.name));
+    }
+    
+    // Count local variables to allocate space; the parameters come
+    // first, the saved $s registers of promoted variables last
+    int localCount = paramCount + countLocalVars(ast, node->data.func_decl.body);
+    if (ctx->guide) {
+        ctx->guide->callSite = 0;
+        choosePromoted(ctx, id, params, paramCount);
+        ctx->guide->savedOffset = -4 - localCount * 4;
+        localCount += ctx->guide->promotedCount;
+    }
+    if (localCount > 0) {
+        emitText(ctx, "    # Allocate space for %d local variables\n", localCount);
+        emitAddi(ctx, REG_SP, REG_SP, -(localCount * 4));
+    }
+    emitSavePromoted(ctx);
+    
+    // Save argument registers to parameter locations
+    for (int i = 0; i < paramCount && i < 4; i++) {
+        int reg = promotedRegister(ctx, astNode(ast, params[i])->data.param.name);
+        if (reg >= 0) {
+            emitMove(ctx, reg, A(i));
+        } else {
+            emitMem(ctx, MIPS_SW, A(i), -4 - i * 4, REG_FP);
+        }
+    }
+    
+    // Generate function body
+    genStmt(ctx, node->data.func_decl.body);
+    
+    // Function epilogue (if no explicit return)
+    emitText(ctx, "    # Epilogue\n");
+    emitRestorePromoted(ctx);
+    if (localCount > 0) {
+        emitAddi(ctx, REG_SP, REG_SP, localCount * 4);
+    }
+    emitMove(ctx, REG_SP, REG_FP);
+    emitMem(ctx, MIPS_LW, REG_FP, 0, REG_SP);
+    emitMem(ctx, MIPS_LW, REG_RA, 4, REG_SP);
+    emitAddi(ctx, REG_SP, REG_SP, 8);
+    emitReturn(ctx);
+    
+    ctx->inFunction = 0;
+    if (ctx->guide) ctx->guide->promotedCount = 0;
+}
+
+/* Incremental builds: splice in the function's earlier output if its
+ * subtree and callees are unchanged, else generate and remember it */
+static void genFunctionCached(CompilerContext* ctx, NodeId id) {
+    unsigned char digest[SHA256_SIZE];
+    functionDigest(ctx->functions, &ctx->ast, id, ctx->tempReg, ctx->optLevel, digest);
+    const FunctionEntry* entry = functionCacheFind(ctx->functions, digest);
+    if (entry) {
+        textAppend(ctx->output, entry->text, entry->size);
+        ctx->tempReg = entry->exitTempReg;
+        ctx->functions->reused++;
+        return;
+    }
+    
+    size_t start = ctx->output->size;
+    int errorsBefore = ctx->errorCount;
+    genFunction(ctx, id);
+    ctx->functions->generated++;
+    if (ctx->errorCount == errorsBefore && !ctx->output->failed) {
+        functionCacheStore(ctx->functions, digest, &ctx->ast, id, ctx->output->data + start,
+                           ctx->output->size - start, ctx->tempReg);
+    }
+}
+
+void genStmt(CompilerContext* ctx, NodeId id) {
+    const AST* ast = &ctx->ast;
+    ASTNode* node = astNode(ast, id);
     if (!node) return;
     
     switch(node->type) {
         case NODE_FUNC_LIST:
-            genStmt(node->data.list.item);
-            genStmt(node->data.list.next);
+        case NODE_STMT_LIST:
+            for (int i = 0; i < node->data.list.count; i++) {
+                genStmt(ctx, node->data.list.items[i]);
+            }
             break;
             
-        case NODE_FUNC_DECL: {
-            inFunction = 1;
-            localVarCount = 0;
-            
-            // Generate function label - don't mangle main
-            fprintf(output, "\n");
-            if (strcmp(node->data.func_decl.name, "main") == 0) {
-                fprintf(output, "# Function: %s\n", node->data.func_decl.name);
-                fprintf(output, "%s:\n", node->data.func_decl.name);
+        case NODE_FUNC_DECL:
+            if (ctx->functions && !ctx->binaryOutput && !ctx->profile && !ctx->guide) {
+                genFunctionCached(ctx, id);
             } else {
-                fprintf(output, "# Function: %s\n", node->data.func_decl.name);
-                fprintf(output, "func_%s:\n", node->data.func_decl.name);
+                genFunction(ctx, id);
             }
-            
-            // Function prologue
-            fprintf(output, "    # Prologue\n");
-            fprintf(output, "    addi $sp, $sp, -8\n");
-            fprintf(output, "    sw $ra, 4($sp)\n");
-            fprintf(output, "    sw $fp, 0($sp)\n");
-            fprintf(output, "    move $fp, $sp\n");
-            
-            // Enter scope for this function
-            enterScope();
-            
-            // Collect all parameters using helper function
-            ASTNode* params[10];
-            int paramCount = collectParameters(node->data.func_decl.params, params);
-            
-            // Add parameters to symbol table
-            for (int i = 0; i < paramCount; i++) {
-                fprintf(output, "    # Parameter %d: %s\n", i, params[i]->data.param.name);
-                addParameter(params[i]->data.param.name, params[i]->data.param.type);
-            }
-            
-            // Save argument registers to parameter locations
-            for (int i = 0; i < paramCount && i < 4; i++) {
-                fprintf(output, "    sw $a%d, %d($fp)\n", i, 8 + i * 4);
-            }
-            
-            // Count local variables to allocate space
-            int localCount = countLocalVars(node->data.func_decl.body);
-            if (localCount > 0) {
-                fprintf(output, "    # Allocate space for %d local variables\n", localCount);
-                fprintf(output, "    addi $sp, $sp, %d\n", -(localCount * 4));
-            }
-            
-            // Generate function body
-            genStmt(node->data.func_decl.body);
-            
-            // Function epilogue (if no explicit return)
-            fprintf(output, "    # Epilogue\n");
-            if (localCount > 0) {
-                fprintf(output, "    addi $sp, $sp, %d\n", localCount * 4);
-            }
-            fprintf(output, "    move $sp, $fp\n");
-            fprintf(output, "    lw $fp, 0($sp)\n");
-            fprintf(output, "    lw $ra, 4($sp)\n");
-            fprintf(output, "    addi $sp, $sp, 8\n");
-            fprintf(output, "    jr $ra\n");
-            
-            exitScope();
-            inFunction = 0;
             break;
-        }
         
         case NODE_DECL: {
-            addVar(node->data.name);
-            localVarCount++;
-            fprintf(output, "    # Declared %s\n", node->data.name);
+            ctx->localVarCount++;
+            emitText(ctx, "    # Declared %s\n", astName(ast, node->data.name));
             break;
         }
         
         case NODE_ARRAY_DECL: {
-            addArray(node->data.array_decl.name, node->data.array_decl.size);
-            fprintf(output, "    # Declared array %s[%d]\n", 
-                    node->data.array_decl.name, node->data.array_decl.size);
+            emitText(ctx, "    # Declared array %s[%d]\n", 
+                    astName(ast, node->data.array_decl.name), node->data.array_decl.size);
             break;
         }
 
         case NODE_ARRAY_2D_DECL: {
-            addArray2D(node->data.array_2d_decl.name, 
-                       node->data.array_2d_decl.rows, 
-                       node->data.array_2d_decl.cols);
-            fprintf(output, "    # Declared 2D array %s[%d][%d]\n", 
-                    node->data.array_2d_decl.name, 
+            emitText(ctx, "    # Declared 2D array %s[%d][%d]\n", 
+                    astName(ast, node->data.array_2d_decl.name), 
                     node->data.array_2d_decl.rows, 
                     node->data.array_2d_decl.cols);
             break;
         }
         
         case NODE_ASSIGN: {
-            Symbol* sym = lookupSymbol(node->data.assign.var);
+            const Symbol* sym = boundSymbol(&ctx->symtab, node->data.assign.symbol);
             if (!sym) {
-                fprintf(stderr, "Error: Variable %s not declared\n", node->data.assign.var);
-                exit(1);
+                compilerError(ctx, "Error: Variable %s not declared", astName(ast, node->data.assign.var));
+                return;
             }
             int offset = sym->offset;
-            genExpr(node->data.assign.value);
-            fprintf(output, "    sw $t%d, %d($fp)\n", tempReg - 1, offset);
-            tempReg = 0;
+            int reg = promotedRegister(ctx, node->data.assign.var);
+            genExpr(ctx, node->data.assign.value);
+            if (reg >= 0) {
+                emitMove(ctx, reg, T(ctx->tempReg - 1));
+            } else {
+                emitMem(ctx, MIPS_SW, T(ctx->tempReg - 1), offset, REG_FP);
+            }
+            ctx->tempReg = 0;
             break;
         }
         
         case NODE_ARRAY_ASSIGN: {
-            Symbol* sym = lookupSymbol(node->data.array_assign.name);
+            const Symbol* sym = boundSymbol(&ctx->symtab, node->data.array_assign.symbol);
             if (!sym) {
-                fprintf(stderr, "Error: Array %s not declared\n", node->data.array_assign.name);
-                exit(1);
+                compilerError(ctx, "Error: Array %s not declared",
+                              astName(ast, node->data.array_assign.name));
+                return;
             }
             int baseOffset = sym->offset;
+            int offset;
+            if (constantElement(ctx, sym, 0, node->data.array_assign.index, &offset)) {
+                genExpr(ctx, node->data.array_assign.value);
+                emitMem(ctx, MIPS_SW, T(ctx->tempReg - 1), offset, REG_FP);
+                ctx->tempReg = 0;
+                break;
+            }
             
-            genExpr(node->data.array_assign.index);
-            int indexReg = tempReg - 1;
+            genExpr(ctx, node->data.array_assign.index);
+            int indexReg = ctx->tempReg - 1;
             
-            fprintf(output, "    sll $t%d, $t%d, 2\n", indexReg, indexReg);
-            fprintf(output, "    addi $t%d, $fp, %d\n", getNextTemp(), baseOffset);
-            int baseReg = tempReg - 1;
-            fprintf(output, "    add $t%d, $t%d, $t%d\n", baseReg, baseReg, indexReg);
+            // The address ends up in the index register, so the value
+            // has every other temp to work with
+            emitSll(ctx, T(indexReg), T(indexReg), 2);
+            emitAddi(ctx, T(getNextTemp(ctx)), REG_FP, baseOffset);
+            int baseReg = ctx->tempReg - 1;
+            emitR(ctx, MIPS_ADD, T(indexReg), T(baseReg), T(indexReg));
+            ctx->tempReg = indexReg + 1;
             
-            genExpr(node->data.array_assign.value);
-            int valueReg = tempReg - 1;
+            genExpr(ctx, node->data.array_assign.value);
+            int valueReg = ctx->tempReg - 1;
             
-            fprintf(output, "    sw $t%d, 0($t%d)\n", valueReg, baseReg);
-            tempReg = 0;
+            emitMem(ctx, MIPS_SW, T(valueReg), 0, T(indexReg));
+            ctx->tempReg = 0;
             break;
         }
 
         case NODE_ARRAY_2D_ASSIGN: {
-            Symbol* sym = getSymbol(node->data.array_2d_assign.name);
+            const Symbol* sym = boundSymbol(&ctx->symtab, node->data.array_2d_assign.symbol);
             if (!sym || !sym->is2DArray) {
-                fprintf(stderr, "Error: 2D Array %s not declared\n", node->data.array_2d_assign.name);
-                exit(1);
+                compilerError(ctx, "Error: 2D Array %s not declared",
+                              astName(ast, node->data.array_2d_assign.name));
+                return;
             }
             
             int baseOffset = sym->offset;
             int cols = sym->cols;
+            int offset;
+            if (constantElement(ctx, sym, node->data.array_2d_assign.row, node->data.array_2d_assign.col,
+                                &offset)) {
+                genExpr(ctx, node->data.array_2d_assign.value);
+                emitMem(ctx, MIPS_SW, T(ctx->tempReg - 1), offset, REG_FP);
+                ctx->tempReg = 0;
+                break;
+            }
             
-            genExpr(node->data.array_2d_assign.row);
-            int rowReg = tempReg - 1;
-            genExpr(node->data.array_2d_assign.col);
-            int colReg = tempReg - 1;
+            genExpr(ctx, node->data.array_2d_assign.row);
+            int rowReg = ctx->tempReg - 1;
+            genExpr(ctx, node->data.array_2d_assign.col);
+            int colReg = ctx->tempReg - 1;
             
-            fprintf(output, "    li $t%d, %d\n", getNextTemp(), cols);
-            int colsReg = tempReg - 1;
-            fprintf(output, "    mul $t%d, $t%d, $t%d\n", rowReg, rowReg, colsReg);
-            fprintf(output, "    add $t%d, $t%d, $t%d\n", rowReg, rowReg, colReg);
-            fprintf(output, "    sll $t%d, $t%d, 2\n", rowReg, rowReg);
-            fprintf(output, "    addi $t%d, $fp, %d\n", colsReg, baseOffset);
-            fprintf(output, "    add $t%d, $t%d, $t%d\n", colsReg, colsReg, rowReg);
+            emitLi(ctx, T(getNextTemp(ctx)), cols);
+            int colsReg = ctx->tempReg - 1;
+            emitR(ctx, MIPS_MUL, T(rowReg), T(rowReg), T(colsReg));
+            emitR(ctx, MIPS_ADD, T(rowReg), T(rowReg), T(colReg));
+            emitSll(ctx, T(rowReg), T(rowReg), 2);
+            emitAddi(ctx, T(colsReg), REG_FP, baseOffset);
+            emitR(ctx, MIPS_ADD, T(rowReg), T(colsReg), T(rowReg));
+            ctx->tempReg = rowReg + 1;
             
-            genExpr(node->data.array_2d_assign.value);
-            int valueReg = tempReg - 1;
+            genExpr(ctx, node->data.array_2d_assign.value);
+            int valueReg = ctx->tempReg - 1;
             
-            fprintf(output, "    sw $t%d, 0($t%d)\n", valueReg, colsReg);
-            tempReg = 0;
+            emitMem(ctx, MIPS_SW, T(valueReg), 0, T(rowReg));
+            ctx->tempReg = 0;
             break;
         }
         
         case NODE_PRINT:
-            genExpr(node->data.expr);
-            fprintf(output, "    # Print integer\n");
-            fprintf(output, "    move $a0, $t%d\n", tempReg - 1);
-            fprintf(output, "    li $v0, 1\n");
-            fprintf(output, "    syscall\n");
-            fprintf(output, "    # Print newline\n");
-            fprintf(output, "    li $v0, 11\n");
-            fprintf(output, "    li $a0, 10\n");
-            fprintf(output, "    syscall\n");
-            tempReg = 0;
+            genExpr(ctx, node->data.expr);
+            emitText(ctx, "    # Print integer\n");
+            emitMove(ctx, REG_A0, T(ctx->tempReg - 1));
+            emitLi(ctx, REG_V0, 1);
+            emitSyscall(ctx);
+            emitText(ctx, "    # Print newline\n");
+            emitLi(ctx, REG_V0, 11);
+            emitLi(ctx, REG_A0, 10);
+            emitSyscall(ctx);
+            ctx->tempReg = 0;
             break;
         
         case NODE_RETURN: {
             if (node->data.return_expr) {
-                genExpr(node->data.return_expr);
-                fprintf(output, "    move $v0, $t%d\n", tempReg - 1);
+                genExpr(ctx, node->data.return_expr);
+                emitMove(ctx, REG_V0, T(ctx->tempReg - 1));
             }
             
             // Count locals for proper deallocation
-            fprintf(output, "    # Return statement\n");
-            if (localVarCount > 0) {
-                fprintf(output, "    addi $sp, $sp, %d\n", localVarCount * 4);
-            }
-            fprintf(output, "    move $sp, $fp\n");
-            fprintf(output, "    lw $fp, 0($sp)\n");
-            fprintf(output, "    lw $ra, 4($sp)\n");
-            fprintf(output, "    addi $sp, $sp, 8\n");
-            fprintf(output, "    jr $ra\n");
-            tempReg = 0;
+            emitText(ctx, "    # Return statement\n");
+            emitRestorePromoted(ctx);
+            if (ctx->localVarCount > 0) {
+                emitAddi(ctx, REG_SP, REG_SP, ctx->localVarCount * 4);
+            }
+            emitMove(ctx, REG_SP, REG_FP);
+            emitMem(ctx, MIPS_LW, REG_FP, 0, REG_SP);
+            emitMem(ctx, MIPS_LW, REG_RA, 4, REG_SP);
+            emitAddi(ctx, REG_SP, REG_SP, 8);
+            emitReturn(ctx);
+            ctx->tempReg = 0;
             break;
         }
             
-        case NODE_STMT_LIST:
-            genStmt(node->data.stmtlist.stmt);
-            genStmt(node->data.stmtlist.next);
-            break;
-            
         default:
             break;
     }
 }
 
 // Helper function to count local variables in function body
-int countLocalVars(ASTNode* node) {
+int countLocalVars(const AST* ast, NodeId id) {
+    ASTNode* node = astNode(ast, id);
     if (!node) return 0;
     
     int count = 0;
@@ -400,39 +1243,361 @@ int countLocalVars(ASTNode* node) {
         case NODE_ARRAY_2D_DECL:
             return node->data.array_2d_decl.rows * node->data.array_2d_decl.cols;
         case NODE_STMT_LIST:
-            count += countLocalVars(node->data.stmtlist.stmt);
-            count += countLocalVars(node->data.stmtlist.next);
+            for (int i = 0; i < node->data.list.count; i++) {
+                count += countLocalVars(ast, node->data.list.items[i]);
+            }
             return count;
         default:
             return 0;
     }
 }
 
-void generateMIPS(ASTNode* root, const char* filename) {
-    output = fopen(filename, "w");
-    if (!output) {
-        fprintf(stderr, "Cannot open output file %s\n", filename);
-        exit(1);
+/* DECLARATION CHECK
+ * The undeclared-name errors of genExpr and genStmt, for back ends that
+ * do not go through them (--jit). A use that fails is not looked into
+ * any further, as in code generation.
+ */
+static void checkNode(CompilerContext* ctx, NodeId id) {
+    const AST* ast = &ctx->ast;
+    ASTNode* node = astNode(ast, id);
+    if (!node) return;
+    const Symbol* sym;
+
+    switch (node->type) {
+        case NODE_VAR:
+            if (!node->data.var.symbol) {
+                compilerError(ctx, "Error: Variable %s not declared", astName(ast, node->data.var.name));
+            }
+            break;
+        case NODE_BINOP:
+            checkNode(ctx, node->data.binop.left);
+            checkNode(ctx, node->data.binop.right);
+            break;
+        case NODE_ASSIGN:
+            if (!node->data.assign.symbol) {
+                compilerError(ctx, "Error: Variable %s not declared", astName(ast, node->data.assign.var));
+                break;
+            }
+            checkNode(ctx, node->data.assign.value);
+            break;
+        case NODE_ARRAY_ASSIGN:
+            if (!node->data.array_assign.symbol) {
+                compilerError(ctx, "Error: Array %s not declared",
+                              astName(ast, node->data.array_assign.name));
+                break;
+            }
+            checkNode(ctx, node->data.array_assign.index);
+            checkNode(ctx, node->data.array_assign.value);
+            break;
+        case NODE_ARRAY_ACCESS:
+            if (!node->data.array_access.symbol) {
+                compilerError(ctx, "Error: Array %s not declared",
+                              astName(ast, node->data.array_access.name));
+                break;
+            }
+            checkNode(ctx, node->data.array_access.index);
+            break;
+        case NODE_ARRAY_2D_ASSIGN:
+            sym = boundSymbol(&ctx->symtab, node->data.array_2d_assign.symbol);
+            if (!sym || !sym->is2DArray) {
+                compilerError(ctx, "Error: 2D Array %s not declared",
+                              astName(ast, node->data.array_2d_assign.name));
+                break;
+            }
+            checkNode(ctx, node->data.array_2d_assign.row);
+            checkNode(ctx, node->data.array_2d_assign.col);
+            checkNode(ctx, node->data.array_2d_assign.value);
+            break;
+        case NODE_ARRAY_2D_ACCESS:
+            sym = boundSymbol(&ctx->symtab, node->data.array_2d_access.symbol);
+            if (!sym || !sym->is2DArray) {
+                compilerError(ctx, "Error: 2D Array %s not declared",
+                              astName(ast, node->data.array_2d_access.name));
+                break;
+            }
+            checkNode(ctx, node->data.array_2d_access.row);
+            checkNode(ctx, node->data.array_2d_access.col);
+            break;
+        case NODE_PRINT:
+            checkNode(ctx, node->data.expr);
+            break;
+        case NODE_RETURN:
+            checkNode(ctx, node->data.return_expr);
+            break;
+        case NODE_FUNC_CALL:
+            checkNode(ctx, node->data.func_call.args);
+            break;
+        case NODE_FUNC_DECL:
+            checkNode(ctx, node->data.func_decl.body);
+            break;
+        case NODE_FUNC_LIST:
+        case NODE_STMT_LIST:
+        case NODE_ARG_LIST:
+            for (int i = 0; i < node->data.list.count; i++) {
+                checkNode(ctx, node->data.list.items[i]);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+int checkDeclarations(CompilerContext* ctx) {
+    int errorsBefore = ctx->errorCount;
+    checkNode(ctx, ctx->root);
+    return ctx->errorCount != errorsBefore;
+}
+
+/* PARALLEL CODE GENERATION
+ * Each function is generated in a scope of its own, so only one piece
+ * of state runs from one function into the next: the temp register.
+ * Statements reset it, so a function leaves it where the program
+ * started. A task generates a range of functions into its own buffer
+ * and diagnostics on that assumption. The ranges are joined in source
+ * order, and the assumption is checked as they are: a function that
+ * started in a different state than the one before it left is
+ * generated again in place. The result is the same as generating the
+ * functions one after another.
+ */
+
+/* Where one function's output ends in its task's buffers */
+typedef struct {
+    size_t textEnd;
+    size_t diagEnd;
+    int errorCount;
+    int entryTempReg;
+    int exitTempReg;
+} FunctionOutput;
+
+/* A range of functions generated by one task */
+typedef struct {
+    const char* fileName;
+    const AST* ast;
+    const SymbolTable* symtab;
+    NodeId* funcs;
+    int count;
+    int entryTempReg;
+    int optLevel;
+    FunctionOutput* outputs;
+    TextBuffer text;
+    char* diagText;
+    size_t diagSize;
+    int failed;             // Out of memory: the range is redone in place
+} CodegenTask;
+
+static void genFunctionsTask(void* arg) {
+    CodegenTask* task = arg;
+    CompilerContext* ctx = createContext(task->fileName);
+    FILE* diag = open_memstream(&task->diagText, &task->diagSize);
+    if (!ctx || !diag) {
+        task->failed = 1;
+        if (diag) fclose(diag);
+        freeContext(ctx);
+        return;
     }
+    ctx->ast = *task->ast;      // Borrowed, and only read
+    ctx->symtab = *task->symtab;
+    ctx->diag = diag;
+    ctx->output = &task->text;
+    ctx->tempReg = task->entryTempReg;
+    ctx->optLevel = task->optLevel;
     
-    // Initialize symbol table
-    initSymTab();
+    for (int i = 0; i < task->count; i++) {
+        FunctionOutput* out = &task->outputs[i];
+        int errorsBefore = ctx->errorCount;
+        out->entryTempReg = ctx->tempReg;
+        genStmt(ctx, task->funcs[i]);
+        fflush(diag);
+        out->textEnd = task->text.size;
+        out->diagEnd = task->diagSize;
+        out->errorCount = ctx->errorCount - errorsBefore;
+        out->exitTempReg = ctx->tempReg;
+    }
+    fclose(diag);
+    if (task->text.failed) task->failed = 1;
+    astInit(&ctx->ast, &ctx->strings);
+    memset(&ctx->symtab, 0, sizeof(SymbolTable));
+    freeContext(ctx);
+}
+
+// Append one range's output to ctx's, redoing what cannot be used
+static void joinFunctions(CompilerContext* ctx, CodegenTask* task) {
+    size_t textStart = 0, diagStart = 0;
+    for (int i = 0; i < task->count; i++) {
+        FunctionOutput* out = &task->outputs[i];
+        if (!task->failed && out->entryTempReg == ctx->tempReg) {
+            textAppend(ctx->output, task->text.data + textStart, out->textEnd - textStart);
+            fwrite(task->diagText + diagStart, 1, out->diagEnd - diagStart, ctx->diag);
+            ctx->errorCount += out->errorCount;
+            ctx->tempReg = out->exitTempReg;
+        } else {
+            genStmt(ctx, task->funcs[i]);
+        }
+        if (!task->failed) {
+            textStart = out->textEnd;
+            diagStart = out->diagEnd;
+        }
+    }
+}
+
+// genStmt for the whole program, with ranges of functions on ctx->pool.
+// Returns -1 (having done nothing) if the work cannot be split.
+static int genFunctionsParallel(CompilerContext* ctx) {
+    NodeId* funcs = NULL;
+    int count = collectFunctions(&ctx->ast, ctx->root, &funcs);
+    int taskCount = count > 1 ? poolTaskCount(ctx->pool, count) : 0;
+    CodegenTask* tasks = taskCount > 0 ? calloc(taskCount, sizeof(CodegenTask)) : NULL;
+    FunctionOutput* outputs = tasks ? calloc(count, sizeof(FunctionOutput)) : NULL;
+    if (!outputs) {
+        free(tasks);
+        free(funcs);
+        return -1;
+    }
+    
+    for (int t = 0; t < taskCount; t++) {
+        int first = (int)((long)count * t / taskCount);
+        int last = (int)((long)count * (t + 1) / taskCount);
+        CodegenTask* task = &tasks[t];
+        task->fileName = ctx->fileName;
+        task->ast = &ctx->ast;
+        task->symtab = &ctx->symtab;
+        task->funcs = funcs + first;
+        task->count = last - first;
+        task->entryTempReg = ctx->tempReg;
+        task->optLevel = ctx->optLevel;
+        task->outputs = outputs + first;
+        poolSubmit(ctx->pool, genFunctionsTask, task);
+    }
+    poolWait(ctx->pool);
     
-    // MIPS program header - proper SPIM format
-    fprintf(output, ".data\n");
-    fprintf(output, "\n");
-    fprintf(output, ".text\n");
-    fprintf(output, ".globl main\n");
-    fprintf(output, "\n");
+    for (int t = 0; t < taskCount; t++) {
+        joinFunctions(ctx, &tasks[t]);
+        textFree(&tasks[t].text);
+        free(tasks[t].diagText);
+    }
+    free(outputs);
+    free(tasks);
+    free(funcs);
+    return 0;
+}
+
+// MIPS program header - proper SPIM format
+static void emitProgramHeader(CompilerContext* ctx) {
+    emitText(ctx, ".data\n");
+    emitText(ctx, "\n");
+    emitText(ctx, ".text\n");
+    emitText(ctx, ".globl main\n");
+    emitText(ctx, "\n");
+}
+
+// Add exit syscall at the end if main doesn't return properly
+static void emitProgramExit(CompilerContext* ctx) {
+    emitText(ctx, "\n# Exit program\n");
+    emitLabel(ctx, "_exit", 0);
+    emitLi(ctx, REG_V0, 10);
+    emitSyscall(ctx);
+}
+
+// Run the binding pass unless the driver already has
+static int bindNames(CompilerContext* ctx) {
+    if (ctx->symtab.root == ctx->root) return 0;
+    if (bindProgram(&ctx->symtab, &ctx->ast, ctx->root) != 0) {
+        compilerError(ctx, "Error: Out of memory");
+        return -1;
+    }
+    return 0;
+}
+
+/* Appends the assembly to out. Returns 0 on success, nonzero if memory
+ * ran out or the program had errors (reported through the context) */
+int generateMIPS(CompilerContext* ctx, TextBuffer* out) {
+    int errorsBefore = ctx->errorCount;
+    ctx->output = out;
     
-    // Generate code for all functions
-    genStmt(root);
+    if (ctx->functions) {
+        functionCacheBegin(ctx->functions, &ctx->ast, ctx->root);
+    }
+    if (bindNames(ctx) != 0 || beginProfile(ctx) != 0 || beginGuide(ctx) != 0) {
+        endProfile(ctx);
+        ctx->output = NULL;
+        return 1;
+    }
     
-    // Add exit syscall at the end if main doesn't return properly
-    fprintf(output, "\n# Exit program\n");
-    fprintf(output, "_exit:\n");
-    fprintf(output, "    li $v0, 10\n");
-    fprintf(output, "    syscall\n");
+    emitProgramHeader(ctx);
     
-    fclose(output);
-}
\ No newline at end of file
+    // Generate code for all functions. Functions are only reused from
+    // the function cache one at a time; counters are laid out in order.
+    if (ctx->guide) {
+        genGuidedFunctions(ctx, 0);
+    } else if (!ctx->pool || ctx->functions || ctx->profile || genFunctionsParallel(ctx) != 0) {
+        genStmt(ctx, ctx->root);
+    }
+    if (ctx->profile) emitProfileExit(ctx);
+    emitProgramExit(ctx);
+    if (ctx->guide) genGuidedFunctions(ctx, 1);
+    endProfile(ctx);
+    endGuide(ctx);
+    
+    ctx->output = NULL;
+    if (out->failed) {
+        compilerError(ctx, "Error: Out of memory");
+    }
+    return ctx->errorCount != errorsBefore;
+}
+
+/* STREAMING (--stream)
+ * The program is generated one function at a time, as the parser
+ * finishes each, into out; the caller may write out and empty the
+ * buffer between functions. Only plain code generation streams: the
+ * profile, the guide and the function cache need the whole program. */
+void beginMIPSStream(CompilerContext* ctx, TextBuffer* out) {
+    ctx->output = out;
+    emitProgramHeader(ctx);
+}
+
+void generateMIPSFunction(CompilerContext* ctx, NodeId func) {
+    if (bindFunction(&ctx->symtab, &ctx->ast, func) != 0) {
+        compilerError(ctx, "Error: Out of memory");
+        return;
+    }
+    genStmt(ctx, func);
+}
+
+void endMIPSStream(CompilerContext* ctx) {
+    emitProgramExit(ctx);
+    ctx->output = NULL;
+}
+
+/* Same code generation, but encoded straight to an ELF32 object or
+ * executable instead of being printed as assembly text */
+int generateMIPSBinary(CompilerContext* ctx, int bigEndian, int executable,
+                       unsigned char** image, size_t* size) {
+    int errorsBefore = ctx->errorCount;
+    ctx->binaryOutput = mipsAsmCreate();
+    ctx->binaryOutput->diag = ctx->diag;
+    ctx->binaryOutput->bigEndian = bigEndian;
+    
+    if (bindNames(ctx) == 0 && beginProfile(ctx) == 0 && beginGuide(ctx) == 0) {
+        if (ctx->guide) {
+            genGuidedFunctions(ctx, 0);
+        } else {
+            genStmt(ctx, ctx->root);
+        }
+        if (ctx->profile) emitProfileExit(ctx);
+    }
+    
+    emitLabel(ctx, "_exit", 0);
+    emitLi(ctx, REG_V0, 10);
+    emitSyscall(ctx);
+    if (ctx->guide) genGuidedFunctions(ctx, 1);
+    endProfile(ctx);
+    endGuide(ctx);
+    
+    int result = 1;
+    if (ctx->errorCount == errorsBefore) {
+        result = mipsBuildELF(ctx->binaryOutput, bigEndian, executable, image, size);
+    }
+    mipsAsmFree(ctx->binaryOutput);
+    ctx->binaryOutput = NULL;
+    return result;
+}
@@ -2,8 +2,22 @@
 #define CODEGEN_H
 
 #include "ast.h"
+#include "context.h"
 
-void generateMIPS(ASTNode* root, const char* filename);
-int countLocalVars(ASTNode* node);
+int generateMIPS(CompilerContext* ctx, TextBuffer* out);
+int generateMIPSBinary(CompilerContext* ctx, int bigEndian, int executable,
+                       unsigned char** image, size_t* size);
+int countLocalVars(const AST* ast, NodeId id);
 
-#endif
\ No newline at end of file
+/* Report every use of an undeclared name in the bound program, as code
+ * generation would, without generating code. Returns nonzero if there
+ * was any. */
+int checkDeclarations(CompilerContext* ctx);
+
+/* Streaming: the header, each function as it is parsed, then the exit
+ * code. The caller checks out->failed before emptying it. */
+void beginMIPSStream(CompilerContext* ctx, TextBuffer* out);
+void generateMIPSFunction(CompilerContext* ctx, NodeId func);
+void endMIPSStream(CompilerContext* ctx);
+
+#endif
@@ -0,0 +1,76 @@
+/* COMPILER CONTEXT
+ * Creates and destroys the per-compilation state and reports errors
+ * against it. Nothing here is shared between contexts.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "context.h"
+
+CompilerContext* createContext(const char* fileName) {
+    CompilerContext* ctx = calloc(1, sizeof(CompilerContext));
+    if (!ctx) return NULL;
+    ctx->fileName = fileName;
+    ctx->diag = stderr;
+    astInit(&ctx->ast, &ctx->strings);
+    initTAC(&ctx->tacList);
+    initTAC(&ctx->optimizedList);
+    return ctx;
+}
+
+void freeContext(CompilerContext* ctx) {
+    if (!ctx) return;
+    freeTAC(&ctx->tacList);
+    freeTAC(&ctx->optimizedList);
+    freeSymTab(&ctx->symtab);
+    astFree(&ctx->ast);
+    freeStringTable(&ctx->strings);
+    free(ctx);
+}
+
+/* Drop the results of one compilation so the context can run another.
+ * Interned names are kept: they stay valid, and the next program
+ * probably uses many of the same ones. The AST arena is emptied but
+ * keeps its memory. */
+void resetContext(CompilerContext* ctx, const char* fileName) {
+    StringTable strings = ctx->strings;
+    AST ast = ctx->ast;
+    freeTAC(&ctx->tacList);
+    freeTAC(&ctx->optimizedList);
+    freeSymTab(&ctx->symtab);
+    astClear(&ast);
+
+    memset(ctx, 0, sizeof(CompilerContext));
+    ctx->strings = strings;
+    ctx->ast = ast;
+    ctx->ast.names = &ctx->strings;
+    ctx->fileName = fileName;
+    ctx->diag = stderr;
+    initTAC(&ctx->tacList);
+    initTAC(&ctx->optimizedList);
+}
+
+/* Between functions the parsers hold no node or name, so streaming
+ * keeps only the function being compiled. Once the tree has run out of
+ * memory nothing more is compiled, and the parser reports it. */
+void parsedFunction(CompilerContext* ctx, NodeId func) {
+    if (!ctx->functionSink) {
+        appendToList(&ctx->ast, func);
+        return;
+    }
+    if (ctx->ast.failed) return;
+    ctx->functionSink(ctx, func);
+    astClear(&ctx->ast);
+    clearStringTable(&ctx->strings);
+}
+
+/* Print one error line to the context's diagnostic stream */
+void compilerError(CompilerContext* ctx, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(ctx->diag, fmt, args);
+    va_end(args);
+    fputc('\n', ctx->diag);
+    ctx->errorCount++;
+}
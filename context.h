@@ -0,0 +1,85 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include <stdio.h>
+#include "ast.h"
+#include "tac.h"
+#include "symtab.h"
+#include "mips.h"
+#include "stats.h"
+#include "intern.h"
+#include "pool.h"
+
+/* COMPILER CONTEXT
+ * All state of one compilation. Every phase takes the context instead
+ * of using globals, so separate contexts can compile concurrently.
+ */
+typedef struct CompilerContext {
+    const char* fileName;   // Source being compiled (for messages)
+    FILE* diag;             // Where errors are reported
+    int errorCount;
+    ThreadPool* pool;       // If set, functions are compiled on it in parallel
+
+    /* Front end */
+    AST ast;                // Nodes of the program being compiled
+    NodeId root;            // Its function list
+    StringTable strings;    // Interned identifiers, named by id in the AST
+    int scanner;            // --scanner: a ScannerKind (lexer.h)
+    int prattParser;        // --parser=pratt: parse with pratt.c instead of bison
+    void (*functionSink)(struct CompilerContext* ctx, NodeId func);    // --stream: see parsedFunction
+    void* sinkData;
+
+    /* Intermediate code */
+    TACList tacList;
+    TACList optimizedList;
+
+    /* Semantic analysis */
+    SymbolTable symtab;
+
+    /* Code generation */
+    TextBuffer* output;     // Text assembly being built
+    MipsAsm* binaryOutput;  // Set when encoding machine code instead of text
+    struct FunctionCache* functions;    // Earlier per-function output, if any
+    int optLevel;           // -O: 1 folds constants and constant indices
+    const char* profileGenerate;    // -fprofile-generate: file the program writes its counts to
+    struct Profile* profile;        // Counters being laid out for it
+    struct Profile* profileUse;     // -fprofile-use: counts from an instrumented run
+    struct ProfileGuide* guide;     // What code generation takes from them
+    int tempReg;
+    int inFunction;
+    int localVarCount;
+
+    /* Phase measurements */
+    Stats stats;
+} CompilerContext;
+
+CompilerContext* createContext(const char* fileName);
+void freeContext(CompilerContext* ctx);
+void resetContext(CompilerContext* ctx, const char* fileName);
+void compilerError(CompilerContext* ctx, const char* fmt, ...);
+
+/* Called by the parsers with each function they complete. It joins the
+ * function list, or, if the context has a function sink, goes to the
+ * sink and is then dropped with the rest of the AST and the names. */
+void parsedFunction(CompilerContext* ctx, NodeId func);
+
+/* Lex and parse a whole file or buffer into ctx->root (parser.y) */
+int parseFile(CompilerContext* ctx, FILE* in);
+int parseString(CompilerContext* ctx, const char* src, size_t len);
+int parseBuffer(CompilerContext* ctx, char* buffer, size_t size);
+
+/* Push parsing (parser.y): the source is fed in chunks cut anywhere,
+ * as it arrives, and parsed as far as it goes. It always runs bison
+ * with the hand-written scanner. Feed returns nonzero once the parse
+ * has failed; Finish ends the input and returns what parseBuffer
+ * would have. */
+#define PUSH_CHUNK_SIZE (64 * 1024)
+typedef struct PushParser PushParser;
+PushParser* pushParserCreate(CompilerContext* ctx);
+int pushParserFeed(PushParser* parser, const char* chunk, size_t size);
+int pushParserFinish(PushParser* parser);
+void pushParserFree(PushParser* parser);
+/* Push-parse what is read from fd (a pipe or socket) */
+int parseStream(CompilerContext* ctx, int fd);
+
+#endif
@@ -0,0 +1,563 @@
+/* INCREMENTAL CODE GENERATION
+ * The assembly of a function depends only on its own subtree, the -O
+ * level and the code generator's temp register when it starts, so that
+ * is what its digest covers. The functions it calls are recorded with their
+ * signatures; a cached function is only reused while all of them are
+ * unchanged, so an edit to a callee's parameters regenerates its
+ * callers too.
+ *
+ * The digest is the SHA-256 of a compact encoding of the subtree.
+ * Entries are kept in an open-addressing table keyed by digest. The
+ * compile server keeps one table for its lifetime; the command line
+ * saves the table of each input file between runs (--incremental).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "incremental.h"
+#include "textbuf.h"
+
+#define DIGEST_FORMAT "minicompiler-function-3"
+#define FILE_MAGIC "MCFN0001"
+
+/* ============ DIGESTS ============ */
+
+static void encodeInt(TextBuffer* out, int value) {
+    textAppend(out, (const char*)&value, sizeof(value));
+}
+
+// Names end in their NUL; 0xff (never part of an identifier) stands
+// for a missing one
+static void encodeName(TextBuffer* out, const char* name) {
+    if (name) {
+        textAppend(out, name, strlen(name) + 1);
+    } else {
+        textAppendChar(out, (char)0xff);
+    }
+}
+
+static void encodeNode(TextBuffer* out, const AST* ast, NodeId id) {
+    ASTNode* node = astNode(ast, id);
+    if (!node) {
+        textAppendChar(out, (char)0xff);
+        return;
+    }
+    textAppendChar(out, (char)node->type);
+    switch (node->type) {
+        case NODE_NUM:
+            encodeInt(out, node->data.num);
+            break;
+        case NODE_VAR:
+            encodeName(out, astName(ast, node->data.var.name));
+            break;
+        case NODE_DECL:
+            encodeName(out, astName(ast, node->data.name));
+            break;
+        case NODE_BINOP:
+            textAppendChar(out, node->data.binop.op);
+            encodeNode(out, ast, node->data.binop.left);
+            encodeNode(out, ast, node->data.binop.right);
+            break;
+        case NODE_ASSIGN:
+            encodeName(out, astName(ast, node->data.assign.var));
+            encodeNode(out, ast, node->data.assign.value);
+            break;
+        case NODE_PRINT:
+            encodeNode(out, ast, node->data.expr);
+            break;
+        case NODE_RETURN:
+            encodeNode(out, ast, node->data.return_expr);
+            break;
+        case NODE_ARRAY_DECL:
+            encodeName(out, astName(ast, node->data.array_decl.name));
+            encodeInt(out, node->data.array_decl.size);
+            break;
+        case NODE_ARRAY_ASSIGN:
+            encodeName(out, astName(ast, node->data.array_assign.name));
+            encodeNode(out, ast, node->data.array_assign.index);
+            encodeNode(out, ast, node->data.array_assign.value);
+            break;
+        case NODE_ARRAY_ACCESS:
+            encodeName(out, astName(ast, node->data.array_access.name));
+            encodeNode(out, ast, node->data.array_access.index);
+            break;
+        case NODE_ARRAY_2D_DECL:
+            encodeName(out, astName(ast, node->data.array_2d_decl.name));
+            encodeInt(out, node->data.array_2d_decl.rows);
+            encodeInt(out, node->data.array_2d_decl.cols);
+            break;
+        case NODE_ARRAY_2D_ASSIGN:
+            encodeName(out, astName(ast, node->data.array_2d_assign.name));
+            encodeNode(out, ast, node->data.array_2d_assign.row);
+            encodeNode(out, ast, node->data.array_2d_assign.col);
+            encodeNode(out, ast, node->data.array_2d_assign.value);
+            break;
+        case NODE_ARRAY_2D_ACCESS:
+            encodeName(out, astName(ast, node->data.array_2d_access.name));
+            encodeNode(out, ast, node->data.array_2d_access.row);
+            encodeNode(out, ast, node->data.array_2d_access.col);
+            break;
+        case NODE_FUNC_DECL:
+            encodeName(out, astName(ast, node->data.func_decl.returnType));
+            encodeName(out, astName(ast, node->data.func_decl.name));
+            encodeNode(out, ast, node->data.func_decl.params);
+            encodeNode(out, ast, node->data.func_decl.body);
+            break;
+        case NODE_FUNC_CALL:
+            encodeName(out, astName(ast, node->data.func_call.name));
+            encodeNode(out, ast, node->data.func_call.args);
+            break;
+        case NODE_PARAM:
+            encodeName(out, astName(ast, node->data.param.type));
+            encodeName(out, astName(ast, node->data.param.name));
+            break;
+        case NODE_STMT_LIST:
+        case NODE_PARAM_LIST:
+        case NODE_ARG_LIST:
+        case NODE_FUNC_LIST:
+            encodeInt(out, node->data.list.count);
+            for (int i = 0; i < node->data.list.count; i++) {
+                encodeNode(out, ast, node->data.list.items[i]);
+            }
+            break;
+    }
+}
+
+void functionDigest(FunctionCache* cache, const AST* ast, NodeId func, int tempReg, int optLevel,
+                    unsigned char digest[SHA256_SIZE]) {
+    // Hashing one compact encoding is much cheaper than feeding the
+    // hash field by field
+    TextBuffer* encoding = &cache->encoding;
+    textReset(encoding);
+    textAppend(encoding, DIGEST_FORMAT, sizeof(DIGEST_FORMAT));
+    encodeInt(encoding, tempReg);
+    encodeInt(encoding, optLevel);
+    encodeNode(encoding, ast, func);
+
+    Sha256 sha;
+    sha256Init(&sha);
+    sha256Update(&sha, encoding->data, encoding->size);
+    sha256Final(&sha, digest);
+}
+
+uint32_t functionBodyHash(const AST* ast, NodeId func) {
+    TextBuffer encoding = {0};
+    encodeNode(&encoding, ast, func);
+    unsigned char digest[SHA256_SIZE];
+    Sha256 sha;
+    sha256Init(&sha);
+    sha256Update(&sha, encoding.data, encoding.size);
+    sha256Final(&sha, digest);
+    textFree(&encoding);
+    return ((uint32_t)digest[0] << 24) | ((uint32_t)digest[1] << 16) | ((uint32_t)digest[2] << 8) | digest[3];
+}
+
+/* ============ SIGNATURES ============ */
+
+static void appendParamTypes(TextBuffer* text, const AST* ast, NodeId id) {
+    ASTNode* params = astNode(ast, id);
+    if (!params) return;
+    if (params->type == NODE_PARAM_LIST) {
+        for (int i = 0; i < params->data.list.count; i++) {
+            if (i > 0) textAppendChar(text, ',');
+            appendParamTypes(text, ast, params->data.list.items[i]);
+        }
+    } else if (params->type == NODE_PARAM) {
+        textAppendString(text, astName(ast, params->data.param.type));
+    }
+}
+
+static void collectSignatures(FunctionCache* cache, const AST* ast, NodeId id, int* capacity) {
+    ASTNode* node = astNode(ast, id);
+    if (!node) return;
+    if (node->type == NODE_FUNC_LIST) {
+        for (int i = 0; i < node->data.list.count; i++) {
+            collectSignatures(cache, ast, node->data.list.items[i], capacity);
+        }
+        return;
+    }
+    if (node->type != NODE_FUNC_DECL) return;
+
+    if (cache->signatureCount == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 64;
+        cache->signatures = realloc(cache->signatures, *capacity * sizeof(FunctionSignature));
+    }
+    TextBuffer* text = &cache->encoding;
+    textReset(text);
+    const char* name = astName(ast, node->data.func_decl.name);
+    textAppendf(text, "%s %s(", astName(ast, node->data.func_decl.returnType), name);
+    appendParamTypes(text, ast, node->data.func_decl.params);
+    textAppendChar(text, ')');
+    char* signature = strdup(text->failed ? "" : text->data);
+    cache->signatures[cache->signatureCount++] = (FunctionSignature){ name, signature };
+}
+
+// By name, then by signature so a duplicate definition always finds
+// the same one
+static int compareSignatures(const void* a, const void* b) {
+    const FunctionSignature* x = a;
+    const FunctionSignature* y = b;
+    int order = strcmp(x->name, y->name);
+    return order ? order : strcmp(x->signature, y->signature);
+}
+
+static const char* lookupSignature(const FunctionCache* cache, const char* name) {
+    int low = 0, high = cache->signatureCount;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (strcmp(cache->signatures[mid].name, name) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < cache->signatureCount && strcmp(cache->signatures[low].name, name) == 0) {
+        return cache->signatures[low].signature;
+    }
+    return "";
+}
+
+static void freeSignatures(FunctionCache* cache) {
+    for (int i = 0; i < cache->signatureCount; i++) free(cache->signatures[i].signature);
+    free(cache->signatures);
+    cache->signatures = NULL;
+    cache->signatureCount = 0;
+}
+
+void functionCacheBegin(FunctionCache* cache, const AST* ast, NodeId root) {
+    int capacity = 0;
+    freeSignatures(cache);
+    collectSignatures(cache, ast, root, &capacity);
+    qsort(cache->signatures, cache->signatureCount, sizeof(FunctionSignature), compareSignatures);
+    cache->build++;
+    cache->reused = 0;
+    cache->generated = 0;
+}
+
+/* ============ TABLE ============ */
+
+static void freeEntry(FunctionEntry* entry) {
+    if (!entry->borrowed) free(entry->text);
+    for (int i = 0; i < entry->depCount; i++) {
+        free(entry->deps[i].name);
+        free(entry->deps[i].signature);
+    }
+    free(entry->deps);
+    memset(entry, 0, sizeof(FunctionEntry));
+}
+
+static size_t slotOf(const unsigned char digest[SHA256_SIZE], size_t capacity) {
+    size_t hash;
+    memcpy(&hash, digest, sizeof(hash));
+    return hash & (capacity - 1);
+}
+
+static FunctionEntry* findSlot(FunctionEntry* entries, size_t capacity, const unsigned char digest[SHA256_SIZE]) {
+    size_t slot = slotOf(digest, capacity);
+    while (entries[slot].text && memcmp(entries[slot].digest, digest, SHA256_SIZE) != 0) {
+        slot = (slot + 1) & (capacity - 1);
+    }
+    return &entries[slot];
+}
+
+// Move the entries into a table of the given size, leaving out those
+// the current build did not use if dropUnused is set
+static void rebuild(FunctionCache* cache, size_t capacity, int dropUnused) {
+    FunctionEntry* entries = calloc(capacity, sizeof(FunctionEntry));
+    if (!entries) return;
+    cache->count = 0;
+    cache->bytes = 0;
+    for (size_t i = 0; i < cache->capacity; i++) {
+        FunctionEntry* entry = &cache->entries[i];
+        if (!entry->text) continue;
+        if (dropUnused && entry->lastUsed != cache->build) {
+            freeEntry(entry);
+            cache->changed = 1;
+            continue;
+        }
+        *findSlot(entries, capacity, entry->digest) = *entry;
+        cache->count++;
+        cache->bytes += entry->size;
+    }
+    free(cache->entries);
+    cache->entries = entries;
+    cache->capacity = capacity;
+}
+
+const FunctionEntry* functionCacheFind(FunctionCache* cache, const unsigned char digest[SHA256_SIZE]) {
+    if (cache->count == 0) return NULL;
+    FunctionEntry* entry = findSlot(cache->entries, cache->capacity, digest);
+    if (!entry->text) return NULL;
+    for (int i = 0; i < entry->depCount; i++) {
+        if (strcmp(lookupSignature(cache, entry->deps[i].name), entry->deps[i].signature) != 0) {
+            return NULL;
+        }
+    }
+    entry->lastUsed = cache->build;
+    return entry;
+}
+
+static void collectCalls(const AST* ast, NodeId id, FunctionEntry* entry, int* capacity) {
+    ASTNode* node = astNode(ast, id);
+    if (!node) return;
+    switch (node->type) {
+        case NODE_FUNC_CALL: {
+            const char* name = astName(ast, node->data.func_call.name);
+            int known = 0;
+            for (int i = 0; i < entry->depCount && !known; i++) {
+                known = strcmp(entry->deps[i].name, name) == 0;
+            }
+            if (!known) {
+                if (entry->depCount == *capacity) {
+                    *capacity = *capacity ? *capacity * 2 : 4;
+                    entry->deps = realloc(entry->deps, *capacity * sizeof(FunctionDep));
+                }
+                entry->deps[entry->depCount++] = (FunctionDep){ strdup(name), NULL };
+            }
+            collectCalls(ast, node->data.func_call.args, entry, capacity);
+            break;
+        }
+        case NODE_BINOP:
+            collectCalls(ast, node->data.binop.left, entry, capacity);
+            collectCalls(ast, node->data.binop.right, entry, capacity);
+            break;
+        case NODE_ASSIGN:
+            collectCalls(ast, node->data.assign.value, entry, capacity);
+            break;
+        case NODE_PRINT:
+            collectCalls(ast, node->data.expr, entry, capacity);
+            break;
+        case NODE_RETURN:
+            collectCalls(ast, node->data.return_expr, entry, capacity);
+            break;
+        case NODE_ARRAY_ASSIGN:
+            collectCalls(ast, node->data.array_assign.index, entry, capacity);
+            collectCalls(ast, node->data.array_assign.value, entry, capacity);
+            break;
+        case NODE_ARRAY_ACCESS:
+            collectCalls(ast, node->data.array_access.index, entry, capacity);
+            break;
+        case NODE_ARRAY_2D_ASSIGN:
+            collectCalls(ast, node->data.array_2d_assign.row, entry, capacity);
+            collectCalls(ast, node->data.array_2d_assign.col, entry, capacity);
+            collectCalls(ast, node->data.array_2d_assign.value, entry, capacity);
+            break;
+        case NODE_ARRAY_2D_ACCESS:
+            collectCalls(ast, node->data.array_2d_access.row, entry, capacity);
+            collectCalls(ast, node->data.array_2d_access.col, entry, capacity);
+            break;
+        case NODE_STMT_LIST:
+        case NODE_ARG_LIST:
+            for (int i = 0; i < node->data.list.count; i++) {
+                collectCalls(ast, node->data.list.items[i], entry, capacity);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void functionCacheStore(FunctionCache* cache, const unsigned char digest[SHA256_SIZE], const AST* ast,
+                        NodeId func, const char* text, size_t size, int exitTempReg) {
+    // Keep the load factor at most 1/2
+    if ((cache->count + 1) * 2 > cache->capacity) {
+        rebuild(cache, cache->capacity ? cache->capacity * 2 : 256, 0);
+        if ((cache->count + 1) * 2 > cache->capacity) return;
+    }
+
+    FunctionEntry* entry = findSlot(cache->entries, cache->capacity, digest);
+    if (entry->text) {
+        // Same code, but a callee changed since it was stored
+        cache->bytes -= entry->size;
+        cache->count--;
+        freeEntry(entry);
+    }
+    entry->text = malloc(size ? size : 1);
+    if (!entry->text) return;
+    memcpy(entry->text, text, size);
+    memcpy(entry->digest, digest, SHA256_SIZE);
+    entry->size = size;
+    entry->exitTempReg = exitTempReg;
+    entry->lastUsed = cache->build;
+
+    int capacity = 0;
+    collectCalls(ast, astNode(ast, func)->data.func_decl.body, entry, &capacity);
+    for (int i = 0; i < entry->depCount; i++) {
+        entry->deps[i].signature = strdup(lookupSignature(cache, entry->deps[i].name));
+    }
+    cache->count++;
+    cache->bytes += size;
+    cache->changed = 1;
+}
+
+void functionCacheTrim(FunctionCache* cache, size_t maxBytes) {
+    if (cache->bytes > maxBytes || maxBytes == 0) {
+        rebuild(cache, cache->capacity ? cache->capacity : 256, 1);
+    }
+}
+
+void functionCacheFree(FunctionCache* cache) {
+    for (size_t i = 0; i < cache->capacity; i++) {
+        if (cache->entries[i].text) freeEntry(&cache->entries[i]);
+    }
+    free(cache->entries);
+    freeSignatures(cache);
+    textFree(&cache->encoding);
+    if (cache->loaded) munmap(cache->loaded, cache->loadedSize);
+    memset(cache, 0, sizeof(FunctionCache));
+}
+
+/* ============ FILES ============
+ * magic, entry count, then per entry: digest, exit temp register, text
+ * size and text, dependency count and each name and signature. Sizes
+ * are uint64_t in host byte order; the file is only a cache. */
+
+typedef struct {
+    char* data;
+    size_t size;
+    size_t offset;
+} Reader;
+
+static int take(Reader* reader, void* out, size_t size) {
+    if (reader->size - reader->offset < size) return -1;
+    memcpy(out, reader->data + reader->offset, size);
+    reader->offset += size;
+    return 0;
+}
+
+static char* takeString(Reader* reader, size_t* size) {
+    uint64_t length;
+    if (take(reader, &length, sizeof(length)) != 0 || reader->size - reader->offset < length) return NULL;
+    char* text = malloc(length + 1);
+    if (!text) return NULL;
+    memcpy(text, reader->data + reader->offset, length);
+    text[length] = '\0';
+    reader->offset += length;
+    if (size) *size = length;
+    return text;
+}
+
+static int readEntry(Reader* reader, FunctionEntry* entry) {
+    int64_t exitTempReg;
+    uint64_t depCount;
+    if (take(reader, entry->digest, SHA256_SIZE) != 0 || take(reader, &exitTempReg, sizeof(exitTempReg)) != 0) {
+        return -1;
+    }
+    entry->exitTempReg = (int)exitTempReg;
+    uint64_t size;
+    if (take(reader, &size, sizeof(size)) != 0 || reader->size - reader->offset < size || size == 0) {
+        return -1;
+    }
+    entry->text = reader->data + reader->offset;
+    entry->size = size;
+    entry->borrowed = 1;
+    reader->offset += size;
+    if (take(reader, &depCount, sizeof(depCount)) != 0 || depCount > reader->size) return -1;
+
+    entry->deps = calloc(depCount ? depCount : 1, sizeof(FunctionDep));
+    if (!entry->deps) return -1;
+    for (uint64_t i = 0; i < depCount; i++) {
+        FunctionDep* dep = &entry->deps[entry->depCount++];
+        dep->name = takeString(reader, NULL);
+        dep->signature = dep->name ? takeString(reader, NULL) : NULL;
+        if (!dep->signature) return -1;
+    }
+    return 0;
+}
+
+int functionCacheLoad(FunctionCache* cache, const char* path) {
+    // Mapped rather than read: reused text is copied once, straight
+    // from the page cache into the output
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat info;
+    char* data = NULL;
+    size_t size = 0;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        size = info.st_size;
+        data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) data = NULL;
+    }
+    close(fd);
+
+    Reader reader = { data, size, 0 };
+    char magic[8];
+    uint64_t count;
+    int valid = data && take(&reader, magic, sizeof(magic)) == 0 && memcmp(magic, FILE_MAGIC, 8) == 0 &&
+                take(&reader, &count, sizeof(count)) == 0;
+    for (uint64_t i = 0; valid && i < count; i++) {
+        FunctionEntry entry = {0};
+        valid = readEntry(&reader, &entry) == 0;
+        if (!valid) {
+            freeEntry(&entry);
+            break;
+        }
+        if ((cache->count + 1) * 2 > cache->capacity) {
+            rebuild(cache, cache->capacity ? cache->capacity * 2 : 256, 0);
+        }
+        FunctionEntry* slot = findSlot(cache->entries, cache->capacity, entry.digest);
+        if (slot->text) {
+            freeEntry(&entry);
+            continue;
+        }
+        *slot = entry;
+        cache->count++;
+        cache->bytes += entry.size;
+    }
+    cache->loaded = data;
+    cache->loadedSize = size;
+    if (!valid) {
+        functionCacheFree(cache);
+        return -1;
+    }
+    return 0;
+}
+
+static void appendNumber(TextBuffer* out, uint64_t value) {
+    textAppend(out, (const char*)&value, sizeof(value));
+}
+
+static void appendString(TextBuffer* out, const char* text, size_t size) {
+    appendNumber(out, size);
+    textAppend(out, text, size);
+}
+
+int functionCacheSave(const FunctionCache* cache, const char* path) {
+    TextBuffer out = {0};
+    textAppend(&out, FILE_MAGIC, 8);
+    appendNumber(&out, cache->count);
+    for (size_t i = 0; i < cache->capacity; i++) {
+        const FunctionEntry* entry = &cache->entries[i];
+        if (!entry->text) continue;
+        textAppend(&out, (const char*)entry->digest, SHA256_SIZE);
+        appendNumber(&out, (uint64_t)(int64_t)entry->exitTempReg);
+        appendString(&out, entry->text, entry->size);
+        appendNumber(&out, entry->depCount);
+        for (int j = 0; j < entry->depCount; j++) {
+            appendString(&out, entry->deps[j].name, strlen(entry->deps[j].name));
+            appendString(&out, entry->deps[j].signature, strlen(entry->deps[j].signature));
+        }
+    }
+
+    // Written aside and renamed, so a concurrent load sees the old or new file
+    TextBuffer temp = {0};
+    textAppendf(&temp, "%s.tmp.%ld", path, (long)getpid());
+    int fd = out.failed || temp.failed ? -1 : open(temp.data, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    int result = -1;
+    if (fd >= 0) {
+        int failed = writeAll(fd, out.data, out.size) != 0;
+        if (close(fd) != 0) failed = 1;
+        if (!failed && rename(temp.data, path) == 0) {
+            result = 0;
+        } else {
+            unlink(temp.data);
+        }
+    }
+    textFree(&out);
+    textFree(&temp);
+    return result;
+}
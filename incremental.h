@@ -0,0 +1,85 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ast.h"
+#include "sha256.h"
+#include "textbuf.h"
+
+/* A function the cached code calls, with the signature it had */
+typedef struct {
+    char* name;
+    char* signature;        // "" if the function was not defined
+} FunctionDep;
+
+/* Generated assembly of one function. It can be spliced in again while
+ * the function's subtree hashes the same and every callee still has
+ * the recorded signature. */
+typedef struct {
+    unsigned char digest[SHA256_SIZE];  // Subtree, -O level and code generator state on entry
+    char* text;             // size bytes, not NUL-terminated
+    size_t size;
+    int borrowed;           // text points into the mapped file
+    int exitTempReg;        // Code generator state after the function
+    FunctionDep* deps;
+    int depCount;
+    unsigned long lastUsed; // Build that last generated or reused it
+} FunctionEntry;
+
+/* Signature of a function of the program being compiled */
+typedef struct {
+    const char* name;
+    char* signature;
+} FunctionSignature;
+
+/* Per-function output of earlier builds, found by digest. A zeroed
+ * cache is empty and ready to use. */
+typedef struct FunctionCache {
+    FunctionEntry* entries; // Open addressing; text == NULL means free
+    size_t capacity;
+    size_t count;
+    size_t bytes;           // Text held by all entries
+    unsigned long build;
+    char* loaded;           // File mapped by functionCacheLoad
+    size_t loadedSize;
+
+    /* The current build */
+    FunctionSignature* signatures;
+    int signatureCount;
+    int reused;
+    int generated;
+    int changed;            // Entries added or dropped since the load
+    TextBuffer encoding;    // Scratch space for functionDigest
+} FunctionCache;
+
+/* Start a build of the program under root */
+void functionCacheBegin(FunctionCache* cache, const AST* ast, NodeId root);
+
+/* Digest of a NODE_FUNC_DECL subtree entered with the given temp register
+ * and generated at the given -O level */
+void functionDigest(FunctionCache* cache, const AST* ast, NodeId func, int tempReg, int optLevel,
+                    unsigned char digest[SHA256_SIZE]);
+
+/* 32 bits of the hash of func's subtree alone: profiles keep it to tell
+ * whether a function changed since it was measured */
+uint32_t functionBodyHash(const AST* ast, NodeId func);
+
+/* Entry for digest if it is still valid for this build, else NULL */
+const FunctionEntry* functionCacheFind(FunctionCache* cache, const unsigned char digest[SHA256_SIZE]);
+
+/* Remember text generated for func */
+void functionCacheStore(FunctionCache* cache, const unsigned char digest[SHA256_SIZE], const AST* ast,
+                        NodeId func, const char* text, size_t size, int exitTempReg);
+
+/* Once bytes exceeds maxBytes, drop entries the current build did not use */
+void functionCacheTrim(FunctionCache* cache, size_t maxBytes);
+
+/* Persist between runs. Load fills an empty cache; it returns -1 (and
+ * leaves the cache empty) if the file is missing or unreadable. */
+int functionCacheLoad(FunctionCache* cache, const char* path);
+int functionCacheSave(const FunctionCache* cache, const char* path);
+
+void functionCacheFree(FunctionCache* cache);
+
+#endif
@@ -0,0 +1,115 @@
+/* STRING INTERNING
+ * Identifiers are copied once per distinct name instead of once per
+ * token. The scanner interns straight from its buffer, so a name that
+ * appears a thousand times costs one copy and a hash lookup each time.
+ * Each distinct string is numbered too; the AST keeps those 32-bit ids
+ * instead of pointers.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "intern.h"
+
+#define BLOCK_SIZE 4096
+
+// FNV-1a
+static unsigned hashString(const char* text, size_t length) {
+    unsigned hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)text[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static char* storeString(StringTable* table, const char* text, size_t length) {
+    StringBlock* block = table->blocks;
+    if (!block || block->size - block->used < length + 1) {
+        size_t size = length + 1 > BLOCK_SIZE ? length + 1 : BLOCK_SIZE;
+        block = malloc(sizeof(StringBlock) + size);
+        if (!block) return NULL;
+        block->used = 0;
+        block->size = size;
+        block->next = table->blocks;
+        table->blocks = block;
+    }
+    char* copy = block->data + block->used;
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    block->used += length + 1;
+    return copy;
+}
+
+static int growTable(StringTable* table) {
+    size_t capacity = table->capacity ? table->capacity * 2 : 256;
+    InternEntry* entries = calloc(capacity, sizeof(InternEntry));
+    if (!entries) return -1;
+    for (size_t i = 0; i < table->capacity; i++) {
+        InternEntry* entry = &table->entries[i];
+        if (!entry->text) continue;
+        size_t slot = entry->hash & (capacity - 1);
+        while (entries[slot].text) slot = (slot + 1) & (capacity - 1);
+        entries[slot] = *entry;
+    }
+    free(table->entries);
+    table->entries = entries;
+    table->capacity = capacity;
+    return 0;
+}
+
+unsigned internName(StringTable* table, const char* text, size_t length) {
+    // Keep the load factor under 3/4
+    if ((table->count + 1) * 4 > table->capacity * 3 && growTable(table) != 0) {
+        return 0;
+    }
+    if (table->count + 1 >= table->textCapacity) {
+        size_t capacity = table->textCapacity ? table->textCapacity * 2 : 256;
+        char** texts = realloc(table->texts, capacity * sizeof(char*));
+        if (!texts) return 0;
+        table->texts = texts;
+        table->textCapacity = capacity;
+    }
+
+    unsigned hash = hashString(text, length);
+    size_t slot = hash & (table->capacity - 1);
+    while (table->entries[slot].text) {
+        InternEntry* entry = &table->entries[slot];
+        if (entry->hash == hash && entry->length == length && memcmp(entry->text, text, length) == 0) {
+            return entry->id;
+        }
+        slot = (slot + 1) & (table->capacity - 1);
+    }
+
+    char* copy = storeString(table, text, length);
+    if (!copy) return 0;
+    unsigned id = ++table->count;
+    table->entries[slot] = (InternEntry){ copy, length, hash, id };
+    table->texts[id] = copy;
+    return id;
+}
+
+void freeStringTable(StringTable* table) {
+    StringBlock* block = table->blocks;
+    while (block) {
+        StringBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    free(table->entries);
+    free(table->texts);
+    memset(table, 0, sizeof(StringTable));
+}
+
+void clearStringTable(StringTable* table) {
+    StringBlock* keep = table->blocks;
+    if (keep) {
+        StringBlock* block = keep->next;
+        while (block) {
+            StringBlock* next = block->next;
+            free(block);
+            block = next;
+        }
+        keep->next = NULL;
+        keep->used = 0;
+    }
+    if (table->entries) memset(table->entries, 0, table->capacity * sizeof(InternEntry));
+    table->count = 0;
+}
@@ -0,0 +1,48 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+
+/* Storage for interned strings, carved out of large blocks */
+typedef struct StringBlock {
+    struct StringBlock* next;
+    size_t used;
+    size_t size;
+    char data[];
+} StringBlock;
+
+/* One slot of the hash table */
+typedef struct {
+    char* text;             // NULL when the slot is free
+    size_t length;
+    unsigned hash;
+    unsigned id;
+} InternEntry;
+
+/* Set of distinct strings. A zeroed table is empty and ready to use.
+ * Strings are numbered from 1 in the order they were added. */
+typedef struct {
+    InternEntry* entries;
+    size_t capacity;        // Always zero or a power of two
+    size_t count;
+    StringBlock* blocks;
+    char** texts;           // By id; texts[0] is unused
+    size_t textCapacity;
+} StringTable;
+
+/* Return the id of text[0..length), adding it if needed (0 if memory
+ * ran out). Equal strings always get the same id, and nameText gives
+ * the table's copy, valid until the table is freed or cleared. text
+ * does not have to be NUL-terminated. */
+unsigned internName(StringTable* table, const char* text, size_t length);
+
+static inline const char* nameText(const StringTable* table, unsigned id) {
+    return id ? table->texts[id] : NULL;
+}
+void freeStringTable(StringTable* table);
+
+/* Forget every string but keep the slot array and one block, so a
+ * long-lived table can start over without going back to malloc */
+void clearStringTable(StringTable* table);
+
+#endif
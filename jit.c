@@ -0,0 +1,578 @@
+/* JIT COMPILER - x86-64 BACKEND
+ * Lowers optimized TAC straight to x86-64 machine code in executable
+ * memory, so a program can run in-process without writing a .s file.
+ * Every declared name (parameter, variable, array) and temporary gets
+ * a slot in the function's stack frame and values are 32-bit, just
+ * like on MIPS.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "jit.h"
+#include "intern.h"
+
+#define MAX_JIT_ARGS 6
+
+/* x86-64 register numbers */
+#define REG_EAX 0
+#define REG_ECX 1
+#define REG_EDX 2
+#define REG_ESI 6
+#define REG_EDI 7
+#define REG_R8D 8
+#define REG_R9D 9
+
+/* System V argument registers, in order */
+static const int argRegs[MAX_JIT_ARGS] = { REG_EDI, REG_ESI, REG_EDX, REG_ECX, REG_R8D, REG_R9D };
+
+/* Growable machine code buffer */
+typedef struct {
+    unsigned char* bytes;
+    size_t size;
+    size_t capacity;
+} CodeBuffer;
+
+/* Stack slot for one TAC name */
+typedef struct {
+    char* name;     // NULL if the name has no slot
+    int offset;     // Offset from %rbp (negative)
+    int cols;       // Column count for 2D arrays
+} Slot;
+
+/* Frame layout of the function being compiled. Slots are kept by the
+ * id of their name in 'names', so finding one is a hash lookup. */
+typedef struct {
+    StringTable names;
+    Slot* slots;    // By name id
+    size_t capacity;
+    int size;
+} Frame;
+
+/* Call site waiting for its callee's address */
+typedef struct {
+    size_t at;
+    char* callee;
+} CallFixup;
+
+/* Function placement before the code is mapped */
+typedef struct {
+    char* name;
+    size_t start;
+    size_t size;
+} FuncInfo;
+
+typedef struct {
+    CodeBuffer code;
+    Frame frame;
+    CallFixup* fixups;
+    int fixupCount;
+    int fixupCapacity;
+    FuncInfo* funcs;
+    int funcCount;
+    int funcCapacity;
+    int failed;
+} JITState;
+
+/* Runtime helper for PRINT - matches the MIPS print int + newline syscalls */
+static void jitPrint(int value) {
+    printf("%d\n", value);
+}
+
+static void emitByte(CodeBuffer* buf, unsigned char b) {
+    if (buf->size == buf->capacity) {
+        buf->capacity = buf->capacity ? buf->capacity * 2 : 4096;
+        buf->bytes = realloc(buf->bytes, buf->capacity);
+    }
+    buf->bytes[buf->size++] = b;
+}
+
+static void emit32(CodeBuffer* buf, int32_t value) {
+    uint32_t v = (uint32_t)value;
+    for (int i = 0; i < 4; i++) {
+        emitByte(buf, (v >> (i * 8)) & 0xFF);
+    }
+}
+
+static void emit64(CodeBuffer* buf, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        emitByte(buf, (value >> (i * 8)) & 0xFF);
+    }
+}
+
+static void patch32(CodeBuffer* buf, size_t at, int32_t value) {
+    uint32_t v = (uint32_t)value;
+    for (int i = 0; i < 4; i++) {
+        buf->bytes[at + i] = (v >> (i * 8)) & 0xFF;
+    }
+}
+
+// The entry for name's slot, used or not (NULL if memory ran out)
+static Slot* slotEntry(Frame* frame, const char* name) {
+    unsigned id = internName(&frame->names, name, strlen(name));
+    if (!id) return NULL;
+    if (id >= frame->capacity) {
+        size_t capacity = frame->capacity ? frame->capacity : 64;
+        while (capacity <= id) capacity *= 2;
+        Slot* slots = realloc(frame->slots, capacity * sizeof(Slot));
+        if (!slots) return NULL;
+        memset(slots + frame->capacity, 0, (capacity - frame->capacity) * sizeof(Slot));
+        frame->slots = slots;
+        frame->capacity = capacity;
+    }
+    return &frame->slots[id];
+}
+
+static Slot* findSlot(Frame* frame, const char* name) {
+    Slot* slot = slotEntry(frame, name);
+    return slot && slot->name ? slot : NULL;
+}
+
+static void addSlot(Frame* frame, const char* name, int bytes, int cols) {
+    if (!name || isConstant((char*)name)) return;
+    Slot* slot = slotEntry(frame, name);
+    if (!slot || slot->name) return;
+
+    frame->size += bytes;
+    slot->name = (char*)name;
+    slot->offset = -frame->size;
+    slot->cols = cols;
+}
+
+/* Lay out the frame for the function starting after FUNC_BEGIN */
+static void layoutFrame(Frame* frame, TACInstr* instr) {
+    for (size_t id = 1; id <= frame->names.count && id < frame->capacity; id++) {
+        frame->slots[id].name = NULL;
+    }
+    clearStringTable(&frame->names);
+    frame->size = 0;
+
+    for (; instr && instr->op != TAC_FUNC_END; instr = instr->next) {
+        switch (instr->op) {
+            case TAC_DECL_ARRAY:
+                addSlot(frame, instr->result, atoi(instr->arg1) * 4, 0);
+                break;
+            case TAC_DECL_ARRAY_2D: {
+                int rows = atoi(instr->arg1);
+                int cols = atoi(instr->arg2);
+                addSlot(frame, instr->result, rows * cols * 4, cols);
+                break;
+            }
+            case TAC_PARAM_DECL:
+            case TAC_DECL:
+                addSlot(frame, instr->result, 4, 0);
+                break;
+            case TAC_ASSIGN:
+            case TAC_ADD:
+            case TAC_SUB:
+            case TAC_MUL:
+            case TAC_LOAD:
+            case TAC_LOAD_2D:
+            case TAC_CALL:
+                // Temporaries are declared by being set; any other name
+                // needs a declaration, and requireSlot reports it
+                if (isTemp(instr->result)) addSlot(frame, instr->result, 4, 0);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Keep %rsp 16-byte aligned so calls into libc are safe
+    frame->size = (frame->size + 15) & ~15;
+}
+
+static Slot* requireSlot(JITState* jit, const char* name) {
+    Slot* slot = findSlot(&jit->frame, name);
+    if (!slot) {
+        fprintf(stderr, "JIT Error: Variable %s not declared\n", name);
+        jit->failed = 1;
+    }
+    return slot;
+}
+
+/* ModRM + disp32 for [%rbp + offset] */
+static void emitFrameOperand(CodeBuffer* buf, int reg, int offset) {
+    emitByte(buf, 0x80 | ((reg & 7) << 3) | 5);
+    emit32(buf, offset);
+}
+
+/* ModRM + SIB + disp32 for [%rbp + %rcx*4 + offset] */
+static void emitIndexedOperand(CodeBuffer* buf, int reg, int offset) {
+    emitByte(buf, 0x80 | ((reg & 7) << 3) | 4);
+    emitByte(buf, 0x8D);
+    emit32(buf, offset);
+}
+
+/* reg = constant or frame slot */
+static void loadOperand(JITState* jit, int reg, const char* operand) {
+    CodeBuffer* buf = &jit->code;
+
+    if (isConstant((char*)operand)) {
+        if (reg >= 8) emitByte(buf, 0x41);
+        emitByte(buf, 0xB8 + (reg & 7));
+        emit32(buf, atoi(operand));
+        return;
+    }
+
+    Slot* slot = requireSlot(jit, operand);
+    if (!slot) return;
+    if (reg >= 8) emitByte(buf, 0x44);
+    emitByte(buf, 0x8B);
+    emitFrameOperand(buf, reg, slot->offset);
+}
+
+/* frame slot = reg */
+static void storeOperand(JITState* jit, int reg, const char* name) {
+    Slot* slot = requireSlot(jit, name);
+    if (!slot) return;
+    if (reg >= 8) emitByte(&jit->code, 0x44);
+    emitByte(&jit->code, 0x89);
+    emitFrameOperand(&jit->code, reg, slot->offset);
+}
+
+/* %rcx = sign-extended element index of arr[index] */
+static void emitIndex(JITState* jit, const char* index) {
+    loadOperand(jit, REG_ECX, index);
+    emitByte(&jit->code, 0x48);     // movsxd %ecx, %rcx
+    emitByte(&jit->code, 0x63);
+    emitByte(&jit->code, 0xC9);
+}
+
+/* %rcx = sign-extended element index of arr[row][col] */
+static void emitIndex2D(JITState* jit, Slot* array, const char* row, const char* col) {
+    CodeBuffer* buf = &jit->code;
+    loadOperand(jit, REG_ECX, row);
+    emitByte(buf, 0x69);            // imul $cols, %ecx, %ecx
+    emitByte(buf, 0xC9);
+    emit32(buf, array->cols);
+    loadOperand(jit, REG_EDX, col);
+    emitByte(buf, 0x01);            // add %edx, %ecx
+    emitByte(buf, 0xD1);
+    emitByte(buf, 0x48);            // movsxd %ecx, %rcx
+    emitByte(buf, 0x63);
+    emitByte(buf, 0xC9);
+}
+
+static void emitReturn(CodeBuffer* buf) {
+    emitByte(buf, 0xC9);            // leave
+    emitByte(buf, 0xC3);            // ret
+}
+
+static void beginFunction(JITState* jit, TACInstr* begin) {
+    CodeBuffer* buf = &jit->code;
+
+    if (jit->funcCount == jit->funcCapacity) {
+        jit->funcCapacity = jit->funcCapacity ? jit->funcCapacity * 2 : 16;
+        jit->funcs = realloc(jit->funcs, jit->funcCapacity * sizeof(FuncInfo));
+    }
+    FuncInfo* func = &jit->funcs[jit->funcCount++];
+    func->name = begin->result;
+    func->start = buf->size;
+    func->size = 0;
+
+    layoutFrame(&jit->frame, begin->next);
+
+    // Prologue
+    emitByte(buf, 0x55);            // push %rbp
+    emitByte(buf, 0x48);            // mov %rsp, %rbp
+    emitByte(buf, 0x89);
+    emitByte(buf, 0xE5);
+    if (jit->frame.size > 0) {
+        emitByte(buf, 0x48);        // sub $size, %rsp
+        emitByte(buf, 0x81);
+        emitByte(buf, 0xEC);
+        emit32(buf, jit->frame.size);
+    }
+}
+
+static void endFunction(JITState* jit) {
+    // Falling off the end returns 0
+    emitByte(&jit->code, 0x31);     // xor %eax, %eax
+    emitByte(&jit->code, 0xC0);
+    emitReturn(&jit->code);
+
+    FuncInfo* func = &jit->funcs[jit->funcCount - 1];
+    func->size = jit->code.size - func->start;
+}
+
+static void addFixup(JITState* jit, const char* callee) {
+    if (jit->fixupCount == jit->fixupCapacity) {
+        jit->fixupCapacity = jit->fixupCapacity ? jit->fixupCapacity * 2 : 16;
+        jit->fixups = realloc(jit->fixups, jit->fixupCapacity * sizeof(CallFixup));
+    }
+    jit->fixups[jit->fixupCount].at = jit->code.size;
+    jit->fixups[jit->fixupCount].callee = (char*)callee;
+    jit->fixupCount++;
+}
+
+static void genInstr(JITState* jit, TACInstr* instr, char** pending, int* pendingCount, int* paramIndex) {
+    CodeBuffer* buf = &jit->code;
+
+    switch (instr->op) {
+        case TAC_FUNC_BEGIN:
+            beginFunction(jit, instr);
+            *paramIndex = 0;
+            *pendingCount = 0;
+            break;
+
+        case TAC_FUNC_END:
+            endFunction(jit);
+            break;
+
+        case TAC_PARAM_DECL: {
+            if (*paramIndex >= MAX_JIT_ARGS) {
+                fprintf(stderr, "JIT Error: More than %d parameters\n", MAX_JIT_ARGS);
+                jit->failed = 1;
+                break;
+            }
+            storeOperand(jit, argRegs[(*paramIndex)++], instr->result);
+            break;
+        }
+
+        case TAC_ASSIGN:
+            loadOperand(jit, REG_EAX, instr->arg1);
+            storeOperand(jit, REG_EAX, instr->result);
+            break;
+
+        case TAC_ADD:
+        case TAC_SUB:
+        case TAC_MUL:
+            loadOperand(jit, REG_EAX, instr->arg1);
+            loadOperand(jit, REG_ECX, instr->arg2);
+            if (instr->op == TAC_ADD) {
+                emitByte(buf, 0x01);    // add %ecx, %eax
+                emitByte(buf, 0xC8);
+            } else if (instr->op == TAC_SUB) {
+                emitByte(buf, 0x29);    // sub %ecx, %eax
+                emitByte(buf, 0xC8);
+            } else {
+                emitByte(buf, 0x0F);    // imul %ecx, %eax
+                emitByte(buf, 0xAF);
+                emitByte(buf, 0xC1);
+            }
+            storeOperand(jit, REG_EAX, instr->result);
+            break;
+
+        case TAC_PRINT:
+            loadOperand(jit, REG_EDI, instr->arg1);
+            emitByte(buf, 0x48);        // movabs $jitPrint, %rax
+            emitByte(buf, 0xB8);
+            emit64(buf, (uint64_t)(uintptr_t)jitPrint);
+            emitByte(buf, 0xFF);        // call *%rax
+            emitByte(buf, 0xD0);
+            break;
+
+        case TAC_LOAD: {
+            Slot* array = requireSlot(jit, instr->arg1);
+            if (!array) break;
+            emitIndex(jit, instr->arg2);
+            emitByte(buf, 0x8B);        // mov base(%rbp,%rcx,4), %eax
+            emitIndexedOperand(buf, REG_EAX, array->offset);
+            storeOperand(jit, REG_EAX, instr->result);
+            break;
+        }
+
+        case TAC_STORE: {
+            Slot* array = requireSlot(jit, instr->result);
+            if (!array) break;
+            emitIndex(jit, instr->arg1);
+            loadOperand(jit, REG_EAX, instr->arg2);
+            emitByte(buf, 0x89);        // mov %eax, base(%rbp,%rcx,4)
+            emitIndexedOperand(buf, REG_EAX, array->offset);
+            break;
+        }
+
+        case TAC_LOAD_2D: {
+            Slot* array = requireSlot(jit, instr->arg1);
+            if (!array) break;
+            emitIndex2D(jit, array, instr->arg2, instr->arg3);
+            emitByte(buf, 0x8B);
+            emitIndexedOperand(buf, REG_EAX, array->offset);
+            storeOperand(jit, REG_EAX, instr->result);
+            break;
+        }
+
+        case TAC_STORE_2D: {
+            Slot* array = requireSlot(jit, instr->result);
+            if (!array) break;
+            emitIndex2D(jit, array, instr->arg1, instr->arg2);
+            loadOperand(jit, REG_EAX, instr->arg3);
+            emitByte(buf, 0x89);
+            emitIndexedOperand(buf, REG_EAX, array->offset);
+            break;
+        }
+
+        case TAC_PARAM:
+            if (*pendingCount >= MAX_JIT_ARGS) {
+                fprintf(stderr, "JIT Error: More than %d arguments\n", MAX_JIT_ARGS);
+                jit->failed = 1;
+                break;
+            }
+            pending[(*pendingCount)++] = instr->arg1;
+            break;
+
+        case TAC_CALL:
+            for (int i = 0; i < *pendingCount; i++) {
+                loadOperand(jit, argRegs[i], pending[i]);
+            }
+            *pendingCount = 0;
+            emitByte(buf, 0xE8);        // call rel32 (patched once all functions are placed)
+            addFixup(jit, instr->arg1);
+            emit32(buf, 0);
+            storeOperand(jit, REG_EAX, instr->result);
+            break;
+
+        case TAC_RETURN:
+            if (instr->arg1) {
+                loadOperand(jit, REG_EAX, instr->arg1);
+            } else {
+                emitByte(buf, 0x31);    // xor %eax, %eax
+                emitByte(buf, 0xC0);
+            }
+            emitReturn(buf);
+            break;
+
+        default:
+            // LABEL and declarations generate no code
+            break;
+    }
+}
+
+/* Patch every call site with the distance to its callee */
+static void resolveCalls(JITState* jit) {
+    for (int i = 0; i < jit->fixupCount; i++) {
+        CallFixup* fixup = &jit->fixups[i];
+        FuncInfo* target = NULL;
+
+        for (int j = 0; j < jit->funcCount; j++) {
+            if (strcmp(jit->funcs[j].name, fixup->callee) == 0) {
+                target = &jit->funcs[j];
+                break;
+            }
+        }
+        if (!target) {
+            fprintf(stderr, "JIT Error: Function %s not defined\n", fixup->callee);
+            jit->failed = 1;
+            continue;
+        }
+        patch32(&jit->code, fixup->at, (int32_t)(target->start - (fixup->at + 4)));
+    }
+}
+
+static void freeState(JITState* jit) {
+    free(jit->code.bytes);
+    free(jit->frame.slots);
+    freeStringTable(&jit->frame.names);
+    free(jit->fixups);
+    free(jit->funcs);
+}
+
+JITModule* jitCompile(TACInstr* code) {
+#if !defined(__x86_64__)
+    (void)code;
+    fprintf(stderr, "JIT Error: JIT mode requires an x86-64 host\n");
+    return NULL;
+#else
+    JITState jit;
+    memset(&jit, 0, sizeof(jit));
+
+    char* pending[MAX_JIT_ARGS];
+    int pendingCount = 0;
+    int paramIndex = 0;
+
+    for (TACInstr* instr = code; instr; instr = instr->next) {
+        genInstr(&jit, instr, pending, &pendingCount, &paramIndex);
+    }
+    resolveCalls(&jit);
+
+    if (jit.failed || jit.code.size == 0) {
+        freeState(&jit);
+        return NULL;
+    }
+
+    // Copy into fresh pages, then flip them from writable to executable
+    long pageSize = sysconf(_SC_PAGESIZE);
+    size_t mappedSize = (jit.code.size + pageSize - 1) & ~(size_t)(pageSize - 1);
+    unsigned char* mem = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        perror("JIT Error: mmap");
+        freeState(&jit);
+        return NULL;
+    }
+    memcpy(mem, jit.code.bytes, jit.code.size);
+    if (mprotect(mem, mappedSize, PROT_READ | PROT_EXEC) != 0) {
+        perror("JIT Error: mprotect");
+        munmap(mem, mappedSize);
+        freeState(&jit);
+        return NULL;
+    }
+
+    JITModule* module = malloc(sizeof(JITModule));
+    module->code = mem;
+    module->mappedSize = mappedSize;
+    module->funcCount = jit.funcCount;
+    module->funcs = malloc(jit.funcCount * sizeof(JITFunction));
+    for (int i = 0; i < jit.funcCount; i++) {
+        module->funcs[i].name = strdup(jit.funcs[i].name);
+        module->funcs[i].start = mem + jit.funcs[i].start;
+        module->funcs[i].size = jit.funcs[i].size;
+    }
+
+    freeState(&jit);
+    return module;
+#endif
+}
+
+void* jitLookup(JITModule* module, const char* name) {
+    for (int i = 0; i < module->funcCount; i++) {
+        if (strcmp(module->funcs[i].name, name) == 0) {
+            return module->funcs[i].start;
+        }
+    }
+    return NULL;
+}
+
+/* Call the JIT'd main and return its result */
+int jitRun(JITModule* module) {
+    void* entry = jitLookup(module, "main");
+    if (!entry) {
+        fprintf(stderr, "JIT Error: No main function\n");
+        return 1;
+    }
+
+    int (*mainFunc)(void);
+    memcpy(&mainFunc, &entry, sizeof(mainFunc));
+    int result = mainFunc();
+    fflush(stdout);
+    return result;
+}
+
+/* Write /tmp/perf-<pid>.map so perf can symbolize JIT'd code */
+void jitWritePerfMap(JITModule* module) {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/perf-%d.map", (int)getpid());
+
+    FILE* map = fopen(path, "a");
+    if (!map) return;
+    for (int i = 0; i < module->funcCount; i++) {
+        fprintf(map, "%lx %lx %s\n",
+                (unsigned long)(uintptr_t)module->funcs[i].start,
+                (unsigned long)module->funcs[i].size,
+                module->funcs[i].name);
+    }
+    fclose(map);
+}
+
+void jitFree(JITModule* module) {
+    if (!module) return;
+    munmap(module->code, module->mappedSize);
+    for (int i = 0; i < module->funcCount; i++) {
+        free(module->funcs[i].name);
+    }
+    free(module->funcs);
+    free(module);
+}
@@ -0,0 +1,29 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <stddef.h>
+#include "tac.h"
+
+/* A function placed in JIT memory */
+typedef struct {
+    char* name;
+    unsigned char* start;
+    size_t size;
+} JITFunction;
+
+/* Executable image produced from one TAC list */
+typedef struct {
+    unsigned char* code;      // mmap'd executable memory
+    size_t mappedSize;
+    JITFunction* funcs;
+    int funcCount;
+} JITModule;
+
+/* JIT OPERATIONS */
+JITModule* jitCompile(TACInstr* code);
+void* jitLookup(JITModule* module, const char* name);
+int jitRun(JITModule* module);
+void jitWritePerfMap(JITModule* module);
+void jitFree(JITModule* module);
+
+#endif
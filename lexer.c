@@ -0,0 +1,513 @@
+/* HAND-WRITTEN SCANNER
+ * One table lookup classifies each byte, so whitespace, identifiers and
+ * numbers are each a tight loop over the buffer. Keywords are told from
+ * identifiers by a perfect hash: int, void, print and return all have
+ * different lengths, so the length picks the only keyword a word could
+ * be and one comparison settles it. Numbers are converted as they are
+ * scanned, with atoi's result for the ones that do not fit.
+ *
+ * Runs of whitespace and identifier characters are skipped 16 bytes at
+ * a time with SSE2 or 32 with AVX2, chosen when the lexer starts from
+ * what the CPU supports. Comments end at the next newline, which
+ * memchr already finds with vector instructions.
+ *
+ * The flex scanner of scanner.l stays available behind the same
+ * interface (--scanner=flex) as the reference for this one.
+ *
+ * Input that arrives in pieces is scanned a chunk at a time where it
+ * lies (chunkScannerFeed). A token is never longer than the identifier,
+ * number or comment it is, so only the one a chunk ends in the middle
+ * of is copied, and finished with the start of the next chunk.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#include "lexer.h"
+#include "context.h"
+
+/* Reentrant flex scanner (lex.yy.c) */
+int flexScan(YYSTYPE* yylval_param, void* yyscanner);
+int yylex_init_extra(struct CompilerContext* extra, void** scanner);
+void yyset_in(FILE* in, void* scanner);
+struct yy_buffer_state* yy_scan_bytes(const char* bytes, int len, void* scanner);
+struct yy_buffer_state* yy_scan_buffer(char* base, size_t size, void* scanner);
+int yylex_destroy(void* scanner);
+
+/* ============ CHARACTER CLASSES ============ */
+
+#define CLASS_SPACE 1
+#define CLASS_DIGIT 2
+#define CLASS_IDENT 4       // Letters, digits and _
+#define CLASS_PUNCT 8       // A token of its own
+
+static const unsigned char charClass[256] = {
+    [' '] = CLASS_SPACE, ['\t'] = CLASS_SPACE, ['\n'] = CLASS_SPACE,
+    ['0' ... '9'] = CLASS_DIGIT | CLASS_IDENT,
+    ['a' ... 'z'] = CLASS_IDENT, ['A' ... 'Z'] = CLASS_IDENT, ['_'] = CLASS_IDENT,
+    ['+'] = CLASS_PUNCT, ['-'] = CLASS_PUNCT, ['*'] = CLASS_PUNCT, ['/'] = CLASS_PUNCT,
+    ['='] = CLASS_PUNCT, [';'] = CLASS_PUNCT, [','] = CLASS_PUNCT,
+    ['('] = CLASS_PUNCT, [')'] = CLASS_PUNCT, ['{'] = CLASS_PUNCT, ['}'] = CLASS_PUNCT,
+    ['['] = CLASS_PUNCT, [']'] = CLASS_PUNCT,
+};
+
+/* ============ KEYWORDS ============ */
+
+typedef struct {
+    const char* text;
+    int token;
+} Keyword;
+
+// Indexed by length - KEYWORD_MIN
+#define KEYWORD_MIN 3
+#define KEYWORD_MAX 6
+static const Keyword keywords[KEYWORD_MAX - KEYWORD_MIN + 1] = {
+    { "int", INT }, { "void", VOID }, { "print", PRINT }, { "return", RETURN },
+};
+
+static int keyword(const char* text, size_t length) {
+    if (length < KEYWORD_MIN || length > KEYWORD_MAX) return 0;
+    const Keyword* candidate = &keywords[length - KEYWORD_MIN];
+    return text[0] == candidate->text[0] && memcmp(text, candidate->text, length) == 0 ? candidate->token : 0;
+}
+
+/* ============ RUN SCANNING ============ */
+
+/* Each returns the first byte at or after p that is not in its run,
+ * or end. The vector versions only load whole blocks before end and
+ * finish byte by byte. */
+typedef const char* (*SkipRun)(const char* p, const char* end);
+
+typedef struct LexerKernels {
+    const char* label;
+    SkipRun skipSpace;
+    SkipRun skipIdent;
+} LexerKernels;
+
+static const char* skipSpaceScalar(const char* p, const char* end) {
+    while (p < end && (charClass[(unsigned char)*p] & CLASS_SPACE)) p++;
+    return p;
+}
+
+static const char* skipIdentScalar(const char* p, const char* end) {
+    while (p < end && (charClass[(unsigned char)*p] & CLASS_IDENT)) p++;
+    return p;
+}
+
+#if defined(__x86_64__)
+
+// Bytes of v that are ' ', '\t' or '\n'
+static inline __m128i spaceBytes(__m128i v) {
+    __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                 _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+    return _mm_or_si128(blank, _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+}
+
+// Bytes of v in [a-zA-Z0-9_]. Setting bit 5 folds upper case onto lower
+// case and nothing else onto a-z; bytes over 127 compare as negative.
+static inline __m128i identBytes(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                   _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    return _mm_or_si128(_mm_or_si128(letter, digit), _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+}
+
+// Most runs are a byte or two long: a single space, a short name. Those
+// end here, before any block is loaded; NULL means the run goes on.
+static inline const char* shortRun(const char* p, const char* end, int cls) {
+    if (p == end || !(charClass[(unsigned char)p[0]] & cls)) return p;
+    if (p + 1 == end || !(charClass[(unsigned char)p[1]] & cls)) return p + 1;
+    return NULL;
+}
+
+static const char* skipSpaceSSE2(const char* p, const char* end) {
+    const char* stop = shortRun(p, end, CLASS_SPACE);
+    if (stop) return stop;
+    while (end - p >= 16) {
+        unsigned other = ~_mm_movemask_epi8(spaceBytes(_mm_loadu_si128((const __m128i*)p))) & 0xFFFF;
+        if (other) return p + __builtin_ctz(other);
+        p += 16;
+    }
+    return skipSpaceScalar(p, end);
+}
+
+static const char* skipIdentSSE2(const char* p, const char* end) {
+    const char* stop = shortRun(p, end, CLASS_IDENT);
+    if (stop) return stop;
+    while (end - p >= 16) {
+        unsigned other = ~_mm_movemask_epi8(identBytes(_mm_loadu_si128((const __m128i*)p))) & 0xFFFF;
+        if (other) return p + __builtin_ctz(other);
+        p += 16;
+    }
+    return skipIdentScalar(p, end);
+}
+
+/* The same tests 32 bytes wide. AVX2 has no signed less-than, so the
+ * upper bounds are greater-than with the operands swapped. */
+__attribute__((target("avx2")))
+static const char* skipSpaceAVX2(const char* p, const char* end) {
+    const char* stop = shortRun(p, end, CLASS_SPACE);
+    if (stop) return stop;
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        __m256i space = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+                                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+        unsigned other = ~(unsigned)_mm256_movemask_epi8(space);
+        if (other) return p + __builtin_ctz(other);
+        p += 32;
+    }
+    return skipSpaceScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char* skipIdentAVX2(const char* p, const char* end) {
+    const char* stop = shortRun(p, end, CLASS_IDENT);
+    if (stop) return stop;
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                          _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+        __m256i ident = _mm256_or_si256(_mm256_or_si256(letter, digit),
+                                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+        unsigned other = ~(unsigned)_mm256_movemask_epi8(ident);
+        if (other) return p + __builtin_ctz(other);
+        p += 32;
+    }
+    return skipIdentScalar(p, end);
+}
+
+#endif
+
+// Indexed by ScannerKind
+static const LexerKernels kernels[] = {
+    [SCANNER_SCALAR] = { "lex (scalar)", skipSpaceScalar, skipIdentScalar },
+#if defined(__x86_64__)
+    [SCANNER_SSE2] = { "lex (sse2)", skipSpaceSSE2, skipIdentSSE2 },
+    [SCANNER_AVX2] = { "lex (avx2)", skipSpaceAVX2, skipIdentAVX2 },
+#endif
+};
+
+// The kind that runs for kind on this CPU
+static int availableKind(int kind) {
+    if (kind == SCANNER_FLEX) return kind;
+#if defined(__x86_64__)
+    if ((kind == SCANNER_FAST || kind == SCANNER_AVX2) && __builtin_cpu_supports("avx2")) return SCANNER_AVX2;
+    // Every x86-64 CPU has SSE2
+    return kind == SCANNER_SCALAR ? SCANNER_SCALAR : SCANNER_SSE2;
+#else
+    return SCANNER_SCALAR;
+#endif
+}
+
+int scannerKind(const char* name) {
+    static const char* names[] = { "fast", "scalar", "sse2", "avx2", "flex" };
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+        if (strcmp(name, names[i]) == 0) return i;
+    }
+    return -1;
+}
+
+const char* scannerLabel(int kind) {
+    kind = availableKind(kind);
+    return kind == SCANNER_FLEX ? "lex (flex)" : kernels[kind].label;
+}
+
+/* ============ SCANNING ============ */
+
+void lexerInit(Lexer* lexer, CompilerContext* ctx, const char* src, size_t len) {
+    lexer->pos = src;
+    lexer->end = src + len;
+    lexer->ctx = ctx;
+    lexer->inComment = 0;
+    int kind = availableKind(ctx->scanner);
+    lexer->kernels = &kernels[kind == SCANNER_FLEX ? SCANNER_SCALAR : kind];
+}
+
+// Like atoi: digits past LONG_MAX saturate, and the long is then cut to
+// an int
+static int scanNumber(Lexer* lexer) {
+    const char* p = lexer->pos;
+    unsigned long value = 0;
+    int overflow = 0;
+    while (p < lexer->end && (charClass[(unsigned char)*p] & CLASS_DIGIT)) {
+        unsigned digit = *p++ - '0';
+        if (value > (LONG_MAX - digit) / 10) overflow = 1;
+        else value = value * 10 + digit;
+    }
+    lexer->pos = p;
+    return overflow ? (int)LONG_MAX : (int)(long)value;
+}
+
+// The next token. Unless final, more input may follow end: a token
+// that reaches end is not taken but left at lexer->pos, and
+// LEXER_MORE is returned where final would mean the end of input.
+static inline __attribute__((always_inline)) int scan(Lexer* lexer, YYSTYPE* value, int final) {
+    const char* end = lexer->end;
+    if (lexer->inComment) {
+        const char* newline = memchr(lexer->pos, '\n', end - lexer->pos);
+        lexer->pos = newline ? newline : end;
+        if (!newline) return final ? 0 : LEXER_MORE;
+        lexer->inComment = 0;
+    }
+    for (;;) {
+        const char* p = lexer->kernels->skipSpace(lexer->pos, end);
+        if (p == end) {
+            lexer->pos = p;
+            return final ? 0 : LEXER_MORE;
+        }
+        unsigned char c = *p;
+        unsigned char cls = charClass[c];
+
+        if (cls & CLASS_DIGIT) {
+            lexer->pos = p;
+            value->num = scanNumber(lexer);
+            if (!final && lexer->pos == end) {
+                lexer->pos = p;
+                return LEXER_MORE;
+            }
+            return NUM;
+        }
+        if (cls & CLASS_IDENT) {
+            const char* start = p;
+            p = lexer->kernels->skipIdent(p + 1, end);
+            if (!final && p == end) {
+                lexer->pos = start;
+                return LEXER_MORE;
+            }
+            lexer->pos = p;
+            size_t length = p - start;
+            int token = keyword(start, length);
+            if (token) return token;
+            value->name = internName(&lexer->ctx->strings, start, length);
+            return ID;
+        }
+        if (c == '/' && !final && p + 1 == end) {
+            // The start of a comment, or a '/' of its own
+            lexer->pos = p;
+            return LEXER_MORE;
+        }
+        if (c == '/' && p + 1 < end && p[1] == '/') {
+            // A comment runs to the end of the line
+            const char* newline = memchr(p, '\n', end - p);
+            lexer->pos = newline ? newline : end;
+            if (!final && !newline) {
+                lexer->inComment = 1;
+                return LEXER_MORE;
+            }
+            continue;
+        }
+        lexer->pos = p + 1;
+        if (cls & CLASS_PUNCT) return c;
+        // Reported like flex's catch-all rule, which goes on scanning
+        compilerError(lexer->ctx, "Lexical Error: Unknown character '%.*s'", 1, p);
+    }
+}
+
+int lexerNext(Lexer* lexer, YYSTYPE* value) {
+    return scan(lexer, value, 1);
+}
+
+/* ============ RESUMABLE SCANNING ============ */
+
+void chunkScannerInit(ChunkScanner* scanner, CompilerContext* ctx) {
+    memset(scanner, 0, sizeof(ChunkScanner));
+    lexerInit(&scanner->lexer, ctx, NULL, 0);
+}
+
+void chunkScannerFree(ChunkScanner* scanner) {
+    free(scanner->carry);
+    memset(scanner, 0, sizeof(ChunkScanner));
+}
+
+static int carryAppend(ChunkScanner* scanner, const char* bytes, size_t size) {
+    if (size == 0) return 0;
+    if (scanner->carrySize + size > scanner->carryCapacity) {
+        size_t capacity = scanner->carryCapacity ? scanner->carryCapacity : 64;
+        while (capacity < scanner->carrySize + size) capacity *= 2;
+        char* grown = realloc(scanner->carry, capacity);
+        if (!grown) return -1;
+        scanner->carry = grown;
+        scanner->carryCapacity = capacity;
+    }
+    memcpy(scanner->carry + scanner->carrySize, bytes, size);
+    scanner->carrySize += size;
+    return 0;
+}
+
+// Hand the tokens of text to sink, then keep what is left of it (the
+// cut-off token) as the carry. text may be the carry itself.
+static int scanPiece(ChunkScanner* scanner, const char* text, size_t size, int final,
+                     TokenSink sink, void* arg) {
+    Lexer* lexer = &scanner->lexer;
+    lexer->pos = text;
+    lexer->end = text + size;
+    for (;;) {
+        YYSTYPE value;
+        int token = final ? scan(lexer, &value, 1) : scan(lexer, &value, 0);
+        if (token == LEXER_MORE || token == 0) break;
+        int result = sink(arg, token, &value);
+        if (result != 0) return result;
+    }
+    size_t rest = lexer->end - lexer->pos;
+    if (text == scanner->carry) {
+        memmove(scanner->carry, lexer->pos, rest);
+        scanner->carrySize = rest;
+        return 0;
+    }
+    return carryAppend(scanner, lexer->pos, rest) == 0 ? 0 : LEXER_NO_MEMORY;
+}
+
+int chunkScannerFeed(ChunkScanner* scanner, const char* chunk, size_t size, int final,
+                     TokenSink sink, void* arg) {
+    const char* p = chunk;
+    const char* end = chunk + size;
+
+    // Finish the token cut off last time: it takes the identifier
+    // characters that continue it, and the byte after them settles it
+    while (scanner->carrySize > 0 && (p < end || final)) {
+        const char* stop = p;
+        while (stop < end && (charClass[(unsigned char)*stop] & CLASS_IDENT)) stop++;
+        if (stop < end) stop++;
+        if (carryAppend(scanner, p, stop - p) != 0) return LEXER_NO_MEMORY;
+        p = stop;
+        int result = scanPiece(scanner, scanner->carry, scanner->carrySize, final && p == end, sink, arg);
+        if (result != 0) return result;
+    }
+
+    if (scanner->carrySize == 0) {
+        int result = scanPiece(scanner, p, end - p, final, sink, arg);
+        if (result != 0) return result;
+    }
+    if (!final) return 0;
+    YYSTYPE value;
+    memset(&value, 0, sizeof(value));
+    return sink(arg, 0, &value);
+}
+
+/* ============ SCANNER SELECTION ============ */
+
+static int openFlex(Scanner* scanner, CompilerContext* ctx) {
+    memset(scanner, 0, sizeof(Scanner));
+    if (yylex_init_extra(ctx, &scanner->flex) != 0) {
+        compilerError(ctx, "Error: Cannot create scanner");
+        return 1;
+    }
+    return 0;
+}
+
+int scannerOpen(Scanner* scanner, CompilerContext* ctx, const char* src, size_t len) {
+    if (ctx->scanner != SCANNER_FLEX) {
+        memset(scanner, 0, sizeof(Scanner));
+        lexerInit(&scanner->lexer, ctx, src, len);
+        return 0;
+    }
+    if (len > INT_MAX - 2) {
+        compilerError(ctx, "Error: Source too large");
+        return 1;
+    }
+    if (openFlex(scanner, ctx) != 0) return 1;
+    yy_scan_bytes(src, (int)len, scanner->flex);
+    return 0;
+}
+
+int scannerOpenBuffer(Scanner* scanner, CompilerContext* ctx, char* buffer, size_t size) {
+    if (ctx->scanner != SCANNER_FLEX) return scannerOpen(scanner, ctx, buffer, size);
+    if (openFlex(scanner, ctx) != 0) return 1;
+    yy_scan_buffer(buffer, size + 2, scanner->flex);
+    return 0;
+}
+
+// The hand-written scanner wants all of the input in memory
+static char* readStream(FILE* in, size_t* size) {
+    size_t capacity = 4096;
+    char* text = malloc(capacity);
+    *size = 0;
+    while (text) {
+        *size += fread(text + *size, 1, capacity - *size, in);
+        if (*size < capacity) break;
+        char* grown = realloc(text, capacity * 2);
+        if (!grown) free(text);
+        text = grown;
+        capacity *= 2;
+    }
+    return text;
+}
+
+int scannerOpenFile(Scanner* scanner, CompilerContext* ctx, FILE* in) {
+    if (ctx->scanner == SCANNER_FLEX) {
+        if (openFlex(scanner, ctx) != 0) return 1;
+        yyset_in(in, scanner->flex);
+        return 0;
+    }
+    size_t size;
+    char* text = readStream(in, &size);
+    if (!text || ferror(in)) {
+        free(text);
+        compilerError(ctx, "Error: Cannot read input");
+        return 1;
+    }
+    scannerOpen(scanner, ctx, text, size);
+    scanner->text = text;
+    return 0;
+}
+
+int scannerNext(Scanner* scanner, YYSTYPE* value) {
+    return scanner->flex ? flexScan(value, scanner->flex) : lexerNext(&scanner->lexer, value);
+}
+
+void scannerClose(Scanner* scanner) {
+    if (scanner->flex) yylex_destroy(scanner->flex);
+    free(scanner->text);
+    memset(scanner, 0, sizeof(Scanner));
+}
+
+/* ============ TOKEN DUMPS ============ */
+
+int scanTokens(CompilerContext* ctx, char* buffer, size_t size, Token** tokens, size_t* count) {
+    Scanner scanner;
+    *tokens = NULL;
+    *count = 0;
+    if (scannerOpenBuffer(&scanner, ctx, buffer, size) != 0) return 1;
+    size_t capacity = 0;
+    for (;;) {
+        if (*count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            Token* grown = realloc(*tokens, capacity * sizeof(Token));
+            if (!grown) {
+                scannerClose(&scanner);
+                compilerError(ctx, "Error: Out of memory");
+                return 1;
+            }
+            *tokens = grown;
+        }
+        Token* token = &(*tokens)[*count];
+        token->type = scannerNext(&scanner, &token->value);
+        if (token->type == 0) break;
+        (*count)++;
+    }
+    scannerClose(&scanner);
+    return 0;
+}
+
+/* One line per token: the keyword, ID or NUM with its value, or the
+ * quoted character */
+void printToken(FILE* out, const CompilerContext* ctx, const Token* token) {
+    switch (token->type) {
+        case INT: fprintf(out, "INT\n"); break;
+        case VOID: fprintf(out, "VOID\n"); break;
+        case PRINT: fprintf(out, "PRINT\n"); break;
+        case RETURN: fprintf(out, "RETURN\n"); break;
+        case ID: fprintf(out, "ID %s\n", nameText(&ctx->strings, token->value.name)); break;
+        case NUM: fprintf(out, "NUM %d\n", token->value.num); break;
+        default: fprintf(out, "'%c'\n", token->type); break;
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "ast.h"
+#include "parser.tab.h"
+
+struct CompilerContext;
+struct LexerKernels;
+
+/* Scanners (--scanner). The hand-written scanner skips whitespace and
+ * finds the end of identifiers with SSE2 or AVX2 when the CPU has them;
+ * FAST takes the best one available, and asking for a kind the CPU
+ * lacks gets the next best. */
+typedef enum {
+    SCANNER_FAST,
+    SCANNER_SCALAR,
+    SCANNER_SSE2,
+    SCANNER_AVX2,
+    SCANNER_FLEX,           // scanner.l
+} ScannerKind;
+
+/* The kind a --scanner name stands for, or -1 */
+int scannerKind(const char* name);
+/* Phase label naming the scanner that runs for kind on this CPU, such
+ * as "lex (avx2)" */
+const char* scannerLabel(int kind);
+
+/* HAND-WRITTEN SCANNER
+ * Produces the same tokens as scanner.l straight from the source bytes:
+ * it reads up to end without needing a terminator and never writes to
+ * the buffer. Identifiers are interned from where they lie, so the
+ * only copy of a token's text is the first one made of each name. */
+typedef struct {
+    const char* pos;        // Next byte to scan
+    const char* end;
+    struct CompilerContext* ctx;
+    const struct LexerKernels* kernels;     // Run scanning for the selected instruction set
+    int inComment;          // Resumable scanning: the last piece ended inside a comment
+} Lexer;
+
+void lexerInit(Lexer* lexer, struct CompilerContext* ctx, const char* src, size_t len);
+
+/* The next token's code (parser.tab.h) with its value in *value, or 0
+ * at the end of the input */
+int lexerNext(Lexer* lexer, YYSTYPE* value);
+
+/* RESUMABLE SCANNING
+ * For input that arrives in chunks, cut anywhere. Each chunk is scanned
+ * in place and its tokens are pushed to a sink; a token the chunk ends
+ * in the middle of is copied, to be finished by the next chunk. */
+#define LEXER_MORE -1           // The input ended in what may be a longer token
+#define LEXER_NO_MEMORY -2
+
+/* Receives each token; a nonzero result stops the scanning and is
+ * returned from chunkScannerFeed */
+typedef int (*TokenSink)(void* arg, int token, const YYSTYPE* value);
+
+typedef struct {
+    Lexer lexer;
+    char* carry;            // The start of a token cut off by the end of a chunk
+    size_t carrySize;
+    size_t carryCapacity;
+} ChunkScanner;
+
+void chunkScannerInit(ChunkScanner* scanner, struct CompilerContext* ctx);
+/* Scan the next chunk. With final set it is the last one (it may be
+ * empty), and the end token 0 is pushed after its tokens. Returns 0, a
+ * sink's nonzero result, or LEXER_NO_MEMORY. */
+int chunkScannerFeed(ChunkScanner* scanner, const char* chunk, size_t size, int final,
+                     TokenSink sink, void* arg);
+void chunkScannerFree(ChunkScanner* scanner);
+
+/* The scanner the parser pulls tokens from: the hand-written one, or
+ * the flex scanner of scanner.l with --scanner=flex, which is kept as
+ * the reference the others are checked against. */
+typedef struct Scanner {
+    Lexer lexer;
+    void* flex;             // The flex scanner, if that is the one in use
+    char* text;             // Input read from a stream by scannerOpenFile
+} Scanner;
+
+/* Scan a copy of src (flex), or src itself */
+int scannerOpen(Scanner* scanner, struct CompilerContext* ctx, const char* src, size_t len);
+/* Scan a buffer in place; see parseBuffer for what flex needs of it */
+int scannerOpenBuffer(Scanner* scanner, struct CompilerContext* ctx, char* buffer, size_t size);
+int scannerOpenFile(Scanner* scanner, struct CompilerContext* ctx, FILE* in);
+int scannerNext(Scanner* scanner, YYSTYPE* value);
+void scannerClose(Scanner* scanner);
+
+/* TOKEN DUMPS (--dump-tokens) */
+typedef struct {
+    int type;
+    YYSTYPE value;
+} Token;
+
+/* Lex a whole buffer into a malloc'd array. Returns 0, or 1 if the
+ * scanner could not be created or memory ran out. */
+int scanTokens(struct CompilerContext* ctx, char* buffer, size_t size, Token** tokens, size_t* count);
+void printToken(FILE* out, const struct CompilerContext* ctx, const Token* token);
+
+#endif
@@ -4,81 +4,870 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
 #include "ast.h"
+#include "context.h"
 #include "codegen.h"
 #include "tac.h"
+#include "jit.h"
+#include "mips.h"
+#include "sim.h"
+#include "stats.h"
+#include "pool.h"
+#include "source.h"
+#include "cache.h"
+#include "server.h"
+#include "incremental.h"
+#include "sha256.h"
+#include "profile.h"
+#include "lexer.h"
 
-extern int yyparse();
-extern FILE* yyin;
-extern ASTNode* root;
+#define MAX_RESPONSE_DEPTH 8
 
-int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        printf("Usage: %s <input.c> <output.s>\n", argv[0]);
-        printf("Example: ./minicompiler test.c output.s\n");
+/* COMMAND-LINE OPTIONS */
+typedef struct {
+    const char** inputFiles;
+    int inputCount;
+    const char* outputFile;
+    const char* emit;       // asm, obj or exe
+    int bigEndian;
+    int optLevel;           // -O0 (default) or -O1
+    int quiet;              // -q: no banners, only requested dumps
+    int scanner;            // --scanner: a ScannerKind
+    int prattParser;        // --parser=pratt: the hand-written parser
+    int stream;             // --stream: compile each function as soon as it is parsed
+    int dumpTokens;         // --dump-tokens: print the token stream and stop
+    int dumpAST;
+    int dumpTAC;
+    int dumpOptTAC;
+    int jit;
+    int disasm;
+    int simulate;           // --sim: run executables in the MIPS simulator
+    int simStats;           // --sim-stats: and report what they executed
+    int profileGenerate;    // -fprofile-generate: instrument the program
+    int profileUse;         // -fprofile-use: optimize with the counts
+    const char* profileFile;    // Where they are written or read (NULL: input.prof)
+    int showProfile;        // --show-profile: print profiles
+    int timeReport;         // --time-report: phase table on stderr at exit
+    int statsJSON;          // --stats-json[=file]: same data as JSON
+    const char* statsFile;  // NULL means stdout
+    int jobs;               // -j: files compiled at once
+    int useCache;           // --cache or --cache-dir
+    const char* cacheDir;   // NULL means the default directory
+    long long cacheMaxSize;
+    int cacheStats;         // --cache-stats: print hit/miss counts
+    CompileCache* cache;    // Open when useCache; shared by all jobs
+    const char* serverSocket;   // --server: serve compile requests
+    const char* clientSocket;   // --client: send the build to a server
+    int incremental;        // --incremental: reuse unchanged functions
+    char* functionDir;      // Where per-input function caches are kept
+    CompileCache* functionDirCache; // The cache functionDir is in, which bounds its size
+} Options;
+
+/* One input file of a build, compiled on the thread pool */
+typedef struct {
+    const Options* opts;
+    CompilerContext* ctx;
+    char* diagText;         // Diagnostics held back until the build ends
+    size_t diagSize;
+    char* profileFile;      // -fprofile-generate or -fprofile-use
+    int buffered;
+    int result;
+} Job;
+
+/* JIT MODE - compile straight to x86-64 in memory and run main */
+static int runJIT(CompilerContext* ctx, const Options* opts) {
+    (void)opts;
+    SourceBuffer source;
+    if (loadSource(ctx->fileName, &source) != 0) {
+        compilerError(ctx, "Error: Cannot open input file '%s'", ctx->fileName);
         return 1;
     }
+    phaseBegin(&ctx->stats, "parse", ctx->prattParser ? "lex+parse (pratt)" : "lex+parse (yyparse)");
+    int parsed = parseBuffer(ctx, source.data, source.size);
+    phaseEnd(&ctx->stats);
+    freeSource(&source);
+    if (parsed != 0) return 1;
     
-    yyin = fopen(argv[1], "r");
-    if (!yyin) {
-        fprintf(stderr, "Error: Cannot open input file '%s'\n", argv[1]);
+    // The TAC keeps names as written, so undeclared ones are caught
+    // here, with the errors code generation would give
+    phaseBegin(&ctx->stats, "bind", "semantic: bind names");
+    int bound = bindProgram(&ctx->symtab, &ctx->ast, ctx->root);
+    phaseEnd(&ctx->stats);
+    if (bound != 0) {
+        compilerError(ctx, "Error: Out of memory");
         return 1;
     }
+    if (checkDeclarations(ctx) != 0) return 1;
     
-    printf("\n");
-    printf("╔════════════════════════════════════════════════════════════╗\n");
-    printf("║          MINIMAL C COMPILER - EDUCATIONAL VERSION          ║\n");
-    printf("╚════════════════════════════════════════════════════════════╝\n");
-    printf("\n");
+    phaseBegin(&ctx->stats, "tac", "TAC generation");
+    generateTACParallel(&ctx->tacList, &ctx->ast, ctx->root, ctx->pool);
+    phaseEnd(&ctx->stats);
     
-    /* PHASE 1: Lexical and Syntax Analysis */
-    printf("┌──────────────────────────────────────────────────────────┐\n");
-    printf("│ PHASE 1: LEXICAL & SYNTAX ANALYSIS                       │\n");
-    printf("├──────────────────────────────────────────────────────────┤\n");
-    printf("│ • Reading source file: %s\n", argv[1]);
-    printf("│ • Tokenizing input (scanner.l)\n");
-    printf("│ • Parsing grammar rules (parser.y)\n");
-    printf("│ • Building Abstract Syntax Tree\n");
-    printf("└──────────────────────────────────────────────────────────┘\n");
+    phaseBegin(&ctx->stats, "opt-fold-propagate", "optimize: constant folding/propagation");
+    optimizeTACParallel(&ctx->tacList, &ctx->optimizedList, ctx->pool);
+    phaseEnd(&ctx->stats);
     
-    if (yyparse() == 0) {
-        printf("✓ Parse successful - program is syntactically correct!\n\n");
+    phaseBegin(&ctx->stats, "jit-compile", "JIT compile (x86-64)");
+    JITModule* module = jitCompile(ctx->optimizedList.head);
+    phaseEnd(&ctx->stats);
+    if (!module) return 1;
+    jitWritePerfMap(module);
+    
+    phaseBegin(&ctx->stats, "jit-run", "JIT run (main)");
+    int result = jitRun(module);
+    phaseEnd(&ctx->stats);
+    jitFree(module);
+    return result;
+}
+
+/* TOKEN DUMP - lex the whole file, then print one token per line */
+static int runDumpTokens(CompilerContext* ctx) {
+    SourceBuffer source;
+    if (loadSource(ctx->fileName, &source) != 0) {
+        compilerError(ctx, "Error: Cannot open input file '%s'", ctx->fileName);
+        return 1;
+    }
+    Token* tokens;
+    size_t count;
+    phaseBegin(&ctx->stats, "lex", scannerLabel(ctx->scanner));
+    int failed = scanTokens(ctx, source.data, source.size, &tokens, &count) != 0;
+    phaseEnd(&ctx->stats);
+    freeSource(&source);
+    if (failed) return 1;
+    
+    phaseBegin(&ctx->stats, "dump-tokens", "print tokens");
+    for (size_t i = 0; i < count; i++) {
+        printToken(stdout, ctx, &tokens[i]);
+    }
+    phaseEnd(&ctx->stats);
+    free(tokens);
+    return ctx->errorCount != 0;
+}
+
+static void usage(const char* prog) {
+    printf("Usage: %s [options] <input.c> [-o <output>]\n", prog);
+    printf("       %s [options] -j <n> <a.c> <b.c> ...\n", prog);
+    printf("       %s --jit <input.c>\n", prog);
+    printf("       %s --disasm <file.o>\n", prog);
+    printf("       %s --sim [--sim-stats] <a.out>\n", prog);
+    printf("       %s --show-profile <file.prof>\n", prog);
+    printf("       %s --server <socket>\n", prog);
+    printf("Options:\n");
+    printf("  -o <file>            Output file (default: input name with .s/.o, or a.out)\n");
+    printf("  -j <n>               Compile up to n files, or functions of one file, at once\n");
+    printf("                       (0: one per CPU)\n");
+    printf("  @<file>              Read more arguments from a response file\n");
+    printf("  -O0, -O1             Optimization level (default 0; -O is -O1)\n");
+    printf("  -q                   Quiet: no phase banners or dumps\n");
+    printf("  --dump-tokens        Print the tokens of the input and stop\n");
+    printf("  --dump-ast           Print the abstract syntax tree\n");
+    printf("  --dump-tac           Print the unoptimized three-address code\n");
+    printf("  --dump-opt-tac       Print the optimized three-address code\n");
+    printf("  --emit=asm|obj|exe   Output MIPS assembly (default), an ELF32 object or executable\n");
+    printf("  -EB, -EL             Big-endian (default) or little-endian ELF output\n");
+    printf("  --parser=bison|pratt Bison parser (default) or the hand-written one\n");
+    printf("  --stream             Compile and write out each function as soon as it is parsed,\n");
+    printf("                       so memory use follows the largest function (asm, with -q)\n");
+    printf("  --scanner=<kind>     fast (default): hand-written, with the best of avx2, sse2 or\n");
+    printf("                       scalar run skipping the CPU has; flex: the reference scanner\n");
+    printf("  --sim-stats          With --sim: print instruction and code size counts on stderr\n");
+    printf("  -fprofile-generate[=file]\n");
+    printf("                       Count calls; main's return writes them to file (input.prof)\n");
+    printf("  -fprofile-use[=file] Inline, keep variables in registers and order functions\n");
+    printf("                       by the counts in file (input.prof)\n");
+    printf("  --time-report        Print wall/CPU time and heap growth per phase at exit\n");
+    printf("  --stats-json[=file]  Write the same measurements as JSON (default: stdout)\n");
+    printf("  --cache              Reuse earlier output from the compile cache (with -q)\n");
+    printf("  --cache-dir=<dir>    Cache directory (default: ~/.cache/minicompiler)\n");
+    printf("  --cache-max-size=<n> Cache size limit in bytes, or with a k/M/G suffix\n");
+    printf("  --cache-stats        Print cache hits and misses (alone: just print them)\n");
+    printf("  --incremental        Regenerate only the functions changed since the last build\n");
+    printf("  --server <socket>    Stay resident and compile requests sent to socket\n");
+    printf("  --client <socket>    Have the server at socket do the compiling\n");
+    printf("Example: ./minicompiler test.c -o output.s\n");
+}
+
+/* RESPONSE FILES
+ * @file is replaced by the arguments in file, separated by whitespace.
+ * Quotes group words and a backslash escapes the next character, as
+ * in gcc's response files.
+ */
+static void addArg(char*** args, int* count, int* capacity, char* arg) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 16;
+        *args = realloc(*args, *capacity * sizeof(char*));
+    }
+    (*args)[(*count)++] = arg;
+}
+
+static int readResponseFile(const char* name, char*** args, int* count, int* capacity, int depth);
+
+static int expandArg(char* arg, char*** args, int* count, int* capacity, int depth) {
+    if (arg[0] == '@' && arg[1] != '\0') {
+        return readResponseFile(arg + 1, args, count, capacity, depth + 1);
+    }
+    addArg(args, count, capacity, arg);
+    return 0;
+}
+
+static int readResponseFile(const char* name, char*** args, int* count, int* capacity, int depth) {
+    if (depth > MAX_RESPONSE_DEPTH) {
+        fprintf(stderr, "Error: Response files nested too deeply at '%s'\n", name);
+        return -1;
+    }
+    FILE* file = fopen(name, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open response file '%s'\n", name);
+        return -1;
+    }
+    
+    char* word = NULL;
+    size_t length = 0, size = 0;
+    int inWord = 0, quote = 0, c;
+    while ((c = fgetc(file)) != EOF) {
+        if (!quote && isspace(c)) {
+            if (inWord) {
+                word[length] = '\0';
+                if (expandArg(word, args, count, capacity, depth) != 0) {
+                    fclose(file);
+                    return -1;
+                }
+                word = NULL;
+                length = size = 0;
+                inWord = 0;
+            }
+            continue;
+        }
+        if (c == '\\') {
+            int next = fgetc(file);
+            if (next != EOF) c = next;
+        } else if (quote && c == quote) {
+            quote = 0;
+            continue;
+        } else if (!quote && (c == '"' || c == '\'')) {
+            quote = c;
+            inWord = 1;
+            continue;
+        }
+        if (length + 2 > size) {
+            size = size ? size * 2 : 32;
+            word = realloc(word, size);
+        }
+        word[length++] = (char)c;
+        inWord = 1;
+    }
+    fclose(file);
+    
+    if (inWord) {
+        if (!word) word = calloc(1, 1);   // "" is an empty argument
+        word[length] = '\0';
+        return expandArg(word, args, count, capacity, depth);
+    }
+    return 0;
+}
+
+/* A .c file is always an input; anything else in second place is the
+ * output of the legacy "<input> <output>" form */
+static int isSourceName(const char* name) {
+    size_t len = strlen(name);
+    return len > 2 && strcmp(name + len - 2, ".c") == 0;
+}
+
+/* --cache-max-size: "64M" -> bytes; -1 if malformed */
+static long long parseSize(const char* text) {
+    char* end;
+    long long size = strtoll(text, &end, 10);
+    if (end == text || size < 0) return -1;
+    switch (*end) {
+        case 'k': case 'K': size *= 1024; end++; break;
+        case 'm': case 'M': size *= 1024 * 1024; end++; break;
+        case 'g': case 'G': size *= 1024 * 1024 * 1024; end++; break;
+    }
+    return *end == '\0' ? size : -1;
+}
+
+/* Parse argv into opts. Returns 0 on success. */
+static int parseOptions(int argc, char* argv[], Options* opts) {
+    int onlyFiles = 0;
+    
+    memset(opts, 0, sizeof(Options));
+    opts->emit = "asm";
+    opts->bigEndian = 1;
+    opts->jobs = 1;
+    opts->inputFiles = malloc(argc * sizeof(char*));
+    
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
         
-        /* PHASE 2: AST Display */
-        printf("┌──────────────────────────────────────────────────────────┐\n");
-        printf("│ PHASE 2: ABSTRACT SYNTAX TREE (AST)                      │\n");
-        printf("├──────────────────────────────────────────────────────────┤\n");
-        printf("│ Tree structure representing the program hierarchy:       │\n");
-        printf("└──────────────────────────────────────────────────────────┘\n");
-        printAST(root, 0);
+        if (onlyFiles || arg[0] != '-' || arg[1] == '\0') {
+            // Positional: input files, or the legacy output file
+            if (opts->inputCount == 1 && !opts->outputFile && !isSourceName(arg)) {
+                opts->outputFile = arg;
+            } else {
+                opts->inputFiles[opts->inputCount++] = arg;
+            }
+        } else if (strcmp(arg, "--") == 0) {
+            onlyFiles = 1;
+        } else if (strcmp(arg, "-o") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: -o requires a file name\n");
+                return -1;
+            }
+            opts->outputFile = argv[++i];
+        } else if (strncmp(arg, "-o", 2) == 0) {
+            opts->outputFile = arg + 2;
+        } else if (strncmp(arg, "-j", 2) == 0) {
+            const char* count = arg[2] ? arg + 2 : (i + 1 < argc ? argv[++i] : NULL);
+            char* end;
+            long jobs = count ? strtol(count, &end, 10) : -1;
+            if (!count || *end != '\0' || jobs < 0 || jobs > 1024) {
+                fprintf(stderr, "Error: -j requires a thread count from 0 to 1024\n");
+                return -1;
+            }
+            opts->jobs = jobs == 0 ? poolDefaultSize() : (int)jobs;
+        } else if (strncmp(arg, "-O", 2) == 0) {
+            if (strcmp(arg, "-O") != 0 && strcmp(arg, "-O0") != 0 && strcmp(arg, "-O1") != 0) {
+                fprintf(stderr, "Error: Unknown optimization level '%s' (use -O0 or -O1)\n", arg);
+                return -1;
+            }
+            opts->optLevel = arg[2] != '0';
+        } else if (strcmp(arg, "-q") == 0) {
+            opts->quiet = 1;
+        } else if (strcmp(arg, "--dump-tokens") == 0) {
+            opts->dumpTokens = 1;
+        } else if (strcmp(arg, "--dump-ast") == 0) {
+            opts->dumpAST = 1;
+        } else if (strcmp(arg, "--dump-tac") == 0) {
+            opts->dumpTAC = 1;
+        } else if (strcmp(arg, "--dump-opt-tac") == 0) {
+            opts->dumpOptTAC = 1;
+        } else if (strcmp(arg, "--jit") == 0) {
+            opts->jit = 1;
+        } else if (strcmp(arg, "--disasm") == 0) {
+            opts->disasm = 1;
+        } else if (strcmp(arg, "--sim") == 0) {
+            opts->simulate = 1;
+        } else if (strcmp(arg, "--sim-stats") == 0) {
+            opts->simulate = 1;
+            opts->simStats = 1;
+        } else if (strcmp(arg, "-fprofile-generate") == 0) {
+            opts->profileGenerate = 1;
+        } else if (strncmp(arg, "-fprofile-generate=", 19) == 0 && arg[19]) {
+            opts->profileGenerate = 1;
+            opts->profileFile = arg + 19;
+        } else if (strcmp(arg, "-fprofile-use") == 0) {
+            opts->profileUse = 1;
+        } else if (strncmp(arg, "-fprofile-use=", 14) == 0 && arg[14]) {
+            opts->profileUse = 1;
+            opts->profileFile = arg + 14;
+        } else if (strcmp(arg, "--show-profile") == 0) {
+            opts->showProfile = 1;
+        } else if (strncmp(arg, "--scanner=", 10) == 0) {
+            opts->scanner = scannerKind(arg + 10);
+            if (opts->scanner < 0) {
+                fprintf(stderr, "Error: Unknown scanner '%s' (use fast, scalar, sse2, avx2 or flex)\n",
+                        arg + 10);
+                return -1;
+            }
+        } else if (strcmp(arg, "--parser=bison") == 0 || strcmp(arg, "--parser=pratt") == 0) {
+            opts->prattParser = arg[9] == 'p';
+        } else if (strncmp(arg, "--parser=", 9) == 0) {
+            fprintf(stderr, "Error: Unknown parser '%s' (use bison or pratt)\n", arg + 9);
+            return -1;
+        } else if (strcmp(arg, "--stream") == 0) {
+            opts->stream = 1;
+        } else if (strncmp(arg, "--emit=", 7) == 0) {
+            opts->emit = arg + 7;
+            if (strcmp(opts->emit, "asm") != 0 && strcmp(opts->emit, "obj") != 0 &&
+                strcmp(opts->emit, "exe") != 0) {
+                fprintf(stderr, "Error: Unknown output kind '%s'\n", opts->emit);
+                return -1;
+            }
+        } else if (strcmp(arg, "--time-report") == 0) {
+            opts->timeReport = 1;
+        } else if (strcmp(arg, "--stats-json") == 0) {
+            opts->statsJSON = 1;
+        } else if (strncmp(arg, "--stats-json=", 13) == 0) {
+            opts->statsJSON = 1;
+            opts->statsFile = arg + 13;
+        } else if (strcmp(arg, "--cache") == 0) {
+            opts->useCache = 1;
+        } else if (strncmp(arg, "--cache-dir=", 12) == 0) {
+            opts->useCache = 1;
+            opts->cacheDir = arg + 12;
+        } else if (strncmp(arg, "--cache-max-size=", 17) == 0) {
+            opts->cacheMaxSize = parseSize(arg + 17);
+            if (opts->cacheMaxSize <= 0) {
+                fprintf(stderr, "Error: --cache-max-size needs a positive size such as 500k or 2M\n");
+                return -1;
+            }
+        } else if (strcmp(arg, "--incremental") == 0) {
+            opts->incremental = 1;
+        } else if (strcmp(arg, "--cache-stats") == 0) {
+            opts->cacheStats = 1;
+        } else if (strcmp(arg, "--server") == 0 || strcmp(arg, "--client") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: %s requires a socket path\n", arg);
+                return -1;
+            }
+            if (arg[2] == 's') {
+                opts->serverSocket = argv[++i];
+            } else {
+                opts->clientSocket = argv[++i];
+            }
+        } else if (strncmp(arg, "--server=", 9) == 0) {
+            opts->serverSocket = arg + 9;
+        } else if (strncmp(arg, "--client=", 9) == 0) {
+            opts->clientSocket = arg + 9;
+        } else if (strcmp(arg, "-EB") == 0) {
+            opts->bigEndian = 1;
+        } else if (strcmp(arg, "-EL") == 0) {
+            opts->bigEndian = 0;
+        } else {
+            fprintf(stderr, "Error: Unknown option '%s'\n", arg);
+            return -1;
+        }
+    }
+    
+    if (opts->serverSocket) {
+        if (opts->inputCount > 0 || opts->clientSocket) {
+            fprintf(stderr, "Error: --server takes no input files\n");
+            return -1;
+        }
+        return 0;
+    }
+    
+    // The server only produces output files, like a -q build
+    if (opts->clientSocket) {
+        if (opts->jit || opts->dumpTokens || opts->dumpAST || opts->dumpTAC || opts->dumpOptTAC) {
+            fprintf(stderr, "Error: --jit and --dump-* cannot be used with --client\n");
+            return -1;
+        }
+        if (opts->profileGenerate || opts->profileUse) {
+            fprintf(stderr, "Error: -fprofile-generate and -fprofile-use cannot be used with --client\n");
+            return -1;
+        }
+        opts->quiet = 1;
+    }
+    
+    if (opts->profileGenerate && opts->profileUse) {
+        fprintf(stderr, "Error: -fprofile-generate and -fprofile-use cannot be used together\n");
+        return -1;
+    }
+    
+    // Streaming never has the whole program, only the function being
+    // compiled, and writes assembly as it goes
+    if (opts->stream) {
+        if (opts->jit || opts->dumpTokens || opts->dumpAST || opts->dumpTAC || opts->dumpOptTAC ||
+            opts->clientSocket) {
+            fprintf(stderr, "Error: --jit, --dump-* and --client cannot be used with --stream\n");
+            return -1;
+        }
+        if (opts->profileGenerate || opts->profileUse || opts->useCache || opts->incremental ||
+            strcmp(opts->emit, "asm") != 0) {
+            fprintf(stderr, "Error: --stream only writes plain assembly: no -fprofile-*, --cache, "
+                    "--incremental or --emit=obj|exe\n");
+            return -1;
+        }
+        opts->quiet = 1;
+    }
+    
+    // --cache-stats on its own only reports
+    if (opts->inputCount == 0 && opts->cacheStats) return 0;
+    if (opts->inputCount == 0) {
+        fprintf(stderr, "Error: No input file\n");
+        return -1;
+    }
+    
+    // Several files compile concurrently, so nothing may print to stdout
+    if (opts->inputCount > 1) {
+        if (opts->outputFile) {
+            fprintf(stderr, "Error: -o cannot be used with multiple input files\n");
+            return -1;
+        }
+        if (opts->profileFile) {
+            fprintf(stderr, "Error: -fprofile-generate=file and -fprofile-use=file cannot be used "
+                    "with multiple input files\n");
+            return -1;
+        }
+        if (opts->jit || opts->dumpTokens || opts->dumpAST || opts->dumpTAC || opts->dumpOptTAC) {
+            fprintf(stderr, "Error: --jit and --dump-* need a single input file\n");
+            return -1;
+        }
+        opts->quiet = 1;
+    }
+    
+    // Without -q or any --dump-*, show everything like the classic driver
+    if (!opts->quiet && !opts->dumpTokens && !opts->dumpAST && !opts->dumpTAC && !opts->dumpOptTAC) {
+        opts->dumpAST = opts->dumpTAC = opts->dumpOptTAC = 1;
+    }
+    return 0;
+}
+
+/* Output is built in memory and goes out in one write */
+static int writeOutputFile(CompilerContext* ctx, const char* name, const void* data, size_t size) {
+    int fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        compilerError(ctx, "Cannot open output file %s", name);
+        return 1;
+    }
+    int failed = writeAll(fd, data, size) != 0;
+    if (close(fd) != 0) failed = 1;
+    if (failed) compilerError(ctx, "Error: Cannot write output file %s", name);
+    return failed;
+}
+
+/* -o, or foo.c -> foo.s (asm) or foo.o (obj); an executable is a.out,
+ * or foo when several files are built at once */
+static char* outputName(const Options* opts, const char* input) {
+    const char* emit = opts->emit;
+    if (opts->outputFile) return strdup(opts->outputFile);
+    if (strcmp(emit, "exe") == 0 && opts->inputCount == 1) return strdup("a.out");
+    
+    const char* ext = strcmp(emit, "obj") == 0 ? ".o" : strcmp(emit, "exe") == 0 ? "" : ".s";
+    const char* base = strrchr(input, '/');
+    base = base ? base + 1 : input;
+    const char* dot = strrchr(base, '.');
+    size_t len = dot ? (size_t)(dot - base) : strlen(base);
+    
+    char* name = malloc(len + strlen(ext) + 1);
+    memcpy(name, base, len);
+    strcpy(name + len, ext);
+    return name;
+}
+
+/* -fprofile-generate and -fprofile-use: the file name given, else
+ * foo.c -> foo.prof */
+static char* profileName(const Options* opts, const char* input) {
+    if (opts->profileFile) return strdup(opts->profileFile);
+    const char* base = strrchr(input, '/');
+    base = base ? base + 1 : input;
+    const char* dot = strrchr(base, '.');
+    size_t len = dot ? (size_t)(dot - base) : strlen(base);
+    
+    char* name = malloc(len + sizeof(".prof"));
+    memcpy(name, base, len);
+    strcpy(name + len, ".prof");
+    return name;
+}
+
+/* The options that change the output, as hashed into cache keys */
+static void cacheOptions(const Options* opts, char* text, size_t size) {
+    const char* order = strcmp(opts->emit, "asm") == 0 ? "" : opts->bigEndian ? " -EB" : " -EL";
+    snprintf(text, size, "%s%s -O%d", opts->emit, order, opts->optLevel);
+}
+
+/* --incremental: the function cache of an input, named by the hash of
+ * its absolute path */
+static char* functionCachePath(const Options* opts, const char* input) {
+    char* absolute = realpath(input, NULL);
+    if (!absolute) return NULL;
+    Sha256 sha;
+    unsigned char digest[SHA256_SIZE];
+    sha256Init(&sha);
+    sha256Update(&sha, absolute, strlen(absolute));
+    sha256Final(&sha, digest);
+    free(absolute);
+    
+    TextBuffer path = {0};
+    textAppendf(&path, "%s/", opts->functionDir);
+    for (int i = 0; i < SHA256_SIZE; i++) textAppendf(&path, "%02x", digest[i]);
+    return path.data;
+}
+
+/* --incremental: load the function cache of the file being compiled
+ * into functions and hand it to the code generator. Returns where it is
+ * kept, or NULL if incremental builds are off. */
+static char* loadFunctionCache(CompilerContext* ctx, const Options* opts, FunctionCache* functions) {
+    char* statePath = opts->functionDir ? functionCachePath(opts, ctx->fileName) : NULL;
+    if (!statePath) return NULL;
+    phaseBegin(&ctx->stats, "incremental-load", "incremental: load function cache");
+    functionCacheLoad(functions, statePath);
+    ctx->functions = functions;
+    phaseEnd(&ctx->stats);
+    return statePath;
+}
+
+static void saveFunctionCache(CompilerContext* ctx, const Options* opts, FunctionCache* functions,
+                              char* statePath, int succeeded) {
+    phaseBegin(&ctx->stats, "incremental-save", "incremental: save function cache");
+    ctx->functions = NULL;
+    if (succeeded) {
+        // Only this build's functions are worth keeping. The file counts
+        // towards the compile cache's size limit, and a file that was
+        // only read is marked as used so eviction keeps it longer.
+        functionCacheTrim(functions, 0);
+        struct stat old;
+        long long replaced = stat(statePath, &old) == 0 ? old.st_size : -1;
+        if (!functions->changed) {
+            utimensat(AT_FDCWD, statePath, NULL, 0);
+        } else if (functionCacheSave(functions, statePath) == 0) {
+            struct stat saved;
+            if (stat(statePath, &saved) == 0) cacheAdded(opts->functionDirCache, replaced, saved.st_size);
+        }
+    }
+    phaseEnd(&ctx->stats);
+    if (!opts->quiet) {
+        printf("✓ Reused %d of %d functions from the last build\n",
+               functions->reused, functions->reused + functions->generated);
+    }
+    functionCacheFree(functions);
+    free(statePath);
+}
+
+/* Pipes and sockets are parsed while they are read (push.tab.c), unless
+ * the compile cache needs the whole source first or a parser or scanner
+ * that can only pull was asked for */
+static int pushedInput(CompilerContext* ctx, const char* fileName, int cacheable) {
+    struct stat info;
+    return !cacheable && !ctx->prattParser && ctx->scanner != SCANNER_FLEX &&
+           stat(fileName, &info) == 0 && (S_ISFIFO(info.st_mode) || S_ISSOCK(info.st_mode));
+}
+
+// The loaded source, or what is read from input as it arrives
+static int parseInput(CompilerContext* ctx, const SourceBuffer* source, int input) {
+    if (input < 0) return parseBuffer(ctx, source->data, source->size);
+    int parsed = parseStream(ctx, input);
+    close(input);
+    return parsed;
+}
+
+/* STREAMING (--stream)
+ * The parser hands over each function as it completes it. Its code is
+ * generated into a buffer that goes to the output file whenever it has
+ * grown enough, and the parser then drops the function's nodes and
+ * names, so memory use follows the largest function rather than the
+ * file. Output written before an error is found is removed again.
+ */
+#define STREAM_FLUSH_SIZE (64 * 1024)
+
+typedef struct {
+    const char* fileName;
+    int fd;
+    TextBuffer text;
+    int failed;             // Code generation or output failed: write nothing more
+} OutputStream;
+
+// Write out the buffered text once there is at least atLeast of it
+static void flushStream(CompilerContext* ctx, OutputStream* stream, size_t atLeast) {
+    if (stream->text.size < atLeast) return;
+    if (stream->text.failed && !stream->failed) {
+        compilerError(ctx, "Error: Out of memory");
+        stream->failed = 1;
+    }
+    if (!stream->failed && writeAll(stream->fd, stream->text.data, stream->text.size) != 0) {
+        compilerError(ctx, "Error: Cannot write output file %s", stream->fileName);
+        stream->failed = 1;
+    }
+    textReset(&stream->text);
+}
+
+// Lexical errors are reported but, as without --stream, do not fail
+// the build; code generation errors do
+static void streamFunction(CompilerContext* ctx, NodeId func) {
+    OutputStream* stream = ctx->sinkData;
+    int errorsBefore = ctx->errorCount;
+    generateMIPSFunction(ctx, func);
+    if (ctx->errorCount != errorsBefore) stream->failed = 1;
+    flushStream(ctx, stream, STREAM_FLUSH_SIZE);
+}
+
+static int compileStream(CompilerContext* ctx, const char* outputFile, const SourceBuffer* source,
+                         int input) {
+    OutputStream stream = { outputFile, -1, {0}, 0 };
+    stream.fd = open(outputFile, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (stream.fd < 0) {
+        compilerError(ctx, "Cannot open output file %s", outputFile);
+        if (input >= 0) close(input);
+        return 1;
+    }
+    
+    ctx->functionSink = streamFunction;
+    ctx->sinkData = &stream;
+    const char* label = ctx->prattParser ? "lex+parse+codegen (pratt)" : "lex+parse+codegen (yyparse)";
+    phaseBegin(&ctx->stats, "stream", label);
+    beginMIPSStream(ctx, &stream.text);
+    int parsed = parseInput(ctx, source, input);
+    endMIPSStream(ctx);
+    flushStream(ctx, &stream, 0);
+    phaseEnd(&ctx->stats);
+    ctx->functionSink = NULL;
+    ctx->sinkData = NULL;
+    textFree(&stream.text);
+    
+    if (close(stream.fd) != 0 && !stream.failed) {
+        compilerError(ctx, "Error: Cannot write output file %s", outputFile);
+        stream.failed = 1;
+    }
+    int failed = parsed != 0 || stream.failed;
+    if (failed) unlink(outputFile);
+    return failed;
+}
+
+/* Run the full pipeline for one source file */
+static int compile(CompilerContext* ctx, const Options* opts) {
+    const char* inputFile = ctx->fileName;
+    int banners = !opts->quiet;
+    
+    // A cached result stands in for the whole compile. Banners and dumps
+    // are output of their own, so only quiet builds use the cache.
+    // Instrumented builds are not worth keeping, and the key does not
+    // cover the profile a -fprofile-use build read.
+    char key[CACHE_KEY_SIZE];
+    int errorsBefore = ctx->errorCount;
+    int cacheable = opts->cache && opts->quiet && !opts->dumpAST && !opts->dumpTAC && !opts->dumpOptTAC &&
+                    !ctx->profileGenerate && !ctx->profileUse;
+    
+    // The file is scanned in place; names are interned, so the
+    // mapping can go as soon as the parse is done. A pipe is scanned a
+    // read at a time instead.
+    SourceBuffer source = {0};
+    int input = pushedInput(ctx, inputFile, cacheable) ? open(inputFile, O_RDONLY) : -1;
+    if (input < 0 && loadSource(inputFile, &source) != 0) {
+        compilerError(ctx, "Error: Cannot open input file '%s'", inputFile);
+        return 1;
+    }
+    
+    if (cacheable) {
+        char* data;
+        size_t size;
+        phaseBegin(&ctx->stats, "cache-lookup", "compile cache lookup");
+        char options[32];
+        cacheOptions(opts, options, sizeof(options));
+        cacheKey(opts->cache, options, source.data, source.size, key);
+        int hit = cacheLookup(opts->cache, key, &data, &size) == 0;
+        phaseEnd(&ctx->stats);
+        if (hit) {
+            freeSource(&source);
+            char* outputFile = outputName(opts, inputFile);
+            int written = writeOutputFile(ctx, outputFile, data, size);
+            free(outputFile);
+            free(data);
+            return written;
+        }
+    }
+    
+    if (opts->stream) {
+        char* outputFile = outputName(opts, inputFile);
+        int streamed = compileStream(ctx, outputFile, &source, input);
+        freeSource(&source);
+        free(outputFile);
+        return streamed;
+    }
+    
+    if (banners) {
         printf("\n");
-        
-        /* PHASE 3: Intermediate Code */
-        printf("┌──────────────────────────────────────────────────────────┐\n");
-        printf("│ PHASE 3: INTERMEDIATE CODE GENERATION                    │\n");
-        printf("├──────────────────────────────────────────────────────────┤\n");
-        printf("│ Three-Address Code (TAC) - simplified instructions:      │\n");
-        printf("│ • Each instruction has at most 3 operands                │\n");
-        printf("│ • Temporary variables (t0, t1, ...) for expressions      │\n");
-        printf("└──────────────────────────────────────────────────────────┘\n");
-        initTAC();
-        generateTAC(root);
-        printTAC();
+        printf("╔════════════════════════════════════════════════════════════╗\n");
+        printf("║          MINIMAL C COMPILER - EDUCATIONAL VERSION          ║\n");
+        printf("╚════════════════════════════════════════════════════════════╝\n");
         printf("\n");
         
-        /* PHASE 4: Optimization */
+        /* PHASE 1: Lexical and Syntax Analysis */
         printf("┌──────────────────────────────────────────────────────────┐\n");
-        printf("│ PHASE 4: CODE OPTIMIZATION                               │\n");
+        printf("│ PHASE 1: LEXICAL & SYNTAX ANALYSIS                       │\n");
         printf("├──────────────────────────────────────────────────────────┤\n");
-        printf("│ Applying optimizations:                                  │\n");
-        printf("│ • Constant folding (evaluate compile-time expressions)   │\n");
-        printf("│ • Copy propagation (replace variables with values)       │\n");
+        printf("│ • Reading source file: %s\n", inputFile);
+        printf("│ • Tokenizing input (%s)\n", ctx->scanner == SCANNER_FLEX ? "scanner.l" : "lexer.c");
+        printf("│ • Parsing grammar rules (%s)\n", ctx->prattParser ? "pratt.c" : "parser.y");
+        printf("│ • Building Abstract Syntax Tree\n");
         printf("└──────────────────────────────────────────────────────────┘\n");
-        optimizeTAC();
-        printOptimizedTAC();
+    }
+    
+    const char* label = input >= 0 ? "lex+parse (yypush_parse)" :
+                        ctx->prattParser ? "lex+parse (pratt)" : "lex+parse (yyparse)";
+    phaseBegin(&ctx->stats, "parse", label);
+    int parsed = parseInput(ctx, &source, input);
+    phaseEnd(&ctx->stats);
+    freeSource(&source);
+    if (parsed != 0) {
+        if (banners) {
+            printf("✗ Parse failed - check your syntax!\n");
+            printf("Common errors:\n");
+            printf("  • Missing semicolon after statements\n");
+            printf("  • Undeclared variables\n");
+            printf("  • Invalid syntax for print statements\n");
+        }
+        return 1;
+    }
+    if (banners) {
+        printf("✓ Parse successful - program is syntactically correct!\n\n");
+    }
+    
+    // Every name is resolved once here; code generation then indexes
+    // the symbols instead of looking names up
+    phaseBegin(&ctx->stats, "bind", "semantic: bind names");
+    int bound = bindProgram(&ctx->symtab, &ctx->ast, ctx->root);
+    phaseEnd(&ctx->stats);
+    if (bound != 0) {
+        compilerError(ctx, "Error: Out of memory");
+        return 1;
+    }
+    
+    /* PHASE 2: AST Display */
+    if (opts->dumpAST) {
+        if (banners) {
+            printf("┌──────────────────────────────────────────────────────────┐\n");
+            printf("│ PHASE 2: ABSTRACT SYNTAX TREE (AST)                      │\n");
+            printf("├──────────────────────────────────────────────────────────┤\n");
+            printf("│ Tree structure representing the program hierarchy:       │\n");
+            printf("└──────────────────────────────────────────────────────────┘\n");
+        }
+        phaseBegin(&ctx->stats, "dump-ast", "dump: AST");
+        printAST(&ctx->ast, ctx->root, 0);
         printf("\n");
+        phaseEnd(&ctx->stats);
+    }
+    
+    /* PHASES 3-4: TAC is only built when it is shown - the MIPS
+     * backend works from the AST */
+    if (opts->dumpTAC || opts->dumpOptTAC) {
+        if (banners) {
+            printf("┌──────────────────────────────────────────────────────────┐\n");
+            printf("│ PHASE 3: INTERMEDIATE CODE GENERATION                    │\n");
+            printf("├──────────────────────────────────────────────────────────┤\n");
+            printf("│ Three-Address Code (TAC) - simplified instructions:      │\n");
+            printf("│ • Each instruction has at most 3 operands                │\n");
+            printf("│ • Temporary variables (.t0, .t1, ...) for expressions    │\n");
+            printf("└──────────────────────────────────────────────────────────┘\n");
+        }
+        phaseBegin(&ctx->stats, "tac", "TAC generation");
+        generateTACParallel(&ctx->tacList, &ctx->ast, ctx->root, ctx->pool);
+        phaseEnd(&ctx->stats);
+        if (opts->dumpTAC) {
+            phaseBegin(&ctx->stats, "dump-tac", "dump: TAC");
+            printTAC(&ctx->tacList);
+            printf("\n");
+            phaseEnd(&ctx->stats);
+        }
         
-        /* PHASE 5: Code Generation */
+        if (opts->dumpOptTAC) {
+            if (banners) {
+                printf("┌──────────────────────────────────────────────────────────┐\n");
+                printf("│ PHASE 4: CODE OPTIMIZATION                               │\n");
+                printf("├──────────────────────────────────────────────────────────┤\n");
+                printf("│ Applying optimizations:                                  │\n");
+                printf("│ • Constant folding (evaluate compile-time expressions)   │\n");
+                printf("│ • Copy propagation (replace variables with values)       │\n");
+                printf("└──────────────────────────────────────────────────────────┘\n");
+            }
+            phaseBegin(&ctx->stats, "opt-fold-propagate", "optimize: constant folding/propagation");
+            optimizeTACParallel(&ctx->tacList, &ctx->optimizedList, ctx->pool);
+            phaseEnd(&ctx->stats);
+            phaseBegin(&ctx->stats, "dump-opt-tac", "dump: optimized TAC");
+            printOptimizedTAC(&ctx->optimizedList);
+            printf("\n");
+            phaseEnd(&ctx->stats);
+        }
+    }
+    
+    /* PHASE 5: Code Generation */
+    if (banners) {
         printf("┌──────────────────────────────────────────────────────────┐\n");
         printf("│ PHASE 5: MIPS CODE GENERATION                            │\n");
         printf("├──────────────────────────────────────────────────────────┤\n");
@@ -87,23 +876,314 @@ int main(int argc, char* argv[]) {
         printf("│ • Using $t0-$t7 for temporary values                     │\n");
         printf("│ • System calls for print operations                      │\n");
         printf("└──────────────────────────────────────────────────────────┘\n");
-        generateMIPS(root, argv[2]);
-        printf("✓ MIPS assembly code generated to: %s\n", argv[2]);
+    }
+    char* outputFile = outputName(opts, inputFile);
+    int generated = 1;
+    // A hit replays only the output, so a build that reported anything
+    // (a lexical error does not stop it) is not stored
+    cacheable = cacheable && ctx->errorCount == errorsBefore;
+    if (strcmp(opts->emit, "asm") == 0) {
+        // Functions unchanged since the last build are copied from the
+        // function cache with --incremental (code built for or with a
+        // profile is not)
+        FunctionCache functions = {0};
+        int profiled = ctx->profileGenerate || ctx->profileUse;
+        char* statePath = profiled ? NULL : loadFunctionCache(ctx, opts, &functions);
+        phaseBegin(&ctx->stats, "codegen", "MIPS code generation");
+        TextBuffer text = {0};
+        generated = generateMIPS(ctx, &text);
+        if (generated == 0) {
+            if (cacheable) cacheStore(opts->cache, key, text.data, text.size);
+            generated = writeOutputFile(ctx, outputFile, text.data, text.size);
+        }
+        textFree(&text);
+        phaseEnd(&ctx->stats);
+        if (statePath) saveFunctionCache(ctx, opts, &functions, statePath, generated == 0);
+    } else {
+        // Nothing is written unless the whole image was built
+        phaseBegin(&ctx->stats, "codegen", "MIPS code generation");
+        unsigned char* image = NULL;
+        size_t size = 0;
+        generated = generateMIPSBinary(ctx, opts->bigEndian, strcmp(opts->emit, "exe") == 0, &image, &size);
+        if (generated == 0) {
+            if (cacheable) cacheStore(opts->cache, key, image, size);
+            generated = writeOutputFile(ctx, outputFile, image, size);
+        }
+        free(image);
+        phaseEnd(&ctx->stats);
+    }
+    if (generated != 0) {
+        free(outputFile);
+        return 1;
+    }
+    
+    if (banners) {
+        if (strcmp(opts->emit, "asm") == 0) {
+            printf("✓ MIPS assembly code generated to: %s\n", outputFile);
+        } else {
+            printf("✓ MIPS %s-endian ELF %s written to: %s\n", opts->bigEndian ? "big" : "little",
+                   strcmp(opts->emit, "exe") == 0 ? "executable" : "object", outputFile);
+        }
         printf("\n");
         
         printf("╔════════════════════════════════════════════════════════════╗\n");
         printf("║                  COMPILATION SUCCESSFUL!                   ║\n");
         printf("║         Run the output file in a MIPS simulator            ║\n");
         printf("╚════════════════════════════════════════════════════════════╝\n");
+    }
+    
+    free(outputFile);
+    return 0;
+}
+
+/* --client: the server compiles the file; the output and diagnostics
+ * are handled exactly as for a local compile */
+static int compileRemote(CompilerContext* ctx, const Options* opts) {
+    SourceBuffer source;
+    if (loadSource(ctx->fileName, &source) != 0) {
+        compilerError(ctx, "Error: Cannot open input file '%s'", ctx->fileName);
+        return 1;
+    }
+    ServerRequest request = { ctx->fileName, opts->emit, opts->bigEndian, opts->optLevel,
+                              source.data, source.size };
+    ServerReply reply;
+    int reached = serverCompile(opts->clientSocket, &request, &reply) == 0;
+    freeSource(&source);
+    if (!reached) {
+        compilerError(ctx, "Error: Cannot reach compile server at '%s'", opts->clientSocket);
+        return 1;
+    }
+    
+    fwrite(reply.diagnostics, 1, reply.diagnosticsSize, ctx->diag);
+    ctx->errorCount += reply.errorCount;
+    int result = reply.status != 0;
+    if (!result) {
+        char* outputFile = outputName(opts, ctx->fileName);
+        result = writeOutputFile(ctx, outputFile, reply.output, reply.outputSize);
+        free(outputFile);
+    }
+    freeServerReply(&reply);
+    return result;
+}
+
+/* Compile one file with its own context. When several files are built
+ * the diagnostics go to a memory buffer and are printed in input order,
+ * so the output does not depend on -j. */
+static void runJob(void* arg) {
+    Job* job = arg;
+    FILE* diag = job->buffered ? open_memstream(&job->diagText, &job->diagSize) : NULL;
+    if (diag) job->ctx->diag = diag;
+    
+    if (job->opts->profileUse && !job->opts->jit) {
+        job->ctx->profileUse = profileLoad(job->profileFile, job->ctx->diag);
+        if (!job->ctx->profileUse) {
+            job->result = 1;
+            if (diag) fclose(diag);
+            return;
+        }
+    }
+    
+    if (job->opts->jit) {
+        job->result = runJIT(job->ctx, job->opts);
+    } else if (job->opts->dumpTokens) {
+        job->result = runDumpTokens(job->ctx);
+    } else if (job->opts->clientSocket) {
+        job->result = compileRemote(job->ctx, job->opts);
     } else {
-        printf("✗ Parse failed - check your syntax!\n");
-        printf("Common errors:\n");
-        printf("  • Missing semicolon after statements\n");
-        printf("  • Undeclared variables\n");
-        printf("  • Invalid syntax for print statements\n");
+        job->result = compile(job->ctx, job->opts);
+    }
+    
+    if (diag) fclose(diag);
+}
+
+/* Compile every input, on a thread pool when -j asks for more than one
+ * thread. A single file returns its own result (the exit status of a JIT
+ * run); a build of several returns 1 if any of them failed. */
+static int compileAll(const Options* opts, Stats* total) {
+    int count = opts->inputCount;
+    Job* jobs = calloc(count, sizeof(Job));
+    int threads = opts->jobs < count ? opts->jobs : count;
+    ThreadPool* pool = threads > 1 ? poolCreate(threads) : NULL;
+    // A single file spreads its functions over the threads instead
+    ThreadPool* functionPool = count == 1 && opts->jobs > 1 ? poolCreate(opts->jobs) : NULL;
+    
+    for (int i = 0; i < count; i++) {
+        Job* job = &jobs[i];
+        job->opts = opts;
+        job->ctx = createContext(opts->inputFiles[i]);
+        if (!job->ctx) {
+            fprintf(stderr, "Error: Out of memory\n");
+            exit(1);
+        }
+        if (opts->timeReport || opts->statsJSON) {
+            statsEnable(&job->ctx->stats);
+        }
+        job->ctx->pool = functionPool;
+        job->ctx->optLevel = opts->optLevel;
+        job->ctx->scanner = opts->scanner;
+        job->ctx->prattParser = opts->prattParser;
+        if (opts->profileGenerate || opts->profileUse) {
+            job->profileFile = profileName(opts, opts->inputFiles[i]);
+        }
+        if (opts->profileGenerate) job->ctx->profileGenerate = job->profileFile;
+        job->buffered = count > 1;
+        if (pool) {
+            poolSubmit(pool, runJob, job);
+        } else {
+            runJob(job);
+        }
+    }
+    if (pool) {
+        poolWait(pool);
+        poolDestroy(pool);
+    }
+    poolDestroy(functionPool);
+    
+    int failed = 0;
+    for (int i = 0; i < count; i++) {
+        Job* job = &jobs[i];
+        if (job->diagSize > 0) {
+            fprintf(stderr, "In file '%s':\n", opts->inputFiles[i]);
+            fwrite(job->diagText, 1, job->diagSize, stderr);
+        }
+        free(job->diagText);
+        statsMerge(total, &job->ctx->stats);
+        if (job->result != 0) failed++;
+        profileFree(job->ctx->profileUse);
+        freeContext(job->ctx);
+        free(job->profileFile);
+    }
+    int result = count == 1 ? jobs[0].result : failed != 0;
+    free(jobs);
+    
+    if (count > 1 && failed) {
+        fprintf(stderr, "%d of %d files failed to compile\n", failed, count);
+    }
+    return result;
+}
+
+/* --show-profile: each profile's functions and call sites */
+static int showProfiles(const Options* opts) {
+    int result = 0;
+    for (int i = 0; i < opts->inputCount; i++) {
+        Profile* profile = profileLoad(opts->inputFiles[i], stderr);
+        if (!profile) {
+            result = 1;
+            continue;
+        }
+        if (opts->inputCount > 1) printf("%s:\n", opts->inputFiles[i]);
+        profilePrint(profile, stdout);
+        profileFree(profile);
+    }
+    return result;
+}
+
+/* --sim: run each executable in turn. A single program returns its own
+ * exit status, as with --jit; a program that faults fails the run. */
+static int simulate(const Options* opts) {
+    int result = 0;
+    for (int i = 0; i < opts->inputCount; i++) {
+        const char* file = opts->inputFiles[i];
+        SimResult run;
+        if (mipsSimulateELF(file, stdout, SIM_DEFAULT_MAX_STEPS, &run) != 0) {
+            result = 1;
+            continue;
+        }
+        if (opts->simStats) {
+            fprintf(stderr, "%s:\n", file);
+            fprintf(stderr, "  instructions  %llu\n", (unsigned long long)run.instructions);
+            fprintf(stderr, "  loads         %llu\n", (unsigned long long)run.loads);
+            fprintf(stderr, "  stores        %llu\n", (unsigned long long)run.stores);
+            fprintf(stderr, "  calls         %llu\n", (unsigned long long)run.calls);
+            fprintf(stderr, "  code size     %u\n", run.codeSize);
+            fprintf(stderr, "  exit status   %d\n", run.status);
+        }
+        if (opts->inputCount == 1) result = run.status;
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    // Expand @response files before looking at any option
+    char** args = NULL;
+    int argCount = 0, argCapacity = 0;
+    addArg(&args, &argCount, &argCapacity, argv[0]);
+    for (int i = 1; i < argc; i++) {
+        if (expandArg(argv[i], &args, &argCount, &argCapacity, 0) != 0) return 1;
+    }
+    
+    Options opts;
+    if (parseOptions(argCount, args, &opts) != 0) {
+        usage(argv[0]);
         return 1;
     }
     
-    fclose(yyin);
-    return 0;
-}
\ No newline at end of file
+    if (opts.disasm) {
+        int result = 0;
+        for (int i = 0; i < opts.inputCount; i++) {
+            if (mipsDisassembleELF(opts.inputFiles[i], stdout) != 0) result = 1;
+        }
+        return result;
+    }
+    
+    if (opts.simulate) {
+        return simulate(&opts);
+    }
+    
+    if (opts.showProfile) {
+        return showProfiles(&opts);
+    }
+    
+    if (opts.serverSocket) {
+        return runServer(opts.serverSocket);
+    }
+    
+    // A cache that cannot be set up only costs the speedup
+    CompileCache cache;
+    int cacheOpened = (opts.useCache || opts.cacheStats || opts.incremental) &&
+                      cacheOpen(&cache, opts.cacheDir, opts.cacheMaxSize) == 0;
+    if (opts.useCache && cacheOpened) opts.cache = &cache;
+    if (opts.incremental && cacheOpened) {
+        TextBuffer dir = {0};
+        textAppendf(&dir, "%s/" CACHE_FUNCTION_DIR, cache.dir);
+        if (dir.data && (mkdir(dir.data, 0777) == 0 || errno == EEXIST)) {
+            opts.functionDir = dir.data;
+            opts.functionDirCache = &cache;
+        } else {
+            textFree(&dir);
+        }
+    }
+    if (opts.inputCount == 0) {
+        // Only --cache-stats was given
+        if (cacheOpened) {
+            cachePrintStats(&cache, stdout);
+            cacheClose(&cache);
+        }
+        return cacheOpened ? 0 : 1;
+    }
+    
+    Stats total = {0};
+    int result = compileAll(&opts, &total);
+    
+    if (cacheOpened) {
+        if (opts.cacheStats) cachePrintStats(&cache, stdout);
+        cacheClose(&cache);
+    }
+    free(opts.functionDir);
+    
+    if (opts.timeReport) {
+        printTimeReport(&total, stderr);
+    }
+    if (opts.statsJSON) {
+        FILE* out = opts.statsFile ? fopen(opts.statsFile, "w") : stdout;
+        if (!out) {
+            fprintf(stderr, "Error: Cannot open stats file '%s'\n", opts.statsFile);
+            return 1;
+        }
+        char label[32];
+        snprintf(label, sizeof(label), "%d files", opts.inputCount);
+        writeStatsJSON(&total, out, opts.inputCount == 1 ? opts.inputFiles[0] : label);
+        if (out != stdout) fclose(out);
+    }
+    return result;
+}
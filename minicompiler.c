@@ -0,0 +1,68 @@
+/* MINICOMPILER LIBRARY
+ * mc_compile runs the same phases as the driver (parse, then MIPS code
+ * generation) on a fresh CompilerContext. Diagnostics go to an
+ * open_memstream buffer; assembly text and ELF images are built in
+ * memory anyway and are handed over without a copy.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "minicompiler.h"
+#include "context.h"
+#include "codegen.h"
+
+static int generate(CompilerContext* ctx, const mc_options* options, mc_result* result) {
+    if (options->emit == MC_EMIT_ASM) {
+        // The emitter's buffer becomes the caller's output as is
+        TextBuffer text = {0};
+        int generated = generateMIPS(ctx, &text);
+        result->output = text.data;
+        result->outputSize = text.size;
+        return generated;
+    }
+
+    unsigned char* image = NULL;
+    int generated = generateMIPSBinary(ctx, !options->littleEndian, options->emit == MC_EMIT_EXE,
+                                       &image, &result->outputSize);
+    result->output = (char*)image;
+    return generated;
+}
+
+int mc_compile(const char* src, size_t len, const mc_options* options, mc_result* result) {
+    static const mc_options defaults = { MC_EMIT_ASM, 0, NULL, 0 };
+    if (!options) options = &defaults;
+    memset(result, 0, sizeof(mc_result));
+
+    CompilerContext* ctx = createContext(options->fileName ? options->fileName : "<input>");
+    FILE* diag = open_memstream(&result->diagnostics, &result->diagnosticsSize);
+    if (!ctx || !diag) {
+        if (diag) fclose(diag);
+        freeContext(ctx);
+        result->errorCount = 1;
+        return 1;
+    }
+    ctx->diag = diag;
+    ctx->optLevel = options->optLevel;
+
+    int failed = parseString(ctx, src, len) != 0 || generate(ctx, options, result) != 0;
+
+    result->errorCount = ctx->errorCount;
+    fclose(diag);
+    freeContext(ctx);
+
+    // Partial output is of no use to the caller
+    if (failed) {
+        free(result->output);
+        result->output = NULL;
+        result->outputSize = 0;
+        if (result->errorCount == 0) result->errorCount = 1;
+    }
+    return failed;
+}
+
+void mc_result_free(mc_result* result) {
+    if (!result) return;
+    free(result->output);
+    free(result->diagnostics);
+    memset(result, 0, sizeof(mc_result));
+}
@@ -0,0 +1,51 @@
+#ifndef MINICOMPILER_H
+#define MINICOMPILER_H
+
+/* MINICOMPILER LIBRARY
+ * Public interface of libminicompiler.a / libminicompiler.so for
+ * programs that embed the compiler. Source and output stay in memory:
+ * nothing is read from or written to disk. Every call has its own
+ * compiler state, so threads may compile at the same time.
+ */
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* What mc_compile produces */
+typedef enum {
+    MC_EMIT_ASM,            // MIPS assembly text (SPIM format)
+    MC_EMIT_OBJ,            // ELF32 relocatable object
+    MC_EMIT_EXE             // ELF32 executable
+} mc_emit;
+
+/* Compile options. All zero (or a NULL pointer) means big-endian,
+ * unoptimized assembly with diagnostics against "<input>". */
+typedef struct {
+    mc_emit emit;
+    int littleEndian;       // Byte order of ELF output
+    const char* fileName;   // Name used in diagnostics
+    int optLevel;           // 0 or 1, as -O0/-O1
+} mc_options;
+
+/* Everything mc_compile returns. Release with mc_result_free. */
+typedef struct {
+    char* output;           // Assembly text or ELF image, NULL on failure
+    size_t outputSize;      // Bytes in output (text is also NUL-terminated)
+    char* diagnostics;      // Error messages, one per line ("" if none)
+    size_t diagnosticsSize;
+    int errorCount;
+} mc_result;
+
+/* Compile len bytes of source. Returns 0 on success and nonzero if the
+ * program has errors or memory ran out; the result is filled in either
+ * way. */
+int mc_compile(const char* src, size_t len, const mc_options* options, mc_result* result);
+void mc_result_free(mc_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
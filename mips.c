@@ -0,0 +1,918 @@
+/* MIPS32 ENCODER, ELF32 WRITER AND DISASSEMBLER
+ * Lets the code generator produce machine code directly instead of text
+ * assembly that another tool has to re-parse. Pseudo-instructions are
+ * expanded the same way an assembler would (li -> addiu/ori/lui+ori,
+ * la -> lui+addiu, move -> addu, large offsets through $at) and jal/jr
+ * get a nop in their branch delay slot. The disassembler folds those expansions back, so
+ * its output lines up with the text path instruction for instruction.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mips.h"
+
+#define TEXT_BASE 0x00400000    // SPIM/MARS text segment address
+#define DATA_BASE 0x10010000    // SPIM/MARS data segment address
+#define PAGE_SIZE 0x1000
+
+/* ELF constants (see the System V ABI, MIPS supplement) */
+#define ET_REL 1
+#define ET_EXEC 2
+#define EM_MIPS 8
+#define EF_MIPS_ABI_O32 0x00001000
+#define EF_MIPS_ARCH_32 0x50000000
+#define SHT_PROGBITS 1
+#define SHT_SYMTAB 2
+#define SHT_STRTAB 3
+#define SHT_REL 9
+#define SHF_WRITE 0x1
+#define SHF_ALLOC 0x2
+#define SHF_EXECINSTR 0x4
+#define STB_LOCAL 0
+#define STB_GLOBAL 1
+#define STT_OBJECT 1
+#define STT_FUNC 2
+#define STT_SECTION 3
+#define PT_LOAD 1
+#define PF_X 1
+#define PF_W 2
+#define PF_R 4
+#define R_MIPS_26 4
+#define R_MIPS_HI16 5
+#define R_MIPS_LO16 6
+
+static const char* regNames[32] = {
+    "$zero", "$at", "$v0", "$v1", "$a0", "$a1", "$a2", "$a3",
+    "$t0", "$t1", "$t2", "$t3", "$t4", "$t5", "$t6", "$t7",
+    "$s0", "$s1", "$s2", "$s3", "$s4", "$s5", "$s6", "$s7",
+    "$t8", "$t9", "$k0", "$k1", "$gp", "$sp", "$fp", "$ra"
+};
+
+static const unsigned char regNameLengths[32] = {
+    5, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3
+};
+
+static int validRegister(int reg) {
+    return reg >= 0 && reg < 32;
+}
+
+int mipsValidRegisters(const MipsInstr* instr) {
+    return validRegister(instr->rd) && validRegister(instr->rs) && validRegister(instr->rt);
+}
+
+const char* mipsRegName(int reg) {
+    return validRegister(reg) ? regNames[reg] : NULL;
+}
+
+// An invalid register is spelled so that no assembler accepts it
+static void appendReg(TextBuffer* out, int reg) {
+    if (!validRegister(reg)) {
+        textAppendf(out, "$invalid%d", reg);
+        return;
+    }
+    textAppend(out, regNames[reg], regNameLengths[reg]);
+}
+
+// Mnemonic followed by a space
+static void appendOp(TextBuffer* out, const char* name) {
+    textAppendString(out, name);
+    textAppendChar(out, ' ');
+}
+
+static void appendSeparator(TextBuffer* out) {
+    textAppend(out, ", ", 2);
+}
+
+/* Append the assembler form of one instruction, without indentation or
+ * newline. This is the emitter's hot path, so nothing here goes through
+ * printf. */
+void mipsAppendInstr(TextBuffer* out, const MipsInstr* instr) {
+    switch (instr->op) {
+        case MIPS_ADD:
+        case MIPS_SUB:
+        case MIPS_MUL:
+            appendOp(out, instr->op == MIPS_ADD ? "add" : instr->op == MIPS_SUB ? "sub" : "mul");
+            appendReg(out, instr->rd);
+            appendSeparator(out);
+            appendReg(out, instr->rs);
+            appendSeparator(out);
+            appendReg(out, instr->rt);
+            break;
+        case MIPS_ADDI:
+        case MIPS_ADDIU:
+            appendOp(out, instr->op == MIPS_ADDI ? "addi" : "addiu");
+            appendReg(out, instr->rt);
+            appendSeparator(out);
+            appendReg(out, instr->rs);
+            appendSeparator(out);
+            textAppendInt(out, instr->imm);
+            break;
+        case MIPS_SLL:
+            appendOp(out, "sll");
+            appendReg(out, instr->rd);
+            appendSeparator(out);
+            appendReg(out, instr->rt);
+            appendSeparator(out);
+            textAppendInt(out, instr->imm);
+            break;
+        case MIPS_LW:
+        case MIPS_SW:
+            appendOp(out, instr->op == MIPS_LW ? "lw" : "sw");
+            appendReg(out, instr->rt);
+            appendSeparator(out);
+            textAppendInt(out, instr->imm);
+            textAppendChar(out, '(');
+            appendReg(out, instr->rs);
+            textAppendChar(out, ')');
+            break;
+        case MIPS_LI:
+            appendOp(out, "li");
+            appendReg(out, instr->rt);
+            appendSeparator(out);
+            textAppendInt(out, instr->imm);
+            break;
+        case MIPS_MOVE:
+            appendOp(out, "move");
+            appendReg(out, instr->rd);
+            appendSeparator(out);
+            appendReg(out, instr->rs);
+            break;
+        case MIPS_LA:
+            appendOp(out, "la");
+            appendReg(out, instr->rt);
+            appendSeparator(out);
+            if (instr->label) {
+                textAppendString(out, instr->label);
+            } else {
+                textAppendf(out, "0x%x", (unsigned)instr->imm);
+            }
+            break;
+        case MIPS_JAL:
+            if (instr->label) {
+                appendOp(out, "jal");
+                textAppendString(out, instr->label);
+            } else {
+                textAppendf(out, "jal 0x%x", (unsigned)instr->imm);
+            }
+            break;
+        case MIPS_JR:
+            appendOp(out, "jr");
+            appendReg(out, instr->rs);
+            break;
+        case MIPS_SYSCALL:
+            textAppendString(out, "syscall");
+            break;
+        case MIPS_NOP:
+            textAppendString(out, "nop");
+            break;
+    }
+}
+
+void mipsFormatInstr(const MipsInstr* instr, char* buf, size_t size) {
+    TextBuffer text = {0};
+    mipsAppendInstr(&text, instr);
+    snprintf(buf, size, "%s", text.data ? text.data : "");
+    textFree(&text);
+}
+
+/* ============ ENCODING ============ */
+
+static uint32_t encodeR(int rs, int rt, int rd, int sa, int funct) {
+    return ((uint32_t)rs << 21) | ((uint32_t)rt << 16) | ((uint32_t)rd << 11) |
+           ((uint32_t)sa << 6) | (uint32_t)funct;
+}
+
+static uint32_t encodeI(int opcode, int rs, int rt, int imm) {
+    return ((uint32_t)opcode << 26) | ((uint32_t)rs << 21) | ((uint32_t)rt << 16) |
+           ((uint32_t)imm & 0xFFFF);
+}
+
+static int fitsInt16(int value) {
+    return value >= -32768 && value <= 32767;
+}
+
+MipsAsm* mipsAsmCreate() {
+    MipsAsm* as = calloc(1, sizeof(MipsAsm));
+    as->diag = stderr;
+    return as;
+}
+
+static void emitWord(MipsAsm* as, uint32_t word) {
+    if (as->count == as->capacity) {
+        as->capacity = as->capacity ? as->capacity * 2 : 1024;
+        as->text = realloc(as->text, as->capacity * sizeof(uint32_t));
+    }
+    as->text[as->count++] = word;
+}
+
+static MipsSymbol* addSymbol(MipsAsm* as, const char* name) {
+    if (as->symbolCount == as->symbolCapacity) {
+        as->symbolCapacity = as->symbolCapacity ? as->symbolCapacity * 2 : 32;
+        as->symbols = realloc(as->symbols, as->symbolCapacity * sizeof(MipsSymbol));
+    }
+    MipsSymbol* sym = &as->symbols[as->symbolCount++];
+    memset(sym, 0, sizeof(MipsSymbol));
+    sym->name = strdup(name);
+    return sym;
+}
+
+void mipsAsmLabel(MipsAsm* as, const char* name, int global) {
+    MipsSymbol* sym = addSymbol(as, name);
+    sym->offset = as->count * 4;
+    sym->global = global;
+}
+
+static void addReloc(MipsAsm* as, const char* label, int type) {
+    if (as->relocCount == as->relocCapacity) {
+        as->relocCapacity = as->relocCapacity ? as->relocCapacity * 2 : 32;
+        as->relocs = realloc(as->relocs, as->relocCapacity * sizeof(MipsReloc));
+    }
+    as->relocs[as->relocCount].offset = as->count * 4;
+    as->relocs[as->relocCount].label = strdup(label);
+    as->relocs[as->relocCount].type = type;
+    as->relocCount++;
+}
+
+/* The data section is built in order: label, then the words and
+ * strings that follow it */
+static void putData(MipsAsm* as, const void* bytes, size_t n) {
+    if (as->dataSize + n > as->dataCapacity) {
+        size_t capacity = as->dataCapacity ? as->dataCapacity : 256;
+        while (capacity < as->dataSize + n) capacity *= 2;
+        as->data = realloc(as->data, capacity);
+        as->dataCapacity = capacity;
+    }
+    memcpy(as->data + as->dataSize, bytes, n);
+    as->dataSize += n;
+}
+
+void mipsAsmDataLabel(MipsAsm* as, const char* name) {
+    MipsSymbol* sym = addSymbol(as, name);
+    sym->offset = as->dataSize;
+    sym->data = 1;
+}
+
+void mipsAsmDataWord(MipsAsm* as, uint32_t value) {
+    unsigned char b[4];
+    for (int i = 0; i < 4; i++) {
+        int shift = as->bigEndian ? (3 - i) * 8 : i * 8;
+        b[i] = (value >> shift) & 0xFF;
+    }
+    putData(as, b, 4);
+}
+
+// NUL-terminated, like .asciiz
+void mipsAsmDataString(MipsAsm* as, const char* text) {
+    putData(as, text, strlen(text) + 1);
+}
+
+// Pad to a word boundary, like .align 2
+void mipsAsmDataAlign(MipsAsm* as) {
+    static const unsigned char zeros[4] = {0};
+    putData(as, zeros, (4 - as->dataSize % 4) % 4);
+}
+
+void mipsAsmEmit(MipsAsm* as, const MipsInstr* instr) {
+    if (!mipsValidRegisters(instr)) {
+        fprintf(as->diag, "Internal error: instruction with register %d, %d or %d\n",
+                instr->rd, instr->rs, instr->rt);
+        as->invalid = 1;
+        return;
+    }
+    switch (instr->op) {
+        case MIPS_ADD:
+            emitWord(as, encodeR(instr->rs, instr->rt, instr->rd, 0, 0x20));
+            break;
+        case MIPS_SUB:
+            emitWord(as, encodeR(instr->rs, instr->rt, instr->rd, 0, 0x22));
+            break;
+        case MIPS_MUL:
+            emitWord(as, (0x1Cu << 26) | encodeR(instr->rs, instr->rt, instr->rd, 0, 0x02));
+            break;
+        case MIPS_ADDI:
+            if (fitsInt16(instr->imm)) {
+                emitWord(as, encodeI(0x08, instr->rs, instr->rt, instr->imm));
+            } else {
+                // lui/ori the constant into $at, then add
+                emitWord(as, encodeI(0x0F, 0, REG_AT, (instr->imm >> 16) & 0xFFFF));
+                emitWord(as, encodeI(0x0D, REG_AT, REG_AT, instr->imm & 0xFFFF));
+                emitWord(as, encodeR(instr->rs, REG_AT, instr->rt, 0, 0x20));
+            }
+            break;
+        case MIPS_ADDIU:
+            emitWord(as, encodeI(0x09, instr->rs, instr->rt, instr->imm));
+            break;
+        case MIPS_SLL:
+            emitWord(as, encodeR(0, instr->rt, instr->rd, instr->imm & 31, 0x00));
+            break;
+        case MIPS_LW:
+        case MIPS_SW: {
+            int opcode = instr->op == MIPS_LW ? 0x23 : 0x2B;
+            if (fitsInt16(instr->imm)) {
+                emitWord(as, encodeI(opcode, instr->rs, instr->rt, instr->imm));
+            } else {
+                // High half (rounded for the signed low half) goes through $at
+                int hi = (instr->imm + 0x8000) >> 16;
+                int lo = instr->imm - hi * 65536;
+                emitWord(as, encodeI(0x0F, 0, REG_AT, hi & 0xFFFF));
+                emitWord(as, encodeR(REG_AT, instr->rs, REG_AT, 0, 0x21));
+                emitWord(as, encodeI(opcode, REG_AT, instr->rt, lo));
+            }
+            break;
+        }
+        case MIPS_LI:
+            if (fitsInt16(instr->imm)) {
+                emitWord(as, encodeI(0x09, REG_ZERO, instr->rt, instr->imm));
+            } else if (instr->imm >= 0 && instr->imm <= 0xFFFF) {
+                emitWord(as, encodeI(0x0D, REG_ZERO, instr->rt, instr->imm));
+            } else {
+                emitWord(as, encodeI(0x0F, 0, instr->rt, (instr->imm >> 16) & 0xFFFF));
+                emitWord(as, encodeI(0x0D, instr->rt, instr->rt, instr->imm & 0xFFFF));
+            }
+            break;
+        case MIPS_MOVE:
+            emitWord(as, encodeR(instr->rs, REG_ZERO, instr->rd, 0, 0x21));
+            break;
+        case MIPS_LA:
+            // lui/addiu, both halves filled in by mipsBuildELF
+            addReloc(as, instr->label, MIPS_LA);
+            emitWord(as, encodeI(0x0F, 0, instr->rt, 0));
+            emitWord(as, encodeI(0x09, instr->rt, instr->rt, 0));
+            break;
+        case MIPS_JAL:
+            addReloc(as, instr->label, MIPS_JAL);
+            emitWord(as, 0x03u << 26);
+            emitWord(as, 0);
+            break;
+        case MIPS_JR:
+            emitWord(as, encodeR(instr->rs, 0, 0, 0, 0x08));
+            emitWord(as, 0);
+            break;
+        case MIPS_SYSCALL:
+            emitWord(as, 0x0000000C);
+            break;
+        case MIPS_NOP:
+            emitWord(as, 0);
+            break;
+    }
+}
+
+void mipsAsmFree(MipsAsm* as) {
+    if (!as) return;
+    for (int i = 0; i < as->symbolCount; i++) free(as->symbols[i].name);
+    for (int i = 0; i < as->relocCount; i++) free(as->relocs[i].label);
+    free(as->symbols);
+    free(as->relocs);
+    free(as->text);
+    free(as->data);
+    free(as);
+}
+
+/* ============ ELF32 OUTPUT ============ */
+
+/* Growable byte buffer that writes multi-byte values in target order */
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+    int bigEndian;
+} ByteBuf;
+
+static void bufReserve(ByteBuf* buf, size_t extra) {
+    if (buf->size + extra > buf->capacity) {
+        size_t capacity = buf->capacity ? buf->capacity : 256;
+        while (capacity < buf->size + extra) capacity *= 2;
+        buf->data = realloc(buf->data, capacity);
+        buf->capacity = capacity;
+    }
+}
+
+static void bufPut(ByteBuf* buf, const void* bytes, size_t n) {
+    bufReserve(buf, n);
+    memcpy(buf->data + buf->size, bytes, n);
+    buf->size += n;
+}
+
+static void bufPut8(ByteBuf* buf, unsigned value) {
+    unsigned char b = value & 0xFF;
+    bufPut(buf, &b, 1);
+}
+
+static void bufPut16(ByteBuf* buf, unsigned value) {
+    unsigned char b[2];
+    if (buf->bigEndian) {
+        b[0] = (value >> 8) & 0xFF; b[1] = value & 0xFF;
+    } else {
+        b[0] = value & 0xFF; b[1] = (value >> 8) & 0xFF;
+    }
+    bufPut(buf, b, 2);
+}
+
+static void bufPut32(ByteBuf* buf, uint32_t value) {
+    unsigned char b[4];
+    for (int i = 0; i < 4; i++) {
+        int shift = buf->bigEndian ? (3 - i) * 8 : i * 8;
+        b[i] = (value >> shift) & 0xFF;
+    }
+    bufPut(buf, b, 4);
+}
+
+static void bufPadTo(ByteBuf* buf, size_t offset) {
+    while (buf->size < offset) bufPut8(buf, 0);
+}
+
+static size_t alignUp(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+/* Add a name to a string table, returning its offset */
+static uint32_t addString(ByteBuf* strtab, const char* name) {
+    uint32_t offset = strtab->size;
+    bufPut(strtab, name, strlen(name) + 1);
+    return offset;
+}
+
+/* Section header contents, gathered before layout */
+typedef struct {
+    const char* name;
+    uint32_t type;
+    uint32_t flags;
+    uint32_t addr;
+    ByteBuf* content;
+    uint32_t link;
+    uint32_t info;
+    uint32_t align;
+    uint32_t entsize;
+    uint32_t nameOffset;
+    uint32_t offset;
+} Section;
+
+static void putSymbol(ByteBuf* symtab, uint32_t name, uint32_t value, int bind, int type, int shndx) {
+    bufPut32(symtab, name);
+    bufPut32(symtab, value);
+    bufPut32(symtab, 0);
+    bufPut8(symtab, (bind << 4) | type);
+    bufPut8(symtab, 0);
+    bufPut16(symtab, shndx);
+}
+
+static MipsSymbol* findLabel(MipsAsm* as, const char* name) {
+    for (int i = 0; i < as->symbolCount; i++) {
+        if (strcmp(as->symbols[i].name, name) == 0) {
+            return &as->symbols[i];
+        }
+    }
+    return NULL;
+}
+
+/* Lay out the ELF file in memory. On success *image is a malloc'd
+ * buffer of *size bytes owned by the caller. */
+int mipsBuildELF(MipsAsm* as, int bigEndian, int executable, unsigned char** image, size_t* size) {
+    ByteBuf text = {0}, data = {0}, rel = {0}, symtab = {0}, strtab = {0}, shstrtab = {0}, file = {0};
+    text.bigEndian = rel.bigEndian = symtab.bigEndian = file.bigEndian = bigEndian;
+    uint32_t textAddr = executable ? TEXT_BASE : 0;
+    uint32_t dataAddr = executable ? DATA_BASE : 0;
+    int hasData = as->dataSize > 0;
+    int failed = as->invalid;
+
+    // Symbol/section indices are fixed by the layout below; .data only
+    // exists when something was put there
+    int textIndex = 1;
+    int dataIndex = hasData ? 2 : 0;
+    int symtabIndex = 2 + hasData + !executable;
+    int strtabIndex = symtabIndex + 1;
+    int dataSymbol = 2;     // Section symbols: 1 is .text, 2 is .data
+
+    // Resolve jal and la: absolute for executables, section-relative with
+    // R_MIPS_26 or R_MIPS_HI16/LO16 relocations for objects
+    for (int i = 0; i < as->relocCount; i++) {
+        MipsReloc* reloc = &as->relocs[i];
+        MipsSymbol* target = findLabel(as, reloc->label);
+        if (!target || target->data != (reloc->type == MIPS_LA)) {
+            fprintf(as->diag, "Error: %s label %s\n", target ? "Misused" : "Undefined", reloc->label);
+            failed = 1;
+            continue;
+        }
+        uint32_t* word = &as->text[reloc->offset / 4];
+        if (reloc->type == MIPS_JAL) {
+            *word = (*word & 0xFC000000) | (((textAddr + target->offset) >> 2) & 0x03FFFFFF);
+            if (!executable) {
+                bufPut32(&rel, reloc->offset);
+                bufPut32(&rel, (1u << 8) | R_MIPS_26);
+            }
+            continue;
+        }
+        // High half rounded for the signed addiu, as %hi/%lo do
+        uint32_t addr = dataAddr + target->offset;
+        word[0] = (word[0] & 0xFFFF0000) | (((addr + 0x8000) >> 16) & 0xFFFF);
+        word[1] = (word[1] & 0xFFFF0000) | (addr & 0xFFFF);
+        if (!executable) {
+            bufPut32(&rel, reloc->offset);
+            bufPut32(&rel, ((uint32_t)dataSymbol << 8) | R_MIPS_HI16);
+            bufPut32(&rel, reloc->offset + 4);
+            bufPut32(&rel, ((uint32_t)dataSymbol << 8) | R_MIPS_LO16);
+        }
+    }
+    if (failed) return -1;
+
+    for (int i = 0; i < as->count; i++) {
+        bufPut32(&text, as->text[i]);
+    }
+    if (hasData) bufPut(&data, as->data, as->dataSize);
+
+    // Symbols: null, section symbols, locals, then globals
+    addString(&strtab, "");
+    putSymbol(&symtab, 0, 0, STB_LOCAL, 0, 0);
+    putSymbol(&symtab, 0, textAddr, STB_LOCAL, STT_SECTION, textIndex);
+    int firstGlobal = 2;
+    if (hasData) {
+        putSymbol(&symtab, 0, dataAddr, STB_LOCAL, STT_SECTION, dataIndex);
+        firstGlobal++;
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < as->symbolCount; i++) {
+            MipsSymbol* sym = &as->symbols[i];
+            if (sym->global != pass) continue;
+            uint32_t name = addString(&strtab, sym->name);
+            if (sym->data) {
+                putSymbol(&symtab, name, dataAddr + sym->offset,
+                          sym->global ? STB_GLOBAL : STB_LOCAL, STT_OBJECT, dataIndex);
+            } else {
+                putSymbol(&symtab, name, textAddr + sym->offset,
+                          sym->global ? STB_GLOBAL : STB_LOCAL, STT_FUNC, textIndex);
+            }
+            if (!pass) firstGlobal++;
+        }
+    }
+
+    Section sections[7];
+    int sectionCount = 0;
+    memset(sections, 0, sizeof(sections));
+    sectionCount++;     // SHN_UNDEF
+    sections[sectionCount++] = (Section){ ".text", SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR,
+                                          textAddr, &text, 0, 0, 4, 0, 0, 0 };
+    if (hasData) {
+        sections[sectionCount++] = (Section){ ".data", SHT_PROGBITS, SHF_ALLOC | SHF_WRITE,
+                                              dataAddr, &data, 0, 0, 4, 0, 0, 0 };
+    }
+    if (!executable) {
+        sections[sectionCount++] = (Section){ ".rel.text", SHT_REL, 0, 0, &rel,
+                                              symtabIndex, textIndex, 4, 8, 0, 0 };
+    }
+    sections[sectionCount++] = (Section){ ".symtab", SHT_SYMTAB, 0, 0, &symtab,
+                                          strtabIndex, firstGlobal, 4, 16, 0, 0 };
+    sections[sectionCount++] = (Section){ ".strtab", SHT_STRTAB, 0, 0, &strtab, 0, 0, 1, 0, 0, 0 };
+    sections[sectionCount++] = (Section){ ".shstrtab", SHT_STRTAB, 0, 0, &shstrtab, 0, 0, 1, 0, 0, 0 };
+
+    addString(&shstrtab, "");
+    for (int i = 1; i < sectionCount; i++) {
+        sections[i].nameOffset = addString(&shstrtab, sections[i].name);
+    }
+
+    // Layout: header, program header, sections, section header table
+    int phnum = executable ? 1 + hasData : 0;
+    size_t offset = 52 + phnum * 32;
+    for (int i = 1; i < sectionCount; i++) {
+        // Loadable sections start on a page boundary so they can be mapped
+        int loaded = i == textIndex || (hasData && i == dataIndex);
+        size_t align = (executable && loaded) ? PAGE_SIZE : sections[i].align;
+        offset = alignUp(offset, align);
+        sections[i].offset = offset;
+        offset += sections[i].content->size;
+    }
+    size_t shoff = alignUp(offset, 4);
+
+    MipsSymbol* mainSym = findLabel(as, "main");
+    uint32_t entry = executable && mainSym ? textAddr + mainSym->offset : 0;
+
+    // ELF header
+    unsigned char ident[16] = { 0x7F, 'E', 'L', 'F', 1, bigEndian ? 2 : 1, 1 };
+    bufPut(&file, ident, sizeof(ident));
+    bufPut16(&file, executable ? ET_EXEC : ET_REL);
+    bufPut16(&file, EM_MIPS);
+    bufPut32(&file, 1);
+    bufPut32(&file, entry);
+    bufPut32(&file, phnum ? 52 : 0);
+    bufPut32(&file, shoff);
+    bufPut32(&file, EF_MIPS_ARCH_32 | EF_MIPS_ABI_O32);
+    bufPut16(&file, 52);
+    bufPut16(&file, 32);
+    bufPut16(&file, phnum);
+    bufPut16(&file, 40);
+    bufPut16(&file, sectionCount);
+    bufPut16(&file, sectionCount - 1);
+
+    if (executable) {
+        bufPut32(&file, PT_LOAD);
+        bufPut32(&file, sections[textIndex].offset);
+        bufPut32(&file, textAddr);
+        bufPut32(&file, textAddr);
+        bufPut32(&file, text.size);
+        bufPut32(&file, text.size);
+        bufPut32(&file, PF_R | PF_X);
+        bufPut32(&file, PAGE_SIZE);
+    }
+    if (executable && hasData) {
+        bufPut32(&file, PT_LOAD);
+        bufPut32(&file, sections[dataIndex].offset);
+        bufPut32(&file, dataAddr);
+        bufPut32(&file, dataAddr);
+        bufPut32(&file, data.size);
+        bufPut32(&file, data.size);
+        bufPut32(&file, PF_R | PF_W);
+        bufPut32(&file, PAGE_SIZE);
+    }
+
+    for (int i = 1; i < sectionCount; i++) {
+        bufPadTo(&file, sections[i].offset);
+        bufPut(&file, sections[i].content->data, sections[i].content->size);
+    }
+
+    bufPadTo(&file, shoff);
+    for (int i = 0; i < sectionCount; i++) {
+        Section* s = &sections[i];
+        bufPut32(&file, s->nameOffset);
+        bufPut32(&file, s->type);
+        bufPut32(&file, s->flags);
+        bufPut32(&file, s->addr);
+        bufPut32(&file, s->offset);
+        bufPut32(&file, s->content ? s->content->size : 0);
+        bufPut32(&file, s->link);
+        bufPut32(&file, s->info);
+        bufPut32(&file, s->align);
+        bufPut32(&file, s->entsize);
+    }
+
+    *image = file.data;
+    *size = file.size;
+
+    free(text.data);
+    free(data.data);
+    free(rel.data);
+    free(symtab.data);
+    free(strtab.data);
+    free(shstrtab.data);
+    return 0;
+}
+
+/* ============ DISASSEMBLY ============ */
+
+/* Decode the instruction at words[index], folding the multi-word
+ * expansions produced by mipsAsmEmit. Returns the number of words
+ * consumed, or 0 if the word is not one the code generator emits. */
+int mipsDecode(const uint32_t* words, int count, int index, MipsInstr* instr) {
+    uint32_t w = words[index];
+    int opcode = w >> 26;
+    int rs = (w >> 21) & 31;
+    int rt = (w >> 16) & 31;
+    int rd = (w >> 11) & 31;
+    int sa = (w >> 6) & 31;
+    int funct = w & 63;
+    int imm = (int16_t)(w & 0xFFFF);
+    uint32_t uimm = w & 0xFFFF;
+
+    memset(instr, 0, sizeof(MipsInstr));
+
+    if (w == 0) {
+        instr->op = MIPS_NOP;
+        return 1;
+    }
+
+    switch (opcode) {
+        case 0x00:
+            instr->rd = rd;
+            instr->rs = rs;
+            instr->rt = rt;
+            switch (funct) {
+                case 0x20: instr->op = MIPS_ADD; return 1;
+                case 0x22: instr->op = MIPS_SUB; return 1;
+                case 0x21:
+                    if (rt != REG_ZERO) return 0;
+                    instr->op = MIPS_MOVE;
+                    return 1;
+                case 0x00:
+                    instr->op = MIPS_SLL;
+                    instr->imm = sa;
+                    return 1;
+                case 0x08: instr->op = MIPS_JR; return 1;
+                case 0x0C: instr->op = MIPS_SYSCALL; return 1;
+            }
+            return 0;
+
+        case 0x1C:
+            if (funct != 0x02) return 0;
+            instr->op = MIPS_MUL;
+            instr->rd = rd;
+            instr->rs = rs;
+            instr->rt = rt;
+            return 1;
+
+        case 0x08:
+            instr->op = MIPS_ADDI;
+            instr->rt = rt;
+            instr->rs = rs;
+            instr->imm = imm;
+            return 1;
+
+        case 0x09:
+            if (rs != REG_ZERO) {
+                instr->op = MIPS_ADDIU;
+                instr->rt = rt;
+                instr->rs = rs;
+                instr->imm = imm;
+                return 1;
+            }
+            // fall through
+        case 0x0D:
+            if (rs != REG_ZERO) return 0;
+            instr->op = MIPS_LI;
+            instr->rt = rt;
+            instr->imm = opcode == 0x09 ? imm : (int)uimm;
+            return 1;
+
+        case 0x0F: {
+            // lui starts a li, la, addi or lw/sw expansion
+            if (index + 1 >= count) return 0;
+            uint32_t next = words[index + 1];
+            int nextOp = next >> 26;
+            int nextRs = (next >> 21) & 31;
+            int nextRt = (next >> 16) & 31;
+            int32_t high = (int32_t)(uimm << 16);
+
+            if (nextOp == 0x0D && nextRs == rt && nextRt == rt && rt != REG_AT) {
+                instr->op = MIPS_LI;
+                instr->rt = rt;
+                instr->imm = high | (next & 0xFFFF);
+                return 2;
+            }
+            if (nextOp == 0x09 && nextRs == rt && nextRt == rt && rt != REG_AT) {
+                instr->op = MIPS_LA;
+                instr->rt = rt;
+                instr->imm = high + (int16_t)(next & 0xFFFF);
+                return 2;
+            }
+            if (rt != REG_AT || index + 2 >= count) return 0;
+            uint32_t last = words[index + 2];
+
+            if (nextOp == 0x0D && nextRs == REG_AT && nextRt == REG_AT &&
+                (last >> 26) == 0 && (last & 63) == 0x20 && ((last >> 16) & 31) == REG_AT) {
+                instr->op = MIPS_ADDI;
+                instr->rt = (last >> 11) & 31;
+                instr->rs = (last >> 21) & 31;
+                instr->imm = high | (next & 0xFFFF);
+                return 3;
+            }
+            if (nextOp == 0 && (next & 63) == 0x21 && nextRs == REG_AT &&
+                ((next >> 11) & 31) == REG_AT &&
+                ((last >> 26) == 0x23 || (last >> 26) == 0x2B) && ((last >> 21) & 31) == REG_AT) {
+                instr->op = (last >> 26) == 0x23 ? MIPS_LW : MIPS_SW;
+                instr->rt = (last >> 16) & 31;
+                instr->rs = nextRt;
+                instr->imm = high + (int16_t)(last & 0xFFFF);
+                return 3;
+            }
+            return 0;
+        }
+
+        case 0x23:
+        case 0x2B:
+            instr->op = opcode == 0x23 ? MIPS_LW : MIPS_SW;
+            instr->rt = rt;
+            instr->rs = rs;
+            instr->imm = imm;
+            return 1;
+
+        case 0x03:
+            instr->op = MIPS_JAL;
+            instr->imm = w & 0x03FFFFFF;
+            return 1;
+    }
+    return 0;
+}
+
+/* Read-side helpers for ELF files of either byte order */
+static uint32_t get16(const unsigned char* p, int bigEndian) {
+    return bigEndian ? (p[0] << 8) | p[1] : p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const unsigned char* p, int bigEndian) {
+    return bigEndian ? ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]
+                     : p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Name of the symbol of section shndx at value
+static const char* symbolAt(const unsigned char* image, size_t symOff, size_t symSize,
+                            size_t strOff, int bigEndian, int shndx, uint32_t value) {
+    for (size_t off = symOff; off + 16 <= symOff + symSize; off += 16) {
+        const unsigned char* sym = image + off;
+        int type = sym[12] & 0xF;
+        if (type == STT_SECTION || get32(sym, bigEndian) == 0) continue;
+        if ((int)get16(sym + 14, bigEndian) != shndx) continue;
+        if (get32(sym + 4, bigEndian) == value) {
+            return (const char*)image + strOff + get32(sym, bigEndian);
+        }
+    }
+    return NULL;
+}
+
+/* Print the text section of an ELF file in the same form the text
+ * code generator uses: "label:" lines and indented instructions */
+int mipsDisassembleELF(const char* filename, FILE* out) {
+    FILE* in = fopen(filename, "rb");
+    if (!in) {
+        fprintf(stderr, "Error: Cannot open input file '%s'\n", filename);
+        return -1;
+    }
+    fseek(in, 0, SEEK_END);
+    long fileSize = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    unsigned char* image = malloc(fileSize > 0 ? fileSize : 1);
+    size_t got = fread(image, 1, fileSize, in);
+    fclose(in);
+
+    if (fileSize < 52 || got != (size_t)fileSize || memcmp(image, "\x7F" "ELF", 4) != 0 ||
+        image[4] != 1) {
+        fprintf(stderr, "Error: '%s' is not an ELF32 file\n", filename);
+        free(image);
+        return -1;
+    }
+    int bigEndian = image[5] == 2;
+    int executable = get16(image + 16, bigEndian) == ET_EXEC;
+    if (get16(image + 18, bigEndian) != EM_MIPS) {
+        fprintf(stderr, "Error: '%s' is not a MIPS file\n", filename);
+        free(image);
+        return -1;
+    }
+
+    uint32_t shoff = get32(image + 32, bigEndian);
+    int shnum = get16(image + 48, bigEndian);
+    int shstrndx = get16(image + 50, bigEndian);
+    if (shoff + (size_t)shnum * 40 > (size_t)fileSize || shstrndx >= shnum) {
+        fprintf(stderr, "Error: '%s' has a bad section table\n", filename);
+        free(image);
+        return -1;
+    }
+
+    const unsigned char* shstr = image + shoff + shstrndx * 40;
+    size_t shstrOff = get32(shstr + 16, bigEndian);
+    size_t textOff = 0, textSize = 0, symOff = 0, symSize = 0, strOff = 0;
+    uint32_t textAddr = 0;
+    int textIndex = 0, dataIndex = 0;
+    for (int i = 0; i < shnum; i++) {
+        const unsigned char* sh = image + shoff + i * 40;
+        const char* name = (const char*)image + shstrOff + get32(sh, bigEndian);
+        uint32_t type = get32(sh + 4, bigEndian);
+        if (strcmp(name, ".data") == 0) {
+            dataIndex = i;
+        } else if (strcmp(name, ".text") == 0) {
+            textIndex = i;
+            textAddr = get32(sh + 12, bigEndian);
+            textOff = get32(sh + 16, bigEndian);
+            textSize = get32(sh + 20, bigEndian);
+        } else if (type == SHT_SYMTAB) {
+            symOff = get32(sh + 16, bigEndian);
+            symSize = get32(sh + 20, bigEndian);
+            uint32_t link = get32(sh + 24, bigEndian);
+            strOff = get32(image + shoff + link * 40 + 16, bigEndian);
+        }
+    }
+
+    int count = textSize / 4;
+    uint32_t* words = malloc((count ? count : 1) * sizeof(uint32_t));
+    for (int i = 0; i < count; i++) {
+        words[i] = get32(image + textOff + i * 4, bigEndian);
+    }
+
+    char line[128];
+    for (int i = 0; i < count; ) {
+        uint32_t addr = textAddr + i * 4;
+        const char* label = symbolAt(image, symOff, symSize, strOff, bigEndian, textIndex, addr);
+        if (label) fprintf(out, "%s:\n", label);
+
+        MipsInstr instr;
+        int used = mipsDecode(words, count, i, &instr);
+        if (used == 0) {
+            fprintf(out, "    .word 0x%08x\n", words[i]);
+            i++;
+            continue;
+        }
+        if (instr.op == MIPS_JAL) {
+            // Objects keep the section offset in the field, executables the address
+            uint32_t target = (uint32_t)instr.imm << 2;
+            if (executable) target |= (addr + 4) & 0xF0000000;
+            instr.label = symbolAt(image, symOff, symSize, strOff, bigEndian, textIndex, target);
+            instr.imm = target;
+        } else if (instr.op == MIPS_LA) {
+            instr.label = symbolAt(image, symOff, symSize, strOff, bigEndian, dataIndex,
+                                   (uint32_t)instr.imm);
+        }
+        mipsFormatInstr(&instr, line, sizeof(line));
+        fprintf(out, "    %s\n", line);
+        i += used;
+    }
+
+    free(words);
+    free(image);
+    return 0;
+}
@@ -0,0 +1,113 @@
+#ifndef MIPS_H
+#define MIPS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "textbuf.h"
+
+/* MIPS REGISTER NUMBERS */
+#define REG_ZERO 0
+#define REG_AT   1
+#define REG_V0   2
+#define REG_V1   3
+#define REG_A0   4
+#define REG_T0   8
+#define REG_S0   16
+#define REG_S1   17
+#define REG_T8   24
+#define REG_T9   25
+#define REG_SP   29
+#define REG_FP   30
+#define REG_RA   31
+
+/* Instructions (and pseudo-instructions) the code generator uses */
+typedef enum {
+    MIPS_ADD,       // add rd, rs, rt
+    MIPS_SUB,       // sub rd, rs, rt
+    MIPS_MUL,       // mul rd, rs, rt
+    MIPS_ADDI,      // addi rt, rs, imm
+    MIPS_ADDIU,     // addiu rt, rs, imm (no overflow trap)
+    MIPS_SLL,       // sll rd, rt, imm
+    MIPS_LW,        // lw rt, imm(rs)
+    MIPS_SW,        // sw rt, imm(rs)
+    MIPS_LI,        // li rt, imm
+    MIPS_MOVE,      // move rd, rs
+    MIPS_LA,        // la rt, label (a .data address)
+    MIPS_JAL,       // jal label
+    MIPS_JR,        // jr rs
+    MIPS_SYSCALL,   // syscall
+    MIPS_NOP        // nop (branch delay slot filler)
+} MipsOp;
+
+/* One instruction in symbolic form */
+typedef struct {
+    MipsOp op;
+    int rd;
+    int rs;
+    int rt;
+    int imm;            // Immediate, shift amount or memory offset
+    const char* label;  // Target of jal, or the data label of la
+} MipsInstr;
+
+/* Symbol defined in the text or data section */
+typedef struct {
+    char* name;
+    uint32_t offset;
+    int global;
+    int data;           // Offset is into .data rather than .text
+} MipsSymbol;
+
+/* jal or la waiting for its label */
+typedef struct {
+    uint32_t offset;
+    char* label;
+    int type;           // MIPS_JAL: 26-bit target; MIPS_LA: lui/addiu pair
+} MipsReloc;
+
+/* Binary assembler state - encoded words plus labels */
+typedef struct {
+    uint32_t* text;
+    int count;
+    int capacity;
+    MipsSymbol* symbols;
+    int symbolCount;
+    int symbolCapacity;
+    MipsReloc* relocs;
+    int relocCount;
+    int relocCapacity;
+    unsigned char* data;    // .data contents, words in target byte order
+    size_t dataSize;
+    size_t dataCapacity;
+    int bigEndian;          // Byte order for mipsAsmDataWord
+    FILE* diag;         // Where mipsBuildELF reports errors
+    int invalid;        // mipsAsmEmit rejected an instruction
+} MipsAsm;
+
+/* Nonzero if every register instr names is one of $0-$31. Anything
+ * else is a code generator bug, which is reported rather than masked
+ * into some other register. */
+int mipsValidRegisters(const MipsInstr* instr);
+
+/* TEXT FORM */
+const char* mipsRegName(int reg);       // NULL if reg is not 0-31
+void mipsFormatInstr(const MipsInstr* instr, char* buf, size_t size);
+void mipsAppendInstr(TextBuffer* out, const MipsInstr* instr);
+
+/* BINARY ENCODING */
+MipsAsm* mipsAsmCreate();
+void mipsAsmLabel(MipsAsm* as, const char* name, int global);
+/* An instruction with an invalid register is reported and left out,
+ * and mipsBuildELF then fails */
+void mipsAsmEmit(MipsAsm* as, const MipsInstr* instr);
+void mipsAsmDataLabel(MipsAsm* as, const char* name);
+void mipsAsmDataWord(MipsAsm* as, uint32_t value);
+void mipsAsmDataString(MipsAsm* as, const char* text);
+void mipsAsmDataAlign(MipsAsm* as);
+int mipsBuildELF(MipsAsm* as, int bigEndian, int executable, unsigned char** image, size_t* size);
+void mipsAsmFree(MipsAsm* as);
+
+/* DISASSEMBLY */
+int mipsDecode(const uint32_t* words, int count, int index, MipsInstr* instr);
+int mipsDisassembleELF(const char* filename, FILE* out);
+
+#endif
@@ -55,7 +55,7 @@
 #define YYSKELETON_NAME "yacc.c"
 
 /* Pure parsers.  */
-#define YYPURE 0
+#define YYPURE 2
 
 /* Push parsers.  */
 #define YYPUSH 0
@@ -72,16 +72,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
 #include "ast.h"
+#include "context.h"
 
-extern int yylex();
-extern int yylineno;
-extern char* yytext;
-void yyerror(const char* s);
-
-ASTNode* root = NULL;
-
-#line 85 "parser.tab.c"
+#line 81 "parser.tab.c"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -155,6 +151,21 @@ typedef enum yysymbol_kind_t yysymbol_kind_t;
 
 
 
+/* Unqualified %code blocks.  */
+#line 21 "parser.y"
+
+#include "lexer.h"
+#include "pratt.h"
+
+#if YYPULL
+static int yylex(YYSTYPE* value, struct Scanner* scanner) {
+    return scannerNext(scanner, value);
+}
+#endif
+
+static void yyerror(struct Scanner* scanner, struct CompilerContext* ctx, const char* s);
+
+#line 169 "parser.tab.c"
 
 #ifdef short
 # undef short
@@ -534,13 +545,13 @@ static const yytype_int8 yytranslate[] =
 
 #if YYDEBUG
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
-static const yytype_int8 yyrline[] =
+static const yytype_uint8 yyrline[] =
 {
-       0,    35,    35,    38,    39,    42,    44,    48,    49,    52,
-      53,    56,    59,    60,    63,    64,    65,    66,    67,    68,
-      69,    70,    73,    76,    79,    82,    85,    88,    92,    95,
-      96,    99,   100,   103,   104,   105,   106,   107,   108,   109,
-     110,   111,   112
+       0,    65,    65,    68,    69,    72,    78,    82,    83,    86,
+      87,    90,    93,    94,    97,    98,    99,   100,   101,   102,
+     103,   104,   107,   110,   113,   116,   119,   122,   126,   129,
+     130,   133,   134,   137,   138,   139,   140,   141,   142,   143,
+     144,   145,   146
 };
 #endif
 
@@ -727,7 +738,7 @@ enum { YYENOMEM = -2 };
       }                                                           \
     else                                                          \
       {                                                           \
-        yyerror (YY_("syntax error: cannot back up")); \
+        yyerror (scanner, ctx, YY_("syntax error: cannot back up")); \
         YYERROR;                                                  \
       }                                                           \
   while (0)
@@ -760,7 +771,7 @@ do {                                                                      \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Kind, Value); \
+                  Kind, Value, scanner, ctx); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
@@ -772,10 +783,12 @@ do {                                                                      \
 
 static void
 yy_symbol_value_print (FILE *yyo,
-                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, struct Scanner* scanner, struct CompilerContext* ctx)
 {
   FILE *yyoutput = yyo;
   YY_USE (yyoutput);
+  YY_USE (scanner);
+  YY_USE (ctx);
   if (!yyvaluep)
     return;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
@@ -790,12 +803,12 @@ yy_symbol_value_print (FILE *yyo,
 
 static void
 yy_symbol_print (FILE *yyo,
-                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, struct Scanner* scanner, struct CompilerContext* ctx)
 {
   YYFPRINTF (yyo, "%s %s (",
              yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  yy_symbol_value_print (yyo, yykind, yyvaluep, scanner, ctx);
   YYFPRINTF (yyo, ")");
 }
 
@@ -829,7 +842,7 @@ do {                                                            \
 
 static void
 yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
-                 int yyrule)
+                 int yyrule, struct Scanner* scanner, struct CompilerContext* ctx)
 {
   int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
@@ -842,7 +855,7 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
                        YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
-                       &yyvsp[(yyi + 1) - (yynrhs)]);
+                       &yyvsp[(yyi + 1) - (yynrhs)], scanner, ctx);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -850,7 +863,7 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
 # define YY_REDUCE_PRINT(Rule)          \
 do {                                    \
   if (yydebug)                          \
-    yy_reduce_print (yyssp, yyvsp, Rule); \
+    yy_reduce_print (yyssp, yyvsp, Rule, scanner, ctx); \
 } while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
@@ -891,9 +904,11 @@ int yydebug;
 
 static void
 yydestruct (const char *yymsg,
-            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, struct Scanner* scanner, struct CompilerContext* ctx)
 {
   YY_USE (yyvaluep);
+  YY_USE (scanner);
+  YY_USE (ctx);
   if (!yymsg)
     yymsg = "Deleting";
   YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
@@ -904,13 +919,6 @@ yydestruct (const char *yymsg,
 }
 
 
-/* Lookahead token kind.  */
-int yychar;
-
-/* The semantic value of the lookahead symbol.  */
-YYSTYPE yylval;
-/* Number of syntax errors so far.  */
-int yynerrs;
 
 
 
@@ -920,8 +928,21 @@ int yynerrs;
 `----------*/
 
 int
-yyparse (void)
+yyparse (struct Scanner* scanner, struct CompilerContext* ctx)
 {
+/* Lookahead token kind.  */
+int yychar;
+
+
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
+
+    /* Number of syntax errors so far.  */
+    int yynerrs = 0;
+
     yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
     int yyerrstatus = 0;
@@ -1074,7 +1095,7 @@ yybackup:
   if (yychar == YYEMPTY)
     {
       YYDPRINTF ((stderr, "Reading a token\n"));
-      yychar = yylex ();
+      yychar = yylex (&yylval, scanner);
     }
 
   if (yychar <= YYEOF)
@@ -1162,205 +1183,209 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* program: func_list  */
-#line 35 "parser.y"
-                   { root = (yyvsp[0].node); }
-#line 1168 "parser.tab.c"
+#line 65 "parser.y"
+                   { ctx->root = endList(&ctx->ast, NODE_FUNC_LIST, (yyvsp[0].list)); (yyval.node) = 0; }
+#line 1189 "parser.tab.c"
     break;
 
   case 3: /* func_list: func_decl  */
-#line 38 "parser.y"
-                     { (yyval.node) = (yyvsp[0].node); }
-#line 1174 "parser.tab.c"
+#line 68 "parser.y"
+                     { (yyval.list) = beginList(&ctx->ast); parsedFunction(ctx, (yyvsp[0].node)); }
+#line 1195 "parser.tab.c"
     break;
 
   case 4: /* func_list: func_list func_decl  */
-#line 39 "parser.y"
-                               { (yyval.node) = createFuncList((yyvsp[-1].node), (yyvsp[0].node)); }
-#line 1180 "parser.tab.c"
+#line 69 "parser.y"
+                               { (yyval.list) = (yyvsp[-1].list); parsedFunction(ctx, (yyvsp[0].node)); }
+#line 1201 "parser.tab.c"
     break;
 
   case 5: /* func_decl: type ID '(' param_list ')' '{' stmt_list '}'  */
-#line 43 "parser.y"
-         { (yyval.node) = createFuncDecl((yyvsp[-7].string), (yyvsp[-6].string), (yyvsp[-4].node), (yyvsp[-1].node)); }
-#line 1186 "parser.tab.c"
+#line 73 "parser.y"
+         {
+             NodeId body = endList(&ctx->ast, NODE_STMT_LIST, (yyvsp[-1].list));
+             NodeId params = endList(&ctx->ast, NODE_PARAM_LIST, (yyvsp[-4].list));
+             (yyval.node) = createFuncDecl(&ctx->ast, (yyvsp[-7].name), (yyvsp[-6].name), params, body);
+         }
+#line 1211 "parser.tab.c"
     break;
 
   case 6: /* func_decl: type ID '(' ')' '{' stmt_list '}'  */
-#line 45 "parser.y"
-         { (yyval.node) = createFuncDecl((yyvsp[-6].string), (yyvsp[-5].string), NULL, (yyvsp[-1].node)); }
-#line 1192 "parser.tab.c"
+#line 79 "parser.y"
+         { (yyval.node) = createFuncDecl(&ctx->ast, (yyvsp[-6].name), (yyvsp[-5].name), 0, endList(&ctx->ast, NODE_STMT_LIST, (yyvsp[-1].list))); }
+#line 1217 "parser.tab.c"
     break;
 
   case 7: /* type: INT  */
-#line 48 "parser.y"
-          { (yyval.string) = "int"; }
-#line 1198 "parser.tab.c"
+#line 82 "parser.y"
+          { (yyval.name) = internName(&ctx->strings, "int", 3); }
+#line 1223 "parser.tab.c"
     break;
 
   case 8: /* type: VOID  */
-#line 49 "parser.y"
-           { (yyval.string) = "void"; }
-#line 1204 "parser.tab.c"
+#line 83 "parser.y"
+           { (yyval.name) = internName(&ctx->strings, "void", 4); }
+#line 1229 "parser.tab.c"
     break;
 
   case 9: /* param_list: param  */
-#line 52 "parser.y"
-                  { (yyval.node) = (yyvsp[0].node); }
-#line 1210 "parser.tab.c"
+#line 86 "parser.y"
+                  { (yyval.list) = beginList(&ctx->ast); appendToList(&ctx->ast, (yyvsp[0].node)); }
+#line 1235 "parser.tab.c"
     break;
 
   case 10: /* param_list: param_list ',' param  */
-#line 53 "parser.y"
-                                 { (yyval.node) = createParamList((yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1216 "parser.tab.c"
+#line 87 "parser.y"
+                                 { (yyval.list) = (yyvsp[-2].list); appendToList(&ctx->ast, (yyvsp[0].node)); }
+#line 1241 "parser.tab.c"
     break;
 
   case 11: /* param: INT ID  */
-#line 56 "parser.y"
-              { (yyval.node) = createParam("int", (yyvsp[0].string)); }
-#line 1222 "parser.tab.c"
+#line 90 "parser.y"
+              { (yyval.node) = createParam(&ctx->ast, internName(&ctx->strings, "int", 3), (yyvsp[0].name)); }
+#line 1247 "parser.tab.c"
     break;
 
   case 12: /* stmt_list: stmt  */
-#line 59 "parser.y"
-                { (yyval.node) = (yyvsp[0].node); }
-#line 1228 "parser.tab.c"
+#line 93 "parser.y"
+                { (yyval.list) = beginList(&ctx->ast); appendToList(&ctx->ast, (yyvsp[0].node)); }
+#line 1253 "parser.tab.c"
     break;
 
   case 13: /* stmt_list: stmt_list stmt  */
-#line 60 "parser.y"
-                          { (yyval.node) = createStmtList((yyvsp[-1].node), (yyvsp[0].node)); }
-#line 1234 "parser.tab.c"
+#line 94 "parser.y"
+                          { (yyval.list) = (yyvsp[-1].list); appendToList(&ctx->ast, (yyvsp[0].node)); }
+#line 1259 "parser.tab.c"
     break;
 
   case 22: /* decl: INT ID ';'  */
-#line 73 "parser.y"
-                 { (yyval.node) = createDecl((yyvsp[-1].string)); }
-#line 1240 "parser.tab.c"
+#line 107 "parser.y"
+                 { (yyval.node) = createDecl(&ctx->ast, (yyvsp[-1].name)); }
+#line 1265 "parser.tab.c"
     break;
 
   case 23: /* array_decl: INT ID '[' NUM ']' ';'  */
-#line 76 "parser.y"
-                                   { (yyval.node) = createArrayDecl((yyvsp[-4].string), (yyvsp[-2].num)); }
-#line 1246 "parser.tab.c"
+#line 110 "parser.y"
+                                   { (yyval.node) = createArrayDecl(&ctx->ast, (yyvsp[-4].name), (yyvsp[-2].num)); }
+#line 1271 "parser.tab.c"
     break;
 
   case 24: /* array_2d_decl: INT ID '[' NUM ']' '[' NUM ']' ';'  */
-#line 79 "parser.y"
-                                                  { (yyval.node) = createArray2DDecl((yyvsp[-7].string), (yyvsp[-5].num), (yyvsp[-2].num)); }
-#line 1252 "parser.tab.c"
+#line 113 "parser.y"
+                                                  { (yyval.node) = createArray2DDecl(&ctx->ast, (yyvsp[-7].name), (yyvsp[-5].num), (yyvsp[-2].num)); }
+#line 1277 "parser.tab.c"
     break;
 
   case 25: /* assign: ID '=' expr ';'  */
-#line 82 "parser.y"
-                        { (yyval.node) = createAssign((yyvsp[-3].string), (yyvsp[-1].node)); }
-#line 1258 "parser.tab.c"
+#line 116 "parser.y"
+                        { (yyval.node) = createAssign(&ctx->ast, (yyvsp[-3].name), (yyvsp[-1].node)); }
+#line 1283 "parser.tab.c"
     break;
 
   case 26: /* array_assign: ID '[' expr ']' '=' expr ';'  */
-#line 85 "parser.y"
-                                           { (yyval.node) = createArrayAssign((yyvsp[-6].string), (yyvsp[-4].node), (yyvsp[-1].node)); }
-#line 1264 "parser.tab.c"
+#line 119 "parser.y"
+                                           { (yyval.node) = createArrayAssign(&ctx->ast, (yyvsp[-6].name), (yyvsp[-4].node), (yyvsp[-1].node)); }
+#line 1289 "parser.tab.c"
     break;
 
   case 27: /* array_2d_assign: ID '[' expr ']' '[' expr ']' '=' expr ';'  */
-#line 89 "parser.y"
-               { (yyval.node) = createArray2DAssign((yyvsp[-9].string), (yyvsp[-7].node), (yyvsp[-4].node), (yyvsp[-1].node)); }
-#line 1270 "parser.tab.c"
+#line 123 "parser.y"
+               { (yyval.node) = createArray2DAssign(&ctx->ast, (yyvsp[-9].name), (yyvsp[-7].node), (yyvsp[-4].node), (yyvsp[-1].node)); }
+#line 1295 "parser.tab.c"
     break;
 
   case 28: /* print_stmt: PRINT '(' expr ')' ';'  */
-#line 92 "parser.y"
-                                   { (yyval.node) = createPrint((yyvsp[-2].node)); }
-#line 1276 "parser.tab.c"
+#line 126 "parser.y"
+                                   { (yyval.node) = createPrint(&ctx->ast, (yyvsp[-2].node)); }
+#line 1301 "parser.tab.c"
     break;
 
   case 29: /* return_stmt: RETURN expr ';'  */
-#line 95 "parser.y"
-                             { (yyval.node) = createReturn((yyvsp[-1].node)); }
-#line 1282 "parser.tab.c"
+#line 129 "parser.y"
+                             { (yyval.node) = createReturn(&ctx->ast, (yyvsp[-1].node)); }
+#line 1307 "parser.tab.c"
     break;
 
   case 30: /* return_stmt: RETURN ';'  */
-#line 96 "parser.y"
-                        { (yyval.node) = createReturn(NULL); }
-#line 1288 "parser.tab.c"
+#line 130 "parser.y"
+                        { (yyval.node) = createReturn(&ctx->ast, 0); }
+#line 1313 "parser.tab.c"
     break;
 
   case 31: /* arg_list: expr  */
-#line 99 "parser.y"
-               { (yyval.node) = createArgList((yyvsp[0].node), NULL); }
-#line 1294 "parser.tab.c"
+#line 133 "parser.y"
+               { (yyval.list) = beginList(&ctx->ast); appendToList(&ctx->ast, (yyvsp[0].node)); }
+#line 1319 "parser.tab.c"
     break;
 
   case 32: /* arg_list: arg_list ',' expr  */
-#line 100 "parser.y"
-                            { (yyval.node) = createArgList((yyvsp[0].node), (yyvsp[-2].node)); }
-#line 1300 "parser.tab.c"
+#line 134 "parser.y"
+                            { (yyval.list) = (yyvsp[-2].list); appendToList(&ctx->ast, (yyvsp[0].node)); }
+#line 1325 "parser.tab.c"
     break;
 
   case 33: /* expr: expr '+' expr  */
-#line 103 "parser.y"
-                    { (yyval.node) = createBinOp('+', (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1306 "parser.tab.c"
+#line 137 "parser.y"
+                    { (yyval.node) = createBinOp(&ctx->ast, '+', (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1331 "parser.tab.c"
     break;
 
   case 34: /* expr: expr '-' expr  */
-#line 104 "parser.y"
-                    { (yyval.node) = createBinOp('-', (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1312 "parser.tab.c"
+#line 138 "parser.y"
+                    { (yyval.node) = createBinOp(&ctx->ast, '-', (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1337 "parser.tab.c"
     break;
 
   case 35: /* expr: expr '*' expr  */
-#line 105 "parser.y"
-                    { (yyval.node) = createBinOp('*', (yyvsp[-2].node), (yyvsp[0].node)); }
-#line 1318 "parser.tab.c"
+#line 139 "parser.y"
+                    { (yyval.node) = createBinOp(&ctx->ast, '*', (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1343 "parser.tab.c"
     break;
 
   case 36: /* expr: '(' expr ')'  */
-#line 106 "parser.y"
+#line 140 "parser.y"
                    { (yyval.node) = (yyvsp[-1].node); }
-#line 1324 "parser.tab.c"
+#line 1349 "parser.tab.c"
     break;
 
   case 37: /* expr: NUM  */
-#line 107 "parser.y"
-          { (yyval.node) = createNum((yyvsp[0].num)); }
-#line 1330 "parser.tab.c"
+#line 141 "parser.y"
+          { (yyval.node) = createNum(&ctx->ast, (yyvsp[0].num)); }
+#line 1355 "parser.tab.c"
     break;
 
   case 38: /* expr: ID  */
-#line 108 "parser.y"
-         { (yyval.node) = createVar((yyvsp[0].string)); }
-#line 1336 "parser.tab.c"
+#line 142 "parser.y"
+         { (yyval.node) = createVar(&ctx->ast, (yyvsp[0].name)); }
+#line 1361 "parser.tab.c"
     break;
 
   case 39: /* expr: ID '[' expr ']'  */
-#line 109 "parser.y"
-                      { (yyval.node) = createArrayAccess((yyvsp[-3].string), (yyvsp[-1].node)); }
-#line 1342 "parser.tab.c"
+#line 143 "parser.y"
+                      { (yyval.node) = createArrayAccess(&ctx->ast, (yyvsp[-3].name), (yyvsp[-1].node)); }
+#line 1367 "parser.tab.c"
     break;
 
   case 40: /* expr: ID '[' expr ']' '[' expr ']'  */
-#line 110 "parser.y"
-                                   { (yyval.node) = createArray2DAccess((yyvsp[-6].string), (yyvsp[-4].node), (yyvsp[-1].node)); }
-#line 1348 "parser.tab.c"
+#line 144 "parser.y"
+                                   { (yyval.node) = createArray2DAccess(&ctx->ast, (yyvsp[-6].name), (yyvsp[-4].node), (yyvsp[-1].node)); }
+#line 1373 "parser.tab.c"
     break;
 
   case 41: /* expr: ID '(' arg_list ')'  */
-#line 111 "parser.y"
-                          { (yyval.node) = createFuncCall((yyvsp[-3].string), (yyvsp[-1].node)); }
-#line 1354 "parser.tab.c"
+#line 145 "parser.y"
+                          { (yyval.node) = createFuncCall(&ctx->ast, (yyvsp[-3].name), endList(&ctx->ast, NODE_ARG_LIST, (yyvsp[-1].list))); }
+#line 1379 "parser.tab.c"
     break;
 
   case 42: /* expr: ID '(' ')'  */
-#line 112 "parser.y"
-                 { (yyval.node) = createFuncCall((yyvsp[-2].string), NULL); }
-#line 1360 "parser.tab.c"
+#line 146 "parser.y"
+                 { (yyval.node) = createFuncCall(&ctx->ast, (yyvsp[-2].name), 0); }
+#line 1385 "parser.tab.c"
     break;
 
 
-#line 1364 "parser.tab.c"
+#line 1389 "parser.tab.c"
 
       default: break;
     }
@@ -1407,7 +1432,7 @@ yyerrlab:
   if (!yyerrstatus)
     {
       ++yynerrs;
-      yyerror (YY_("syntax error"));
+      yyerror (scanner, ctx, YY_("syntax error"));
     }
 
   if (yyerrstatus == 3)
@@ -1424,7 +1449,7 @@ yyerrlab:
       else
         {
           yydestruct ("Error: discarding",
-                      yytoken, &yylval);
+                      yytoken, &yylval, scanner, ctx);
           yychar = YYEMPTY;
         }
     }
@@ -1480,7 +1505,7 @@ yyerrlab1:
 
 
       yydestruct ("Error: popping",
-                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, scanner, ctx);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -1518,7 +1543,7 @@ yyabortlab:
 | yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
 `-----------------------------------------------------------*/
 yyexhaustedlab:
-  yyerror (YY_("memory exhausted"));
+  yyerror (scanner, ctx, YY_("memory exhausted"));
   yyresult = 2;
   goto yyreturnlab;
 
@@ -1533,7 +1558,7 @@ yyreturnlab:
          user semantic actions for why this is necessary.  */
       yytoken = YYTRANSLATE (yychar);
       yydestruct ("Cleanup: discarding lookahead",
-                  yytoken, &yylval);
+                  yytoken, &yylval, scanner, ctx);
     }
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
@@ -1542,7 +1567,7 @@ yyreturnlab:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, scanner, ctx);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
@@ -1553,9 +1578,128 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 115 "parser.y"
+#line 149 "parser.y"
 
 
-void yyerror(const char* s) {
-    fprintf(stderr, "Syntax Error: %s\n", s);
+static void yyerror(struct Scanner* scanner, struct CompilerContext* ctx, const char* s) {
+    (void)scanner;
+    compilerError(ctx, "Syntax Error: %s", s);
 }
+
+#if YYPULL
+
+/* Lists left open by an earlier parse that failed are abandoned */
+static int runParser(Scanner* scanner, CompilerContext* ctx) {
+    ctx->ast.pendingCount = 0;
+    int result = ctx->prattParser ? prattParse(ctx, scanner) : yyparse(scanner, ctx);
+    scannerClose(scanner);
+    if (ctx->ast.failed) {
+        compilerError(ctx, "Error: Out of memory");
+        result = 1;
+    }
+    return result;
+}
+
+int parseFile(CompilerContext* ctx, FILE* in) {
+    Scanner scanner;
+    if (scannerOpenFile(&scanner, ctx, in) != 0) return 1;
+    return runParser(&scanner, ctx);
+}
+
+/* Same as parseFile for source already in memory; src need not be
+ * NUL-terminated. */
+int parseString(CompilerContext* ctx, const char* src, size_t len) {
+    Scanner scanner;
+    if (scannerOpen(&scanner, ctx, src, len) != 0) return 1;
+    return runParser(&scanner, ctx);
+}
+
+/* Scan a buffer in place (see source.h): buffer[size] and
+ * buffer[size + 1] must be NUL, and flex writes into it while it runs.
+ * Identifiers are interned straight from the buffer. */
+int parseBuffer(CompilerContext* ctx, char* buffer, size_t size) {
+    Scanner scanner;
+    if (scannerOpenBuffer(&scanner, ctx, buffer, size) != 0) return 1;
+    return runParser(&scanner, ctx);
+}
+#endif
+
+#if YYPUSH
+/* PUSH PARSING
+ * The chunk scanner hands each token straight to bison's push parser,
+ * so source is parsed while the rest of it is still arriving. */
+struct PushParser {
+    CompilerContext* ctx;
+    yypstate* state;
+    ChunkScanner scanner;
+    int status;             // YYPUSH_MORE until the parse has ended
+};
+
+PushParser* pushParserCreate(CompilerContext* ctx) {
+    PushParser* parser = calloc(1, sizeof(PushParser));
+    if (parser) parser->state = yypstate_new();
+    if (!parser || !parser->state) {
+        free(parser);
+        compilerError(ctx, "Error: Out of memory");
+        return NULL;
+    }
+    parser->ctx = ctx;
+    parser->status = YYPUSH_MORE;
+    chunkScannerInit(&parser->scanner, ctx);
+    ctx->ast.pendingCount = 0;
+    return parser;
+}
+
+static int pushToken(void* arg, int token, const YYSTYPE* value) {
+    PushParser* parser = arg;
+    parser->status = yypush_parse(parser->state, token, value, NULL, parser->ctx);
+    return parser->status != YYPUSH_MORE || parser->ctx->ast.failed;
+}
+
+static void pushChunk(PushParser* parser, const char* chunk, size_t size, int final) {
+    if (parser->status != YYPUSH_MORE) return;
+    if (chunkScannerFeed(&parser->scanner, chunk, size, final, pushToken, parser) == LEXER_NO_MEMORY ||
+        parser->ctx->ast.failed) {
+        compilerError(parser->ctx, "Error: Out of memory");
+        parser->status = 2;
+    }
+}
+
+int pushParserFeed(PushParser* parser, const char* chunk, size_t size) {
+    pushChunk(parser, chunk, size, 0);
+    return parser->status != YYPUSH_MORE;
+}
+
+int pushParserFinish(PushParser* parser) {
+    pushChunk(parser, "", 0, 1);
+    return parser->status != 0;
+}
+
+void pushParserFree(PushParser* parser) {
+    if (!parser) return;
+    yypstate_delete(parser->state);
+    chunkScannerFree(&parser->scanner);
+    free(parser);
+}
+
+/* Parse what is read from fd as it comes, a read at a time, instead of
+ * waiting for all of it. Reading stops at the first syntax error. */
+int parseStream(CompilerContext* ctx, int fd) {
+    PushParser* parser = pushParserCreate(ctx);
+    if (!parser) return 1;
+    char chunk[PUSH_CHUNK_SIZE];
+    int failed = 0;
+    for (;;) {
+        ssize_t got = read(fd, chunk, sizeof(chunk));
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) {
+            compilerError(ctx, "Error: Cannot read input");
+            failed = 1;
+        }
+        if (got <= 0 || pushParserFeed(parser, chunk, got) != 0) break;
+    }
+    if (!failed) failed = pushParserFinish(parser);
+    pushParserFree(parser);
+    return failed;
+}
+#endif
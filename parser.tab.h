@@ -44,6 +44,13 @@
 #if YYDEBUG
 extern int yydebug;
 #endif
+/* "%code requires" blocks.  */
+#line 11 "parser.y"
+
+struct CompilerContext;
+struct Scanner;
+
+#line 54 "parser.tab.h"
 
 /* Token kinds.  */
 #ifndef YYTOKENTYPE
@@ -68,13 +75,14 @@ extern int yydebug;
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 15 "parser.y"
+#line 38 "parser.y"
 
     int num;
-    char* string;
-    struct ASTNode* node;
+    NameId name;
+    NodeId node;
+    uint32_t list;
 
-#line 78 "parser.tab.h"
+#line 86 "parser.tab.h"
 
 };
 typedef union YYSTYPE YYSTYPE;
@@ -83,10 +91,9 @@ typedef union YYSTYPE YYSTYPE;
 #endif
 
 
-extern YYSTYPE yylval;
 
 
-int yyparse (void);
+int yyparse (struct Scanner* scanner, struct CompilerContext* ctx);
 
 
 #endif /* !YY_YY_PARSER_TAB_H_INCLUDED  */
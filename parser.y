@@ -2,29 +2,59 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
 #include "ast.h"
+#include "context.h"
+%}
 
-extern int yylex();
-extern int yylineno;
-extern char* yytext;
-void yyerror(const char* s);
+%code requires {
+struct CompilerContext;
+struct Scanner;
+}
 
-ASTNode* root = NULL;
-%}
+/* The grammar is built twice: parser.tab.c is the usual pull parser,
+ * and push.tab.c the push parser bison makes of it with
+ * -Dapi.push-pull=push. One parser doing both would run yyparse through
+ * the push interface, a call per token with its state kept in memory,
+ * which made lex+parse 15% slower. YYPULL and YYPUSH tell them apart. */
+%code {
+#include "lexer.h"
+#include "pratt.h"
+
+#if YYPULL
+static int yylex(YYSTYPE* value, struct Scanner* scanner) {
+    return scannerNext(scanner, value);
+}
+#endif
+
+static void yyerror(struct Scanner* scanner, struct CompilerContext* ctx, const char* s);
+}
+
+%define api.pure full
+%param {struct Scanner* scanner}
+%parse-param {struct CompilerContext* ctx}
 
 %union {
     int num;
-    char* string;
-    struct ASTNode* node;
+    NameId name;
+    NodeId node;
+    uint32_t list;
 }
 
 %token <num> NUM
-%token <string> ID
+%token <name> ID
 %token INT PRINT RETURN VOID
 
-%type <node> program func_list func_decl param_list param stmt_list stmt decl assign print_stmt return_stmt
-%type <node> expr array_decl array_assign array_2d_decl array_2d_assign arg_list
-%type <string> type
+%type <node> program func_decl param stmt decl assign print_stmt return_stmt
+%type <node> expr array_decl array_assign array_2d_decl array_2d_assign
+%type <list> func_list param_list stmt_list arg_list
+%type <name> type
+
+/* Identifiers are interned in ctx->strings and nodes are built in
+ * ctx->ast, which owns them; a syntax error leaves nothing to free.
+ * A list value is its start on the AST's pending stack (ast.h), made a
+ * node by the rule that closes it. */
 
 %left '+' '-'
 %left '*' '/'
@@ -32,32 +62,36 @@ ASTNode* root = NULL;
 
 %%
 
-program: func_list { root = $1; }
+program: func_list { ctx->root = endList(&ctx->ast, NODE_FUNC_LIST, $1); $$ = 0; }
        ;
 
-func_list: func_decl { $$ = $1; }
-         | func_list func_decl { $$ = createFuncList($1, $2); }
+func_list: func_decl { $$ = beginList(&ctx->ast); parsedFunction(ctx, $1); }
+         | func_list func_decl { $$ = $1; parsedFunction(ctx, $2); }
          ;
 
 func_decl: type ID '(' param_list ')' '{' stmt_list '}' 
-         { $$ = createFuncDecl($1, $2, $4, $7); }
+         {
+             NodeId body = endList(&ctx->ast, NODE_STMT_LIST, $7);
+             NodeId params = endList(&ctx->ast, NODE_PARAM_LIST, $4);
+             $$ = createFuncDecl(&ctx->ast, $1, $2, params, body);
+         }
          | type ID '(' ')' '{' stmt_list '}' 
-         { $$ = createFuncDecl($1, $2, NULL, $6); }
+         { $$ = createFuncDecl(&ctx->ast, $1, $2, 0, endList(&ctx->ast, NODE_STMT_LIST, $6)); }
          ;
 
-type: INT { $$ = "int"; }
-    | VOID { $$ = "void"; }
+type: INT { $$ = internName(&ctx->strings, "int", 3); }
+    | VOID { $$ = internName(&ctx->strings, "void", 4); }
     ;
 
-param_list: param { $$ = $1; }
-          | param_list ',' param { $$ = createParamList($1, $3); }
+param_list: param { $$ = beginList(&ctx->ast); appendToList(&ctx->ast, $1); }
+          | param_list ',' param { $$ = $1; appendToList(&ctx->ast, $3); }
           ;
 
-param: INT ID { $$ = createParam("int", $2); }
+param: INT ID { $$ = createParam(&ctx->ast, internName(&ctx->strings, "int", 3), $2); }
      ;
 
-stmt_list: stmt { $$ = $1; }
-         | stmt_list stmt { $$ = createStmtList($1, $2); }
+stmt_list: stmt { $$ = beginList(&ctx->ast); appendToList(&ctx->ast, $1); }
+         | stmt_list stmt { $$ = $1; appendToList(&ctx->ast, $2); }
          ;
 
 stmt: decl
@@ -70,50 +104,169 @@ stmt: decl
     | array_2d_assign
     ;
 
-decl: INT ID ';' { $$ = createDecl($2); }
+decl: INT ID ';' { $$ = createDecl(&ctx->ast, $2); }
     ;
 
-array_decl: INT ID '[' NUM ']' ';' { $$ = createArrayDecl($2, $4); }
+array_decl: INT ID '[' NUM ']' ';' { $$ = createArrayDecl(&ctx->ast, $2, $4); }
           ;
 
-array_2d_decl: INT ID '[' NUM ']' '[' NUM ']' ';' { $$ = createArray2DDecl($2, $4, $7); }
+array_2d_decl: INT ID '[' NUM ']' '[' NUM ']' ';' { $$ = createArray2DDecl(&ctx->ast, $2, $4, $7); }
              ;
 
-assign: ID '=' expr ';' { $$ = createAssign($1, $3); }
+assign: ID '=' expr ';' { $$ = createAssign(&ctx->ast, $1, $3); }
       ;
 
-array_assign: ID '[' expr ']' '=' expr ';' { $$ = createArrayAssign($1, $3, $6); }
+array_assign: ID '[' expr ']' '=' expr ';' { $$ = createArrayAssign(&ctx->ast, $1, $3, $6); }
             ;
 
 array_2d_assign: ID '[' expr ']' '[' expr ']' '=' expr ';' 
-               { $$ = createArray2DAssign($1, $3, $6, $9); }
+               { $$ = createArray2DAssign(&ctx->ast, $1, $3, $6, $9); }
                ;
 
-print_stmt: PRINT '(' expr ')' ';' { $$ = createPrint($3); }
+print_stmt: PRINT '(' expr ')' ';' { $$ = createPrint(&ctx->ast, $3); }
           ;
 
-return_stmt: RETURN expr ';' { $$ = createReturn($2); }
-           | RETURN ';' { $$ = createReturn(NULL); }
+return_stmt: RETURN expr ';' { $$ = createReturn(&ctx->ast, $2); }
+           | RETURN ';' { $$ = createReturn(&ctx->ast, 0); }
            ;
 
-arg_list: expr { $$ = createArgList($1, NULL); }
-        | arg_list ',' expr { $$ = createArgList($3, $1); }
+arg_list: expr { $$ = beginList(&ctx->ast); appendToList(&ctx->ast, $1); }
+        | arg_list ',' expr { $$ = $1; appendToList(&ctx->ast, $3); }
         ;
 
-expr: expr '+' expr { $$ = createBinOp('+', $1, $3); }
-    | expr '-' expr { $$ = createBinOp('-', $1, $3); }
-    | expr '*' expr { $$ = createBinOp('*', $1, $3); }
+expr: expr '+' expr { $$ = createBinOp(&ctx->ast, '+', $1, $3); }
+    | expr '-' expr { $$ = createBinOp(&ctx->ast, '-', $1, $3); }
+    | expr '*' expr { $$ = createBinOp(&ctx->ast, '*', $1, $3); }
     | '(' expr ')' { $$ = $2; }
-    | NUM { $$ = createNum($1); }
-    | ID { $$ = createVar($1); }
-    | ID '[' expr ']' { $$ = createArrayAccess($1, $3); }
-    | ID '[' expr ']' '[' expr ']' { $$ = createArray2DAccess($1, $3, $6); }
-    | ID '(' arg_list ')' { $$ = createFuncCall($1, $3); }
-    | ID '(' ')' { $$ = createFuncCall($1, NULL); }
+    | NUM { $$ = createNum(&ctx->ast, $1); }
+    | ID { $$ = createVar(&ctx->ast, $1); }
+    | ID '[' expr ']' { $$ = createArrayAccess(&ctx->ast, $1, $3); }
+    | ID '[' expr ']' '[' expr ']' { $$ = createArray2DAccess(&ctx->ast, $1, $3, $6); }
+    | ID '(' arg_list ')' { $$ = createFuncCall(&ctx->ast, $1, endList(&ctx->ast, NODE_ARG_LIST, $3)); }
+    | ID '(' ')' { $$ = createFuncCall(&ctx->ast, $1, 0); }
     ;
 
 %%
 
-void yyerror(const char* s) {
-    fprintf(stderr, "Syntax Error: %s\n", s);
-}
\ No newline at end of file
+static void yyerror(struct Scanner* scanner, struct CompilerContext* ctx, const char* s) {
+    (void)scanner;
+    compilerError(ctx, "Syntax Error: %s", s);
+}
+
+#if YYPULL
+
+/* Lists left open by an earlier parse that failed are abandoned */
+static int runParser(Scanner* scanner, CompilerContext* ctx) {
+    ctx->ast.pendingCount = 0;
+    int result = ctx->prattParser ? prattParse(ctx, scanner) : yyparse(scanner, ctx);
+    scannerClose(scanner);
+    if (ctx->ast.failed) {
+        compilerError(ctx, "Error: Out of memory");
+        result = 1;
+    }
+    return result;
+}
+
+int parseFile(CompilerContext* ctx, FILE* in) {
+    Scanner scanner;
+    if (scannerOpenFile(&scanner, ctx, in) != 0) return 1;
+    return runParser(&scanner, ctx);
+}
+
+/* Same as parseFile for source already in memory; src need not be
+ * NUL-terminated. */
+int parseString(CompilerContext* ctx, const char* src, size_t len) {
+    Scanner scanner;
+    if (scannerOpen(&scanner, ctx, src, len) != 0) return 1;
+    return runParser(&scanner, ctx);
+}
+
+/* Scan a buffer in place (see source.h): buffer[size] and
+ * buffer[size + 1] must be NUL, and flex writes into it while it runs.
+ * Identifiers are interned straight from the buffer. */
+int parseBuffer(CompilerContext* ctx, char* buffer, size_t size) {
+    Scanner scanner;
+    if (scannerOpenBuffer(&scanner, ctx, buffer, size) != 0) return 1;
+    return runParser(&scanner, ctx);
+}
+#endif
+
+#if YYPUSH
+/* PUSH PARSING
+ * The chunk scanner hands each token straight to bison's push parser,
+ * so source is parsed while the rest of it is still arriving. */
+struct PushParser {
+    CompilerContext* ctx;
+    yypstate* state;
+    ChunkScanner scanner;
+    int status;             // YYPUSH_MORE until the parse has ended
+};
+
+PushParser* pushParserCreate(CompilerContext* ctx) {
+    PushParser* parser = calloc(1, sizeof(PushParser));
+    if (parser) parser->state = yypstate_new();
+    if (!parser || !parser->state) {
+        free(parser);
+        compilerError(ctx, "Error: Out of memory");
+        return NULL;
+    }
+    parser->ctx = ctx;
+    parser->status = YYPUSH_MORE;
+    chunkScannerInit(&parser->scanner, ctx);
+    ctx->ast.pendingCount = 0;
+    return parser;
+}
+
+static int pushToken(void* arg, int token, const YYSTYPE* value) {
+    PushParser* parser = arg;
+    parser->status = yypush_parse(parser->state, token, value, NULL, parser->ctx);
+    return parser->status != YYPUSH_MORE || parser->ctx->ast.failed;
+}
+
+static void pushChunk(PushParser* parser, const char* chunk, size_t size, int final) {
+    if (parser->status != YYPUSH_MORE) return;
+    if (chunkScannerFeed(&parser->scanner, chunk, size, final, pushToken, parser) == LEXER_NO_MEMORY ||
+        parser->ctx->ast.failed) {
+        compilerError(parser->ctx, "Error: Out of memory");
+        parser->status = 2;
+    }
+}
+
+int pushParserFeed(PushParser* parser, const char* chunk, size_t size) {
+    pushChunk(parser, chunk, size, 0);
+    return parser->status != YYPUSH_MORE;
+}
+
+int pushParserFinish(PushParser* parser) {
+    pushChunk(parser, "", 0, 1);
+    return parser->status != 0;
+}
+
+void pushParserFree(PushParser* parser) {
+    if (!parser) return;
+    yypstate_delete(parser->state);
+    chunkScannerFree(&parser->scanner);
+    free(parser);
+}
+
+/* Parse what is read from fd as it comes, a read at a time, instead of
+ * waiting for all of it. Reading stops at the first syntax error. */
+int parseStream(CompilerContext* ctx, int fd) {
+    PushParser* parser = pushParserCreate(ctx);
+    if (!parser) return 1;
+    char chunk[PUSH_CHUNK_SIZE];
+    int failed = 0;
+    for (;;) {
+        ssize_t got = read(fd, chunk, sizeof(chunk));
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) {
+            compilerError(ctx, "Error: Cannot read input");
+            failed = 1;
+        }
+        if (got <= 0 || pushParserFeed(parser, chunk, got) != 0) break;
+    }
+    if (!failed) failed = pushParserFinish(parser);
+    pushParserFree(parser);
+    return failed;
+}
+#endif
@@ -0,0 +1,200 @@
+/* THREAD POOL
+ * Runs independent tasks (input files, or ranges of the functions of
+ * one file) on a fixed set of threads. Tasks are spread round-robin over per-worker deques; a worker
+ * takes the newest task from its own deque and, when that is empty,
+ * steals the oldest task from another worker so long files do not leave
+ * the rest of the pool idle.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "pool.h"
+
+/* Arguments for one worker thread */
+typedef struct {
+    ThreadPool* pool;
+    int index;
+} Worker;
+
+static void pushBottom(WorkQueue* queue, Task task) {
+    pthread_mutex_lock(&queue->lock);
+    if (queue->bottom == queue->capacity) {
+        // Slide live tasks to the front before growing
+        int live = queue->bottom - queue->top;
+        for (int i = 0; i < live; i++) {
+            queue->tasks[i] = queue->tasks[queue->top + i];
+        }
+        queue->top = 0;
+        queue->bottom = live;
+        if (live == queue->capacity) {
+            queue->capacity = queue->capacity ? queue->capacity * 2 : 64;
+            queue->tasks = realloc(queue->tasks, queue->capacity * sizeof(Task));
+        }
+    }
+    queue->tasks[queue->bottom++] = task;
+    pthread_mutex_unlock(&queue->lock);
+}
+
+static int popBottom(WorkQueue* queue, Task* task) {
+    int found = 0;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->bottom > queue->top) {
+        *task = queue->tasks[--queue->bottom];
+        found = 1;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+static int stealTop(WorkQueue* queue, Task* task) {
+    int found = 0;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->bottom > queue->top) {
+        *task = queue->tasks[queue->top++];
+        found = 1;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+// Own deque first, then every other worker's, starting at the next one
+static int takeTask(ThreadPool* pool, int self, Task* task) {
+    if (popBottom(&pool->queues[self], task)) return 1;
+    for (int i = 1; i < pool->count; i++) {
+        if (stealTop(&pool->queues[(self + i) % pool->count], task)) return 1;
+    }
+    return 0;
+}
+
+static void* workerMain(void* arg) {
+    Worker* worker = arg;
+    ThreadPool* pool = worker->pool;
+    int self = worker->index;
+    free(worker);
+    
+    for (;;) {
+        Task task;
+        if (takeTask(pool, self, &task)) {
+            pthread_mutex_lock(&pool->lock);
+            pool->queued--;
+            pthread_mutex_unlock(&pool->lock);
+            
+            task.func(task.arg);
+            
+            pthread_mutex_lock(&pool->lock);
+            if (--pool->pending == 0) {
+                pthread_cond_broadcast(&pool->allDone);
+            }
+            pthread_mutex_unlock(&pool->lock);
+            continue;
+        }
+        
+        // Nothing to take - sleep until something is submitted
+        pthread_mutex_lock(&pool->lock);
+        while (pool->queued == 0 && !pool->shutdown) {
+            pthread_cond_wait(&pool->workReady, &pool->lock);
+        }
+        int done = pool->shutdown && pool->queued == 0;
+        pthread_mutex_unlock(&pool->lock);
+        if (done) break;
+    }
+    return NULL;
+}
+
+ThreadPool* poolCreate(int threads) {
+    if (threads < 1) threads = 1;
+    
+    ThreadPool* pool = calloc(1, sizeof(ThreadPool));
+    pool->count = threads;
+    pool->threads = calloc(threads, sizeof(pthread_t));
+    pool->queues = calloc(threads, sizeof(WorkQueue));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->workReady, NULL);
+    pthread_cond_init(&pool->allDone, NULL);
+    
+    for (int i = 0; i < threads; i++) {
+        pthread_mutex_init(&pool->queues[i].lock, NULL);
+    }
+    for (int i = 0; i < threads; i++) {
+        Worker* worker = malloc(sizeof(Worker));
+        worker->pool = pool;
+        worker->index = i;
+        if (pthread_create(&pool->threads[i], NULL, workerMain, worker) != 0) {
+            // Run with the threads we managed to start
+            fprintf(stderr, "Warning: Could only start %d of %d threads\n", i, threads);
+            free(worker);
+            if (i == 0) {
+                poolDestroy(pool);
+                return NULL;
+            }
+            pool->count = i;
+            break;
+        }
+    }
+    return pool;
+}
+
+void poolSubmit(ThreadPool* pool, TaskFunc func, void* arg) {
+    Task task = { func, arg };
+    int target = pool->nextQueue;
+    pool->nextQueue = (pool->nextQueue + 1) % pool->count;
+    
+    // Count the task before it becomes visible so workers never see
+    // more tasks taken than queued
+    pthread_mutex_lock(&pool->lock);
+    pool->queued++;
+    pool->pending++;
+    pthread_mutex_unlock(&pool->lock);
+    
+    pushBottom(&pool->queues[target], task);
+    
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->workReady);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* Block until every submitted task has finished */
+void poolWait(ThreadPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->allDone, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* Finish queued work, stop the threads and free the pool */
+void poolDestroy(ThreadPool* pool) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->workReady);
+    pthread_mutex_unlock(&pool->lock);
+    
+    for (int i = 0; i < pool->count; i++) {
+        if (pool->threads[i]) pthread_join(pool->threads[i], NULL);
+    }
+    for (int i = 0; i < pool->count; i++) {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+        free(pool->queues[i].tasks);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->workReady);
+    pthread_cond_destroy(&pool->allDone);
+    free(pool->queues);
+    free(pool->threads);
+    free(pool);
+}
+
+/* How many tasks to split items of work into: a few per thread, so a
+ * slow range can be balanced by stealing, but never more than items */
+int poolTaskCount(ThreadPool* pool, int items) {
+    int tasks = pool->count * POOL_TASKS_PER_THREAD;
+    return items < tasks ? items : tasks;
+}
+
+/* Number of online CPUs, used for -j 0 */
+int poolDefaultSize() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
@@ -0,0 +1,47 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <pthread.h>
+
+#define POOL_TASKS_PER_THREAD 4
+
+typedef void (*TaskFunc)(void* arg);
+
+/* One unit of work */
+typedef struct {
+    TaskFunc func;
+    void* arg;
+} Task;
+
+/* Per-worker double-ended queue. The owner pushes and pops at the
+ * bottom; idle workers steal from the top. */
+typedef struct {
+    pthread_mutex_t lock;
+    Task* tasks;
+    int top;
+    int bottom;
+    int capacity;
+} WorkQueue;
+
+/* Fixed-size pool of worker threads with work stealing */
+typedef struct {
+    pthread_t* threads;
+    WorkQueue* queues;
+    int count;
+    int nextQueue;          // Round-robin target for poolSubmit
+    pthread_mutex_t lock;   // Guards the counters below
+    pthread_cond_t workReady;
+    pthread_cond_t allDone;
+    int queued;             // Tasks sitting in some queue
+    int pending;            // Tasks submitted but not finished
+    int shutdown;
+} ThreadPool;
+
+ThreadPool* poolCreate(int threads);
+void poolSubmit(ThreadPool* pool, TaskFunc func, void* arg);
+void poolWait(ThreadPool* pool);
+void poolDestroy(ThreadPool* pool);
+int poolTaskCount(ThreadPool* pool, int items);
+int poolDefaultSize();
+
+#endif
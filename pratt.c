@@ -0,0 +1,399 @@
+/* HAND-WRITTEN PARSER
+ * Recursive descent for functions and statements, which never nest,
+ * and precedence climbing for expressions. An expression is parsed
+ * with three explicit stacks instead of recursion: operands, pending
+ * binary operators, and frames for the constructs that open a nested
+ * expression (parentheses, array indices, call arguments). Each frame
+ * remembers how many operators were pending when it opened, so an
+ * operator never reaches past the frame it belongs to.
+ *
+ * Tokens are read only when a decision needs them, as bison does, and
+ * nodes are created when bison would reduce the rule that builds them.
+ * The AST, the interned names and the diagnostics therefore come out
+ * exactly as with parser.y.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pratt.h"
+#include "context.h"
+
+#define NO_TOKEN -1
+
+typedef enum {
+    FRAME_PAREN,            // ( expr )
+    FRAME_INDEX,            // name[expr], maybe followed by [expr]
+    FRAME_INDEX_2D,         // name[row][expr]
+    FRAME_CALL,             // name(expr, ...)
+} FrameKind;
+
+typedef struct {
+    FrameKind kind;
+    NameId name;            // Array or function
+    NodeId row;             // FRAME_INDEX_2D: the first index
+    uint32_t list;          // FRAME_CALL: start of the arguments (beginList)
+    size_t operators;       // Operators pending when the frame opened
+} Frame;
+
+typedef struct {
+    CompilerContext* ctx;
+    AST* ast;
+    Scanner* scanner;
+    int token;              // Lookahead, or NO_TOKEN if none was read
+    YYSTYPE value;
+
+    NodeId* operands;
+    size_t operandCount, operandCapacity;
+    char* operators;
+    size_t operatorCount, operatorCapacity;
+    Frame* frames;
+    size_t frameCount, frameCapacity;
+} Parser;
+
+/* ============ STACKS ============ */
+
+// Make room for one more item. If memory runs out the AST is marked
+// failed, as when its arena does, and the expression is abandoned.
+static int reserve(Parser* p, void** items, size_t count, size_t* capacity, size_t size) {
+    if (count < *capacity) return 0;
+    size_t grown = *capacity ? *capacity * 2 : 64;
+    void* moved = realloc(*items, grown * size);
+    if (!moved) {
+        p->ast->failed = 1;
+        return -1;
+    }
+    *items = moved;
+    *capacity = grown;
+    return 0;
+}
+
+static void pushOperand(Parser* p, NodeId node) {
+    if (reserve(p, (void**)&p->operands, p->operandCount, &p->operandCapacity, sizeof(NodeId)) != 0) return;
+    p->operands[p->operandCount++] = node;
+}
+
+static NodeId popOperand(Parser* p) {
+    return p->operands[--p->operandCount];
+}
+
+// NULL if memory ran out
+static Frame* pushFrame(Parser* p, FrameKind kind, NameId name) {
+    if (reserve(p, (void**)&p->frames, p->frameCount, &p->frameCapacity, sizeof(Frame)) != 0) return NULL;
+    Frame* frame = &p->frames[p->frameCount++];
+    memset(frame, 0, sizeof(Frame));
+    frame->kind = kind;
+    frame->name = name;
+    frame->operators = p->operatorCount;
+    return frame;
+}
+
+/* ============ TOKENS ============ */
+
+static int peek(Parser* p) {
+    if (p->token == NO_TOKEN) p->token = scannerNext(p->scanner, &p->value);
+    return p->token;
+}
+
+static void advance(Parser* p) {
+    p->token = NO_TOKEN;
+}
+
+static int accept(Parser* p, int token) {
+    if (peek(p) != token) return 0;
+    advance(p);
+    return 1;
+}
+
+// Always returns 1, for use as the failing result
+static int syntaxError(Parser* p) {
+    compilerError(p->ctx, "Syntax Error: syntax error");
+    return 1;
+}
+
+// 0 if the next token is the one expected
+static int expect(Parser* p, int token) {
+    return accept(p, token) ? 0 : syntaxError(p);
+}
+
+static int expectName(Parser* p, NameId* name) {
+    if (peek(p) != ID) return syntaxError(p);
+    *name = p->value.name;
+    advance(p);
+    return 0;
+}
+
+static int expectNumber(Parser* p, int* value) {
+    if (peek(p) != NUM) return syntaxError(p);
+    *value = p->value.num;
+    advance(p);
+    return 0;
+}
+
+/* ============ EXPRESSIONS ============ */
+
+// '+' and '-' bind alike and less than '*', all to the left
+static int precedence(int token) {
+    if (token == '*') return 2;
+    return token == '+' || token == '-' ? 1 : 0;
+}
+
+// Apply the pending operators above the innermost frame that bind at
+// least as tightly as prec
+static void reduce(Parser* p, int prec) {
+    size_t base = p->frameCount ? p->frames[p->frameCount - 1].operators : 0;
+    while (p->operatorCount > base && precedence(p->operators[p->operatorCount - 1]) >= prec) {
+        char op = p->operators[--p->operatorCount];
+        NodeId right = popOperand(p);
+        NodeId left = popOperand(p);
+        pushOperand(p, createBinOp(p->ast, op, left, right));
+    }
+}
+
+// Read one operand. Returns 0 with *open set if it opened a frame
+// instead, so another operand follows.
+static int parseOperand(Parser* p, int* open) {
+    *open = 0;
+    int token = peek(p);
+    if (token == NUM) {
+        pushOperand(p, createNum(p->ast, p->value.num));
+        advance(p);
+        return 0;
+    }
+    if (token == '(') {
+        advance(p);
+        pushFrame(p, FRAME_PAREN, 0);
+        *open = 1;
+        return 0;
+    }
+    if (token != ID) return syntaxError(p);
+    NameId name = p->value.name;
+    advance(p);
+    if (accept(p, '[')) {
+        pushFrame(p, FRAME_INDEX, name);
+        *open = 1;
+    } else if (accept(p, '(')) {
+        if (accept(p, ')')) {
+            pushOperand(p, createFuncCall(p->ast, name, 0));
+        } else {
+            Frame* frame = pushFrame(p, FRAME_CALL, name);
+            if (frame) frame->list = beginList(p->ast);
+            *open = 1;
+        }
+    } else {
+        pushOperand(p, createVar(p->ast, name));
+    }
+    return 0;
+}
+
+// The expression in the innermost frame is complete: consume what
+// closes it. Returns 0 with *open set if the frame goes on with
+// another expression (a second index, the next argument).
+static int closeFrame(Parser* p, int* open) {
+    Frame* frame = &p->frames[p->frameCount - 1];
+    NodeId value = popOperand(p);
+    *open = 0;
+    switch (frame->kind) {
+        case FRAME_PAREN:
+            if (expect(p, ')') != 0) return 1;
+            p->frameCount--;
+            pushOperand(p, value);
+            return 0;
+        case FRAME_INDEX:
+            if (expect(p, ']') != 0) return 1;
+            if (accept(p, '[')) {
+                frame->kind = FRAME_INDEX_2D;
+                frame->row = value;
+                *open = 1;
+                return 0;
+            }
+            p->frameCount--;
+            pushOperand(p, createArrayAccess(p->ast, frame->name, value));
+            return 0;
+        case FRAME_INDEX_2D:
+            if (expect(p, ']') != 0) return 1;
+            p->frameCount--;
+            pushOperand(p, createArray2DAccess(p->ast, frame->name, frame->row, value));
+            return 0;
+        case FRAME_CALL:
+            appendToList(p->ast, value);
+            if (accept(p, ',')) {
+                *open = 1;
+                return 0;
+            }
+            if (expect(p, ')') != 0) return 1;
+            p->frameCount--;
+            pushOperand(p, createFuncCall(p->ast, frame->name, endList(p->ast, NODE_ARG_LIST, frame->list)));
+            return 0;
+    }
+    return 1;
+}
+
+static int parseExpression(Parser* p, NodeId* result) {
+    p->operandCount = p->operatorCount = p->frameCount = 0;
+    int wantOperand = 1;
+    for (;;) {
+        // A push that ran out of memory leaves the stacks short
+        if (p->ast->failed) return 1;
+        if (wantOperand) {
+            if (parseOperand(p, &wantOperand) != 0) return 1;
+            continue;
+        }
+        int token = peek(p);
+        if (precedence(token)) {
+            reduce(p, precedence(token));
+            if (reserve(p, (void**)&p->operators, p->operatorCount, &p->operatorCapacity, 1) != 0) return 1;
+            p->operators[p->operatorCount++] = (char)token;
+            advance(p);
+            wantOperand = 1;
+            continue;
+        }
+        reduce(p, 0);
+        if (p->frameCount == 0) {
+            *result = popOperand(p);
+            return 0;
+        }
+        if (closeFrame(p, &wantOperand) != 0) return 1;
+    }
+}
+
+// expr followed by the token that ends it
+static int parseExpressionThen(Parser* p, int token, NodeId* result) {
+    return parseExpression(p, result) != 0 || expect(p, token) != 0;
+}
+
+/* ============ STATEMENTS ============ */
+
+// INT ID ';'  |  INT ID '[' NUM ']' ';'  |  INT ID '[' NUM ']' '[' NUM ']' ';'
+static int parseDeclaration(Parser* p, NodeId* stmt) {
+    NameId name;
+    int rows, cols;
+    if (expectName(p, &name) != 0) return 1;
+    if (accept(p, ';')) {
+        *stmt = createDecl(p->ast, name);
+        return 0;
+    }
+    if (expect(p, '[') != 0 || expectNumber(p, &rows) != 0 || expect(p, ']') != 0) return 1;
+    if (accept(p, ';')) {
+        *stmt = createArrayDecl(p->ast, name, rows);
+        return 0;
+    }
+    if (expect(p, '[') != 0 || expectNumber(p, &cols) != 0 || expect(p, ']') != 0 || expect(p, ';') != 0) {
+        return 1;
+    }
+    *stmt = createArray2DDecl(p->ast, name, rows, cols);
+    return 0;
+}
+
+// ID '=' expr ';'  |  ID '[' expr ']' '=' expr ';'  |  ID '[' expr ']' '[' expr ']' '=' expr ';'
+static int parseAssignment(Parser* p, NameId name, NodeId* stmt) {
+    NodeId row, col, value;
+    if (accept(p, '=')) {
+        if (parseExpressionThen(p, ';', &value) != 0) return 1;
+        *stmt = createAssign(p->ast, name, value);
+        return 0;
+    }
+    if (expect(p, '[') != 0 || parseExpressionThen(p, ']', &row) != 0) return 1;
+    if (accept(p, '=')) {
+        if (parseExpressionThen(p, ';', &value) != 0) return 1;
+        *stmt = createArrayAssign(p->ast, name, row, value);
+        return 0;
+    }
+    if (expect(p, '[') != 0 || parseExpressionThen(p, ']', &col) != 0 || expect(p, '=') != 0 ||
+        parseExpressionThen(p, ';', &value) != 0) {
+        return 1;
+    }
+    *stmt = createArray2DAssign(p->ast, name, row, col, value);
+    return 0;
+}
+
+static int parseStatement(Parser* p, NodeId* stmt) {
+    NodeId expr;
+    switch (peek(p)) {
+        case INT:
+            advance(p);
+            return parseDeclaration(p, stmt);
+        case ID: {
+            NameId name = p->value.name;
+            advance(p);
+            return parseAssignment(p, name, stmt);
+        }
+        case PRINT:
+            advance(p);
+            if (expect(p, '(') != 0 || parseExpressionThen(p, ')', &expr) != 0 || expect(p, ';') != 0) {
+                return 1;
+            }
+            *stmt = createPrint(p->ast, expr);
+            return 0;
+        case RETURN:
+            advance(p);
+            if (accept(p, ';')) {
+                *stmt = createReturn(p->ast, 0);
+                return 0;
+            }
+            if (parseExpressionThen(p, ';', &expr) != 0) return 1;
+            *stmt = createReturn(p->ast, expr);
+            return 0;
+        default:
+            return syntaxError(p);
+    }
+}
+
+/* ============ FUNCTIONS ============ */
+
+// type ID '(' [INT ID {',' INT ID}] ')' '{' stmt {stmt} '}'
+static int parseFunction(Parser* p, NodeId* func) {
+    int token = peek(p);
+    if (token != INT && token != VOID) return syntaxError(p);
+    advance(p);
+    // Interned before the name is read, as bison reduces type first
+    NameId type = token == INT ? internName(&p->ctx->strings, "int", 3)
+                               : internName(&p->ctx->strings, "void", 4);
+    NameId name;
+    if (expectName(p, &name) != 0 || expect(p, '(') != 0) return 1;
+
+    int hasParams = !accept(p, ')');
+    uint32_t params = beginList(p->ast);
+    while (hasParams) {
+        NameId param;
+        if (expect(p, INT) != 0 || expectName(p, &param) != 0) return 1;
+        appendToList(p->ast, createParam(p->ast, internName(&p->ctx->strings, "int", 3), param));
+        if (accept(p, ')')) break;
+        if (expect(p, ',') != 0) return 1;
+    }
+
+    if (expect(p, '{') != 0) return 1;
+    uint32_t body = beginList(p->ast);
+    do {
+        NodeId stmt;
+        if (parseStatement(p, &stmt) != 0) return 1;
+        appendToList(p->ast, stmt);
+    } while (!accept(p, '}'));
+
+    NodeId bodyList = endList(p->ast, NODE_STMT_LIST, body);
+    NodeId paramList = hasParams ? endList(p->ast, NODE_PARAM_LIST, params) : 0;
+    *func = createFuncDecl(p->ast, type, name, paramList, bodyList);
+    return 0;
+}
+
+int prattParse(CompilerContext* ctx, Scanner* scanner) {
+    Parser p;
+    memset(&p, 0, sizeof(Parser));
+    p.ctx = ctx;
+    p.ast = &ctx->ast;
+    p.scanner = scanner;
+    p.token = NO_TOKEN;
+
+    int failed = 0;
+    uint32_t funcs = beginList(p.ast);
+    do {
+        NodeId func;
+        failed = parseFunction(&p, &func) != 0;
+        if (!failed) parsedFunction(ctx, func);
+    } while (!failed && peek(&p) != 0);
+    if (!failed) ctx->root = endList(p.ast, NODE_FUNC_LIST, funcs);
+
+    free(p.operands);
+    free(p.operators);
+    free(p.frames);
+    return failed;
+}
@@ -0,0 +1,16 @@
+#ifndef PRATT_H
+#define PRATT_H
+
+#include "lexer.h"
+
+struct CompilerContext;
+
+/* HAND-WRITTEN PARSER (--parser=pratt)
+ * Parses the grammar of parser.y into ctx->ast, building the same nodes
+ * in the same order as the bison parser, and reports errors the same
+ * way. Expressions are parsed by operator precedence on explicit stacks,
+ * so nesting depth is bounded by memory rather than by a parse stack
+ * limit or the C stack. Returns 0 on success. */
+int prattParse(struct CompilerContext* ctx, Scanner* scanner);
+
+#endif
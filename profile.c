@@ -0,0 +1,183 @@
+/* EXECUTION PROFILES
+ * The code generator lays out the counter block of an instrumented
+ * program through a Profile built from the AST: functions in source
+ * order, call sites appended as their calls are generated. The same
+ * structure holds a profile read back from the file the program wrote.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "profile.h"
+#include "incremental.h"
+
+/* ============ INSTRUMENTATION ============ */
+
+Profile* profileCreate(const AST* ast, NodeId root) {
+    Profile* profile = calloc(1, sizeof(Profile));
+    NodeId* funcs = NULL;
+    int count = profile ? collectFunctions(ast, root, &funcs) : -1;
+    if (count < 0 || (count > 0 && !(profile->functions = calloc(count, sizeof(ProfileFunction))))) {
+        free(funcs);
+        free(profile);
+        return NULL;
+    }
+    profile->functionCount = count;
+    for (int i = 0; i < count; i++) {
+        profile->functions[i].name = astName(ast, astNode(ast, funcs[i])->data.func_decl.name);
+        profile->functions[i].hash = functionBodyHash(ast, funcs[i]);
+    }
+    profile->current = -1;
+    free(funcs);
+    return profile;
+}
+
+int profileFindFunction(const Profile* profile, const char* name) {
+    for (int i = 0; i < profile->functionCount; i++) {
+        if (strcmp(profile->functions[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// Functions are generated in source order, one after another
+int profileBeginFunction(Profile* profile) {
+    int index = ++profile->current;
+    if (index < profile->functionCount) {
+        profile->functions[index].firstSite = profile->siteCount;
+    }
+    return index;
+}
+
+uint32_t profileEntryCounter(const Profile* profile, int function) {
+    return PROFILE_HEADER_SIZE + function * PROFILE_FUNCTION_SIZE + 8;
+}
+
+// Record a call of callee (a function's index, or -1 if there is no
+// such function) from the current function; returns the offset of its
+// counter in the block
+uint32_t profileAddSite(Profile* profile, int callee) {
+    if (profile->siteCount == profile->siteCapacity) {
+        profile->siteCapacity = profile->siteCapacity ? profile->siteCapacity * 2 : 64;
+        profile->sites = realloc(profile->sites, profile->siteCapacity * sizeof(ProfileSite));
+    }
+    ProfileSite* site = &profile->sites[profile->siteCount];
+    site->callee = callee < 0 ? PROFILE_NO_CALLEE : (uint32_t)callee;
+    site->count = 0;
+    profile->functions[profile->current].siteCount++;
+    return PROFILE_HEADER_SIZE + profile->functionCount * PROFILE_FUNCTION_SIZE +
+           profile->siteCount++ * PROFILE_SITE_SIZE + 4;
+}
+
+uint32_t profileNamesOffset(const Profile* profile) {
+    return PROFILE_HEADER_SIZE + profile->functionCount * PROFILE_FUNCTION_SIZE +
+           profile->siteCount * PROFILE_SITE_SIZE;
+}
+
+uint32_t profileSize(const Profile* profile) {
+    uint32_t size = profileNamesOffset(profile);
+    for (int i = 0; i < profile->functionCount; i++) {
+        size += strlen(profile->functions[i].name) + 1;
+    }
+    return (size + 3) & ~3u;
+}
+
+/* ============ READING ============ */
+
+static uint32_t get32(const unsigned char* p, int bigEndian) {
+    return bigEndian ? ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]
+                     : p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Check the block and point the functions and sites into it
+static int parseProfile(Profile* profile, const unsigned char* data, size_t size) {
+    if (size < PROFILE_HEADER_SIZE) return -1;
+    int bigEndian = get32(data, 1) == PROFILE_MAGIC;
+    if (get32(data, bigEndian) != PROFILE_MAGIC || get32(data + 4, bigEndian) != PROFILE_VERSION) {
+        return -1;
+    }
+    uint32_t functionCount = get32(data + 8, bigEndian);
+    uint32_t siteCount = get32(data + 12, bigEndian);
+    if (functionCount > size / PROFILE_FUNCTION_SIZE || siteCount > size / PROFILE_SITE_SIZE) return -1;
+    size_t namesOffset = PROFILE_HEADER_SIZE + (size_t)functionCount * PROFILE_FUNCTION_SIZE +
+                         (size_t)siteCount * PROFILE_SITE_SIZE;
+    if (namesOffset > size) return -1;
+
+    profile->functions = calloc(functionCount ? functionCount : 1, sizeof(ProfileFunction));
+    profile->sites = calloc(siteCount ? siteCount : 1, sizeof(ProfileSite));
+    if (!profile->functions || !profile->sites) return -1;
+    profile->functionCount = functionCount;
+    profile->siteCount = profile->siteCapacity = siteCount;
+
+    uint32_t sites = 0;
+    for (uint32_t i = 0; i < functionCount; i++) {
+        const unsigned char* record = data + PROFILE_HEADER_SIZE + i * PROFILE_FUNCTION_SIZE;
+        ProfileFunction* func = &profile->functions[i];
+        uint32_t name = get32(record, bigEndian);
+        if (name < namesOffset || name >= size || !memchr(data + name, '\0', size - name)) return -1;
+        func->name = (const char*)data + name;
+        func->hash = get32(record + 4, bigEndian);
+        func->entries = get32(record + 8, bigEndian);
+        func->siteCount = get32(record + 12, bigEndian);
+        func->firstSite = sites;
+        if (func->siteCount > siteCount - sites) return -1;
+        sites += func->siteCount;
+    }
+    if (sites != siteCount) return -1;
+    for (uint32_t i = 0; i < siteCount; i++) {
+        const unsigned char* record = data + PROFILE_HEADER_SIZE + functionCount * PROFILE_FUNCTION_SIZE +
+                                      i * PROFILE_SITE_SIZE;
+        profile->sites[i].callee = get32(record, bigEndian);
+        profile->sites[i].count = get32(record + 4, bigEndian);
+        if (profile->sites[i].callee >= functionCount && profile->sites[i].callee != PROFILE_NO_CALLEE) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Read the file an instrumented program wrote. Returns NULL (with the
+ * reason on diag) if it is missing or not a profile. */
+Profile* profileLoad(const char* filename, FILE* diag) {
+    FILE* in = fopen(filename, "rb");
+    if (!in) {
+        fprintf(diag, "Error: Cannot open profile '%s'\n", filename);
+        return NULL;
+    }
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    Profile* profile = calloc(1, sizeof(Profile));
+    unsigned char* data = malloc(size > 0 ? size : 1);
+    int ok = profile && data && size >= 0 && fread(data, 1, size, in) == (size_t)size;
+    fclose(in);
+    if (profile) profile->names = (char*)data;
+    if (!ok || parseProfile(profile, data, size) != 0) {
+        fprintf(diag, "Error: '%s' is not a profile written by an instrumented program\n", filename);
+        if (!profile) free(data);
+        profileFree(profile);
+        return NULL;
+    }
+    profile->current = -1;
+    return profile;
+}
+
+/* Functions with their entry counts, each followed by its call sites */
+void profilePrint(const Profile* profile, FILE* out) {
+    for (int i = 0; i < profile->functionCount; i++) {
+        const ProfileFunction* func = &profile->functions[i];
+        fprintf(out, "%-24s %12u entries  body %08x\n", func->name, func->entries, func->hash);
+        for (int s = func->firstSite; s < func->firstSite + func->siteCount; s++) {
+            const ProfileSite* site = &profile->sites[s];
+            const char* callee = site->callee == PROFILE_NO_CALLEE ? "?"
+                               : profile->functions[site->callee].name;
+            fprintf(out, "    call %-19s %12u\n", callee, site->count);
+        }
+    }
+}
+
+void profileFree(Profile* profile) {
+    if (!profile) return;
+    free(profile->functions);
+    free(profile->sites);
+    free(profile->names);
+    free(profile);
+}
@@ -0,0 +1,70 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "ast.h"
+
+/* EXECUTION PROFILES
+ * A -fprofile-generate build counts how often each function is entered
+ * and each call site is taken. When main returns, the program writes
+ * the counters to a file in the layout below, in its own byte order:
+ *
+ *   header     magic "MCPF", version, function count, call site count
+ *   functions  name offset, body hash, entry count, call site count
+ *   sites      callee (index into functions, or -1), call count
+ *   names      NUL-terminated, padded to a word
+ *
+ * Call sites are grouped by caller, in function order. Name offsets
+ * count from the start of the block. The body hash tells a profile
+ * that no longer matches its function apart from one that does.
+ */
+
+#define PROFILE_MAGIC 0x4D435046    // "MCPF"
+#define PROFILE_VERSION 1
+#define PROFILE_HEADER_SIZE 16
+#define PROFILE_FUNCTION_SIZE 16
+#define PROFILE_SITE_SIZE 8
+#define PROFILE_NO_CALLEE 0xFFFFFFFFu
+
+typedef struct {
+    const char* name;
+    uint32_t hash;          // functionBodyHash when it was measured
+    uint32_t entries;
+    int firstSite;
+    int siteCount;
+} ProfileFunction;
+
+typedef struct {
+    uint32_t callee;        // Index into functions, or PROFILE_NO_CALLEE
+    uint32_t count;
+} ProfileSite;
+
+/* A profile read from a file, or the counters of a program being
+ * instrumented (with all counts zero) */
+typedef struct Profile {
+    ProfileFunction* functions;
+    int functionCount;
+    ProfileSite* sites;
+    int siteCount;
+    int siteCapacity;
+    char* names;            // Loaded profiles: the names block
+    int current;            // Instrumenting: function being generated
+} Profile;
+
+/* INSTRUMENTATION */
+Profile* profileCreate(const AST* ast, NodeId root);
+int profileFindFunction(const Profile* profile, const char* name);
+int profileBeginFunction(Profile* profile);
+uint32_t profileEntryCounter(const Profile* profile, int function);
+uint32_t profileAddSite(Profile* profile, int callee);
+uint32_t profileNamesOffset(const Profile* profile);
+uint32_t profileSize(const Profile* profile);
+
+/* READING */
+Profile* profileLoad(const char* filename, FILE* diag);
+void profilePrint(const Profile* profile, FILE* out);
+
+void profileFree(Profile* profile);
+
+#endif
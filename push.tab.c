@@ -0,0 +1,1856 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 2
+
+/* Push parsers.  */
+#define YYPUSH 1
+
+/* Pull parsers.  */
+#define YYPULL 0
+
+
+
+
+/* First part of user prologue.  */
+#line 1 "parser.y"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "ast.h"
+#include "context.h"
+
+#line 81 "push.tab.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+/* "%code requires" blocks.  */
+#line 11 "parser.y"
+
+struct CompilerContext;
+struct Scanner;
+
+#line 118 "push.tab.c"
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    NUM = 258,                     /* NUM  */
+    ID = 259,                      /* ID  */
+    INT = 260,                     /* INT  */
+    PRINT = 261,                   /* PRINT  */
+    RETURN = 262,                  /* RETURN  */
+    VOID = 263                     /* VOID  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 38 "parser.y"
+
+    int num;
+    NameId name;
+    NodeId node;
+    uint32_t list;
+
+#line 150 "push.tab.c"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+
+
+
+#ifndef YYPUSH_MORE_DEFINED
+# define YYPUSH_MORE_DEFINED
+enum { YYPUSH_MORE = 4 };
+#endif
+
+typedef struct yypstate yypstate;
+
+
+int yypush_parse (yypstate *ps,
+                  int pushed_char, YYSTYPE const *pushed_val, struct Scanner* scanner, struct CompilerContext* ctx);
+
+yypstate *yypstate_new (void);
+void yypstate_delete (yypstate *ps);
+
+
+
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_NUM = 3,                        /* NUM  */
+  YYSYMBOL_ID = 4,                         /* ID  */
+  YYSYMBOL_INT = 5,                        /* INT  */
+  YYSYMBOL_PRINT = 6,                      /* PRINT  */
+  YYSYMBOL_RETURN = 7,                     /* RETURN  */
+  YYSYMBOL_VOID = 8,                       /* VOID  */
+  YYSYMBOL_9_ = 9,                         /* '+'  */
+  YYSYMBOL_10_ = 10,                       /* '-'  */
+  YYSYMBOL_11_ = 11,                       /* '*'  */
+  YYSYMBOL_12_ = 12,                       /* '/'  */
+  YYSYMBOL_13_ = 13,                       /* '='  */
+  YYSYMBOL_14_ = 14,                       /* '('  */
+  YYSYMBOL_15_ = 15,                       /* ')'  */
+  YYSYMBOL_16_ = 16,                       /* '{'  */
+  YYSYMBOL_17_ = 17,                       /* '}'  */
+  YYSYMBOL_18_ = 18,                       /* ','  */
+  YYSYMBOL_19_ = 19,                       /* ';'  */
+  YYSYMBOL_20_ = 20,                       /* '['  */
+  YYSYMBOL_21_ = 21,                       /* ']'  */
+  YYSYMBOL_YYACCEPT = 22,                  /* $accept  */
+  YYSYMBOL_program = 23,                   /* program  */
+  YYSYMBOL_func_list = 24,                 /* func_list  */
+  YYSYMBOL_func_decl = 25,                 /* func_decl  */
+  YYSYMBOL_type = 26,                      /* type  */
+  YYSYMBOL_param_list = 27,                /* param_list  */
+  YYSYMBOL_param = 28,                     /* param  */
+  YYSYMBOL_stmt_list = 29,                 /* stmt_list  */
+  YYSYMBOL_stmt = 30,                      /* stmt  */
+  YYSYMBOL_decl = 31,                      /* decl  */
+  YYSYMBOL_array_decl = 32,                /* array_decl  */
+  YYSYMBOL_array_2d_decl = 33,             /* array_2d_decl  */
+  YYSYMBOL_assign = 34,                    /* assign  */
+  YYSYMBOL_array_assign = 35,              /* array_assign  */
+  YYSYMBOL_array_2d_assign = 36,           /* array_2d_assign  */
+  YYSYMBOL_print_stmt = 37,                /* print_stmt  */
+  YYSYMBOL_return_stmt = 38,               /* return_stmt  */
+  YYSYMBOL_arg_list = 39,                  /* arg_list  */
+  YYSYMBOL_expr = 40                       /* expr  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+/* Unqualified %code blocks.  */
+#line 21 "parser.y"
+
+#include "lexer.h"
+#include "pratt.h"
+
+#if YYPULL
+static int yylex(YYSTYPE* value, struct Scanner* scanner) {
+    return scannerNext(scanner, value);
+}
+#endif
+
+static void yyerror(struct Scanner* scanner, struct CompilerContext* ctx, const char* s);
+
+#line 241 "push.tab.c"
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  7
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   122
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  22
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  19
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  42
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  95
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   263
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+      14,    15,    11,     9,    18,    10,     2,    12,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,    19,
+       2,    13,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,    20,     2,    21,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    16,     2,    17,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_uint8 yyrline[] =
+{
+       0,    65,    65,    68,    69,    72,    78,    82,    83,    86,
+      87,    90,    93,    94,    97,    98,    99,   100,   101,   102,
+     103,   104,   107,   110,   113,   116,   119,   122,   126,   129,
+     130,   133,   134,   137,   138,   139,   140,   141,   142,   143,
+     144,   145,   146
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "NUM", "ID", "INT",
+  "PRINT", "RETURN", "VOID", "'+'", "'-'", "'*'", "'/'", "'='", "'('",
+  "')'", "'{'", "'}'", "','", "';'", "'['", "']'", "$accept", "program",
+  "func_list", "func_decl", "type", "param_list", "param", "stmt_list",
+  "stmt", "decl", "array_decl", "array_2d_decl", "assign", "array_assign",
+  "array_2d_assign", "print_stmt", "return_stmt", "arg_list", "expr", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-36)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-1)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int8 yypact[] =
+{
+      66,   -36,   -36,    40,    66,   -36,    52,   -36,   -36,    47,
+      38,    84,    56,    87,   -36,   -36,    94,    70,    99,    -6,
+     103,    96,     5,     6,   -36,   -36,   -36,   -36,   -36,   -36,
+     -36,   -36,   -36,    94,   -36,    27,    27,    16,    27,   -36,
+      55,    27,   -36,    54,   -36,   -36,    22,    57,    23,   -36,
+     108,    74,     1,    27,    82,    27,    27,    27,   -36,   -36,
+     -36,    35,    91,    95,   -36,    88,    85,    36,   -36,   102,
+     102,   -36,    27,    27,    89,   -36,   -36,    27,    97,    68,
+      41,   -36,   112,    85,    27,   -36,   105,    98,    49,    27,
+     101,   -36,    71,   -36,   -36
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       0,     7,     8,     0,     2,     3,     0,     1,     4,     0,
+       0,     0,     0,     0,     9,    11,     0,     0,     0,     0,
+       0,     0,     0,     0,    12,    14,    18,    20,    15,    19,
+      21,    16,    17,     0,    10,     0,     0,     0,     0,    37,
+      38,     0,    30,     0,     6,    13,     0,     0,     0,    22,
+       0,     0,     0,     0,     0,     0,     0,     0,    29,     5,
+      25,     0,     0,     0,    42,     0,    31,     0,    36,    33,
+      34,    35,     0,     0,     0,    28,    41,     0,    39,     0,
+       0,    23,     0,    32,     0,    26,     0,     0,     0,     0,
+       0,    40,     0,    24,    27
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int8 yypgoto[] =
+{
+     -36,   -36,   -36,   117,   -36,   -36,   104,    83,   -21,   -36,
+     -36,   -36,   -36,   -36,   -36,   -36,   -36,   -36,   -35
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,     3,     4,     5,     6,    13,    14,    23,    24,    25,
+      26,    27,    28,    29,    30,    31,    32,    65,    43
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
+{
+      47,    48,    45,    51,    39,    40,    54,    35,    39,    40,
+      19,    20,    21,    22,    36,    41,    64,    66,    67,    41,
+      69,    70,    71,    44,    42,    45,    19,    20,    21,    22,
+      39,    40,    55,    56,    57,    49,    50,    79,    80,    59,
+       7,    41,    83,    11,    61,    55,    56,    57,    72,    88,
+      55,    56,    57,    12,    92,    73,     9,    78,    55,    56,
+      57,    10,    86,    55,    56,    57,    55,    56,    57,    52,
+      91,     1,    16,    58,     2,    53,    60,    55,    56,    57,
+      55,    56,    57,    55,    56,    57,    33,    85,    15,    63,
+      94,    55,    56,    57,    55,    56,    57,    68,    19,    20,
+      21,    22,    17,    76,    11,    18,    77,    37,    81,    82,
+      38,    62,    74,    57,    75,    87,    46,    84,    89,    90,
+      93,     8,    34
+};
+
+static const yytype_int8 yycheck[] =
+{
+      35,    36,    23,    38,     3,     4,    41,    13,     3,     4,
+       4,     5,     6,     7,    20,    14,    15,    52,    53,    14,
+      55,    56,    57,    17,    19,    46,     4,     5,     6,     7,
+       3,     4,     9,    10,    11,    19,    20,    72,    73,    17,
+       0,    14,    77,     5,    21,     9,    10,    11,    13,    84,
+       9,    10,    11,    15,    89,    20,     4,    21,     9,    10,
+      11,    14,    21,     9,    10,    11,     9,    10,    11,    14,
+      21,     5,    16,    19,     8,    20,    19,     9,    10,    11,
+       9,    10,    11,     9,    10,    11,    16,    19,     4,    15,
+      19,     9,    10,    11,     9,    10,    11,    15,     4,     5,
+       6,     7,    15,    15,     5,    18,    18,     4,    19,    20,
+      14,     3,    21,    11,    19,     3,    33,    20,    13,    21,
+      19,     4,    18
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,     5,     8,    23,    24,    25,    26,     0,    25,     4,
+      14,     5,    15,    27,    28,     4,    16,    15,    18,     4,
+       5,     6,     7,    29,    30,    31,    32,    33,    34,    35,
+      36,    37,    38,    16,    28,    13,    20,     4,    14,     3,
+       4,    14,    19,    40,    17,    30,    29,    40,    40,    19,
+      20,    40,    14,    20,    40,     9,    10,    11,    19,    17,
+      19,    21,     3,    15,    15,    39,    40,    40,    15,    40,
+      40,    40,    13,    20,    21,    19,    15,    18,    21,    40,
+      40,    19,    20,    40,    20,    19,    21,     3,    40,    13,
+      21,    21,    40,    19,    19
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    22,    23,    24,    24,    25,    25,    26,    26,    27,
+      27,    28,    29,    29,    30,    30,    30,    30,    30,    30,
+      30,    30,    31,    32,    33,    34,    35,    36,    37,    38,
+      38,    39,    39,    40,    40,    40,    40,    40,    40,    40,
+      40,    40,    40
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     1,     2,     8,     7,     1,     1,     1,
+       3,     2,     1,     2,     1,     1,     1,     1,     1,     1,
+       1,     1,     3,     6,     9,     4,     7,    10,     5,     3,
+       2,     1,     3,     3,     3,     3,     3,     1,     1,     4,
+       7,     4,     3
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (scanner, ctx, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, scanner, ctx); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, struct Scanner* scanner, struct CompilerContext* ctx)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (scanner);
+  YY_USE (ctx);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, struct Scanner* scanner, struct CompilerContext* ctx)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep, scanner, ctx);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, struct Scanner* scanner, struct CompilerContext* ctx)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], scanner, ctx);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule, scanner, ctx); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+/* Parser data structure.  */
+struct yypstate
+  {
+    /* Number of syntax errors so far.  */
+    int yynerrs;
+
+    yy_state_fast_t yystate;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss;
+    yy_state_t *yyssp;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs;
+    YYSTYPE *yyvsp;
+    /* Whether this instance has not started parsing yet.
+     * If 2, it corresponds to a finished parsing.  */
+    int yynew;
+  };
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, struct Scanner* scanner, struct CompilerContext* ctx)
+{
+  YY_USE (yyvaluep);
+  YY_USE (scanner);
+  YY_USE (ctx);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+
+
+
+#define yynerrs yyps->yynerrs
+#define yystate yyps->yystate
+#define yyerrstatus yyps->yyerrstatus
+#define yyssa yyps->yyssa
+#define yyss yyps->yyss
+#define yyssp yyps->yyssp
+#define yyvsa yyps->yyvsa
+#define yyvs yyps->yyvs
+#define yyvsp yyps->yyvsp
+#define yystacksize yyps->yystacksize
+
+/* Initialize the parser data structure.  */
+static void
+yypstate_clear (yypstate *yyps)
+{
+  yynerrs = 0;
+  yystate = 0;
+  yyerrstatus = 0;
+
+  yyssp = yyss;
+  yyvsp = yyvs;
+
+  /* Initialize the state stack, in case yypcontext_expected_tokens is
+     called before the first call to yyparse. */
+  *yyssp = 0;
+  yyps->yynew = 1;
+}
+
+/* Initialize the parser data structure.  */
+yypstate *
+yypstate_new (void)
+{
+  yypstate *yyps;
+  yyps = YY_CAST (yypstate *, YYMALLOC (sizeof *yyps));
+  if (!yyps)
+    return YY_NULLPTR;
+  yystacksize = YYINITDEPTH;
+  yyss = yyssa;
+  yyvs = yyvsa;
+  yypstate_clear (yyps);
+  return yyps;
+}
+
+void
+yypstate_delete (yypstate *yyps)
+{
+  if (yyps)
+    {
+#ifndef yyoverflow
+      /* If the stack was reallocated but the parse did not complete, then the
+         stack still needs to be freed.  */
+      if (yyss != yyssa)
+        YYSTACK_FREE (yyss);
+#endif
+      YYFREE (yyps);
+    }
+}
+
+
+
+/*---------------.
+| yypush_parse.  |
+`---------------*/
+
+int
+yypush_parse (yypstate *yyps,
+              int yypushed_char, YYSTYPE const *yypushed_val, struct Scanner* scanner, struct CompilerContext* ctx)
+{
+/* Lookahead token kind.  */
+int yychar;
+
+
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  switch (yyps->yynew)
+    {
+    case 0:
+      yyn = yypact[yystate];
+      goto yyread_pushed_token;
+
+    case 2:
+      yypstate_clear (yyps);
+      break;
+
+    default:
+      break;
+    }
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      if (!yyps->yynew)
+        {
+          YYDPRINTF ((stderr, "Return for a new token:\n"));
+          yyresult = YYPUSH_MORE;
+          goto yypushreturn;
+        }
+      yyps->yynew = 0;
+yyread_pushed_token:
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yypushed_char;
+      if (yypushed_val)
+        yylval = *yypushed_val;
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* program: func_list  */
+#line 65 "parser.y"
+                   { ctx->root = endList(&ctx->ast, NODE_FUNC_LIST, (yyvsp[0].list)); (yyval.node) = 0; }
+#line 1327 "push.tab.c"
+    break;
+
+  case 3: /* func_list: func_decl  */
+#line 68 "parser.y"
+                     { (yyval.list) = beginList(&ctx->ast); parsedFunction(ctx, (yyvsp[0].node)); }
+#line 1333 "push.tab.c"
+    break;
+
+  case 4: /* func_list: func_list func_decl  */
+#line 69 "parser.y"
+                               { (yyval.list) = (yyvsp[-1].list); parsedFunction(ctx, (yyvsp[0].node)); }
+#line 1339 "push.tab.c"
+    break;
+
+  case 5: /* func_decl: type ID '(' param_list ')' '{' stmt_list '}'  */
+#line 73 "parser.y"
+         {
+             NodeId body = endList(&ctx->ast, NODE_STMT_LIST, (yyvsp[-1].list));
+             NodeId params = endList(&ctx->ast, NODE_PARAM_LIST, (yyvsp[-4].list));
+             (yyval.node) = createFuncDecl(&ctx->ast, (yyvsp[-7].name), (yyvsp[-6].name), params, body);
+         }
+#line 1349 "push.tab.c"
+    break;
+
+  case 6: /* func_decl: type ID '(' ')' '{' stmt_list '}'  */
+#line 79 "parser.y"
+         { (yyval.node) = createFuncDecl(&ctx->ast, (yyvsp[-6].name), (yyvsp[-5].name), 0, endList(&ctx->ast, NODE_STMT_LIST, (yyvsp[-1].list))); }
+#line 1355 "push.tab.c"
+    break;
+
+  case 7: /* type: INT  */
+#line 82 "parser.y"
+          { (yyval.name) = internName(&ctx->strings, "int", 3); }
+#line 1361 "push.tab.c"
+    break;
+
+  case 8: /* type: VOID  */
+#line 83 "parser.y"
+           { (yyval.name) = internName(&ctx->strings, "void", 4); }
+#line 1367 "push.tab.c"
+    break;
+
+  case 9: /* param_list: param  */
+#line 86 "parser.y"
+                  { (yyval.list) = beginList(&ctx->ast); appendToList(&ctx->ast, (yyvsp[0].node)); }
+#line 1373 "push.tab.c"
+    break;
+
+  case 10: /* param_list: param_list ',' param  */
+#line 87 "parser.y"
+                                 { (yyval.list) = (yyvsp[-2].list); appendToList(&ctx->ast, (yyvsp[0].node)); }
+#line 1379 "push.tab.c"
+    break;
+
+  case 11: /* param: INT ID  */
+#line 90 "parser.y"
+              { (yyval.node) = createParam(&ctx->ast, internName(&ctx->strings, "int", 3), (yyvsp[0].name)); }
+#line 1385 "push.tab.c"
+    break;
+
+  case 12: /* stmt_list: stmt  */
+#line 93 "parser.y"
+                { (yyval.list) = beginList(&ctx->ast); appendToList(&ctx->ast, (yyvsp[0].node)); }
+#line 1391 "push.tab.c"
+    break;
+
+  case 13: /* stmt_list: stmt_list stmt  */
+#line 94 "parser.y"
+                          { (yyval.list) = (yyvsp[-1].list); appendToList(&ctx->ast, (yyvsp[0].node)); }
+#line 1397 "push.tab.c"
+    break;
+
+  case 22: /* decl: INT ID ';'  */
+#line 107 "parser.y"
+                 { (yyval.node) = createDecl(&ctx->ast, (yyvsp[-1].name)); }
+#line 1403 "push.tab.c"
+    break;
+
+  case 23: /* array_decl: INT ID '[' NUM ']' ';'  */
+#line 110 "parser.y"
+                                   { (yyval.node) = createArrayDecl(&ctx->ast, (yyvsp[-4].name), (yyvsp[-2].num)); }
+#line 1409 "push.tab.c"
+    break;
+
+  case 24: /* array_2d_decl: INT ID '[' NUM ']' '[' NUM ']' ';'  */
+#line 113 "parser.y"
+                                                  { (yyval.node) = createArray2DDecl(&ctx->ast, (yyvsp[-7].name), (yyvsp[-5].num), (yyvsp[-2].num)); }
+#line 1415 "push.tab.c"
+    break;
+
+  case 25: /* assign: ID '=' expr ';'  */
+#line 116 "parser.y"
+                        { (yyval.node) = createAssign(&ctx->ast, (yyvsp[-3].name), (yyvsp[-1].node)); }
+#line 1421 "push.tab.c"
+    break;
+
+  case 26: /* array_assign: ID '[' expr ']' '=' expr ';'  */
+#line 119 "parser.y"
+                                           { (yyval.node) = createArrayAssign(&ctx->ast, (yyvsp[-6].name), (yyvsp[-4].node), (yyvsp[-1].node)); }
+#line 1427 "push.tab.c"
+    break;
+
+  case 27: /* array_2d_assign: ID '[' expr ']' '[' expr ']' '=' expr ';'  */
+#line 123 "parser.y"
+               { (yyval.node) = createArray2DAssign(&ctx->ast, (yyvsp[-9].name), (yyvsp[-7].node), (yyvsp[-4].node), (yyvsp[-1].node)); }
+#line 1433 "push.tab.c"
+    break;
+
+  case 28: /* print_stmt: PRINT '(' expr ')' ';'  */
+#line 126 "parser.y"
+                                   { (yyval.node) = createPrint(&ctx->ast, (yyvsp[-2].node)); }
+#line 1439 "push.tab.c"
+    break;
+
+  case 29: /* return_stmt: RETURN expr ';'  */
+#line 129 "parser.y"
+                             { (yyval.node) = createReturn(&ctx->ast, (yyvsp[-1].node)); }
+#line 1445 "push.tab.c"
+    break;
+
+  case 30: /* return_stmt: RETURN ';'  */
+#line 130 "parser.y"
+                        { (yyval.node) = createReturn(&ctx->ast, 0); }
+#line 1451 "push.tab.c"
+    break;
+
+  case 31: /* arg_list: expr  */
+#line 133 "parser.y"
+               { (yyval.list) = beginList(&ctx->ast); appendToList(&ctx->ast, (yyvsp[0].node)); }
+#line 1457 "push.tab.c"
+    break;
+
+  case 32: /* arg_list: arg_list ',' expr  */
+#line 134 "parser.y"
+                            { (yyval.list) = (yyvsp[-2].list); appendToList(&ctx->ast, (yyvsp[0].node)); }
+#line 1463 "push.tab.c"
+    break;
+
+  case 33: /* expr: expr '+' expr  */
+#line 137 "parser.y"
+                    { (yyval.node) = createBinOp(&ctx->ast, '+', (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1469 "push.tab.c"
+    break;
+
+  case 34: /* expr: expr '-' expr  */
+#line 138 "parser.y"
+                    { (yyval.node) = createBinOp(&ctx->ast, '-', (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1475 "push.tab.c"
+    break;
+
+  case 35: /* expr: expr '*' expr  */
+#line 139 "parser.y"
+                    { (yyval.node) = createBinOp(&ctx->ast, '*', (yyvsp[-2].node), (yyvsp[0].node)); }
+#line 1481 "push.tab.c"
+    break;
+
+  case 36: /* expr: '(' expr ')'  */
+#line 140 "parser.y"
+                   { (yyval.node) = (yyvsp[-1].node); }
+#line 1487 "push.tab.c"
+    break;
+
+  case 37: /* expr: NUM  */
+#line 141 "parser.y"
+          { (yyval.node) = createNum(&ctx->ast, (yyvsp[0].num)); }
+#line 1493 "push.tab.c"
+    break;
+
+  case 38: /* expr: ID  */
+#line 142 "parser.y"
+         { (yyval.node) = createVar(&ctx->ast, (yyvsp[0].name)); }
+#line 1499 "push.tab.c"
+    break;
+
+  case 39: /* expr: ID '[' expr ']'  */
+#line 143 "parser.y"
+                      { (yyval.node) = createArrayAccess(&ctx->ast, (yyvsp[-3].name), (yyvsp[-1].node)); }
+#line 1505 "push.tab.c"
+    break;
+
+  case 40: /* expr: ID '[' expr ']' '[' expr ']'  */
+#line 144 "parser.y"
+                                   { (yyval.node) = createArray2DAccess(&ctx->ast, (yyvsp[-6].name), (yyvsp[-4].node), (yyvsp[-1].node)); }
+#line 1511 "push.tab.c"
+    break;
+
+  case 41: /* expr: ID '(' arg_list ')'  */
+#line 145 "parser.y"
+                          { (yyval.node) = createFuncCall(&ctx->ast, (yyvsp[-3].name), endList(&ctx->ast, NODE_ARG_LIST, (yyvsp[-1].list))); }
+#line 1517 "push.tab.c"
+    break;
+
+  case 42: /* expr: ID '(' ')'  */
+#line 146 "parser.y"
+                 { (yyval.node) = createFuncCall(&ctx->ast, (yyvsp[-2].name), 0); }
+#line 1523 "push.tab.c"
+    break;
+
+
+#line 1527 "push.tab.c"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (scanner, ctx, YY_("syntax error"));
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, scanner, ctx);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, scanner, ctx);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (scanner, ctx, YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, scanner, ctx);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, scanner, ctx);
+      YYPOPSTACK (1);
+    }
+  yyps->yynew = 2;
+  goto yypushreturn;
+
+
+/*-------------------------.
+| yypushreturn -- return.  |
+`-------------------------*/
+yypushreturn:
+
+  return yyresult;
+}
+#undef yynerrs
+#undef yystate
+#undef yyerrstatus
+#undef yyssa
+#undef yyss
+#undef yyssp
+#undef yyvsa
+#undef yyvs
+#undef yyvsp
+#undef yystacksize
+#line 149 "parser.y"
+
+
+static void yyerror(struct Scanner* scanner, struct CompilerContext* ctx, const char* s) {
+    (void)scanner;
+    compilerError(ctx, "Syntax Error: %s", s);
+}
+
+#if YYPULL
+
+/* Lists left open by an earlier parse that failed are abandoned */
+static int runParser(Scanner* scanner, CompilerContext* ctx) {
+    ctx->ast.pendingCount = 0;
+    int result = ctx->prattParser ? prattParse(ctx, scanner) : yyparse(scanner, ctx);
+    scannerClose(scanner);
+    if (ctx->ast.failed) {
+        compilerError(ctx, "Error: Out of memory");
+        result = 1;
+    }
+    return result;
+}
+
+int parseFile(CompilerContext* ctx, FILE* in) {
+    Scanner scanner;
+    if (scannerOpenFile(&scanner, ctx, in) != 0) return 1;
+    return runParser(&scanner, ctx);
+}
+
+/* Same as parseFile for source already in memory; src need not be
+ * NUL-terminated. */
+int parseString(CompilerContext* ctx, const char* src, size_t len) {
+    Scanner scanner;
+    if (scannerOpen(&scanner, ctx, src, len) != 0) return 1;
+    return runParser(&scanner, ctx);
+}
+
+/* Scan a buffer in place (see source.h): buffer[size] and
+ * buffer[size + 1] must be NUL, and flex writes into it while it runs.
+ * Identifiers are interned straight from the buffer. */
+int parseBuffer(CompilerContext* ctx, char* buffer, size_t size) {
+    Scanner scanner;
+    if (scannerOpenBuffer(&scanner, ctx, buffer, size) != 0) return 1;
+    return runParser(&scanner, ctx);
+}
+#endif
+
+#if YYPUSH
+/* PUSH PARSING
+ * The chunk scanner hands each token straight to bison's push parser,
+ * so source is parsed while the rest of it is still arriving. */
+struct PushParser {
+    CompilerContext* ctx;
+    yypstate* state;
+    ChunkScanner scanner;
+    int status;             // YYPUSH_MORE until the parse has ended
+};
+
+PushParser* pushParserCreate(CompilerContext* ctx) {
+    PushParser* parser = calloc(1, sizeof(PushParser));
+    if (parser) parser->state = yypstate_new();
+    if (!parser || !parser->state) {
+        free(parser);
+        compilerError(ctx, "Error: Out of memory");
+        return NULL;
+    }
+    parser->ctx = ctx;
+    parser->status = YYPUSH_MORE;
+    chunkScannerInit(&parser->scanner, ctx);
+    ctx->ast.pendingCount = 0;
+    return parser;
+}
+
+static int pushToken(void* arg, int token, const YYSTYPE* value) {
+    PushParser* parser = arg;
+    parser->status = yypush_parse(parser->state, token, value, NULL, parser->ctx);
+    return parser->status != YYPUSH_MORE || parser->ctx->ast.failed;
+}
+
+static void pushChunk(PushParser* parser, const char* chunk, size_t size, int final) {
+    if (parser->status != YYPUSH_MORE) return;
+    if (chunkScannerFeed(&parser->scanner, chunk, size, final, pushToken, parser) == LEXER_NO_MEMORY ||
+        parser->ctx->ast.failed) {
+        compilerError(parser->ctx, "Error: Out of memory");
+        parser->status = 2;
+    }
+}
+
+int pushParserFeed(PushParser* parser, const char* chunk, size_t size) {
+    pushChunk(parser, chunk, size, 0);
+    return parser->status != YYPUSH_MORE;
+}
+
+int pushParserFinish(PushParser* parser) {
+    pushChunk(parser, "", 0, 1);
+    return parser->status != 0;
+}
+
+void pushParserFree(PushParser* parser) {
+    if (!parser) return;
+    yypstate_delete(parser->state);
+    chunkScannerFree(&parser->scanner);
+    free(parser);
+}
+
+/* Parse what is read from fd as it comes, a read at a time, instead of
+ * waiting for all of it. Reading stops at the first syntax error. */
+int parseStream(CompilerContext* ctx, int fd) {
+    PushParser* parser = pushParserCreate(ctx);
+    if (!parser) return 1;
+    char chunk[PUSH_CHUNK_SIZE];
+    int failed = 0;
+    for (;;) {
+        ssize_t got = read(fd, chunk, sizeof(chunk));
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) {
+            compilerError(ctx, "Error: Cannot read input");
+            failed = 1;
+        }
+        if (got <= 0 || pushParserFeed(parser, chunk, got) != 0) break;
+    }
+    if (!failed) failed = pushParserFinish(parser);
+    pushParserFree(parser);
+    return failed;
+}
+#endif
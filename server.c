@@ -0,0 +1,373 @@
+/* COMPILE SERVER
+ * A resident compiler for many small jobs. Starting a process, faulting
+ * in a fresh heap and filling an empty intern table cost more than
+ * compiling a short file, so the server keeps one CompilerContext, its
+ * string table and the assembly buffer across requests and only drops
+ * the per-program state (AST, symbol table) in between. Assembly of
+ * functions that did not change since an earlier request is reused
+ * (incremental.c). The source is parsed as it comes off the socket, a
+ * read at a time, with the push parser (push.tab.c).
+ *
+ * Requests are served one at a time, one per connection. A client that
+ * stops sending or reading for CLIENT_TIMEOUT_SECONDS is dropped rather
+ * than left to hold up the others. Both ends of
+ * the socket are on the same machine, so numbers are sent in host byte
+ * order:
+ *
+ *   request:  magic, fileName, emit, bigEndian, optLevel, source
+ *   reply:    status, errorCount, output, diagnostics
+ *
+ * A number is a uint64_t; a string is a uint64_t length followed by
+ * that many bytes.
+ */
+#define _GNU_SOURCE             // ppoll
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "server.h"
+#include "context.h"
+#include "codegen.h"
+#include "incremental.h"
+
+#define SERVER_MAGIC 0x32306d6373ULL    // Protocol version 2
+#define MAX_STRING_SIZE (1ULL << 30)
+#define MAX_NAMES 65536                 // Interned names kept between requests
+#define MAX_FUNCTION_BYTES (64 << 20)   // Generated functions kept between requests
+#define CLIENT_TIMEOUT_SECONDS 5        // Longest a client may leave the server waiting
+
+/* State kept warm between requests */
+typedef struct {
+    CompilerContext* ctx;
+    TextBuffer text;
+    FunctionCache functions;    // Functions are only regenerated when they change
+} Server;
+
+static volatile sig_atomic_t stopRequested;
+
+/* In the server, the signal mask reads wait under, so that a stop
+ * request ends a wait for a client. NULL in the client. */
+static const sigset_t* readWaitMask;
+
+static void onSignal(int sig) {
+    (void)sig;
+    stopRequested = 1;
+}
+
+/* ============ WIRE FORMAT ============ */
+
+// send() rather than write(): a peer that went away must not raise SIGPIPE
+static int sendAll(int fd, const void* data, size_t size) {
+    const char* bytes = data;
+    while (size > 0) {
+        ssize_t n = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        bytes += n;
+        size -= n;
+    }
+    return 0;
+}
+
+// In the server, wait until fd can be read. Returns -1 if the client
+// sent nothing for CLIENT_TIMEOUT_SECONDS or a stop was requested.
+static int waitReadable(int fd) {
+    if (!readWaitMask) return 0;
+    struct timespec timeout = { CLIENT_TIMEOUT_SECONDS, 0 };
+    struct pollfd ready = { fd, POLLIN, 0 };
+    for (;;) {
+        int n = ppoll(&ready, 1, &timeout, readWaitMask);
+        if (n > 0) return 0;
+        if (n == 0 || errno != EINTR || stopRequested) return -1;
+    }
+}
+
+static int readAll(int fd, void* data, size_t size) {
+    char* bytes = data;
+    while (size > 0) {
+        if (waitReadable(fd) != 0) return -1;
+        ssize_t n = read(fd, bytes, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        bytes += n;
+        size -= n;
+    }
+    return 0;
+}
+
+static int sendNumber(int fd, uint64_t value) {
+    return sendAll(fd, &value, sizeof(value));
+}
+
+static int sendString(int fd, const void* data, size_t size) {
+    return sendNumber(fd, size) == 0 && sendAll(fd, data, size) == 0 ? 0 : -1;
+}
+
+static int recvNumber(int fd, uint64_t* value) {
+    return readAll(fd, value, sizeof(*value));
+}
+
+// The string is followed by two NULs, as parseBuffer wants of a source
+static int recvString(int fd, char** data, size_t* size) {
+    uint64_t length;
+    if (recvNumber(fd, &length) != 0 || length > MAX_STRING_SIZE) return -1;
+    char* bytes = malloc(length + 2);
+    if (!bytes) return -1;
+    if (readAll(fd, bytes, length) != 0) {
+        free(bytes);
+        return -1;
+    }
+    bytes[length] = '\0';
+    bytes[length + 1] = '\0';
+    *data = bytes;
+    if (size) *size = length;
+    return 0;
+}
+
+static int socketAddress(const char* path, struct sockaddr_un* addr) {
+    memset(addr, 0, sizeof(struct sockaddr_un));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path)) return -1;
+    strcpy(addr->sun_path, path);
+    return 0;
+}
+
+/* ============ SERVER ============ */
+
+static int validEmit(const char* emit) {
+    return strcmp(emit, "asm") == 0 || strcmp(emit, "obj") == 0 || strcmp(emit, "exe") == 0;
+}
+
+// Parse sourceSize bytes of source while they are received. After a
+// syntax error the rest is still read, so the client can finish
+// sending. Returns -1 if the connection broke, else 1 if the parse
+// failed.
+static int recvAndParse(CompilerContext* ctx, int fd, uint64_t sourceSize) {
+    PushParser* parser = pushParserCreate(ctx);
+    int failed = !parser;
+    char chunk[PUSH_CHUNK_SIZE];
+    while (sourceSize > 0) {
+        if (waitReadable(fd) != 0) {
+            pushParserFree(parser);
+            return -1;
+        }
+        ssize_t n = read(fd, chunk, sourceSize < sizeof(chunk) ? sourceSize : sizeof(chunk));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            pushParserFree(parser);
+            return -1;
+        }
+        sourceSize -= n;
+        if (!failed) failed = pushParserFeed(parser, chunk, n) != 0;
+    }
+    if (!failed) failed = pushParserFinish(parser) != 0;
+    pushParserFree(parser);
+    return failed;
+}
+
+// Compile one program and send the reply. Assembly is sent straight
+// from the server's buffer. Returns -1 if the source did not arrive.
+static int answer(Server* server, int fd, const char* name, const char* emit, int bigEndian,
+                  int optLevel, uint64_t sourceSize) {
+    CompilerContext* ctx = server->ctx;
+    char* diagText = NULL;
+    size_t diagSize = 0;
+    FILE* diag = open_memstream(&diagText, &diagSize);
+    ctx->fileName = name;
+    ctx->diag = diag ? diag : stderr;
+    ctx->optLevel = optLevel;
+
+    const char* output = NULL;
+    size_t outputSize = 0;
+    unsigned char* image = NULL;
+    int failed = recvAndParse(ctx, fd, sourceSize);
+    if (failed < 0) {
+        if (diag) fclose(diag);
+        free(diagText);
+        resetContext(ctx, NULL);
+        return -1;
+    }
+    if (!failed && strcmp(emit, "asm") == 0) {
+        textReset(&server->text);
+        ctx->functions = &server->functions;
+        failed = generateMIPS(ctx, &server->text) != 0;
+        functionCacheTrim(&server->functions, MAX_FUNCTION_BYTES);
+        output = server->text.data;
+        outputSize = server->text.size;
+    } else if (!failed) {
+        failed = generateMIPSBinary(ctx, bigEndian, strcmp(emit, "exe") == 0, &image, &outputSize) != 0;
+        output = (const char*)image;
+    }
+    if (failed) {
+        output = NULL;
+        outputSize = 0;
+    }
+    if (diag) fclose(diag);
+
+    // A client that gave up only loses its own answer
+    if (sendNumber(fd, failed) == 0 && sendNumber(fd, ctx->errorCount) == 0 &&
+        sendString(fd, output, outputSize) == 0) {
+        sendString(fd, diagText, diagSize);
+    }
+    free(image);
+    free(diagText);
+
+    resetContext(ctx, NULL);
+    if (ctx->strings.count > MAX_NAMES) clearStringTable(&ctx->strings);
+    return 0;
+}
+
+// The source comes last in a request, so its length is the last thing
+// read before compiling starts
+static void serveConnection(Server* server, int fd) {
+    uint64_t magic, bigEndian, optLevel, sourceSize;
+    char* name = NULL;
+    char* emit = NULL;
+    int valid = recvNumber(fd, &magic) == 0 && magic == SERVER_MAGIC &&
+                recvString(fd, &name, NULL) == 0 && recvString(fd, &emit, NULL) == 0 &&
+                recvNumber(fd, &bigEndian) == 0 && recvNumber(fd, &optLevel) == 0 &&
+                recvNumber(fd, &sourceSize) == 0 && sourceSize <= MAX_STRING_SIZE &&
+                validEmit(emit) && optLevel <= 1;
+    if (valid) {
+        valid = answer(server, fd, name, emit, bigEndian != 0, (int)optLevel, sourceSize) == 0;
+    }
+    if (!valid) fprintf(stderr, "Warning: Ignoring a malformed or incomplete request\n");
+    free(name);
+    free(emit);
+}
+
+// Another server answers on this socket file
+static int serverAlive(const struct sockaddr_un* addr) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return 0;
+    int alive = connect(fd, (const struct sockaddr*)addr, sizeof(struct sockaddr_un)) == 0;
+    close(fd);
+    return alive;
+}
+
+static int listenOn(const char* socketPath) {
+    struct sockaddr_un addr;
+    if (socketAddress(socketPath, &addr) != 0) {
+        fprintf(stderr, "Error: Socket path too long: %s\n", socketPath);
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot create socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    // A socket left behind by a server that died is taken over
+    int bound = bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+    struct stat info;
+    if (!bound && errno == EADDRINUSE && lstat(socketPath, &info) == 0 && S_ISSOCK(info.st_mode) &&
+        !serverAlive(&addr)) {
+        unlink(socketPath);
+        bound = bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+    }
+    if (!bound || listen(fd, SOMAXCONN) != 0) {
+        fprintf(stderr, "Error: Cannot listen on '%s': %s\n", socketPath, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int runServer(const char* socketPath) {
+    int listener = listenOn(socketPath);
+    if (listener < 0) return 1;
+
+    // The signals stay blocked except inside ppoll, so a stop request
+    // cannot slip in between the check and the wait
+    sigset_t blocked, waitMask;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+    sigprocmask(SIG_BLOCK, &blocked, &waitMask);
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    Server server = {0};
+    server.ctx = createContext(NULL);
+    if (!server.ctx) {
+        fprintf(stderr, "Error: Out of memory\n");
+        close(listener);
+        unlink(socketPath);
+        return 1;
+    }
+    fprintf(stderr, "Compile server listening on %s\n", socketPath);
+    readWaitMask = &waitMask;
+
+    int result = 0;
+    while (!stopRequested) {
+        struct pollfd ready = { listener, POLLIN, 0 };
+        if (ppoll(&ready, 1, NULL, &waitMask) < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Error: Waiting for requests failed: %s\n", strerror(errno));
+            result = 1;
+            break;
+        }
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) continue;
+        // Reads wait in waitReadable; a client that does not take its
+        // reply is given up on by send
+        struct timeval timeout = { CLIENT_TIMEOUT_SECONDS, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        serveConnection(&server, fd);
+        close(fd);
+    }
+
+    readWaitMask = NULL;
+    close(listener);
+    unlink(socketPath);
+    freeContext(server.ctx);
+    textFree(&server.text);
+    functionCacheFree(&server.functions);
+    return result;
+}
+
+/* ============ CLIENT ============ */
+
+int serverCompile(const char* socketPath, const ServerRequest* request, ServerReply* reply) {
+    memset(reply, 0, sizeof(ServerReply));
+    struct sockaddr_un addr;
+    if (socketAddress(socketPath, &addr) != 0) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    uint64_t status, errorCount;
+    int answered = connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0 &&
+                   sendNumber(fd, SERVER_MAGIC) == 0 &&
+                   sendString(fd, request->fileName, strlen(request->fileName)) == 0 &&
+                   sendString(fd, request->emit, strlen(request->emit)) == 0 &&
+                   sendNumber(fd, request->bigEndian) == 0 &&
+                   sendNumber(fd, request->optLevel) == 0 &&
+                   sendString(fd, request->source, request->sourceSize) == 0 &&
+                   recvNumber(fd, &status) == 0 && recvNumber(fd, &errorCount) == 0 &&
+                   recvString(fd, &reply->output, &reply->outputSize) == 0 &&
+                   recvString(fd, &reply->diagnostics, &reply->diagnosticsSize) == 0;
+    close(fd);
+    if (!answered) {
+        freeServerReply(reply);
+        return -1;
+    }
+    reply->status = (int)status;
+    reply->errorCount = (int)errorCount;
+    return 0;
+}
+
+void freeServerReply(ServerReply* reply) {
+    free(reply->output);
+    free(reply->diagnostics);
+    memset(reply, 0, sizeof(ServerReply));
+}
@@ -0,0 +1,38 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stddef.h>
+
+/* COMPILE SERVER
+ * `minicompiler --server <socket>` stays resident and compiles requests
+ * sent over a Unix domain socket; `--client <socket>` sends them. */
+
+/* One compile request */
+typedef struct {
+    const char* fileName;   // Used in diagnostics
+    const char* emit;       // asm, obj or exe
+    int bigEndian;
+    int optLevel;           // -O level
+    const char* source;
+    size_t sourceSize;
+} ServerRequest;
+
+/* The server's answer. Release with freeServerReply. */
+typedef struct {
+    int status;             // 0 if the program compiled
+    int errorCount;
+    char* output;           // Assembly text or ELF image
+    size_t outputSize;
+    char* diagnostics;
+    size_t diagnosticsSize;
+} ServerReply;
+
+/* Serve requests until SIGINT or SIGTERM. Returns the exit status. */
+int runServer(const char* socketPath);
+
+/* Client side: returns 0 if the server answered (whatever the status),
+ * -1 if it could not be reached */
+int serverCompile(const char* socketPath, const ServerRequest* request, ServerReply* reply);
+void freeServerReply(ServerReply* reply);
+
+#endif
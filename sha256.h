@@ -0,0 +1,20 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA256_SIZE 32
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;
+    unsigned char block[64];
+    size_t used;
+} Sha256;
+
+void sha256Init(Sha256* sha);
+void sha256Update(Sha256* sha, const void* data, size_t size);
+void sha256Final(Sha256* sha, unsigned char digest[SHA256_SIZE]);
+
+#endif
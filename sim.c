@@ -0,0 +1,485 @@
+/* MIPS SIMULATOR
+ * An interpreter for the MIPS32 integer instructions, enough to run
+ * what the code generator emits (and hand-written code in the same
+ * style) straight from an ELF executable. It models what changes
+ * results and counts: branch delay slots, the overflow trap of add,
+ * addi and sub, and the SPIM/MARS system calls, file I/O included (an
+ * instrumented program writes its profile that way). Caches, pipeline stalls and
+ * coprocessors are not modelled, so the instruction count is the
+ * measure of code quality, not cycles.
+ *
+ * Memory is sparse: 4 KB pages allocated on first write behind a
+ * two-level table, so the stack can sit at the top of the address
+ * space like in SPIM. Bytes are kept in the executable's byte order.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "mips.h"
+
+#define PAGE_BITS 12
+#define PAGE_SIZE (1u << PAGE_BITS)
+#define TABLE_BITS 10
+#define TABLE_SIZE (1u << TABLE_BITS)
+
+#define STACK_TOP 0x7FFFEFFC    // Initial $sp, as in SPIM
+#define GLOBAL_POINTER 0x10008000
+#define EXIT_ADDRESS 0x00000000 // Initial $ra: main returning here ends the run
+#define MAX_FILES 16            // Descriptors for open (0-2 are the standard streams)
+#define PATH_SIZE 4096
+
+#define ET_EXEC 2
+#define EM_MIPS 8
+#define PT_LOAD 1
+#define PF_X 1
+
+typedef struct {
+    uint32_t regs[32];
+    uint32_t hi, lo;
+    uint32_t pc, nextPc;
+    int bigEndian;
+    unsigned char** pages[TABLE_SIZE];  // Second-level tables, NULL until used
+    uint32_t textStart, textEnd;        // Span of the executable segments
+    FILE* out;
+    FILE* files[MAX_FILES];             // Opened by system call 13, NULL when free
+    SimResult* result;
+    int halted;
+    const char* fault;                  // Why the run stopped early
+} Machine;
+
+/* ============ MEMORY ============ */
+
+static unsigned char* findPage(Machine* m, uint32_t addr, int create) {
+    unsigned char** table = m->pages[addr >> (32 - TABLE_BITS)];
+    if (!table) {
+        if (!create) return NULL;
+        table = calloc(TABLE_SIZE, sizeof(unsigned char*));
+        if (!table) return NULL;
+        m->pages[addr >> (32 - TABLE_BITS)] = table;
+    }
+    unsigned char** page = &table[(addr >> PAGE_BITS) & (TABLE_SIZE - 1)];
+    if (!*page && create) *page = calloc(1, PAGE_SIZE);
+    return *page;
+}
+
+// Memory that was never written reads as zero
+static uint32_t load8(Machine* m, uint32_t addr) {
+    unsigned char* page = findPage(m, addr, 0);
+    return page ? page[addr & (PAGE_SIZE - 1)] : 0;
+}
+
+static int store8(Machine* m, uint32_t addr, uint32_t value) {
+    unsigned char* page = findPage(m, addr, 1);
+    if (!page) {
+        m->fault = "out of memory";
+        return -1;
+    }
+    page[addr & (PAGE_SIZE - 1)] = (unsigned char)value;
+    return 0;
+}
+
+// Aligned accesses never cross a page
+static uint32_t load32(Machine* m, uint32_t addr) {
+    unsigned char* page = findPage(m, addr, 0);
+    if (!page) return 0;
+    const unsigned char* p = page + (addr & (PAGE_SIZE - 1));
+    return m->bigEndian ? ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]
+                        : p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int store32(Machine* m, uint32_t addr, uint32_t value) {
+    unsigned char* page = findPage(m, addr, 1);
+    if (!page) {
+        m->fault = "out of memory";
+        return -1;
+    }
+    unsigned char* p = page + (addr & (PAGE_SIZE - 1));
+    for (int i = 0; i < 4; i++) {
+        int shift = m->bigEndian ? 24 - i * 8 : i * 8;
+        p[i] = (unsigned char)(value >> shift);
+    }
+    return 0;
+}
+
+static void freeMemory(Machine* m) {
+    for (uint32_t i = 0; i < TABLE_SIZE; i++) {
+        if (!m->pages[i]) continue;
+        for (uint32_t j = 0; j < TABLE_SIZE; j++) free(m->pages[i][j]);
+        free(m->pages[i]);
+    }
+}
+
+/* ============ LOADING ============ */
+
+static uint32_t get16(const unsigned char* p, int bigEndian) {
+    return bigEndian ? (p[0] << 8) | p[1] : p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const unsigned char* p, int bigEndian) {
+    return bigEndian ? ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]
+                     : p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Copy the PT_LOAD segments into memory and set up the registers
+static int loadELF(Machine* m, const char* filename) {
+    FILE* in = fopen(filename, "rb");
+    if (!in) {
+        fprintf(stderr, "Error: Cannot open input file '%s'\n", filename);
+        return -1;
+    }
+    fseek(in, 0, SEEK_END);
+    long fileSize = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    unsigned char* image = malloc(fileSize > 0 ? fileSize : 1);
+    size_t got = image ? fread(image, 1, fileSize, in) : 0;
+    fclose(in);
+
+    if (!image || fileSize < 52 || got != (size_t)fileSize || memcmp(image, "\x7F" "ELF", 4) != 0 ||
+        image[4] != 1) {
+        fprintf(stderr, "Error: '%s' is not an ELF32 file\n", filename);
+        free(image);
+        return -1;
+    }
+    m->bigEndian = image[5] == 2;
+    if (get16(image + 18, m->bigEndian) != EM_MIPS || get16(image + 16, m->bigEndian) != ET_EXEC) {
+        fprintf(stderr, "Error: '%s' is not a MIPS executable\n", filename);
+        free(image);
+        return -1;
+    }
+
+    uint32_t entry = get32(image + 24, m->bigEndian);
+    uint32_t phoff = get32(image + 28, m->bigEndian);
+    int phentsize = get16(image + 42, m->bigEndian);
+    int phnum = get16(image + 44, m->bigEndian);
+    if (phentsize < 32 || phoff + (size_t)phnum * phentsize > (size_t)fileSize) {
+        fprintf(stderr, "Error: '%s' has a bad program header table\n", filename);
+        free(image);
+        return -1;
+    }
+
+    m->textStart = UINT32_MAX;
+    m->textEnd = 0;
+    for (int i = 0; i < phnum; i++) {
+        const unsigned char* ph = image + phoff + i * phentsize;
+        if (get32(ph, m->bigEndian) != PT_LOAD) continue;
+        uint32_t offset = get32(ph + 4, m->bigEndian);
+        uint32_t vaddr = get32(ph + 8, m->bigEndian);
+        uint32_t fileBytes = get32(ph + 16, m->bigEndian);
+        uint32_t flags = get32(ph + 24, m->bigEndian);
+        if ((size_t)offset + fileBytes > (size_t)fileSize) {
+            fprintf(stderr, "Error: '%s' has a segment past the end of the file\n", filename);
+            free(image);
+            return -1;
+        }
+        // The part past the file size (.bss) is already zero
+        for (uint32_t j = 0; j < fileBytes; j++) {
+            if (store8(m, vaddr + j, image[offset + j]) != 0) {
+                fprintf(stderr, "Error: Out of memory\n");
+                free(image);
+                return -1;
+            }
+        }
+        if (flags & PF_X) {
+            if (vaddr < m->textStart) m->textStart = vaddr;
+            if (vaddr + fileBytes > m->textEnd) m->textEnd = vaddr + fileBytes;
+            m->result->codeSize += fileBytes;
+        }
+    }
+    free(image);
+
+    m->pc = entry;
+    m->nextPc = entry + 4;
+    m->regs[REG_SP] = STACK_TOP;
+    m->regs[REG_FP] = STACK_TOP;
+    m->regs[28] = GLOBAL_POINTER;
+    m->regs[REG_RA] = EXIT_ADDRESS;
+    return 0;
+}
+
+/* ============ EXECUTION ============ */
+
+static void branch(Machine* m, uint32_t target) {
+    m->nextPc = target;
+}
+
+// SPIM's services: print int, print string, exit, print char, exit2
+// open with MARS flags: 0 read, 1 write (create/truncate), 9 append
+static uint32_t openFile(Machine* m, uint32_t pathAddr, uint32_t flags) {
+    char path[PATH_SIZE];
+    size_t len = 0;
+    for (uint32_t c; len + 1 < sizeof(path) && (c = load8(m, pathAddr + len)) != 0; len++) {
+        path[len] = c;
+    }
+    path[len] = '\0';
+    const char* mode = flags == 0 ? "rb" : flags == 1 ? "wb" : flags == 9 ? "ab" : NULL;
+    for (int fd = 3; mode && fd < MAX_FILES; fd++) {
+        if (m->files[fd]) continue;
+        m->files[fd] = fopen(path, mode);
+        return m->files[fd] ? (uint32_t)fd : (uint32_t)-1;
+    }
+    return (uint32_t)-1;
+}
+
+static FILE* fileFor(Machine* m, uint32_t fd) {
+    if (fd == 1) return m->out;
+    if (fd == 2) return stderr;
+    return fd < MAX_FILES ? m->files[fd] : NULL;
+}
+
+static void systemCall(Machine* m) {
+    uint32_t a0 = m->regs[REG_A0];
+    uint32_t a1 = m->regs[REG_A0 + 1];
+    uint32_t a2 = m->regs[REG_A0 + 2];
+    switch (m->regs[REG_V0]) {
+        case 1:
+            fprintf(m->out, "%d", (int32_t)a0);
+            break;
+        case 4:
+            for (uint32_t c; (c = load8(m, a0)) != 0; a0++) fputc(c, m->out);
+            break;
+        case 10:
+            m->result->status = 0;
+            m->halted = 1;
+            break;
+        case 11:
+            fputc(a0 & 0xFF, m->out);
+            break;
+        case 13:
+            m->regs[REG_V0] = openFile(m, a0, a1);
+            break;
+        case 14: {
+            // read: count into $v0, 0 at end of file, -1 on error
+            FILE* file = a0 == 0 ? stdin : fileFor(m, a0);
+            uint32_t n = 0;
+            for (int c; file && n < a2 && (c = fgetc(file)) != EOF; n++) {
+                if (store8(m, a1 + n, c) != 0) break;
+            }
+            m->regs[REG_V0] = file ? n : (uint32_t)-1;
+            break;
+        }
+        case 15: {
+            FILE* file = a0 == 0 ? NULL : fileFor(m, a0);
+            uint32_t n = 0;
+            while (file && n < a2 && fputc(load8(m, a1 + n), file) != EOF) n++;
+            m->regs[REG_V0] = file ? n : (uint32_t)-1;
+            break;
+        }
+        case 16:
+            if (a0 >= 3 && a0 < MAX_FILES && m->files[a0]) {
+                fclose(m->files[a0]);
+                m->files[a0] = NULL;
+            }
+            break;
+        case 17:
+            m->result->status = (int32_t)a0;
+            m->halted = 1;
+            break;
+        default:
+            m->fault = "unsupported system call";
+            break;
+    }
+}
+
+// rs + rt as the trapping add/sub/addi do it
+static void addChecked(Machine* m, int dest, uint32_t a, uint32_t b) {
+    uint32_t sum = a + b;
+    if (~(a ^ b) & (a ^ sum) & 0x80000000) {
+        m->fault = "arithmetic overflow";
+        return;
+    }
+    m->regs[dest] = sum;
+}
+
+static void executeSpecial(Machine* m, uint32_t w, uint32_t pc) {
+    int rs = (w >> 21) & 31, rt = (w >> 16) & 31, rd = (w >> 11) & 31, sa = (w >> 6) & 31;
+    uint32_t a = m->regs[rs], b = m->regs[rt];
+    switch (w & 0x3F) {
+        case 0x00: m->regs[rd] = b << sa; break;                                // sll
+        case 0x02: m->regs[rd] = b >> sa; break;                                // srl
+        case 0x03: m->regs[rd] = (uint32_t)((int32_t)b >> sa); break;           // sra
+        case 0x04: m->regs[rd] = b << (a & 31); break;                          // sllv
+        case 0x06: m->regs[rd] = b >> (a & 31); break;                          // srlv
+        case 0x07: m->regs[rd] = (uint32_t)((int32_t)b >> (a & 31)); break;     // srav
+        case 0x08: branch(m, a); break;                                         // jr
+        case 0x09:                                                              // jalr
+            branch(m, a);
+            m->regs[rd] = pc + 8;
+            m->result->calls++;
+            break;
+        case 0x0C: systemCall(m); break;
+        case 0x10: m->regs[rd] = m->hi; break;                                  // mfhi
+        case 0x12: m->regs[rd] = m->lo; break;                                  // mflo
+        case 0x18: {                                                            // mult
+            int64_t product = (int64_t)(int32_t)a * (int32_t)b;
+            m->lo = (uint32_t)product;
+            m->hi = (uint32_t)((uint64_t)product >> 32);
+            break;
+        }
+        case 0x19: {                                                            // multu
+            uint64_t product = (uint64_t)a * b;
+            m->lo = (uint32_t)product;
+            m->hi = (uint32_t)(product >> 32);
+            break;
+        }
+        case 0x1A:                                                              // div
+            // The result of dividing by zero is unpredictable; leave hi/lo
+            if (b != 0 && !(a == 0x80000000 && b == 0xFFFFFFFF)) {
+                m->lo = (uint32_t)((int32_t)a / (int32_t)b);
+                m->hi = (uint32_t)((int32_t)a % (int32_t)b);
+            }
+            break;
+        case 0x1B:                                                              // divu
+            if (b != 0) {
+                m->lo = a / b;
+                m->hi = a % b;
+            }
+            break;
+        case 0x20: addChecked(m, rd, a, b); break;                              // add
+        case 0x21: m->regs[rd] = a + b; break;                                  // addu
+        case 0x22:                                                              // sub
+            if ((a ^ b) & (a ^ (a - b)) & 0x80000000) {
+                m->fault = "arithmetic overflow";
+            } else {
+                m->regs[rd] = a - b;
+            }
+            break;
+        case 0x23: m->regs[rd] = a - b; break;                                  // subu
+        case 0x24: m->regs[rd] = a & b; break;                                  // and
+        case 0x25: m->regs[rd] = a | b; break;                                  // or
+        case 0x26: m->regs[rd] = a ^ b; break;                                  // xor
+        case 0x27: m->regs[rd] = ~(a | b); break;                               // nor
+        case 0x2A: m->regs[rd] = (int32_t)a < (int32_t)b; break;                // slt
+        case 0x2B: m->regs[rd] = a < b; break;                                  // sltu
+        default: m->fault = "reserved instruction"; break;
+    }
+}
+
+static void execute(Machine* m, uint32_t w, uint32_t pc) {
+    int opcode = w >> 26;
+    int rs = (w >> 21) & 31, rt = (w >> 16) & 31;
+    uint32_t a = m->regs[rs], b = m->regs[rt];
+    uint32_t simm = (uint32_t)(int32_t)(int16_t)(w & 0xFFFF);
+    uint32_t uimm = w & 0xFFFF;
+    uint32_t branchTarget = pc + 4 + (simm << 2);
+    uint32_t jumpTarget = ((pc + 4) & 0xF0000000) | ((w & 0x03FFFFFF) << 2);
+    uint32_t addr = a + simm;
+
+    switch (opcode) {
+        case 0x00: executeSpecial(m, w, pc); break;
+        case 0x01:                                                  // bltz, bgez
+            if (rt == 0 && (int32_t)a < 0) branch(m, branchTarget);
+            else if (rt == 1 && (int32_t)a >= 0) branch(m, branchTarget);
+            else if (rt > 1) m->fault = "reserved instruction";
+            break;
+        case 0x02: branch(m, jumpTarget); break;                    // j
+        case 0x03:                                                  // jal
+            branch(m, jumpTarget);
+            m->regs[REG_RA] = pc + 8;
+            m->result->calls++;
+            break;
+        case 0x04: if (a == b) branch(m, branchTarget); break;      // beq
+        case 0x05: if (a != b) branch(m, branchTarget); break;      // bne
+        case 0x06: if ((int32_t)a <= 0) branch(m, branchTarget); break;    // blez
+        case 0x07: if ((int32_t)a > 0) branch(m, branchTarget); break;     // bgtz
+        case 0x08: addChecked(m, rt, a, simm); break;               // addi
+        case 0x09: m->regs[rt] = a + simm; break;                   // addiu
+        case 0x0A: m->regs[rt] = (int32_t)a < (int32_t)simm; break; // slti
+        case 0x0B: m->regs[rt] = a < simm; break;                   // sltiu
+        case 0x0C: m->regs[rt] = a & uimm; break;                   // andi
+        case 0x0D: m->regs[rt] = a | uimm; break;                   // ori
+        case 0x0E: m->regs[rt] = a ^ uimm; break;                   // xori
+        case 0x0F: m->regs[rt] = uimm << 16; break;                 // lui
+        case 0x1C:                                                  // mul
+            if ((w & 0x3F) == 0x02) {
+                m->regs[(w >> 11) & 31] = (uint32_t)((int64_t)(int32_t)a * (int32_t)b);
+            } else {
+                m->fault = "reserved instruction";
+            }
+            break;
+        case 0x20:                                                  // lb
+            m->regs[rt] = (uint32_t)(int32_t)(int8_t)load8(m, addr);
+            m->result->loads++;
+            break;
+        case 0x24:                                                  // lbu
+            m->regs[rt] = load8(m, addr);
+            m->result->loads++;
+            break;
+        case 0x23:                                                  // lw
+            if (addr & 3) {
+                m->fault = "unaligned load";
+                break;
+            }
+            m->regs[rt] = load32(m, addr);
+            m->result->loads++;
+            break;
+        case 0x28:                                                  // sb
+            store8(m, addr, b);
+            m->result->stores++;
+            break;
+        case 0x2B:                                                  // sw
+            if (addr & 3) {
+                m->fault = "unaligned store";
+                break;
+            }
+            store32(m, addr, b);
+            m->result->stores++;
+            break;
+        default:
+            m->fault = "reserved instruction";
+            break;
+    }
+    m->regs[0] = 0;
+}
+
+int mipsSimulateELF(const char* filename, FILE* out, uint64_t maxSteps, SimResult* result) {
+    Machine* m = calloc(1, sizeof(Machine));
+    memset(result, 0, sizeof(SimResult));
+    if (!m) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return -1;
+    }
+    m->out = out;
+    m->result = result;
+    if (loadELF(m, filename) != 0) {
+        freeMemory(m);
+        free(m);
+        return -1;
+    }
+
+    uint32_t pc = m->pc;
+    while (!m->halted && !m->fault) {
+        pc = m->pc;
+        if (pc == EXIT_ADDRESS) {
+            // main returned
+            result->status = (int32_t)m->regs[REG_V0];
+            break;
+        }
+        if (pc < m->textStart || pc >= m->textEnd || (pc & 3)) {
+            m->fault = "jump outside the text segment";
+            break;
+        }
+        if (result->instructions >= maxSteps) {
+            m->fault = "instruction limit reached";
+            break;
+        }
+        uint32_t word = load32(m, pc);
+        m->pc = m->nextPc;
+        m->nextPc += 4;
+        result->instructions++;
+        execute(m, word, pc);
+    }
+    fflush(out);
+
+    const char* fault = m->fault;
+    for (int fd = 3; fd < MAX_FILES; fd++) {
+        if (m->files[fd]) fclose(m->files[fd]);
+    }
+    freeMemory(m);
+    free(m);
+    if (fault) {
+        fprintf(stderr, "Error: %s: %s at 0x%08x\n", filename, fault, pc);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* MIPS SIMULATOR
+ * Runs an ELF32 MIPS executable (--emit=exe) without SPIM or MARS, so
+ * generated code can be checked and measured from the build. */
+
+/* What a run did */
+typedef struct {
+    int status;                 // Exit status: main's return value or exit2's code
+    uint64_t instructions;      // Executed, delay slots included
+    uint64_t loads;
+    uint64_t stores;
+    uint64_t calls;             // jal and jalr
+    uint32_t codeSize;          // Bytes of executable segments
+} SimResult;
+
+#define SIM_DEFAULT_MAX_STEPS 1000000000ULL
+
+/* Load filename and run it from its entry point, sending the program's
+ * output to out. Returns 0 if the program finished, -1 if it could not
+ * be loaded, faulted or ran longer than maxSteps instructions (the
+ * reason goes to stderr). */
+int mipsSimulateELF(const char* filename, FILE* out, uint64_t maxSteps, SimResult* result);
+
+#endif
@@ -0,0 +1,92 @@
+/* SOURCE INPUT
+ * Regular files are mmap'd privately instead of being read through
+ * stdio, so the scanner works directly on the page cache. Pages are
+ * only copied when flex writes its temporary token terminator into
+ * them. The two NUL bytes flex wants after the text come from an
+ * anonymous mapping laid out behind the file: the file is mapped over
+ * the front of a zeroed region one page longer than needed.
+ * Pipes and other files that cannot be mapped are read into memory.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "source.h"
+
+static int mapSource(int fd, size_t size, SourceBuffer* source) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t mapSize = (size + 2 + page - 1) & ~(page - 1);
+
+    char* base = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return -1;
+    if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, mapSize);
+        return -1;
+    }
+    madvise(base, size, MADV_SEQUENTIAL);
+
+    source->data = base;
+    source->size = size;
+    source->mapSize = mapSize;
+    return 0;
+}
+
+static int readSource(int fd, SourceBuffer* source) {
+    size_t size = 0, capacity = 4096;
+    char* data = malloc(capacity);
+    if (!data) return -1;
+    for (;;) {
+        if (capacity - size <= 2) {
+            capacity *= 2;
+            char* bigger = realloc(data, capacity);
+            if (!bigger) {
+                free(data);
+                return -1;
+            }
+            data = bigger;
+        }
+        ssize_t got = read(fd, data + size, capacity - size - 2);
+        if (got < 0) {
+            free(data);
+            return -1;
+        }
+        if (got == 0) break;
+        size += got;
+    }
+    data[size] = data[size + 1] = '\0';
+
+    source->data = data;
+    source->size = size;
+    source->mapSize = 0;
+    return 0;
+}
+
+/* Returns 0 on success and -1 if the file cannot be opened or read */
+int loadSource(const char* fileName, SourceBuffer* source) {
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat info;
+    int result;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        result = mapSource(fd, (size_t)info.st_size, source);
+        if (result != 0) result = readSource(fd, source);
+    } else {
+        result = readSource(fd, source);
+    }
+    close(fd);
+    return result;
+}
+
+void freeSource(SourceBuffer* source) {
+    if (source->mapSize) {
+        munmap(source->data, source->mapSize);
+    } else {
+        free(source->data);
+    }
+    source->data = NULL;
+    source->size = source->mapSize = 0;
+}
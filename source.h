@@ -0,0 +1,18 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stddef.h>
+
+/* A source file loaded for scanning in place. data[size] and
+ * data[size + 1] are NUL, as yy_scan_buffer requires, and the bytes are
+ * writable because flex NUL-terminates each token while it runs. */
+typedef struct {
+    char* data;
+    size_t size;
+    size_t mapSize;         // Bytes mapped, 0 if data came from malloc
+} SourceBuffer;
+
+int loadSource(const char* fileName, SourceBuffer* source);
+void freeSource(SourceBuffer* source);
+
+#endif
@@ -0,0 +1,143 @@
+/* PHASE STATISTICS
+ * Wall time, CPU time and heap growth for each compiler phase, reported
+ * as a table (--time-report) or as JSON (--stats-json). Heap growth is
+ * the change in bytes in use according to the allocator, so phases that
+ * free memory can show a negative number. CPU time is per thread, but
+ * the heap counter covers the whole process.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+#include "stats.h"
+
+static double readClock(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static long long heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return (long long)info.uordblks + (long long)info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+void statsEnable(Stats* stats) {
+    stats->enabled = 1;
+}
+
+int statsEnabled(Stats* stats) {
+    return stats->enabled;
+}
+
+void phaseBegin(Stats* stats, const char* name, const char* label) {
+    if (!stats->enabled || stats->phaseCount == MAX_PHASES) return;
+
+    stats->phases[stats->phaseCount].name = name;
+    stats->phases[stats->phaseCount].label = label;
+    stats->startHeap = heapInUse();
+    stats->startCPU = readClock(CLOCK_THREAD_CPUTIME_ID);
+    stats->startWall = readClock(CLOCK_MONOTONIC);
+}
+
+void phaseEnd(Stats* stats) {
+    if (!stats->enabled || stats->phaseCount == MAX_PHASES) return;
+
+    PhaseStats* phase = &stats->phases[stats->phaseCount++];
+    phase->wall = readClock(CLOCK_MONOTONIC) - stats->startWall;
+    phase->cpu = readClock(CLOCK_THREAD_CPUTIME_ID) - stats->startCPU;
+    phase->heapBytes = heapInUse() - stats->startHeap;
+}
+
+/* Phases are matched by name, so a multi-file build reports one row per
+ * phase summed over all files */
+void statsMerge(Stats* total, const Stats* stats) {
+    total->enabled = 1;
+    for (int i = 0; i < stats->phaseCount; i++) {
+        const PhaseStats* phase = &stats->phases[i];
+        int j = 0;
+        while (j < total->phaseCount && strcmp(total->phases[j].name, phase->name) != 0) {
+            j++;
+        }
+        if (j == total->phaseCount) {
+            if (total->phaseCount == MAX_PHASES) continue;
+            total->phases[total->phaseCount++] = *phase;
+        } else {
+            total->phases[j].wall += phase->wall;
+            total->phases[j].cpu += phase->cpu;
+            total->phases[j].heapBytes += phase->heapBytes;
+        }
+    }
+}
+
+static PhaseStats totals(Stats* stats) {
+    PhaseStats total = { "total", "TOTAL", 0, 0, 0 };
+    for (int i = 0; i < stats->phaseCount; i++) {
+        total.wall += stats->phases[i].wall;
+        total.cpu += stats->phases[i].cpu;
+        total.heapBytes += stats->phases[i].heapBytes;
+    }
+    return total;
+}
+
+void printTimeReport(Stats* stats, FILE* out) {
+    PhaseStats total = totals(stats);
+    int phaseCount = stats->phaseCount;
+
+    fprintf(out, "\nExecution times (seconds)\n");
+    fprintf(out, " %-40s %17s %10s %14s\n", "phase", "wall", "cpu", "heap bytes");
+    for (int i = 0; i <= phaseCount; i++) {
+        PhaseStats* phase = i < phaseCount ? &stats->phases[i] : &total;
+        double share = total.wall > 0 ? phase->wall * 100.0 / total.wall : 0;
+        if (i == phaseCount) {
+            fprintf(out, " %s\n", "--------------------------------------------------------------------------------------");
+        }
+        fprintf(out, " %-40s %10.6f (%3.0f%%) %10.6f %14lld\n",
+                phase->label, phase->wall, share, phase->cpu, phase->heapBytes);
+    }
+}
+
+static void writeJSONString(FILE* out, const char* str) {
+    fputc('"', out);
+    for (; *str; str++) {
+        unsigned char c = *str;
+        if (c == '"' || c == '\\') {
+            fprintf(out, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void writeJSONPhase(FILE* out, PhaseStats* phase) {
+    fprintf(out, "{\"name\": ");
+    writeJSONString(out, phase->name);
+    fprintf(out, ", \"label\": ");
+    writeJSONString(out, phase->label);
+    fprintf(out, ", \"wall_s\": %.9f, \"cpu_s\": %.9f, \"heap_bytes\": %lld}",
+            phase->wall, phase->cpu, phase->heapBytes);
+}
+
+void writeStatsJSON(Stats* stats, FILE* out, const char* inputFile) {
+    PhaseStats total = totals(stats);
+    int phaseCount = stats->phaseCount;
+
+    fprintf(out, "{\n  \"input\": ");
+    writeJSONString(out, inputFile);
+    fprintf(out, ",\n  \"phases\": [\n");
+    for (int i = 0; i < phaseCount; i++) {
+        fprintf(out, "    ");
+        writeJSONPhase(out, &stats->phases[i]);
+        fprintf(out, i + 1 < phaseCount ? ",\n" : "\n");
+    }
+    fprintf(out, "  ],\n  \"total\": ");
+    writeJSONPhase(out, &total);
+    fprintf(out, "\n}\n");
+}
@@ -0,0 +1,40 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+#define MAX_PHASES 32
+
+/* Measurements for one compiler phase */
+typedef struct {
+    const char* name;       // Short id used in JSON
+    const char* label;      // Description used in the table
+    double wall;            // Seconds of elapsed time
+    double cpu;             // Seconds of process CPU time
+    long long heapBytes;    // Net heap growth during the phase
+} PhaseStats;
+
+/* Measurements of one compilation */
+typedef struct {
+    PhaseStats phases[MAX_PHASES];
+    int phaseCount;
+    int enabled;
+    double startWall;       // Start values of the phase being measured
+    double startCPU;
+    long long startHeap;
+} Stats;
+
+/* PHASE TIMING */
+void statsEnable(Stats* stats);
+int statsEnabled(Stats* stats);
+void phaseBegin(Stats* stats, const char* name, const char* label);
+void phaseEnd(Stats* stats);
+
+/* Add the phases of one compilation into a running total */
+void statsMerge(Stats* total, const Stats* stats);
+
+/* REPORTS */
+void printTimeReport(Stats* stats, FILE* out);
+void writeStatsJSON(Stats* stats, FILE* out, const char* inputFile);
+
+#endif
@@ -1,5 +1,6 @@
 /* SYMBOL TABLE IMPLEMENTATION
- * Manages variable declarations and lookups
+ * The binding pass: resolves every name in the program once, after
+ * parsing, to the symbol or function it refers to.
  * Essential for semantic analysis (checking if variables are declared)
  * Provides memory layout information for code generation
  */
@@ -8,201 +9,217 @@
 #include <string.h>
 #include "symtab.h"
 
-SymbolTable symtab;
-
-void initSymTab() {
-    // Create global scope
-    symtab.globalScope = malloc(sizeof(Scope));
-    symtab.globalScope->count = 0;
-    symtab.globalScope->nextOffset = 0;
-    symtab.globalScope->paramOffset = 8;
-    symtab.globalScope->parent = NULL;
-    symtab.currentScope = symtab.globalScope;
+void initSymTab(SymbolTable* symtab) {
+    symtab->count = 1;
+    symtab->functionCount = 0;
+    symtab->root = 0;
 }
 
-void enterScope() {
-    Scope* newScope = malloc(sizeof(Scope));
-    newScope->count = 0;
-    newScope->nextOffset = -4;  // Local variables have negative offsets
-    newScope->paramOffset = 8;   // Parameters have positive offsets
-    newScope->parent = symtab.currentScope;
-    symtab.currentScope = newScope;
+void freeSymTab(SymbolTable* symtab) {
+    free(symtab->symbols);
+    free(symtab->functions);
+    free(symtab->scope);
+    free(symtab->callees);
+    memset(symtab, 0, sizeof(SymbolTable));
 }
 
-void exitScope() {
-    if (symtab.currentScope != symtab.globalScope) {
-        Scope* oldScope = symtab.currentScope;
-        symtab.currentScope = symtab.currentScope->parent;
-        free(oldScope);
-    }
+// Room in the by-name arrays for every name interned so far
+static int reserveNames(SymbolTable* symtab, const AST* ast) {
+    size_t needed = ast->names->count + 1;
+    if (needed <= symtab->nameCapacity) return 0;
+    size_t capacity = symtab->nameCapacity ? symtab->nameCapacity : 256;
+    while (capacity < needed) capacity *= 2;
+    SymbolId* scope = realloc(symtab->scope, capacity * sizeof(SymbolId));
+    if (scope) symtab->scope = scope;
+    FunctionId* callees = realloc(symtab->callees, capacity * sizeof(FunctionId));
+    if (callees) symtab->callees = callees;
+    if (!scope || !callees) return -1;
+    size_t added = capacity - symtab->nameCapacity;
+    memset(symtab->scope + symtab->nameCapacity, 0, added * sizeof(SymbolId));
+    memset(symtab->callees + symtab->nameCapacity, 0, added * sizeof(FunctionId));
+    symtab->nameCapacity = capacity;
+    return 0;
 }
 
-Symbol* lookupSymbol(char* name) {
-    Scope* scope = symtab.currentScope;
-    
-    while (scope != NULL) {
-        for (int i = 0; i < scope->count; i++) {
-            if (strcmp(scope->vars[i].name, name) == 0) {
-                return &scope->vars[i];
-            }
+/* ============ DECLARATIONS ============ */
+
+/* A function's frame while it is bound: parameters and locals grow
+ * down from $fp */
+typedef struct {
+    SymbolTable* symtab;
+    const AST* ast;
+    int nextOffset;
+    int failed;             // Out of memory
+} Binder;
+
+// Declare name with size words in the current function. A name it
+// already has keeps its first declaration, and the new one takes no
+// room in the frame.
+static Symbol* declare(Binder* binder, NameId name, int size) {
+    SymbolTable* symtab = binder->symtab;
+    if (symtab->scope[name]) return NULL;
+    if (symtab->count >= symtab->capacity) {
+        uint32_t capacity = symtab->capacity ? symtab->capacity * 2 : 64;
+        Symbol* grown = realloc(symtab->symbols, capacity * sizeof(Symbol));
+        if (!grown) {
+            binder->failed = 1;
+            return NULL;
         }
-        scope = scope->parent;
+        symtab->symbols = grown;
+        symtab->capacity = capacity;
     }
-    return NULL;
+    SymbolId id = symtab->count++;
+    Symbol* sym = &symtab->symbols[id];
+    memset(sym, 0, sizeof(Symbol));
+    sym->name = name;
+    // Array elements go up from the lowest slot, so they stay below the frame
+    sym->offset = binder->nextOffset - (size - 1) * 4;
+    binder->nextOffset -= size * 4;
+    symtab->scope[name] = id;
+    return sym;
 }
 
-int isInCurrentScope(char* name) {
-    for (int i = 0; i < symtab.currentScope->count; i++) {
-        if (strcmp(symtab.currentScope->vars[i].name, name) == 0) {
-            return 1;
+/* ============ REFERENCES ============ */
+
+static void bindNode(Binder* binder, NodeId id) {
+    const AST* ast = binder->ast;
+    const SymbolTable* symtab = binder->symtab;
+    ASTNode* node = astNode(ast, id);
+    if (!node) return;
+    Symbol* sym;
+
+    switch (node->type) {
+        case NODE_VAR:
+            node->data.var.symbol = symtab->scope[node->data.var.name];
+            break;
+        case NODE_BINOP:
+            bindNode(binder, node->data.binop.left);
+            bindNode(binder, node->data.binop.right);
+            break;
+        case NODE_DECL:
+            declare(binder, node->data.name, 1);
+            break;
+        case NODE_ARRAY_DECL:
+            sym = declare(binder, node->data.array_decl.name, node->data.array_decl.size);
+            if (sym) {
+                sym->isArray = 1;
+                sym->arraySize = node->data.array_decl.size;
+            }
+            break;
+        case NODE_ARRAY_2D_DECL: {
+            int rows = node->data.array_2d_decl.rows;
+            int cols = node->data.array_2d_decl.cols;
+            sym = declare(binder, node->data.array_2d_decl.name, rows * cols);
+            if (sym) {
+                sym->isArray = 1;
+                sym->is2DArray = 1;
+                sym->cols = cols;
+                sym->arraySize = rows * cols;
+            }
+            break;
         }
+        case NODE_ASSIGN:
+            node->data.assign.symbol = symtab->scope[node->data.assign.var];
+            bindNode(binder, node->data.assign.value);
+            break;
+        case NODE_PRINT:
+            bindNode(binder, node->data.expr);
+            break;
+        case NODE_RETURN:
+            bindNode(binder, node->data.return_expr);
+            break;
+        case NODE_ARRAY_ASSIGN:
+            node->data.array_assign.symbol = symtab->scope[node->data.array_assign.name];
+            bindNode(binder, node->data.array_assign.index);
+            bindNode(binder, node->data.array_assign.value);
+            break;
+        case NODE_ARRAY_ACCESS:
+            node->data.array_access.symbol = symtab->scope[node->data.array_access.name];
+            bindNode(binder, node->data.array_access.index);
+            break;
+        case NODE_ARRAY_2D_ASSIGN:
+            node->data.array_2d_assign.symbol = symtab->scope[node->data.array_2d_assign.name];
+            bindNode(binder, node->data.array_2d_assign.row);
+            bindNode(binder, node->data.array_2d_assign.col);
+            bindNode(binder, node->data.array_2d_assign.value);
+            break;
+        case NODE_ARRAY_2D_ACCESS:
+            node->data.array_2d_access.symbol = symtab->scope[node->data.array_2d_access.name];
+            bindNode(binder, node->data.array_2d_access.row);
+            bindNode(binder, node->data.array_2d_access.col);
+            break;
+        case NODE_FUNC_CALL:
+            node->data.func_call.function = symtab->callees[node->data.func_call.name];
+            bindNode(binder, node->data.func_call.args);
+            break;
+        case NODE_STMT_LIST:
+        case NODE_ARG_LIST:
+            for (int i = 0; i < node->data.list.count; i++) {
+                bindNode(binder, node->data.list.items[i]);
+            }
+            break;
+        default:
+            break;
     }
-    return 0;
 }
 
-int addVar(char* name) {
-    if (isInCurrentScope(name)) {
-        return -1;
-    }
-    
-    Symbol* sym = &symtab.currentScope->vars[symtab.currentScope->count];
-    sym->name = strdup(name);
-    sym->isFunction = 0;
-    sym->isParameter = 0;
-    sym->isArray = 0;
-    sym->is2DArray = 0;
-    sym->offset = symtab.currentScope->nextOffset;
-    
-    symtab.currentScope->nextOffset -= 4;  // Locals grow downward
-    symtab.currentScope->count++;
-    
-    return sym->offset;
-}
+// Parameters first, then the body in order, so each use sees the
+// declarations before it
+static int bindScope(SymbolTable* symtab, const AST* ast, NodeId func) {
+    ASTNode* node = astNode(ast, func);
+    if (!node || node->type != NODE_FUNC_DECL) return 0;
+    Binder binder = { symtab, ast, -4, 0 };
+    SymbolId first = symtab->count;
 
-int addFunction(char* name, char* returnType, int paramCount) {
-    if (isInCurrentScope(name)) {
-        return -1;
+    ASTNode* params = astNode(ast, node->data.func_decl.params);
+    int isList = params && params->type == NODE_PARAM_LIST;
+    int paramCount = isList ? (int)params->data.list.count : params != NULL;
+    for (int i = 0; i < paramCount; i++) {
+        NodeId param = isList ? params->data.list.items[i] : node->data.func_decl.params;
+        Symbol* sym = declare(&binder, astNode(ast, param)->data.param.name, 1);
+        if (sym) sym->isParameter = 1;
     }
-    
-    Symbol* sym = &symtab.currentScope->vars[symtab.currentScope->count];
-    sym->name = strdup(name);
-    sym->returnType = strdup(returnType);
-    sym->isFunction = 1;
-    sym->isParameter = 0;
-    sym->paramCount = paramCount;
-    sym->offset = 0;
-    sym->isArray = 0;
-    sym->is2DArray = 0;
-    
-    symtab.currentScope->count++;
-    return 0;
-}
+    bindNode(&binder, node->data.func_decl.body);
 
-int addParameter(char* name, char* type) {
-    if (isInCurrentScope(name)) {
-        return -1;
+    // The next function starts with nothing in scope
+    for (SymbolId id = first; id < symtab->count; id++) {
+        symtab->scope[symtab->symbols[id].name] = 0;
     }
-    
-    Symbol* sym = &symtab.currentScope->vars[symtab.currentScope->count];
-    sym->name = strdup(name);
-    sym->returnType = strdup(type);
-    sym->isParameter = 1;
-    sym->isFunction = 0;
-    sym->isArray = 0;
-    sym->is2DArray = 0;
-    sym->offset = symtab.currentScope->paramOffset;
-    
-    symtab.currentScope->paramOffset += 4;
-    symtab.currentScope->count++;
-    
-    return sym->offset;
-}
-
-int getVarOffset(char* name) {
-    Symbol* sym = lookupSymbol(name);
-    return sym ? sym->offset : -9999;
-}
-
-int isVarDeclared(char* name) {
-    return lookupSymbol(name) != NULL;
+    return binder.failed ? -1 : 0;
 }
 
-Symbol* getSymbol(char* name) {
-    return lookupSymbol(name);
-}
+/* ============ PASSES ============ */
 
-int addArray(char* name, int size) {
-    if (isInCurrentScope(name)) {
+int bindProgram(SymbolTable* symtab, AST* ast, NodeId root) {
+    initSymTab(symtab);
+    NodeId* funcs = NULL;
+    int count = collectFunctions(ast, root, &funcs);
+    if (count < 0 || reserveNames(symtab, ast) != 0) {
+        free(funcs);
         return -1;
     }
-    
-    Symbol* sym = &symtab.currentScope->vars[symtab.currentScope->count];
-    sym->name = strdup(name);
-    sym->isFunction = 0;
-    sym->isParameter = 0;
-    sym->isArray = 1;
-    sym->is2DArray = 0;
-    sym->arraySize = size;
-    sym->offset = symtab.currentScope->nextOffset;
-    
-    symtab.currentScope->nextOffset -= size * 4;
-    symtab.currentScope->count++;
-    
-    return sym->offset;
-}
+    free(symtab->functions);
+    symtab->functions = funcs;
+    symtab->functionCount = count;
 
-int addArray2D(char* name, int rows, int cols) {
-    if (isInCurrentScope(name)) {
-        return -1;
+    // A name defined twice calls the first definition
+    for (int i = 0; i < count; i++) {
+        NameId name = astNode(ast, funcs[i])->data.func_decl.name;
+        if (!symtab->callees[name]) symtab->callees[name] = i + 1;
+    }
+    int result = 0;
+    for (int i = 0; i < count && result == 0; i++) {
+        result = bindScope(symtab, ast, funcs[i]);
+    }
+    for (int i = 0; i < count; i++) {
+        symtab->callees[astNode(ast, funcs[i])->data.func_decl.name] = 0;
     }
-    
-    Symbol* sym = &symtab.currentScope->vars[symtab.currentScope->count];
-    sym->name = strdup(name);
-    sym->isFunction = 0;
-    sym->isParameter = 0;
-    sym->isArray = 1;
-    sym->is2DArray = 1;
-    sym->rows = rows;
-    sym->cols = cols;
-    sym->arraySize = rows * cols;
-    sym->offset = symtab.currentScope->nextOffset;
-    
-    symtab.currentScope->nextOffset -= rows * cols * 4;
-    symtab.currentScope->count++;
-    
-    return sym->offset;
+    symtab->root = result == 0 ? root : 0;
+    return result;
 }
 
-void printSymTab() {
-    printf("\n=== SYMBOL TABLE STATE ===\n");
-    Scope* scope = symtab.currentScope;
-    int level = 0;
-    
-    while (scope != NULL) {
-        printf("Scope Level %d: Count=%d, NextOffset=%d\n", level, scope->count, scope->nextOffset);
-        if (scope->count == 0) {
-            printf("  (empty)\n");
-        } else {
-            printf("  Variables:\n");
-            for (int i = 0; i < scope->count; i++) {
-                if (scope->vars[i].isFunction) {
-                    printf("    [%d] FUNCTION %s -> returns %s, %d params\n", 
-                           i, scope->vars[i].name, scope->vars[i].returnType, scope->vars[i].paramCount);
-                } else if (scope->vars[i].is2DArray) {
-                    printf("    [%d] %s[%d][%d] -> offset %d\n", 
-                           i, scope->vars[i].name, scope->vars[i].rows, scope->vars[i].cols, scope->vars[i].offset);
-                } else if (scope->vars[i].isArray) {
-                    printf("    [%d] %s[%d] -> offset %d\n", 
-                           i, scope->vars[i].name, scope->vars[i].arraySize, scope->vars[i].offset);
-                } else {
-                    printf("    [%d] %s -> offset %d%s\n", 
-                           i, scope->vars[i].name, scope->vars[i].offset,
-                           scope->vars[i].isParameter ? " (parameter)" : "");
-                }
-            }
-        }
-        scope = scope->parent;
-        level++;
-    }
-    printf("==========================\n\n");
-}
\ No newline at end of file
+int bindFunction(SymbolTable* symtab, AST* ast, NodeId func) {
+    initSymTab(symtab);
+    if (reserveNames(symtab, ast) != 0) return -1;
+    return bindScope(symtab, ast, func);
+}
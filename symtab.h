@@ -1,60 +1,60 @@
 #ifndef SYMTAB_H
 #define SYMTAB_H
 
-#define MAX_VARS 100
-#define MAX_PARAMS 10
+#include <stddef.h>
+#include "ast.h"
 
-/* Symbol entry */
+/* Symbol entry: a parameter, variable or array of one function. A
+ * program has one per declaration, so it is kept small. */
 typedef struct {
-    char* name;
-    int offset;
-    int isArray;
-    int arraySize;
-    int is2DArray;
-    int rows;
-    int cols;
-    int isFunction;
-    int isParameter;
-    char* returnType;
-    int paramCount;
+    NameId name;
+    int offset;             // From $fp; an array's is its first element
+    int arraySize;          // Elements, for arrays
+    int cols;               // Row length, for 2D arrays
+    unsigned char isArray;
+    unsigned char is2DArray;
+    unsigned char isParameter;
 } Symbol;
 
-/* Forward declaration */
-struct Scope;
-
-/* Scope structure for nested scopes */
-typedef struct Scope {
-    Symbol vars[MAX_VARS];
-    int count;
-    int nextOffset;
-    int paramOffset;
-    struct Scope* parent;
-} Scope;
-
-/* Symbol table with scope management */
+/* SYMBOL TABLE
+ * Every function is a scope of its own, holding its parameters and
+ * then its declarations in source order. The binding pass numbers the
+ * symbols of all functions in one array and stores each one's id in
+ * the nodes that refer to it, and the id of the called function in
+ * each call, so later phases index instead of looking names up. A
+ * name is bound from its declaration on; a use before it, or of a
+ * name never declared, keeps id 0 and is reported where it is
+ * compiled. */
 typedef struct {
-    Scope* currentScope;
-    Scope* globalScope;
+    Symbol* symbols;        // By SymbolId; symbols[0] is unused
+    uint32_t count;
+    uint32_t capacity;
+    NodeId* functions;      // Declarations by FunctionId - 1, in source order
+    uint32_t functionCount;
+    NodeId root;            // Program the table was built for
+    SymbolId* scope;        // While binding: by NameId, the function's symbol of that name
+    FunctionId* callees;    // While binding: by NameId, the first function of that name
+    size_t nameCapacity;
 } SymbolTable;
 
-/* Global symbol table instance */
-extern SymbolTable symtab;
-
-/* Basic operations */
-void initSymTab();
-int addVar(char* name);
-int addArray(char* name, int size);
-int addArray2D(char* name, int rows, int cols);
-int getVarOffset(char* name);
-int isVarDeclared(char* name);
-Symbol* getSymbol(char* name);
-
-/* Function and scope operations */
-void enterScope();
-void exitScope();
-int addFunction(char* name, char* returnType, int paramCount);
-int addParameter(char* name, char* type);
-Symbol* lookupSymbol(char* name);
-int isInCurrentScope(char* name);
-
-#endif
\ No newline at end of file
+/* Empty the table, keeping its memory */
+void initSymTab(SymbolTable* symtab);
+void freeSymTab(SymbolTable* symtab);
+
+/* Bind every function of the program under root. Returns 0, or -1 if
+ * memory ran out. */
+int bindProgram(SymbolTable* symtab, AST* ast, NodeId root);
+/* Bind one function on its own (--stream): the table then holds only
+ * its symbols, and calls stay unbound since the other functions are
+ * not there to be found */
+int bindFunction(SymbolTable* symtab, AST* ast, NodeId func);
+
+static inline Symbol* boundSymbol(const SymbolTable* symtab, SymbolId id) {
+    return id ? &symtab->symbols[id] : NULL;
+}
+
+static inline NodeId boundFunction(const SymbolTable* symtab, FunctionId id) {
+    return id ? symtab->functions[id - 1] : 0;
+}
+
+#endif
@@ -0,0 +1,52 @@
+.data
+
+.text
+.globl main
+
+
+# Function: main
+main:
+    # Prologue
+    addi $sp, $sp, -8
+    sw $ra, 4($sp)
+    sw $fp, 0($sp)
+    move $fp, $sp
+    # Allocate space for 1 local variables
+    addi $sp, $sp, -4
+    # Declared t0
+    li $t0, 2
+    sw $t0, -4($fp)
+    lw $t0, -4($fp)
+    li $t1, 3
+    mul $t0, $t0, $t1
+    lw $t1, -4($fp)
+    add $t0, $t0, $t1
+    # Print integer
+    move $a0, $t0
+    li $v0, 1
+    syscall
+    # Print newline
+    li $v0, 11
+    li $a0, 10
+    syscall
+    li $t0, 0
+    move $v0, $t0
+    # Return statement
+    addi $sp, $sp, 4
+    move $sp, $fp
+    lw $fp, 0($sp)
+    lw $ra, 4($sp)
+    addi $sp, $sp, 8
+    jr $ra
+    # Epilogue
+    addi $sp, $sp, 4
+    move $sp, $fp
+    lw $fp, 0($sp)
+    lw $ra, 4($sp)
+    addi $sp, $sp, 8
+    jr $ra
+
+# Exit program
+_exit:
+    li $v0, 10
+    syscall
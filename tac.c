@@ -4,25 +4,38 @@
 #include <ctype.h>
 #include "tac.h"
 #include "symtab.h"
+#include "intern.h"
 
-TACList tacList;
-TACList optimizedList;
+void initTAC(TACList* list) {
+    list->head = NULL;
+    list->tail = NULL;
+    list->tempCount = 0;
+}
 
-void initTAC() {
-    tacList.head = NULL;
-    tacList.tail = NULL;
-    tacList.tempCount = 0;
-    optimizedList.head = NULL;
-    optimizedList.tail = NULL;
+// Free every instruction in the list and leave it empty
+void freeTAC(TACList* list) {
+    TACInstr* curr = list->head;
+    while (curr) {
+        TACInstr* next = curr->next;
+        free(curr->arg1);
+        free(curr->arg2);
+        free(curr->arg3);
+        free(curr->result);
+        free(curr);
+        curr = next;
+    }
+    initTAC(list);
 }
 
-char* newTemp() {
-    char* temp = malloc(10);
-    sprintf(temp, "t%d", tacList.tempCount++);
+// Temporaries are named .t0, .t1, ... so that no variable can be
+// mistaken for one
+char* newTemp(TACList* list) {
+    char* temp = malloc(16);
+    sprintf(temp, ".t%d", list->tempCount++);
     return temp;
 }
 
-TACInstr* createTAC(TACOp op, char* arg1, char* arg2, char* result) {
+TACInstr* createTAC(TACOp op, const char* arg1, const char* arg2, const char* result) {
     TACInstr* instr = malloc(sizeof(TACInstr));
     instr->op = op;
     instr->arg1 = arg1 ? strdup(arg1) : NULL;
@@ -34,7 +47,8 @@ TACInstr* createTAC(TACOp op, char* arg1, char* arg2, char* result) {
     return instr;
 }
 
-TACInstr* createTAC2D(TACOp op, char* arg1, char* arg2, char* arg3, char* result) {
+TACInstr* createTAC2D(TACOp op, const char* arg1, const char* arg2, const char* arg3,
+                      const char* result) {
     TACInstr* instr = malloc(sizeof(TACInstr));
     instr->op = op;
     instr->arg1 = arg1 ? strdup(arg1) : NULL;
@@ -46,25 +60,17 @@ TACInstr* createTAC2D(TACOp op, char* arg1, char* arg2, char* arg3, char* result
     return instr;
 }
 
-void appendTAC(TACInstr* instr) {
-    if (!tacList.head) {
-        tacList.head = tacList.tail = instr;
-    } else {
-        tacList.tail->next = instr;
-        tacList.tail = instr;
-    }
-}
-
-void appendOptimizedTAC(TACInstr* instr) {
-    if (!optimizedList.head) {
-        optimizedList.head = optimizedList.tail = instr;
+void appendTAC(TACList* list, TACInstr* instr) {
+    if (!list->head) {
+        list->head = list->tail = instr;
     } else {
-        optimizedList.tail->next = instr;
-        optimizedList.tail = instr;
+        list->tail->next = instr;
+        list->tail = instr;
     }
 }
 
-char* generateTACExpr(ASTNode* node) {
+char* generateTACExpr(TACList* list, const AST* ast, NodeId id) {
+    ASTNode* node = astNode(ast, id);
     if (!node) return NULL;
     
     switch(node->type) {
@@ -75,71 +81,62 @@ char* generateTACExpr(ASTNode* node) {
         }
         
         case NODE_VAR:
-            return strdup(node->data.name);
+            return strdup(astName(ast, node->data.var.name));
         
         case NODE_BINOP: {
-            char* left = generateTACExpr(node->data.binop.left);
-            char* right = generateTACExpr(node->data.binop.right);
-            char* temp = newTemp();
+            char* left = generateTACExpr(list, ast, node->data.binop.left);
+            char* right = generateTACExpr(list, ast, node->data.binop.right);
+            char* temp = newTemp(list);
             
             if (node->data.binop.op == '+') {
-                appendTAC(createTAC(TAC_ADD, left, right, temp));
+                appendTAC(list, createTAC(TAC_ADD, left, right, temp));
             }
             else if (node->data.binop.op == '-') {
-                appendTAC(createTAC(TAC_SUB, left, right, temp));
+                appendTAC(list, createTAC(TAC_SUB, left, right, temp));
             }
             else if (node->data.binop.op == '*') {
-                appendTAC(createTAC(TAC_MUL, left, right, temp));
+                appendTAC(list, createTAC(TAC_MUL, left, right, temp));
             }
             
             return temp;
         }
         
         case NODE_ARRAY_ACCESS: {
-            char* index = generateTACExpr(node->data.array_access.index);
-            char* temp = newTemp();
-            appendTAC(createTAC(TAC_LOAD, node->data.array_access.name, index, temp));
+            char* index = generateTACExpr(list, ast, node->data.array_access.index);
+            char* temp = newTemp(list);
+            appendTAC(list, createTAC(TAC_LOAD, astName(ast, node->data.array_access.name), index, temp));
             return temp;
         }
         
         case NODE_ARRAY_2D_ACCESS: {
-            char* row = generateTACExpr(node->data.array_2d_access.row);
-            char* col = generateTACExpr(node->data.array_2d_access.col);
-            char* temp = newTemp();
-            appendTAC(createTAC2D(TAC_LOAD_2D, node->data.array_2d_access.name, row, col, temp));
+            char* row = generateTACExpr(list, ast, node->data.array_2d_access.row);
+            char* col = generateTACExpr(list, ast, node->data.array_2d_access.col);
+            char* temp = newTemp(list);
+            appendTAC(list, createTAC2D(TAC_LOAD_2D,
+                                        astName(ast, node->data.array_2d_access.name), row, col, temp));
             return temp;
         }
         
         case NODE_FUNC_CALL: {
-            // Recursively collect arguments into a flat list
-            char* args[10];
-            int argCount = 0;
-            
-            // Helper function to recursively extract arguments
-            void collectArgs(ASTNode* argNode) {
-                if (!argNode) return;
-                
-                if (argNode->type == NODE_ARG_LIST) {
-                    collectArgs(argNode->data.list.item);  // Process left side first
-                    collectArgs(argNode->data.list.next);   // Then right side
-                } else {
-                    // Base case: actual argument expression
-                    args[argCount++] = generateTACExpr(argNode);
-                }
+            // Evaluate the arguments in order, then pass them
+            ASTNode* argList = astNode(ast, node->data.func_call.args);
+            int argCount = argList ? argList->data.list.count : 0;
+            char** args = malloc((argCount ? argCount : 1) * sizeof(char*));
+            for (int i = 0; i < argCount; i++) {
+                args[i] = generateTACExpr(list, ast, argList->data.list.items[i]);
             }
             
-            collectArgs(node->data.func_call.args);
-            
             // Generate PARAM instructions
             for (int i = 0; i < argCount; i++) {
-                appendTAC(createTAC(TAC_PARAM, args[i], NULL, NULL));
+                appendTAC(list, createTAC(TAC_PARAM, args[i], NULL, NULL));
             }
+            free(args);
             
             // Generate the call
-            char* temp = newTemp();
-            TACInstr* call = createTAC(TAC_CALL, node->data.func_call.name, NULL, temp);
+            char* temp = newTemp(list);
+            TACInstr* call = createTAC(TAC_CALL, astName(ast, node->data.func_call.name), NULL, temp);
             call->paramCount = argCount;
-            appendTAC(call);
+            appendTAC(list, call);
             
             return temp;
         }
@@ -149,39 +146,53 @@ char* generateTACExpr(ASTNode* node) {
     }
 }
 
-void generateTAC(ASTNode* node) {
+void generateTAC(TACList* list, const AST* ast, NodeId id) {
+    ASTNode* node = astNode(ast, id);
     if (!node) return;
     
     switch(node->type) {
         case NODE_FUNC_LIST:
-            generateTAC(node->data.list.item);
-            generateTAC(node->data.list.next);
+        case NODE_PARAM_LIST:
+        case NODE_STMT_LIST:
+            for (int i = 0; i < node->data.list.count; i++) {
+                generateTAC(list, ast, node->data.list.items[i]);
+            }
             break;
             
         case NODE_FUNC_DECL: {
+            const char* name = astName(ast, node->data.func_decl.name);
+            
             // Function begin marker
-            appendTAC(createTAC(TAC_FUNC_BEGIN, NULL, NULL, node->data.func_decl.name));
+            appendTAC(list, createTAC(TAC_FUNC_BEGIN, NULL, NULL, name));
             
             // Label for function entry
-            appendTAC(createTAC(TAC_LABEL, NULL, NULL, node->data.func_decl.name));
+            appendTAC(list, createTAC(TAC_LABEL, NULL, NULL, name));
+            
+            // Name the incoming parameters so later phases can bind them
+            generateTAC(list, ast, node->data.func_decl.params);
             
             // Generate TAC for function body (don't manage scope here)
-            generateTAC(node->data.func_decl.body);
+            generateTAC(list, ast, node->data.func_decl.body);
             
             // Function end marker
-            appendTAC(createTAC(TAC_FUNC_END, NULL, NULL, node->data.func_decl.name));
+            appendTAC(list, createTAC(TAC_FUNC_END, NULL, NULL, name));
             
             break;
         }
         
+        case NODE_PARAM:
+            appendTAC(list, createTAC(TAC_PARAM_DECL, NULL, NULL, astName(ast, node->data.param.name)));
+            break;
+        
         case NODE_DECL:
-            appendTAC(createTAC(TAC_DECL, NULL, NULL, node->data.name));
+            appendTAC(list, createTAC(TAC_DECL, NULL, NULL, astName(ast, node->data.name)));
             break;
 
         case NODE_ARRAY_DECL: {
             char sizeStr[20];
             sprintf(sizeStr, "%d", node->data.array_decl.size);
-            appendTAC(createTAC(TAC_DECL_ARRAY, strdup(sizeStr), NULL, node->data.array_decl.name));
+            appendTAC(list, createTAC(TAC_DECL_ARRAY, strdup(sizeStr), NULL,
+                                      astName(ast, node->data.array_decl.name)));
             break;
         }
 
@@ -189,61 +200,58 @@ void generateTAC(ASTNode* node) {
             char rowStr[20], colStr[20];
             sprintf(rowStr, "%d", node->data.array_2d_decl.rows);
             sprintf(colStr, "%d", node->data.array_2d_decl.cols);
-            appendTAC(createTAC(TAC_DECL_ARRAY_2D, strdup(rowStr), strdup(colStr), node->data.array_2d_decl.name));
+            appendTAC(list, createTAC(TAC_DECL_ARRAY_2D, strdup(rowStr), strdup(colStr),
+                                      astName(ast, node->data.array_2d_decl.name)));
             break;
         }
             
         case NODE_ASSIGN: {
-            char* expr = generateTACExpr(node->data.assign.value);
-            appendTAC(createTAC(TAC_ASSIGN, expr, NULL, node->data.assign.var));
+            char* expr = generateTACExpr(list, ast, node->data.assign.value);
+            appendTAC(list, createTAC(TAC_ASSIGN, expr, NULL, astName(ast, node->data.assign.var)));
             break;
         }
 
         case NODE_ARRAY_ASSIGN: {
-            char* index = generateTACExpr(node->data.array_assign.index);
-            char* value = generateTACExpr(node->data.array_assign.value);
-            appendTAC(createTAC(TAC_STORE, index, value, node->data.array_assign.name));
+            char* index = generateTACExpr(list, ast, node->data.array_assign.index);
+            char* value = generateTACExpr(list, ast, node->data.array_assign.value);
+            appendTAC(list, createTAC(TAC_STORE, index, value, astName(ast, node->data.array_assign.name)));
             break;
         }
 
         case NODE_ARRAY_2D_ASSIGN: {
-            char* row = generateTACExpr(node->data.array_2d_assign.row);
-            char* col = generateTACExpr(node->data.array_2d_assign.col);
-            char* value = generateTACExpr(node->data.array_2d_assign.value);
-            appendTAC(createTAC2D(TAC_STORE_2D, row, col, value, node->data.array_2d_assign.name));
+            char* row = generateTACExpr(list, ast, node->data.array_2d_assign.row);
+            char* col = generateTACExpr(list, ast, node->data.array_2d_assign.col);
+            char* value = generateTACExpr(list, ast, node->data.array_2d_assign.value);
+            appendTAC(list, createTAC2D(TAC_STORE_2D, row, col, value,
+                                        astName(ast, node->data.array_2d_assign.name)));
             break;
         }
         
         case NODE_PRINT: {
-            char* expr = generateTACExpr(node->data.expr);
-            appendTAC(createTAC(TAC_PRINT, expr, NULL, NULL));
+            char* expr = generateTACExpr(list, ast, node->data.expr);
+            appendTAC(list, createTAC(TAC_PRINT, expr, NULL, NULL));
             break;
         }
         
         case NODE_RETURN: {
             if (node->data.return_expr) {
-                char* retVal = generateTACExpr(node->data.return_expr);
-                appendTAC(createTAC(TAC_RETURN, retVal, NULL, NULL));
+                char* retVal = generateTACExpr(list, ast, node->data.return_expr);
+                appendTAC(list, createTAC(TAC_RETURN, retVal, NULL, NULL));
             } else {
-                appendTAC(createTAC(TAC_RETURN, NULL, NULL, NULL));
+                appendTAC(list, createTAC(TAC_RETURN, NULL, NULL, NULL));
             }
             break;
         }
         
-        case NODE_STMT_LIST:
-            generateTAC(node->data.stmtlist.stmt);
-            generateTAC(node->data.stmtlist.next);
-            break;
-            
         default:
             break;
     }
 }
 
-void printTAC() {
+void printTAC(TACList* list) {
     printf("Unoptimized TAC Instructions:\n");
     printf("─────────────────────────────\n");
-    TACInstr* curr = tacList.head;
+    TACInstr* curr = list->head;
     int lineNum = 1;
     while (curr) {
         printf("%2d: ", lineNum++);
@@ -270,6 +278,9 @@ void printTAC() {
                     printf("RETURN\n");
                 }
                 break;
+            case TAC_PARAM_DECL:
+                printf("PARAM_DECL %s\n", curr->result);
+                break;
             case TAC_DECL:
                 printf("DECL %s\n", curr->result);
                 break;
@@ -323,25 +334,82 @@ int isConstant(char* str) {
     return 1;
 }
 
-void optimizeTAC() {
-    TACInstr* curr = tacList.head;
-    
-    typedef struct {
-        char* var;
-        char* value;
-    } VarValue;
-    
-    VarValue values[100];
-    int valueCount = 0;
+int isTemp(char* str) {
+    return str && str[0] == '.';
+}
+
+/* The constants variables and temps are known to hold, by name. A
+ * long function folds one per statement, so they are found through
+ * the interning table rather than searched for. */
+typedef struct {
+    StringTable names;      // Every operand seen, numbered from 1
+    char** values;          // By name id: the operand's constant, or NULL
+    size_t capacity;
+} ValueTable;
+
+// Where name's constant is kept, or NULL if memory ran out
+static char** valueSlot(ValueTable* table, const char* name) {
+    unsigned id = internName(&table->names, name, strlen(name));
+    if (!id) return NULL;
+    if (id >= table->capacity) {
+        size_t capacity = table->capacity ? table->capacity : 64;
+        while (capacity <= id) capacity *= 2;
+        char** grown = realloc(table->values, capacity * sizeof(char*));
+        if (!grown) return NULL;
+        memset(grown + table->capacity, 0, (capacity - table->capacity) * sizeof(char*));
+        table->values = grown;
+        table->capacity = capacity;
+    }
+    return &table->values[id];
+}
+
+static void forgetValue(ValueTable* table, const char* name) {
+    char** slot = valueSlot(table, name);
+    if (!slot) return;
+    free(*slot);
+    *slot = NULL;
+}
+
+// Forget every constant, as at the start of a function
+static void forgetValues(ValueTable* table) {
+    for (size_t id = 1; id <= table->names.count && id < table->capacity; id++) {
+        free(table->values[id]);
+        table->values[id] = NULL;
+    }
+    clearStringTable(&table->names);
+}
+
+// Record that name holds value, taking value over. Without the memory
+// the constant is just not propagated.
+static void rememberValue(ValueTable* table, const char* name, char* value) {
+    char** slot = valueSlot(table, name);
+    if (!slot) {
+        free(value);
+        return;
+    }
+    free(*slot);
+    *slot = value;
+}
+
+// The constant operand holds, or the operand itself
+static char* knownValue(ValueTable* table, char* operand) {
+    char** slot = valueSlot(table, operand);
+    return slot && *slot && isConstant(*slot) ? *slot : operand;
+}
+
+// Fold and propagate constants from curr up to end (exclusive),
+// appending the result to 'out'
+static void optimizeRange(TACInstr* curr, TACInstr* end, TACList* out) {
+    ValueTable values = { { 0 }, NULL, 0 };
     
-    while (curr) {
+    while (curr != end) {
         TACInstr* newInstr = NULL;
         
         switch(curr->op) {
             case TAC_FUNC_BEGIN:
             case TAC_FUNC_END:
             case TAC_LABEL:
-                valueCount = 0;
+                forgetValues(&values);
                 newInstr = createTAC(curr->op, curr->arg1, curr->arg2, curr->result);
                 break;
                 
@@ -357,36 +425,21 @@ void optimizeTAC() {
             }
                 
             case TAC_DECL:
-                newInstr = createTAC(TAC_DECL, NULL, NULL, curr->result);
+            case TAC_PARAM_DECL:
+                newInstr = createTAC(curr->op, NULL, NULL, curr->result);
                 break;
                 
             case TAC_ADD: {
-                char* left = curr->arg1;
-                char* right = curr->arg2;
-                
-                for (int i = valueCount - 1; i >= 0; i--) {
-                    if (strcmp(values[i].var, left) == 0 && isConstant(values[i].value)) {
-                        left = values[i].value;
-                        break;
-                    }
-                }
-                for (int i = valueCount - 1; i >= 0; i--) {
-                    if (strcmp(values[i].var, right) == 0 && isConstant(values[i].value)) {
-                        right = values[i].value;
-                        break;
-                    }
-                }
+                char* left = knownValue(&values, curr->arg1);
+                char* right = knownValue(&values, curr->arg2);
                 
                 if (isConstant(left) && isConstant(right)) {
                     int result = atoi(left) + atoi(right);
                     char* resultStr = malloc(20);
                     sprintf(resultStr, "%d", result);
                     
-                    values[valueCount].var = strdup(curr->result);
-                    values[valueCount].value = resultStr;
-                    valueCount++;
-                    
                     newInstr = createTAC(TAC_ASSIGN, resultStr, NULL, curr->result);
+                    rememberValue(&values, curr->result, resultStr);
                 } else {
                     newInstr = createTAC(TAC_ADD, left, right, curr->result);
                 }
@@ -394,32 +447,16 @@ void optimizeTAC() {
             }
 
             case TAC_SUB: {
-                char* left = curr->arg1;
-                char* right = curr->arg2;
-                
-                for (int i = valueCount - 1; i >= 0; i--) {
-                    if (strcmp(values[i].var, left) == 0 && isConstant(values[i].value)) {
-                        left = values[i].value;
-                        break;
-                    }
-                }
-                for (int i = valueCount - 1; i >= 0; i--) {
-                    if (strcmp(values[i].var, right) == 0 && isConstant(values[i].value)) {
-                        right = values[i].value;
-                        break;
-                    }
-                }
+                char* left = knownValue(&values, curr->arg1);
+                char* right = knownValue(&values, curr->arg2);
                 
                 if (isConstant(left) && isConstant(right)) {
                     int result = atoi(left) - atoi(right);
                     char* resultStr = malloc(20);
                     sprintf(resultStr, "%d", result);
                     
-                    values[valueCount].var = strdup(curr->result);
-                    values[valueCount].value = resultStr;
-                    valueCount++;
-                    
                     newInstr = createTAC(TAC_ASSIGN, resultStr, NULL, curr->result);
+                    rememberValue(&values, curr->result, resultStr);
                 } else {
                     newInstr = createTAC(TAC_SUB, left, right, curr->result);
                 }
@@ -427,32 +464,16 @@ void optimizeTAC() {
             }
 
             case TAC_MUL: {
-                char* left = curr->arg1;
-                char* right = curr->arg2;
-                
-                for (int i = valueCount - 1; i >= 0; i--) {
-                    if (strcmp(values[i].var, left) == 0 && isConstant(values[i].value)) {
-                        left = values[i].value;
-                        break;
-                    }
-                }
-                for (int i = valueCount - 1; i >= 0; i--) {
-                    if (strcmp(values[i].var, right) == 0 && isConstant(values[i].value)) {
-                        right = values[i].value;
-                        break;
-                    }
-                }
+                char* left = knownValue(&values, curr->arg1);
+                char* right = knownValue(&values, curr->arg2);
                 
                 if (isConstant(left) && isConstant(right)) {
                     int result = atoi(left) * atoi(right);
                     char* resultStr = malloc(20);
                     sprintf(resultStr, "%d", result);
                     
-                    values[valueCount].var = strdup(curr->result);
-                    values[valueCount].value = resultStr;
-                    valueCount++;
-                    
                     newInstr = createTAC(TAC_ASSIGN, resultStr, NULL, curr->result);
+                    rememberValue(&values, curr->result, resultStr);
                 } else {
                     newInstr = createTAC(TAC_MUL, left, right, curr->result);
                 }
@@ -462,20 +483,9 @@ void optimizeTAC() {
             case TAC_ASSIGN: {
                 char* value = curr->arg1;
                 
-                for (int i = 0; i < valueCount; i++) {
-                    if (strcmp(values[i].var, curr->result) == 0) {
-                        for (int j = i; j < valueCount - 1; j++) {
-                            values[j] = values[j + 1];
-                        }
-                        valueCount--;
-                        break;
-                    }
-                }
-                
+                forgetValue(&values, curr->result);
                 if (isConstant(value)) {
-                    values[valueCount].var = strdup(curr->result);
-                    values[valueCount].value = strdup(value);
-                    valueCount++;
+                    rememberValue(&values, curr->result, strdup(value));
                 }
                 
                 newInstr = createTAC(TAC_ASSIGN, value, NULL, curr->result);
@@ -483,15 +493,7 @@ void optimizeTAC() {
             }
             
             case TAC_PRINT: {
-                char* value = curr->arg1;
-                
-                for (int i = valueCount - 1; i >= 0; i--) {
-                    if (strcmp(values[i].var, value) == 0 && isConstant(values[i].value)) {
-                        value = values[i].value;
-                        break;
-                    }
-                }
-                
+                char* value = knownValue(&values, curr->arg1);
                 newInstr = createTAC(TAC_PRINT, value, NULL, NULL);
                 break;
             }
@@ -522,17 +524,210 @@ void optimizeTAC() {
         }
         
         if (newInstr) {
-            appendOptimizedTAC(newInstr);
+            appendTAC(out, newInstr);
         }
         
         curr = curr->next;
     }
+    forgetValues(&values);
+    freeStringTable(&values.names);
+    free(values.values);
+}
+
+void optimizeTAC(TACList* in, TACList* out) {
+    optimizeRange(in->head, NULL, out);
+}
+
+/* ============ PER-FUNCTION PARALLELISM ============ */
+
+/* Functions share nothing in TAC but the temp numbering, and each
+ * function's optimization starts from an empty constant table. A range
+ * of functions is generated or optimized into a list of its own on the
+ * thread pool, and the lists are joined in source order, so the result
+ * is exactly what the serial passes produce. */
+
+// Temps generateTACExpr creates for an expression
+static int countExprTemps(const AST* ast, NodeId id);
+
+static int countArgTemps(const AST* ast, NodeId id) {
+    ASTNode* node = astNode(ast, id);
+    if (!node) return 0;
+    int count = 0;
+    for (int i = 0; i < node->data.list.count; i++) {
+        count += countExprTemps(ast, node->data.list.items[i]);
+    }
+    return count;
+}
+
+static int countExprTemps(const AST* ast, NodeId id) {
+    ASTNode* node = astNode(ast, id);
+    if (!node) return 0;
+    
+    switch(node->type) {
+        case NODE_BINOP:
+            return 1 + countExprTemps(ast, node->data.binop.left) +
+                   countExprTemps(ast, node->data.binop.right);
+        case NODE_ARRAY_ACCESS:
+            return 1 + countExprTemps(ast, node->data.array_access.index);
+        case NODE_ARRAY_2D_ACCESS:
+            return 1 + countExprTemps(ast, node->data.array_2d_access.row) +
+                   countExprTemps(ast, node->data.array_2d_access.col);
+        case NODE_FUNC_CALL:
+            return 1 + countArgTemps(ast, node->data.func_call.args);
+        default:
+            return 0;
+    }
+}
+
+// Temps generateTAC creates for a statement or function, so a range of
+// functions can number its temps without the ones before it
+static int countTemps(const AST* ast, NodeId id) {
+    ASTNode* node = astNode(ast, id);
+    if (!node) return 0;
+    
+    switch(node->type) {
+        case NODE_FUNC_LIST:
+        case NODE_STMT_LIST: {
+            int count = 0;
+            for (int i = 0; i < node->data.list.count; i++) {
+                count += countTemps(ast, node->data.list.items[i]);
+            }
+            return count;
+        }
+        case NODE_FUNC_DECL:
+            return countTemps(ast, node->data.func_decl.body);
+        case NODE_ASSIGN:
+            return countExprTemps(ast, node->data.assign.value);
+        case NODE_ARRAY_ASSIGN:
+            return countExprTemps(ast, node->data.array_assign.index) +
+                   countExprTemps(ast, node->data.array_assign.value);
+        case NODE_ARRAY_2D_ASSIGN:
+            return countExprTemps(ast, node->data.array_2d_assign.row) +
+                   countExprTemps(ast, node->data.array_2d_assign.col) +
+                   countExprTemps(ast, node->data.array_2d_assign.value);
+        case NODE_PRINT:
+            return countExprTemps(ast, node->data.expr);
+        case NODE_RETURN:
+            return countExprTemps(ast, node->data.return_expr);
+        default:
+            return 0;
+    }
 }
 
-void printOptimizedTAC() {
+// Move the instructions of part to the end of list
+static void spliceTAC(TACList* list, TACList* part) {
+    if (!part->head) return;
+    if (list->head) {
+        list->tail->next = part->head;
+    } else {
+        list->head = part->head;
+    }
+    list->tail = part->tail;
+    part->head = part->tail = NULL;
+}
+
+/* A range of functions, or of instructions, for one task */
+typedef struct {
+    const AST* ast;
+    NodeId* funcs;
+    int count;
+    TACInstr* first;        // Instructions from first up to end
+    TACInstr* end;
+    TACList list;           // What the task produced
+} TACTask;
+
+static void generateTACTask(void* arg) {
+    TACTask* task = arg;
+    for (int i = 0; i < task->count; i++) {
+        generateTAC(&task->list, task->ast, task->funcs[i]);
+    }
+}
+
+static void optimizeTACTask(void* arg) {
+    TACTask* task = arg;
+    optimizeRange(task->first, task->end, &task->list);
+}
+
+/* generateTAC for the program under root, one range of functions per
+ * task on pool (serially without a pool) */
+void generateTACParallel(TACList* list, const AST* ast, NodeId root, ThreadPool* pool) {
+    NodeId* funcs = NULL;
+    int count = pool ? collectFunctions(ast, root, &funcs) : 0;
+    int taskCount = count > 1 ? poolTaskCount(pool, count) : 0;
+    TACTask* tasks = taskCount > 0 ? calloc(taskCount, sizeof(TACTask)) : NULL;
+    if (!tasks) {
+        free(funcs);
+        generateTAC(list, ast, root);
+        return;
+    }
+    
+    int temps = list->tempCount;
+    for (int t = 0; t < taskCount; t++) {
+        int first = (int)((long)count * t / taskCount);
+        int last = (int)((long)count * (t + 1) / taskCount);
+        TACTask* task = &tasks[t];
+        task->ast = ast;
+        task->funcs = funcs + first;
+        task->count = last - first;
+        initTAC(&task->list);
+        task->list.tempCount = temps;
+        for (int i = first; i < last; i++) temps += countTemps(ast, funcs[i]);
+        poolSubmit(pool, generateTACTask, task);
+    }
+    poolWait(pool);
+    
+    for (int t = 0; t < taskCount; t++) spliceTAC(list, &tasks[t].list);
+    list->tempCount = temps;
+    free(tasks);
+    free(funcs);
+}
+
+/* optimizeTAC with the functions of 'in' spread over pool */
+void optimizeTACParallel(TACList* in, TACList* out, ThreadPool* pool) {
+    // Every FUNC_BEGIN starts over with no known constants
+    TACInstr** starts = NULL;
+    int count = 0, capacity = 0;
+    for (TACInstr* curr = in->head; curr && pool; curr = curr->next) {
+        if (curr != in->head && curr->op != TAC_FUNC_BEGIN) continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            TACInstr** grown = realloc(starts, capacity * sizeof(TACInstr*));
+            if (!grown) {
+                count = 0;
+                break;
+            }
+            starts = grown;
+        }
+        starts[count++] = curr;
+    }
+    int taskCount = count > 1 ? poolTaskCount(pool, count) : 0;
+    TACTask* tasks = taskCount > 0 ? calloc(taskCount, sizeof(TACTask)) : NULL;
+    if (!tasks) {
+        free(starts);
+        optimizeTAC(in, out);
+        return;
+    }
+    
+    for (int t = 0; t < taskCount; t++) {
+        int first = (int)((long)count * t / taskCount);
+        int last = (int)((long)count * (t + 1) / taskCount);
+        TACTask* task = &tasks[t];
+        task->first = starts[first];
+        task->end = last < count ? starts[last] : NULL;
+        initTAC(&task->list);
+        poolSubmit(pool, optimizeTACTask, task);
+    }
+    poolWait(pool);
+    
+    for (int t = 0; t < taskCount; t++) spliceTAC(out, &tasks[t].list);
+    free(tasks);
+    free(starts);
+}
+
+void printOptimizedTAC(TACList* list) {
     printf("\nOptimized TAC Instructions:\n");
     printf("───────────────────────────\n");
-    TACInstr* curr = optimizedList.head;
+    TACInstr* curr = list->head;
     int lineNum = 1;
     while (curr) {
         printf("%2d: ", lineNum++);
@@ -559,6 +754,9 @@ void printOptimizedTAC() {
                     printf("RETURN\n");
                 }
                 break;
+            case TAC_PARAM_DECL:
+                printf("PARAM_DECL %s\n", curr->result);
+                break;
             case TAC_DECL:
                 printf("DECL %s\n", curr->result);
                 break;
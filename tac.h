@@ -2,6 +2,7 @@
 #define TAC_H
 
 #include "ast.h"
+#include "pool.h"
 
 /* TAC INSTRUCTION TYPES */
 typedef enum {
@@ -23,7 +24,8 @@ typedef enum {
     TAC_FUNC_END,     // Mark function end
     TAC_PARAM,        // Push parameter for call
     TAC_CALL,         // Function call
-    TAC_RETURN        // Return from function
+    TAC_RETURN,       // Return from function
+    TAC_PARAM_DECL    // Name an incoming parameter
 } TACOp;
 
 /* TAC INSTRUCTION STRUCTURE */
@@ -45,17 +47,26 @@ typedef struct {
 } TACList;
 
 /* TAC GENERATION FUNCTIONS */
-void initTAC();
-char* newTemp();
-TACInstr* createTAC(TACOp op, char* arg1, char* arg2, char* result);
-TACInstr* createTAC2D(TACOp op, char* arg1, char* arg2, char* arg3, char* result);
-void appendTAC(TACInstr* instr);
-void generateTAC(ASTNode* node);
-char* generateTACExpr(ASTNode* node);
+void initTAC(TACList* list);
+void freeTAC(TACList* list);
+char* newTemp(TACList* list);
+TACInstr* createTAC(TACOp op, const char* arg1, const char* arg2, const char* result);
+TACInstr* createTAC2D(TACOp op, const char* arg1, const char* arg2, const char* arg3,
+                      const char* result);
+void appendTAC(TACList* list, TACInstr* instr);
+void generateTAC(TACList* list, const AST* ast, NodeId id);
+char* generateTACExpr(TACList* list, const AST* ast, NodeId id);
 
 /* TAC OPTIMIZATION AND OUTPUT */
-void printTAC();
-void optimizeTAC();
-void printOptimizedTAC();
+void printTAC(TACList* list);
+void optimizeTAC(TACList* in, TACList* out);
+void printOptimizedTAC(TACList* list);
+int isConstant(char* str);
+int isTemp(char* str);    // A name from newTemp, which no identifier can be
+
+/* The same passes with the functions spread over a thread pool; the
+ * result does not depend on the pool. A NULL pool runs them serially. */
+void generateTACParallel(TACList* list, const AST* ast, NodeId root, ThreadPool* pool);
+void optimizeTACParallel(TACList* in, TACList* out, ThreadPool* pool);
 
 #endif
\ No newline at end of file
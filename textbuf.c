@@ -0,0 +1,106 @@
+/* TEXT BUFFER
+ * The assembly emitter appends to one growable buffer instead of
+ * calling fprintf per line. Instructions are formatted by hand
+ * (textAppendInt, register names with known lengths), and the result
+ * goes out in a single write() - or straight to the caller in library
+ * mode. textAppendf is kept for the occasional comment line.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <unistd.h>
+#include "textbuf.h"
+
+#define INITIAL_CAPACITY 65536
+
+// Make room for extra bytes plus the terminating NUL
+static int reserve(TextBuffer* buf, size_t extra) {
+    if (buf->failed) return -1;
+    if (buf->size + extra + 1 <= buf->capacity) return 0;
+
+    size_t capacity = buf->capacity ? buf->capacity : INITIAL_CAPACITY;
+    while (buf->size + extra + 1 > capacity) capacity *= 2;
+    char* data = realloc(buf->data, capacity);
+    if (!data) {
+        buf->failed = 1;
+        return -1;
+    }
+    buf->data = data;
+    buf->capacity = capacity;
+    return 0;
+}
+
+void textAppend(TextBuffer* buf, const char* text, size_t length) {
+    if (reserve(buf, length) != 0) return;
+    memcpy(buf->data + buf->size, text, length);
+    buf->size += length;
+    buf->data[buf->size] = '\0';
+}
+
+void textAppendString(TextBuffer* buf, const char* text) {
+    textAppend(buf, text, strlen(text));
+}
+
+void textAppendChar(TextBuffer* buf, char c) {
+    if (reserve(buf, 1) != 0) return;
+    buf->data[buf->size++] = c;
+    buf->data[buf->size] = '\0';
+}
+
+void textAppendInt(TextBuffer* buf, int value) {
+    char digits[12];
+    char* p = digits + sizeof(digits);
+    // Work in unsigned so INT_MIN negates cleanly
+    unsigned magnitude = value < 0 ? 0u - (unsigned)value : (unsigned)value;
+    do {
+        *--p = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) *--p = '-';
+    textAppend(buf, p, digits + sizeof(digits) - p);
+}
+
+void textAppendv(TextBuffer* buf, const char* fmt, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(NULL, 0, fmt, copy);
+    va_end(copy);
+    if (length < 0 || reserve(buf, (size_t)length) != 0) return;
+
+    vsnprintf(buf->data + buf->size, (size_t)length + 1, fmt, args);
+    buf->size += length;
+}
+
+void textAppendf(TextBuffer* buf, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    textAppendv(buf, fmt, args);
+    va_end(args);
+}
+
+void textFree(TextBuffer* buf) {
+    free(buf->data);
+    memset(buf, 0, sizeof(TextBuffer));
+}
+
+void textReset(TextBuffer* buf) {
+    buf->size = 0;
+    buf->failed = 0;
+    if (buf->data) buf->data[0] = '\0';
+}
+
+int writeAll(int fd, const void* data, size_t size) {
+    const char* bytes = data;
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = write(fd, bytes + done, size - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        done += n;
+    }
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef TEXTBUF_H
+#define TEXTBUF_H
+
+#include <stddef.h>
+#include <stdarg.h>
+
+/* Growable byte buffer for generated text. A zeroed buffer is empty. */
+typedef struct {
+    char* data;             // NUL-terminated once anything was appended
+    size_t size;
+    size_t capacity;
+    int failed;             // Set if memory ran out; later appends are dropped
+} TextBuffer;
+
+void textAppend(TextBuffer* buf, const char* text, size_t length);
+void textAppendString(TextBuffer* buf, const char* text);
+void textAppendChar(TextBuffer* buf, char c);
+void textAppendInt(TextBuffer* buf, int value);
+void textAppendf(TextBuffer* buf, const char* fmt, ...);
+void textAppendv(TextBuffer* buf, const char* fmt, va_list args);
+void textFree(TextBuffer* buf);
+
+/* Empty the buffer but keep its memory for the next use */
+void textReset(TextBuffer* buf);
+
+/* Write all size bytes to fd, retrying short writes. Returns 0 on
+ * success. */
+int writeAll(int fd, const void* data, size_t size);
+
+#endif